@@ -16,10 +16,19 @@ int main(int argc, char** argv)
 	// Executer tous les tests unitaires.
 	// 
 	// Les tests sont crites dans les fichiers:
+	//   tests/TestsAllocation.cpp
 	//   tests/TestsDenseStorage.cpp
+	//   tests/TestsExpression.cpp
+	//   tests/TestsFixedSize.cpp
+	//   tests/TestsInstrumentation.cpp
+	//   tests/TestsMappedFile.cpp
+	//   tests/TestsMap.cpp
 	//   tests/TestsMatrix.cpp
+	//   tests/TestsMatrixView.cpp
 	//   tests/TestsOperators.cpp
+	//   tests/TestsParallel.cpp
 	//   tests/TestsPerformance.cpp
+	//   tests/TestsSimd.cpp
 	//   tests/TestsSparseMatrix.cpp
 	//   tests/TestsSupplementaires.cpp
 	//   tests/TestsVector.cpp
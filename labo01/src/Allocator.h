@@ -0,0 +1,386 @@
+#pragma once
+
+/**
+ * @file Allocator.h
+ *
+ * @brief Politiques d'allocation des tampons dynamiques et arène par trame.
+ *
+ * Une politique d'allocation est une classe sans état qui fournit :
+ *
+ *    static void* allocate(size_t bytes, size_t alignment);
+ *    static void deallocate(void* ptr);
+ *
+ * DenseStorage<_Scalar, Dynamic> reçoit sa politique en paramètre de patron.
+ * La politique par défaut (DefaultAllocator) sert les demandes à partir de
+ * l'arène active du fil d'exécution courant, s'il y en a une, et se rabat sur
+ * le tas sinon. Une arène est une simple allocation par incrément (bump) que
+ * l'on réinitialise une fois par trame ou par résolution : en régime
+ * permanent, les temporaires matriciels n'allouent plus rien sur le tas.
+ *
+ * Les très grands tampons (au moins HugePageAllocator::threshold() octets)
+ * peuvent être servis en pages énormes, ce qui réduit les défauts de TLB des
+ * noyaux limités par la bande passante (GEMV). Ce mode est désactivé par
+ * défaut (GTI320_HUGE_PAGE_THRESHOLD vaut 0).
+ *
+ */
+
+#include "Memory.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#ifndef GTI320_HUGE_PAGE_THRESHOLD
+#define GTI320_HUGE_PAGE_THRESHOLD 0
+#endif
+
+namespace gti320
+{
+    /**
+     * Allocation sur le tas (alignedMalloc / alignedFree).
+     */
+    struct HeapAllocator
+    {
+        static void* allocate(size_t bytes, size_t alignment)
+        {
+            return alignedMalloc(bytes, alignment);
+        }
+
+        static void deallocate(void* ptr)
+        {
+            alignedFree(ptr);
+        }
+    };
+
+    /**
+     * Allocation en pages énormes (huge pages).
+     *
+     * Sous Linux, le bloc est une projection anonyme : MAP_HUGETLB si le
+     * système a réservé des pages énormes, sinon une projection alignée sur
+     * 2 Mo et marquée MADV_HUGEPAGE (pages énormes transparentes). Les pages
+     * ne sont pas touchées ici : c'est le premier contact, fait en parallèle
+     * par DenseStorage, qui les place sur les nœuds NUMA des fils de calcul.
+     * Sur les autres systèmes (et si la projection échoue), on se rabat sur
+     * alignedMalloc().
+     *
+     * Le mot qui précède le bloc contient l'adresse de la projection avec le
+     * bit 1 à 1, et le mot d'avant, sa longueur.
+     */
+    struct HugePageAllocator
+    {
+        static const size_t PageSize = (size_t)2 << 20;
+
+        static void* allocate(size_t bytes, size_t alignment)
+        {
+#if defined(__linux__)
+            if (alignment < 2 * sizeof(uintptr_t))
+                alignment = 2 * sizeof(uintptr_t);
+            assert(alignment <= 4096);
+
+            // L'en-tête occupe le début de la projection.
+            size_t length = (bytes + alignment + PageSize - 1) & ~(PageSize - 1);
+            char* base = nullptr;
+            void* raw = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+            raw = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            base = static_cast<char*>(raw);
+#endif
+            if (raw == MAP_FAILED)
+            {
+                // Une page de plus pour aligner le début sur 2 Mo.
+                length += PageSize;
+                raw = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (raw == MAP_FAILED)
+                    return alignedMalloc(bytes, alignment);
+
+                base = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw) + PageSize - 1) & ~(uintptr_t)(PageSize - 1));
+#if defined(MADV_HUGEPAGE)
+                ::madvise(base, length - (size_t)(base - static_cast<char*>(raw)), MADV_HUGEPAGE);
+#endif
+            }
+
+            uintptr_t* block = reinterpret_cast<uintptr_t*>(base + alignment);
+            block[-1] = reinterpret_cast<uintptr_t>(raw) | 2u;
+            block[-2] = (uintptr_t)length;
+            return block;
+#else
+            return alignedMalloc(bytes, alignment);
+#endif
+        }
+
+        static void deallocate(void* ptr)
+        {
+            if (ptr == nullptr)
+                return;
+
+#if defined(__linux__)
+            const uintptr_t header = reinterpret_cast<uintptr_t*>(ptr)[-1];
+            if (header & 2u)
+            {
+                ::munmap(reinterpret_cast<void*>(header & ~(uintptr_t)3u), (size_t)reinterpret_cast<uintptr_t*>(ptr)[-2]);
+                return;
+            }
+#endif
+            alignedFree(ptr);
+        }
+
+        /**
+         * Taille (octets) à partir de laquelle DefaultAllocator utilise les
+         * pages énormes (0 : jamais).
+         */
+        static size_t& threshold()
+        {
+            static size_t s_threshold = GTI320_HUGE_PAGE_THRESHOLD;
+            return s_threshold;
+        }
+    };
+
+    /**
+     * Arène d'allocation par incrément.
+     *
+     * Les blocs sont découpés séquentiellement dans un tampon unique et ne sont
+     * jamais libérés individuellement : reset() récupère toute la mémoire d'un
+     * coup. Une demande qui ne tient pas dans l'arène est refusée (nullptr) et
+     * la politique appelante se rabat sur le tas ; au reset() suivant, l'arène
+     * est agrandie à la demande totale observée pour que les trames suivantes
+     * tiennent entièrement dans l'arène.
+     *
+     * Un tampon obtenu de l'arène peut survivre à la trame (par exemple un
+     * objet durable redimensionné dans la portée d'une ArenaScope) : tant
+     * qu'un bloc est vivant, reset() ne réutilise pas la mémoire, et les
+     * trames suivantes continuent à la suite du dernier bloc (puis sur le
+     * tas une fois l'arène pleine). L'arène est remise à zéro au premier
+     * reset() où plus aucun bloc n'est vivant. Détruire une arène qui a
+     * encore des blocs vivants met fin au programme : leur libération
+     * écrirait dans l'arène détruite.
+     *
+     * Limite : un seul bloc durable suffit à bloquer l'arène tant qu'il vit.
+     * Toutes les trames suivantes débordent alors sur le tas, et la garantie
+     * « aucune allocation sur le tas en régime permanent » ne tient plus ;
+     * seul deferredResets() le signale. Les objets durables doivent donc être
+     * alloués hors de toute ArenaScope, ou copiés hors de l'arène avant la
+     * fin de la trame.
+     *
+     * Un bloc peut être libéré par un autre fil que celui qui l'a obtenu (une
+     * matrice détruite dans une tâche de la réserve de fils) : le compteur
+     * de blocs vivants est atomique. Les autres opérations (allocate(),
+     * reset()) restent réservées au fil qui a activé l'arène.
+     */
+    class ArenaAllocator
+    {
+    public:
+
+        /**
+         * Construit une arène pouvant contenir `capacity` octets.
+         */
+        explicit ArenaAllocator(size_t capacity = 0) :
+            m_block(nullptr), m_capacity(0), m_used(0), m_requested(0), m_live(0), m_overflows(0), m_deferred(0)
+        {
+            grow(capacity);
+        }
+
+        ~ArenaAllocator()
+        {
+            assert(m_live.load() == 0 && "arene detruite avec des blocs vivants");
+            if (m_live.load(std::memory_order_acquire) != 0)
+                std::abort();
+            HeapAllocator::deallocate(m_block);
+        }
+
+        /**
+         * Réserve `bytes` octets alignés sur `alignment` octets.
+         *
+         * Un mot d'en-tête précède chaque bloc et identifie l'arène
+         * propriétaire (voir DefaultAllocator::deallocate).
+         *
+         * Retourne nullptr si l'arène est pleine.
+         */
+        void* allocate(size_t bytes, size_t alignment)
+        {
+            if (alignment < sizeof(uintptr_t))
+                alignment = sizeof(uintptr_t);
+
+            m_requested += bytes + alignment + sizeof(uintptr_t);
+
+            const uintptr_t base = reinterpret_cast<uintptr_t>(m_block) + m_used;
+            const uintptr_t aligned = (base + sizeof(uintptr_t) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            const size_t end = (size_t)(aligned - reinterpret_cast<uintptr_t>(m_block)) + bytes;
+            if (m_block == nullptr || end > m_capacity)
+            {
+                ++m_overflows;
+                return nullptr;
+            }
+
+            reinterpret_cast<uintptr_t*>(aligned)[-1] = reinterpret_cast<uintptr_t>(this) | 1u;
+            m_used = end;
+            m_live.fetch_add(1, std::memory_order_relaxed);
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        /**
+         * Signale qu'un bloc de l'arène n'est plus utilisé. Peut être appelée
+         * depuis n'importe quel fil.
+         */
+        void release()
+        {
+            const size_t live = m_live.fetch_sub(1, std::memory_order_release);
+            assert(live > 0);
+            (void)live;
+        }
+
+        /**
+         * Récupère toute la mémoire de l'arène, si aucun bloc n'est vivant ;
+         * sinon, ne fait rien (voir deferredResets()).
+         *
+         * Si la dernière trame a débordé, l'arène est agrandie pour contenir
+         * la demande totale observée.
+         */
+        void reset()
+        {
+            if (m_live.load(std::memory_order_acquire) != 0)
+            {
+                // La demande de la prochaine trame s'ajoutera aux blocs vivants.
+                ++m_deferred;
+                m_requested = m_used;
+                return;
+            }
+            if (m_requested > m_capacity)
+            {
+                grow(m_requested);
+            }
+            m_used = 0;
+            m_requested = 0;
+        }
+
+        inline size_t capacity() const { return m_capacity; }
+        inline size_t used() const { return m_used; }
+        inline size_t live() const { return m_live.load(std::memory_order_acquire); }
+
+        /**
+         * Nombre de demandes refusées (servies par le tas) depuis la création.
+         */
+        inline size_t overflows() const { return m_overflows; }
+
+        /**
+         * Nombre de reset() sans effet parce que des blocs étaient vivants.
+         */
+        inline size_t deferredResets() const { return m_deferred; }
+
+        /**
+         * Arène active du fil d'exécution courant (nullptr s'il n'y en a pas).
+         */
+        static ArenaAllocator*& active()
+        {
+            static thread_local ArenaAllocator* s_active = nullptr;
+            return s_active;
+        }
+
+    private:
+
+        ArenaAllocator(const ArenaAllocator&) = delete;
+        ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+        void grow(size_t capacity)
+        {
+            HeapAllocator::deallocate(m_block);
+            m_block = nullptr;
+            m_capacity = 0;
+            if (capacity > 0)
+            {
+                m_block = static_cast<char*>(HeapAllocator::allocate(capacity, Aligned64));
+                m_capacity = capacity;
+            }
+        }
+
+        char* m_block;          // Tampon de l'arène
+        size_t m_capacity;      // Taille du tampon (octets)
+        size_t m_used;          // Octets consommés depuis le dernier reset()
+        size_t m_requested;     // Demande totale (servie ou non) depuis le dernier reset()
+        std::atomic<size_t> m_live; // Nombre de blocs encore utilisés
+        size_t m_overflows;     // Nombre de demandes servies par le tas
+        size_t m_deferred;      // Nombre de reset() différés (blocs vivants)
+    };
+
+    /**
+     * Active une arène pour le fil d'exécution courant, le temps d'une portée.
+     *
+     * À la sortie de la portée, l'arène active précédente est restaurée et
+     * l'arène est réinitialisée. Typiquement, une portée par trame :
+     *
+     *    ArenaScope frame(arena);
+     *    ... calculs de la trame ...
+     */
+    class ArenaScope
+    {
+    public:
+        explicit ArenaScope(ArenaAllocator& arena) :
+            m_arena(arena), m_previous(ArenaAllocator::active())
+        {
+            ArenaAllocator::active() = &m_arena;
+        }
+
+        ~ArenaScope()
+        {
+            ArenaAllocator::active() = m_previous;
+            m_arena.reset();
+        }
+
+    private:
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+
+        ArenaAllocator& m_arena;
+        ArenaAllocator* m_previous;
+    };
+
+    /**
+     * Politique par défaut : arène active du fil courant, sinon les pages
+     * énormes pour les très grands tampons (si activées), sinon le tas.
+     *
+     * Le mot qui précède chaque bloc permet de distinguer les origines :
+     * alignedMalloc() y conserve un pointeur (deux bits de poids faible à 0),
+     * l'arène y inscrit son adresse avec le bit 0 à 1 et HugePageAllocator,
+     * l'adresse de sa projection avec le bit 1 à 1.
+     */
+    struct DefaultAllocator
+    {
+        static void* allocate(size_t bytes, size_t alignment)
+        {
+            ArenaAllocator* arena = ArenaAllocator::active();
+            if (arena != nullptr)
+            {
+                void* ptr = arena->allocate(bytes, alignment);
+                if (ptr != nullptr)
+                    return ptr;
+            }
+            const size_t threshold = HugePageAllocator::threshold();
+            if (threshold > 0 && bytes >= threshold)
+            {
+                return HugePageAllocator::allocate(bytes, alignment);
+            }
+            return HeapAllocator::allocate(bytes, alignment);
+        }
+
+        static void deallocate(void* ptr)
+        {
+            if (ptr == nullptr)
+                return;
+
+            const uintptr_t header = reinterpret_cast<uintptr_t*>(ptr)[-1];
+            if (header & 1u)
+            {
+                reinterpret_cast<ArenaAllocator*>(header & ~(uintptr_t)1u)->release();
+            }
+            else
+            {
+                HugePageAllocator::deallocate(ptr);
+            }
+        }
+    };
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+/**
+ * @file BlockSparseMatrix.h
+ *
+ * @brief Matrice creuse par blocs denses de taille fixe (format BSR, CRS
+ *        par blocs), pour les systèmes dont la structure creuse vient de
+ *        petits blocs : jacobiens cinématiques, corps rigides (3 x 3), etc.
+ *
+ * La matrice est découpée en blocs de _BlockRows x _BlockCols, et seuls les
+ * blocs non nuls sont stockés, en CRS sur les indices de blocs :
+ *
+ *    ligne de blocs bi :    blocs [outer()[bi], outer()[bi + 1])
+ *    bloc k :               colonne de blocs inner()[k],
+ *                           entrées values()[k * BlockSize, (k + 1) * BlockSize)
+ *                           (stockage par colonnes)
+ *
+ * Par rapport à SparseMatrix, un seul indice de colonne est lu par bloc au
+ * lieu d'un par entrée, et le produit de chaque bloc par un morceau de x est
+ * un noyau déroulé à la compilation (voir FixedSize.h). Le produit par la
+ * transposée utilise le même bloc lu par lignes, sans autre copie.
+ *
+ */
+
+#include "Types.h"
+#include "DenseStorage.h"
+#include "Matrix.h"
+#include "FixedSize.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace gti320
+{
+    /**
+     * Bloc (i, j) d'une matrice creuse par blocs : i et j sont des indices
+     * de blocs.
+     */
+    template<typename _Scalar, int _BlockRows, int _BlockCols>
+    struct BlockTripletType
+    {
+        Matrix<_Scalar, _BlockRows, _BlockCols> block;
+        Index i, j;
+    };
+
+    namespace internal
+    {
+        /**
+         * y = A * x pour les lignes de blocs [first, last).
+         */
+        template<int _BlockRows, int _BlockCols, typename _Scalar>
+        inline void bsrSpmvRows(Index first, Index last, const Index* start, const Index* inner, const _Scalar* values,
+            const _Scalar* x, _Scalar* y)
+        {
+            const int size = _BlockRows * _BlockCols;
+            for (Index bi = first; bi < last; ++bi)
+            {
+                _Scalar sum[_BlockRows] = { };
+                for (Index k = start[bi]; k < start[bi + 1]; ++k)
+                {
+                    _Scalar t[_BlockRows];
+                    fixedProduct<_BlockRows, _BlockCols, 1, ColumnStorage, ColumnStorage, ColumnStorage>(values + k * size, x + inner[k] * _BlockCols, t);
+                    for (int r = 0; r < _BlockRows; ++r)
+                        sum[r] += t[r];
+                }
+                for (int r = 0; r < _BlockRows; ++r)
+                    y[bi * _BlockRows + r] = sum[r];
+            }
+        }
+
+        /**
+         * y += A^T * x pour les lignes de blocs [first, last) : chaque bloc,
+         * stocké par colonnes, est lu comme sa transposée stockée par lignes.
+         */
+        template<int _BlockRows, int _BlockCols, typename _Scalar>
+        inline void bsrSpmvTransposedRows(Index first, Index last, const Index* start, const Index* inner, const _Scalar* values,
+            const _Scalar* x, _Scalar* y)
+        {
+            const int size = _BlockRows * _BlockCols;
+            for (Index bi = first; bi < last; ++bi)
+            {
+                const _Scalar* xi = x + bi * _BlockRows;
+                for (Index k = start[bi]; k < start[bi + 1]; ++k)
+                {
+                    _Scalar t[_BlockCols];
+                    fixedProduct<_BlockCols, _BlockRows, 1, RowStorage, ColumnStorage, ColumnStorage>(values + k * size, xi, t);
+                    _Scalar* yj = y + inner[k] * _BlockCols;
+                    for (int c = 0; c < _BlockCols; ++c)
+                        yj[c] += t[c];
+                }
+            }
+        }
+    }
+
+    /**
+     * Matrice creuse de blocs denses _BlockRows x _BlockCols (voir l'en-tête
+     * du fichier). Les dimensions rows() et cols() sont des multiples des
+     * dimensions d'un bloc.
+     *
+     * Invariant : dans chaque ligne de blocs, les colonnes de blocs sont
+     * distinctes et en ordre croissant (établi par setFromTriplets()).
+     */
+    template<typename _Scalar, int _BlockRows, int _BlockCols = _BlockRows>
+    class BlockSparseMatrix
+    {
+        static_assert(_BlockRows > 0 && _BlockCols > 0, "les dimensions d'un bloc doivent être fixes");
+
+    public:
+
+        static const int BlockRows = _BlockRows;
+        static const int BlockCols = _BlockCols;
+        static const int BlockSize = _BlockRows * _BlockCols;
+
+        typedef BlockTripletType<_Scalar, _BlockRows, _BlockCols> Triplet;
+
+        BlockSparseMatrix() : m_blockRows(0), m_blockCols(0), m_start(1)
+        { }
+
+        // Matrice nulle de blockRows x blockCols blocs
+        explicit BlockSparseMatrix(Index blockRows, Index blockCols) :
+            m_blockRows(blockRows), m_blockCols(blockCols), m_start(blockRows + 1)
+        { }
+
+        Index rows() const { return m_blockRows * _BlockRows; }
+
+        Index cols() const { return m_blockCols * _BlockCols; }
+
+        Index blockRows() const { return m_blockRows; }
+
+        Index blockCols() const { return m_blockCols; }
+
+        // Nombre de blocs stockés
+        Index nonZeroBlocks() const { return m_inner.size(); }
+
+        const Index* outer() const { return m_start.data(); }
+
+        const Index* inner() const { return m_inner.data(); }
+
+        const _Scalar* values() const { return m_vals.data(); }
+
+        // Position du bloc (bi, bj) dans inner(), -1 s'il n'est pas stocké.
+        Index find(Index bi, Index bj) const
+        {
+            assert(bi >= 0 && bi < m_blockRows);
+            assert(bj >= 0 && bj < m_blockCols);
+
+            const Index* first = m_inner.data() + m_start[bi];
+            const Index* last = m_inner.data() + m_start[bi + 1];
+            const Index* it = std::lower_bound(first, last, bj);
+            return (it != last && *it == bj) ? (Index)(it - m_inner.data()) : -1;
+        }
+
+        // Coefficient (i, j), 0 s'il est hors des blocs stockés.
+        _Scalar operator()(Index i, Index j) const
+        {
+            const Index k = find(i / _BlockRows, j / _BlockCols);
+            return k < 0 ? _Scalar(0) : m_vals[k * BlockSize + i % _BlockRows + (j % _BlockCols) * _BlockRows];
+        }
+
+        // Construit la matrice à partir de `_size` blocs (bi, bj, bloc), en
+        // O(nnzb + blockRows + blockCols) comme SparseMatrix::setFromTriplets() :
+        // deux tris par dénombrement stables (par colonne de blocs, puis par
+        // ligne de blocs), puis les blocs répétés sont additionnés dans
+        // l'ordre des triplets.
+        void setFromTriplets(const Triplet* _triplets, Index _size)
+        {
+            assert((_triplets != nullptr) || (_size == 0));
+
+            m_start.resize(m_blockRows + 1);
+            m_start.setZero();
+            if (m_blockRows == 0 || m_blockCols == 0 || _size == 0)
+            {
+                m_inner.resize(0);
+                m_vals.resize(0);
+                return;
+            }
+
+            // Passe 1 : permutation des triplets, triée par colonne de blocs.
+            std::vector<Index> count((size_t)std::max(m_blockRows, m_blockCols) + 1);
+            std::vector<Index> byCol((size_t)_size);
+            countingSort(_size, m_blockCols, count,
+                [_triplets](Index t) { return _triplets[t].j; },
+                [&byCol](Index t, Index pos) { byCol[(size_t)pos] = t; });
+
+            // Passe 2 : triplets groupés par ligne de blocs, colonnes en ordre
+            // croissant ; count reçoit le début de chaque ligne.
+            std::vector<Index> order((size_t)_size);
+            countingSort(_size, m_blockRows, count,
+                [_triplets, &byCol](Index q) { return _triplets[byCol[(size_t)q]].i; },
+                [&byCol, &order](Index q, Index pos) { order[(size_t)pos] = byCol[(size_t)q]; });
+            std::vector<Index>().swap(byCol);
+
+            // Passe 3 : fusion des doublons.
+            Index nnzb = 0;
+            for (Index bi = 0; bi < m_blockRows; ++bi)
+            {
+                m_start[bi] = nnzb;
+                for (Index q = count[(size_t)bi]; q < count[(size_t)bi + 1]; ++q)
+                {
+                    if (q == count[(size_t)bi] || _triplets[order[(size_t)q]].j != _triplets[order[(size_t)q - 1]].j)
+                        ++nnzb;
+                }
+            }
+            m_start[m_blockRows] = nnzb;
+
+            m_inner.resize(nnzb, Uninitialized);
+            m_vals.resize(nnzb * BlockSize, Uninitialized);
+            Index k = -1;
+            for (Index q = 0; q < _size; ++q)
+            {
+                const Triplet& triplet = _triplets[order[(size_t)q]];
+                assert(0 <= triplet.j && triplet.j < m_blockCols);
+                const _Scalar* block = triplet.block.data();
+                if (k < 0 || triplet.i != _triplets[order[(size_t)q - 1]].i || triplet.j != m_inner[k])
+                {
+                    ++k;
+                    m_inner[k] = triplet.j;
+                    std::copy(block, block + BlockSize, m_vals.data() + k * BlockSize);
+                }
+                else
+                {
+                    _Scalar* dst = m_vals.data() + k * BlockSize;
+                    for (int e = 0; e < BlockSize; ++e)
+                        dst[e] += block[e];
+                }
+            }
+        }
+
+        /**
+         * y = A * x pour les lignes de blocs [first, last) ; les autres
+         * entrées de y ne sont pas écrites.
+         */
+        void multiplyRows(Index first, Index last, const _Scalar* x, _Scalar* y) const
+        {
+            assert(0 <= first && first <= last && last <= m_blockRows);
+            internal::bsrSpmvRows<_BlockRows, _BlockCols>(first, last, m_start.data(), m_inner.data(), m_vals.data(), x, y);
+        }
+
+        /**
+         * y += A^T * x pour les lignes de blocs [first, last) de A.
+         */
+        void multiplyTransposedRows(Index first, Index last, const _Scalar* x, _Scalar* y) const
+        {
+            assert(0 <= first && first <= last && last <= m_blockRows);
+            internal::bsrSpmvTransposedRows<_BlockRows, _BlockCols>(first, last, m_start.data(), m_inner.data(), m_vals.data(), x, y);
+        }
+
+    private:
+
+        // Tri par dénombrement stable des éléments [0, _size) selon key(e)
+        // dans [0, _keys) : place(e, pos) reçoit la position de e, et
+        // begin[c] le début de la clé c (begin[_keys] = _size).
+        template<typename _Key, typename _Place>
+        static void countingSort(Index _size, Index _keys, std::vector<Index>& begin, const _Key& key, const _Place& place)
+        {
+            std::fill(begin.begin(), begin.begin() + (size_t)_keys + 1, Index(0));
+            for (Index e = 0; e < _size; ++e)
+            {
+                const Index c = key(e);
+                assert(0 <= c && c < _keys);
+                ++begin[(size_t)c + 1];
+            }
+            for (Index c = 0; c < _keys; ++c)
+                begin[(size_t)c + 1] += begin[(size_t)c];
+
+            std::vector<Index> next(begin.begin(), begin.begin() + (size_t)_keys);
+            for (Index e = 0; e < _size; ++e)
+                place(e, next[(size_t)key(e)]++);
+        }
+
+        Index m_blockRows, m_blockCols;
+        DenseStorage<Index, Dynamic> m_start;           // début de chaque ligne de blocs (blockRows() + 1 entrées)
+        DenseStorage<Index, Dynamic> m_inner;           // colonne de chaque bloc
+        DenseStorage<_Scalar, Dynamic> m_vals;          // blocs, BlockSize entrées chacun, stockés par colonnes
+    };
+}
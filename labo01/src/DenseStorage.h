@@ -12,12 +12,83 @@
  */
 
 #include "Types.h"
+#include "Memory.h"
+#include "Allocator.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "Instrumentation.h"
 
 #include <cstring>
+#include <atomic>
 #include <cassert>
+#include <stdexcept>
+#include <utility>
+
+#ifndef GTI320_INLINE_CAPACITY
+#define GTI320_INLINE_CAPACITY 16
+#endif
+
+#ifndef GTI320_PARALLEL_FIRST_TOUCH
+#define GTI320_PARALLEL_FIRST_TOUCH (4u << 20)
+#endif
+
+#ifndef GTI320_COPY_ON_WRITE
+#define GTI320_COPY_ON_WRITE 0
+#endif
 
 namespace gti320
 {
+    namespace internal
+    {
+        inline bool& copyOnWriteSetting()
+        {
+            static bool s_copyOnWrite = GTI320_COPY_ON_WRITE != 0;
+            return s_copyOnWrite;
+        }
+
+        inline size_t& parallelFirstTouchSetting()
+        {
+            static size_t s_bytes = GTI320_PARALLEL_FIRST_TOUCH;
+            return s_bytes;
+        }
+    }
+
+    /**
+     * Vrai si les tampons alloués sur le tas sont partageables (copie sur
+     * écriture, voir DenseStorage<_Scalar, Dynamic>).
+     */
+    inline bool copyOnWrite()
+    {
+        return internal::copyOnWriteSetting();
+    }
+
+    /**
+     * Active ou désactive la copie sur écriture pour les tampons alloués par
+     * la suite. Les tampons déjà partagés le restent jusqu'à leur détachement.
+     */
+    inline void setCopyOnWrite(bool enabled)
+    {
+        internal::copyOnWriteSetting() = enabled;
+    }
+
+    /**
+     * Taille (en octets) à partir de laquelle un nouveau tampon est mis à
+     * zéro en parallèle (premier contact, voir DenseStorage<_Scalar, Dynamic>).
+     */
+    inline size_t parallelFirstTouch()
+    {
+        return internal::parallelFirstTouchSetting();
+    }
+
+    /**
+     * Fixe la taille du premier contact parallèle (0 : désactivé, les
+     * nouveaux tampons sont mis à zéro par le fil appelant).
+     */
+    inline void setParallelFirstTouch(size_t bytes)
+    {
+        internal::parallelFirstTouchSetting() = bytes;
+    }
+
     /**
      * Stockage à taille fixe.
      *
@@ -25,15 +96,20 @@ namespace gti320
      * Ce nombre est donné par le paramètre de patron : _Size
      *
      * Un tampon (tableau) de taille `_Size_` est alloué sur la pile d'exécution.
+     * Le tampon est aligné sur `_Align` octets dès qu'il couvre au moins un
+     * registre vectoriel (voir FixedAlignment).
+     *
+     * La politique d'allocation `_Allocator` et la capacité interne `_Inline`
+     * ne sont utilisées que par le stockage dynamique.
      */
-    template<typename _Scalar, int _Size>
+    template<typename _Scalar, int _Size, int _Align = DefaultAlignment, typename _Allocator = DefaultAllocator, int _Inline = GTI320_INLINE_CAPACITY>
     class DenseStorage
     {
     private:
 
         // TODO déclarer une variable m_data et allouer la mémoire pour y stocker _Size éléments
         // _Scalar* m_data;  // <-- Ceci n'est pas bon, à modifier
-        _Scalar m_data[_Size];
+        alignas(FixedAlignment<_Scalar, _Size, _Align>::value) _Scalar m_data[_Size];
 
     public:
 
@@ -48,6 +124,18 @@ namespace gti320
         DenseStorage(const DenseStorage& other)
         {
             memcpy(m_data, other.m_data, sizeof(m_data));
+            internal::countCopy(sizeof(m_data));
+        }
+
+        /**
+         * Constructeur de déplacement
+         *
+         * Le tampon est sur la pile : déplacer revient à copier.
+         */
+        DenseStorage(DenseStorage&& other) noexcept
+        {
+            memcpy(m_data, other.m_data, sizeof(m_data));
+            internal::countCopy(sizeof(m_data));
         }
 
         /**
@@ -55,7 +143,16 @@ namespace gti320
          * Doit être la même que la taille spécifiée dans le patron
          *
          */
-        explicit DenseStorage(int _size) 
+        explicit DenseStorage(Index _size) 
+        {
+            assert(_size > 0 && _size == _Size);
+        }
+
+        /**
+         * Constructeur avec taille spécifiée, sans initialisation.
+         * Le tampon fixe n'est jamais initialisé : équivalent au précédent.
+         */
+        DenseStorage(Index _size, UninitializedTag)
         {
             assert(_size > 0 && _size == _Size);
         }
@@ -63,10 +160,11 @@ namespace gti320
         /**
          * Constructeur avec taille (_size) et données initiales (_data).
          */
-        explicit DenseStorage(const _Scalar* _data, int _size)
+        explicit DenseStorage(const _Scalar* _data, Index _size)
         {
             assert(_size >= 0 && _size == _Size);
             memcpy(m_data, _data, sizeof(_Scalar) * _size);
+            internal::countCopy(sizeof(m_data));
         }
 
         /**
@@ -80,20 +178,56 @@ namespace gti320
             {
                 assert(other.size() == _Size);
                 memcpy(m_data, other.m_data, sizeof(m_data));
+                internal::countCopy(sizeof(m_data));
+            }
+            return *this;
+        }
+
+        /**
+         * Opérateur de déplacement
+         */
+        DenseStorage& operator=(DenseStorage&& other) noexcept
+        {
+            if (this != &other)
+            {
+                memcpy(m_data, other.m_data, sizeof(m_data));
+                internal::countCopy(sizeof(m_data));
             }
             return *this;
         }
 
-        static int size() { return _Size; }
+        static Index size() { return _Size; }
+
+        static Index capacity() { return _Size; }
+
+        /**
+         * Alignement (en octets) garanti pour le tampon de données.
+         */
+        static int alignment() { return FixedAlignment<_Scalar, _Size, _Align>::value; }
 
         /**
          * Redimensionne le stockage pour qu'il contienne `size` élément.
          */
-        void resize(int size)
+        void resize(Index size)
+        {
+            // Ne rien faire. Invalide pour les matrices à taille fixe.
+        }
+
+        void resize(Index size, UninitializedTag)
         {
             // Ne rien faire. Invalide pour les matrices à taille fixe.
         }
 
+        void reserve(Index capacity)
+        {
+            // Ne rien faire. La capacité est fixée à la compilation.
+        }
+
+        void shrink_to_fit()
+        {
+            // Ne rien faire. La capacité est fixée à la compilation.
+        }
+
         /**
          * Mets tous les éléments à zéro.
          */
@@ -121,7 +255,7 @@ namespace gti320
         /**
          * Accès bracket (en lecteur seulement)
          */
-        const _Scalar& operator[](int i) const
+        const _Scalar& operator[](Index i) const
         {
             assert(0 <= i && i < _Size);
 
@@ -132,7 +266,7 @@ namespace gti320
          * Accès bracket (pour lecture et écriture)
          * return a pointeur
          */
-        _Scalar& operator[](int i)
+        _Scalar& operator[](Index i)
         {
             assert(0 <= i && i < _Size);
 
@@ -147,15 +281,251 @@ namespace gti320
      * Stockage à taille dynamique.
      *
      * Le nombre de données à stocker est déterminé à l'exécution.
-     * Un tampon de la taille demandée doit être alloué sur le tas via
-     * l'opérateur `new []` et la mémoire doit être libérée avec `delete[]`
+     *
+     * Les petits tampons (au plus `_Inline` éléments) sont stockés dans un
+     * tampon interne à l'objet : les petits vecteurs (angles d'une armature,
+     * vecteurs de travail d'une SVD, etc.) n'allouent rien. Au-delà, le tampon
+     * est alloué sur le tas par la politique `_Allocator` (voir Allocator.h).
+     *
+     * Dans les deux cas, le tampon est aligné sur `_Align` octets et sa taille
+     * est arrondie au multiple supérieur de la largeur vectorielle : le dernier
+     * paquet peut donc être lu en entier par un chargement vectoriel. Le
+     * contenu de ce remplissage n'est pas spécifié. L'alignement du tampon
+     * interne suppose que l'objet lui-même est correctement aligné (pile,
+     * variable statique) ; un conteneur C++11 comme std::vector ne le garantit
+     * pas, d'où l'intérêt de vérifier avec isAligned() avant un chargement
+     * aligné.
+     *
+     * La capacité (nombre d'éléments que peut contenir le tampon courant) est
+     * distincte de la taille : un redimensionnement qui tient dans la capacité
+     * réutilise le tampon existant. La capacité n'est jamais inférieure à
+     * `_Inline`. La mémoire du tas n'est rendue que par shrink_to_fit() ou à
+     * la destruction.
+     *
+     * Le tampon peut aussi être une région d'un fichier projeté en mémoire
+     * (voir map() et MappedFile.h). Une copie d'un stockage projeté est un
+     * stockage ordinaire. Un stockage projeté conserve sa projection tant que
+     * les données qu'on lui affecte tiennent dans sa capacité (taille du
+     * fichier) : `C = A * B` écrit alors directement dans le fichier. Au-delà,
+     * il est détaché de son fichier comme un tampon réalloué.
+     *
+     * De la même façon, le tampon peut être un tampon externe dont le
+     * stockage n'est pas propriétaire (voir wrap() et Map.h) : il n'est
+     * jamais libéré, et un stockage externe déplacé est copié.
+     *
+     * Copie sur écriture (optionnelle, voir setCopyOnWrite()) : un tampon du
+     * tas alloué lorsque le mode est actif est précédé d'un compteur de
+     * références atomique. Les copies partagent alors le tampon en O(1) ; il
+     * n'est dupliqué qu'au premier accès en écriture (data() ou operator[]
+     * non constants, setZero(), affectation). Les accès constants ne touchent
+     * jamais au compteur : plusieurs fils peuvent lire et copier un même
+     * tampon partagé. Attention : un accès non constant détache, même pour une
+     * simple lecture.
      */
-    template<typename _Scalar>
-    class DenseStorage<_Scalar, Dynamic>
+    template<typename _Scalar, int _Align, typename _Allocator, int _Inline>
+    class DenseStorage<_Scalar, Dynamic, _Align, _Allocator, _Inline>
     {
     private:
+        static const int InlineSize = ((_Inline + VectorWidth<_Scalar, _Align>::value - 1) / VectorWidth<_Scalar, _Align>::value) * VectorWidth<_Scalar, _Align>::value;
+
         _Scalar* m_data;
-        int m_size;
+        Index m_size;
+        Index m_capacity;
+        MappedFile* m_file;     // Projection propriétaire de m_data (nullptr sinon)
+        bool m_shareable;       // Tampon du tas précédé d'un compteur de références
+        bool m_external;        // Tampon externe, non possédé
+        alignas(FixedAlignment<_Scalar, InlineSize, _Align>::value) _Scalar m_inline[InlineSize > 0 ? InlineSize : 1];
+
+        /**
+         * Tampon interne (nullptr si `_Inline` est nul).
+         */
+        _Scalar* inlineData() { return _Inline > 0 ? m_inline : nullptr; }
+
+        /**
+         * Vrai si les données ne sont pas sur le tas.
+         */
+        bool isInline() const { return m_data == (_Inline > 0 ? m_inline : nullptr); }
+
+        /**
+         * Vrai si le tampon est lié à une mémoire qui survit au stockage
+         * (fichier projeté ou tampon externe) : les affectations y écrivent
+         * plutôt que de remplacer le tampon.
+         */
+        bool isBound() const { return m_file != nullptr || m_external; }
+
+        /**
+         * Choisit le tampon d'un objet en construction : le tampon interne si
+         * `capacity` y tient, sinon un tampon alloué.
+         */
+        void acquire(Index capacity)
+        {
+            if (capacity > _Inline) {
+                m_data = allocate(capacity, m_shareable);
+                m_capacity = capacity;
+            }
+            else {
+                m_data = inlineData();
+                m_capacity = _Inline;
+                m_shareable = false;
+            }
+        }
+
+        /**
+         * Rend le tampon courant s'il a été alloué sur le tas ou défait sa
+         * projection.
+         */
+        void releaseBuffer()
+        {
+            if (m_file != nullptr) {
+                delete m_file;
+                m_file = nullptr;
+            }
+            else if (m_external) {
+                m_external = false;
+            }
+            else if (!isInline()) {
+                deallocate(m_data, m_capacity, m_shareable);
+            }
+        }
+
+        /**
+         * Remplace le tampon par un tampon pouvant contenir `capacity`
+         * éléments (le tampon interne s'il suffit). Les `keep` premiers
+         * éléments sont conservés.
+         *
+         * Un tampon externe (voir wrap()) n'est jamais remplacé : le stockage
+         * s'en détacherait sans que l'appelant le sache, et les écritures
+         * suivantes n'atteindraient plus son tampon. Dépasser sa capacité
+         * lance std::length_error.
+         */
+        void reallocate(Index capacity, Index keep)
+        {
+            if (m_external) {
+                throw std::length_error("gti320::DenseStorage : capacité d'un tampon externe dépassée");
+            }
+
+            bool shareable = false;
+            _Scalar* data = capacity > _Inline ? allocate(capacity, shareable) : inlineData();
+            if (data == m_data) return;
+
+            if (keep > 0) {
+                copy(data, m_data, keep);
+            }
+            releaseBuffer();
+            m_data = data;
+            m_capacity = capacity > _Inline ? capacity : _Inline;
+            m_shareable = shareable;
+        }
+
+        /**
+         * Avant une écriture : duplique le tampon s'il est partagé avec une
+         * autre copie. Les `keep` premiers éléments sont conservés.
+         */
+        inline void detach(Index keep)
+        {
+            if (m_shareable && refs(m_data).load(std::memory_order_acquire) > 1) {
+                _Scalar* data = allocate(m_capacity, m_shareable);
+                if (keep > 0) {
+                    copy(data, m_data, keep);
+                }
+                deallocate(m_data, m_capacity, true);
+                m_data = data;
+            }
+        }
+
+        /**
+         * Met à zéro un tampon qui vient d'être alloué. C'est le premier
+         * contact avec ses pages : au-delà de parallelFirstTouch() octets,
+         * il est réparti avec parallel_for_static(), et chaque page est
+         * placée sur le nœud NUMA du fil auquel gemv confiera la même
+         * tranche du tampon (voir Parallel.h).
+         */
+        void touchZero()
+        {
+            if (m_size <= 0) return;
+
+            const size_t bytes = sizeof(_Scalar) * (size_t)m_size;
+            const size_t threshold = parallelFirstTouch();
+            if (threshold == 0 || bytes < threshold) {
+                memset(m_data, 0, bytes);
+                return;
+            }
+            _Scalar* data = m_data;
+            const Index page = (Index)(4096 / sizeof(_Scalar)) > 0 ? (Index)(4096 / sizeof(_Scalar)) : 1;
+            parallel_for_static(m_size, [data](Index begin, Index end) {
+                memset(data + begin, 0, sizeof(_Scalar) * (end - begin));
+            }, page);
+        }
+
+        /**
+         * Copie `n` éléments d'un tampon à l'autre (comptée, voir
+         * Instrumentation.h).
+         */
+        static void copy(_Scalar* dst, const _Scalar* src, Index n)
+        {
+            memcpy(dst, src, sizeof(_Scalar) * n);
+            internal::countCopy(sizeof(_Scalar) * n);
+        }
+
+        static size_t allocationAlignment()
+        {
+            return _Align > (int)alignof(_Scalar) ? (size_t)_Align : alignof(_Scalar);
+        }
+
+        /**
+         * Taille de l'en-tête (compteur de références) d'un tampon partageable,
+         * arrondie pour conserver l'alignement des données.
+         */
+        static size_t headerSize()
+        {
+            const size_t align = allocationAlignment();
+            return ((sizeof(std::atomic<int>) + align - 1) / align) * align;
+        }
+
+        /**
+         * Compteur de références d'un tampon partageable.
+         */
+        static std::atomic<int>& refs(const _Scalar* p)
+        {
+            return *reinterpret_cast<std::atomic<int>*>(const_cast<char*>(reinterpret_cast<const char*>(p)) - headerSize());
+        }
+
+        /**
+         * Alloue un tampon aligné pouvant contenir `n` éléments (plus le
+         * remplissage). En mode copie sur écriture, le tampon est précédé
+         * d'un compteur de références initialisé à 1 et `shareable` est vrai.
+         */
+        static _Scalar* allocate(Index n, bool& shareable)
+        {
+            const size_t bytes = sizeof(_Scalar) * paddedSize<_Scalar, _Align>(n);
+            shareable = copyOnWrite();
+            internal::countAllocation(shareable ? headerSize() + bytes : bytes);
+            if (!shareable) {
+                return static_cast<_Scalar*>(_Allocator::allocate(bytes, allocationAlignment()));
+            }
+
+            char* block = static_cast<char*>(_Allocator::allocate(headerSize() + bytes, allocationAlignment()));
+            new (block) std::atomic<int>(1);
+            return reinterpret_cast<_Scalar*>(block + headerSize());
+        }
+
+        /**
+         * Libère un tampon de `n` éléments obtenu avec allocate(). Un tampon
+         * partageable n'est libéré qu'à la disparition de sa dernière
+         * référence.
+         */
+        static void deallocate(_Scalar* p, Index n, bool shareable)
+        {
+            const size_t bytes = sizeof(_Scalar) * paddedSize<_Scalar, _Align>(n);
+            if (!shareable) {
+                internal::countFree(bytes);
+                _Allocator::deallocate(p);
+            }
+            else if (refs(p).fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                internal::countFree(headerSize() + bytes);
+                _Allocator::deallocate(reinterpret_cast<char*>(p) - headerSize());
+            }
+        }
 
     public:
 
@@ -163,52 +533,170 @@ namespace gti320
          * Constructeur par défaut
          */
         DenseStorage() :
-        m_data(nullptr), m_size(0)
+        m_data(inlineData()), m_size(0), m_capacity(_Inline), m_file(nullptr), m_shareable(false), m_external(false)
         {}
 
         /**
          * Constructeur avec taille spécifiée
          */
-        explicit DenseStorage(int _size) :
-        m_data(nullptr), m_size(_size)
+        explicit DenseStorage(Index _size) :
+        m_data(nullptr), m_size(_size), m_capacity(0), m_file(nullptr), m_shareable(false), m_external(false)
         {
             // TODO allouer un tampon pour stocker _size éléments de type _Scalar.
-            m_data = new _Scalar[_size];
+            acquire(_size);
             // TODO initialiser ce tampon à zéro.
-            memset(m_data, 0, sizeof(_Scalar) * _size);
+            touchZero();
+        }
 
-            
+        /**
+         * Constructeur avec taille spécifiée, sans initialisation.
+         * Le contenu du tampon n'est pas spécifié : l'appelant doit écrire
+         * toutes les entrées avant de les lire.
+         */
+        DenseStorage(Index _size, UninitializedTag) :
+        m_data(nullptr), m_size(_size), m_capacity(0), m_file(nullptr), m_shareable(false), m_external(false)
+        {
+            acquire(_size);
         }
 
         /**
          * Constructeur de copie
+         *
+         * Un tampon partageable est partagé (copie sur écriture) ; les autres
+         * sont copiés.
          */
         DenseStorage(const DenseStorage& other) :
             m_data(nullptr)
             , m_size(other.m_size)
+            , m_capacity(0)
+            , m_file(nullptr)
+            , m_shareable(false)
+            , m_external(false)
         {
+            if (other.m_shareable) {
+                refs(other.m_data).fetch_add(1, std::memory_order_relaxed);
+                m_data = other.m_data;
+                m_capacity = other.m_capacity;
+                m_shareable = true;
+                return;
+            }
+
             // TODO allouer un tampon pour stocker _size éléments de type _Scalar.
-            m_data = new _Scalar[m_size];
+            acquire(m_size);
             // TODO copier other.m_data dans m_data.
-            memcpy(m_data, other.m_data, sizeof(_Scalar) * m_size);
+            if (m_size > 0) {
+                copy(m_data, other.m_data, m_size);
+            }
+        }
+
+        /**
+         * Constructeur de déplacement
+         *
+         * Un tampon alloué sur le tas ou projeté est récupéré tel quel, sans
+         * allocation ni copie ; un tampon interne ou externe est copié.
+         * `other` est laissé vide.
+         */
+        DenseStorage(DenseStorage&& other) noexcept :
+            m_data(other.m_data)
+            , m_size(other.m_size)
+            , m_capacity(other.m_capacity)
+            , m_file(other.m_file)
+            , m_shareable(other.m_shareable)
+            , m_external(false)
+        {
+            if (other.isInline() || other.m_external) {
+                acquire(m_size);
+                if (m_size > 0) {
+                    copy(m_data, other.m_data, m_size);
+                }
+            }
+            other.m_data = other.inlineData();
+            other.m_size = 0;
+            other.m_capacity = _Inline;
+            other.m_file = nullptr;
+            other.m_shareable = false;
+            other.m_external = false;
         }
 
         /**
          * Opérateur de copie
+         *
+         * Le tampon courant est réutilisé s'il a la capacité suffisante. Un
+         * tampon partageable est plutôt partagé, sauf si le stockage courant
+         * est projeté ou externe.
          */
         DenseStorage& operator=(const DenseStorage& other)
         {
             // TODO implémenter !
             if (this != &other) {
-                delete[] m_data;
+                if (other.m_shareable && !isBound()) {
+                    if (other.m_data != m_data) {
+                        refs(other.m_data).fetch_add(1, std::memory_order_relaxed);
+                        releaseBuffer();
+                        m_data = other.m_data;
+                        m_capacity = other.m_capacity;
+                        m_shareable = true;
+                    }
+                    m_size = other.m_size;
+                    return *this;
+                }
+
+                if (other.m_size > m_capacity) {
+                    reallocate(other.m_size, 0);
+                }
+                else {
+                    detach(0);
+                }
                 m_size = other.m_size;
                 if (m_size > 0) {
-                    m_data = new _Scalar[m_size];
-                    memcpy(m_data, other.m_data, sizeof(_Scalar) * m_size);
+                    copy(m_data, other.m_data, m_size);
+                }
+            }
+            return *this;
+        }
+
+        /**
+         * Opérateur de déplacement
+         *
+         * Si `other` est sur le tas (ou projeté), le tampon courant est libéré
+         * et celui de `other` est récupéré. Les données sont plutôt copiées si
+         * `other` utilise son tampon interne ou un tampon externe, ou si le
+         * stockage courant est projeté (ou externe) et qu'elles tiennent dans
+         * sa capacité.
+         */
+        DenseStorage& operator=(DenseStorage&& other) noexcept
+        {
+            if (this != &other) {
+                if (other.isInline() || other.m_external || (isBound() && other.m_size <= m_capacity)) {
+                    if (other.m_size > m_capacity) {
+                        reallocate(other.m_size, 0);
+                    }
+                    else {
+                        detach(0);
+                    }
+                    m_size = other.m_size;
+                    if (m_size > 0) {
+                        copy(m_data, other.m_data, m_size);
+                    }
                 }
                 else {
-                    m_data = nullptr;
+                    releaseBuffer();
+                    m_data = other.m_data;
+                    m_size = other.m_size;
+                    m_capacity = other.m_capacity;
+                    m_file = other.m_file;
+                    m_shareable = other.m_shareable;
+                    other.m_data = other.inlineData();
+                    other.m_capacity = _Inline;
+                    other.m_file = nullptr;
+                    other.m_shareable = false;
+                }
+                if (other.m_external) {
+                    other.releaseBuffer();
+                    other.m_data = other.inlineData();
+                    other.m_capacity = _Inline;
                 }
+                other.m_size = 0;
             }
             return *this;
         }
@@ -219,50 +707,176 @@ namespace gti320
         ~DenseStorage()
         {
             // TODO libérer la mémoire allouée
-            if (m_data != nullptr) {
-                delete[] m_data;
-                m_data = nullptr;
-            }
+            releaseBuffer();
         }
 
         /**
          * Retourne la taille du tampon
          */
-        inline int size() const { return m_size; }
+        inline Index size() const { return m_size; }
+
+        /**
+         * Retourne le nombre d'éléments que peut contenir le tampon courant
+         */
+        inline Index capacity() const { return m_capacity; }
+
+        /**
+         * Nombre d'éléments que peut contenir le tampon interne.
+         */
+        static Index inlineCapacity() { return _Inline; }
+
+        /**
+         * Alignement (en octets) garanti pour le tampon de données.
+         */
+        static int alignment()
+        {
+            return _Inline > 0 ? FixedAlignment<_Scalar, InlineSize, _Align>::value
+                : (_Align > (int)alignof(_Scalar) ? _Align : (int)alignof(_Scalar));
+        }
 
         /**
          * Redimensionne le tampon alloué pour le stockage.
-         * La mémoire qui n'est plus utilisée doit être libérée.
+         * Les éléments sont remis à zéro lorsque la taille change.
          * 
-         * Note :​ Toutes opérations de redimensionnement entraînent une réallocation de mémoire.
-         * Il n’est pas pertinent de copier les données car le résultat serait de toute façon incohérent.
+         * Note :​ Le tampon existant est réutilisé lorsque sa capacité suffit ; sinon
+         * il est réalloué. Il n’est pas pertinent de copier les données car le
+         * résultat serait de toute façon incohérent.
          */
-        void resize(int _size)
+        void resize(Index _size)
         {
             // TODO redimensionner la mémoire allouée
             if (_size == m_size) return;
 
-            delete [] m_data;
-            m_size = _size;
-            if (m_size > 0) {
-                m_data = new _Scalar[m_size];
-                setZero();
+            const bool fresh = _size > m_capacity;
+            resize(_size, Uninitialized);
+            if (fresh) {
+                touchZero();
             }
             else {
-                m_data = nullptr;
+                setZero();
             }
+        }
 
+        /**
+         * Redimensionne le tampon sans initialiser le nouveau contenu.
+         */
+        void resize(Index _size, UninitializedTag)
+        {
+            if (_size == m_size) return;
+
+            if (_size > m_capacity) {
+                reallocate(_size, 0);
+            }
+            m_size = _size;
+        }
+
+        /**
+         * Réserve un tampon pouvant contenir au moins `_capacity` éléments.
+         * Les éléments existants sont conservés ; la taille ne change pas.
+         */
+        void reserve(Index _capacity)
+        {
+            if (_capacity > m_capacity) {
+                reallocate(_capacity, m_size);
+            }
+        }
+
+        /**
+         * Réduit la capacité à la taille courante (libère la mémoire inutilisée).
+         * Les éléments existants sont conservés ; ils reviennent dans le tampon
+         * interne s'ils y tiennent.
+         */
+        void shrink_to_fit()
+        {
+            if (m_capacity > m_size && !isInline() && !isBound()) {
+                reallocate(m_size, m_size);
+            }
+        }
+
+        /**
+         * Utilise `_size` éléments du fichier projeté `file`, à partir de
+         * `offset` octets, comme tampon de données. Rien n'est copié ni
+         * initialisé. Le stockage devient propriétaire de la projection.
+         *
+         * Retourne faux (et laisse le stockage inchangé) si le fichier est trop
+         * court ou si la région n'est pas alignée sur alignment().
+         */
+        bool map(MappedFile&& file, size_t offset, Index _size)
+        {
+            if (!file.isOpen() || _size < 0 || file.length() < offset + sizeof(_Scalar) * (size_t)_size) {
+                return false;
+            }
+            _Scalar* data = reinterpret_cast<_Scalar*>(static_cast<char*>(file.data()) + offset);
+            if (!isAligned(data, alignment())) {
+                return false;
+            }
+
+            MappedFile* mapped = new MappedFile(std::move(file));
+            releaseBuffer();
+            m_file = mapped;
+            m_shareable = false;
+            m_data = data;
+            m_size = _size;
+            m_capacity = _size;
+            return true;
+        }
+
+        /**
+         * Utilise le tampon externe `data` de `_size` éléments, sans copie.
+         * Le stockage n'en est pas propriétaire : l'appelant doit garder le
+         * tampon valide tant qu'il est utilisé. L'alignement de alignment()
+         * n'est pas garanti pour un tampon externe.
+         *
+         * La capacité est fixée à `_size` : resize() ou reserve() au-delà
+         * lancent std::length_error plutôt que de changer de tampon.
+         */
+        void wrap(_Scalar* data, Index _size)
+        {
+            assert(data != nullptr || _size == 0);
+            releaseBuffer();
+            m_external = true;
+            m_shareable = false;
+            m_data = data;
+            m_size = _size;
+            m_capacity = _size;
+        }
+
+        /**
+         * Vrai si le tampon est un tampon externe (voir wrap()).
+         */
+        inline bool isExternal() const { return m_external; }
+
+        /**
+         * Vrai si le tampon est une région d'un fichier projeté.
+         */
+        inline bool isMapped() const { return m_file != nullptr; }
+
+        /**
+         * Écrit sur le disque les modifications d'un stockage projeté en
+         * lecture-écriture (sans effet sinon).
+         */
+        void flush()
+        {
+            if (m_file != nullptr) {
+                m_file->flush();
+            }
         }
 
         /**
          * Met tous les éléments à zéro.
+         *
+         * Les pages d'un tampon existant sont déjà placées : la mise à zéro
+         * est faite par le fil appelant. Un tampon nouvellement alloué
+         * (constructeur, resize() au-delà de la capacité) passe plutôt par
+         * le premier contact parallèle de touchZero().
          */
         void setZero()
         {
             // TODO implémenter !
-            if (m_data != nullptr && m_size > 0) {
-                memset(m_data, 0, sizeof(_Scalar)*m_size);
-            }
+            if (m_size <= 0) return;
+
+            detach(0);
+            memset(m_data, 0, sizeof(_Scalar)*m_size);
         }
 
         /**
@@ -272,13 +886,14 @@ namespace gti320
 
         /**
          * Accès au tampon de données (pour lecture et écriture)
+         * Un tampon partagé est d'abord dupliqué.
          */
-        _Scalar* data() { return m_data; }
+        _Scalar* data() { detach(m_size); return m_data; }
         
         /**
          * Accès bracket (en lecteur seulement)
          */
-        const _Scalar& operator[](int i) const {
+        const _Scalar& operator[](Index i) const {
             assert(0 <= i && i < m_size);
 
             return m_data[i];
@@ -287,11 +902,21 @@ namespace gti320
         
         /**
          * Accès bracket (pour lecture et écriture)
+         * Un tampon partagé est d'abord dupliqué.
          */
-        _Scalar& operator[](int i) {
+        _Scalar& operator[](Index i) {
             assert(0 <= i && i < m_size);
+            detach(m_size);
             return m_data[i];
         }
+
+        /**
+         * Vrai si le tampon est partagé avec au moins une autre copie.
+         */
+        bool isShared() const
+        {
+            return m_shareable && refs(m_data).load(std::memory_order_acquire) > 1;
+        }
     };
 
 }
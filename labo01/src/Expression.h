@@ -0,0 +1,404 @@
+#pragma once
+
+/**
+ * @file Expression.h
+ *
+ * @brief Expressions paresseuses pour les opérations élément par élément.
+ *
+ * Les opérateurs `+`, `-` et `scalaire *` de Operators.h ne calculent rien :
+ * ils retournent un arbre d'expression léger qui décrit le calcul. L'arbre
+ * est évalué lors de l'affectation (ou de la construction) d'une matrice ou
+ * d'un vecteur, en une seule boucle sur la destination :
+ *
+ *    w = alpha * u + v - w;     // une passe, aucun temporaire
+ *
+ * Les feuilles de l'arbre sont des vues (MatrixView) sur les opérandes, et
+ * les nœuds internes sont copiés par valeur : l'expression ne possède aucune
+ * donnée. Elle doit donc être consommée dans l'instruction qui la crée ; il
+ * ne faut pas la conserver avec `auto`, puisque ses feuilles peuvent désigner
+ * des temporaires détruits à la fin de l'instruction.
+ *
+ * Une entrée de la destination ne dépend que des entrées de même position
+ * des opérandes : une opérande peut être la destination elle-même.
+ *
+ * Les opérateurs composés des matrices et des vecteurs (`+=`, `-=`, `*=`)
+ * mettent à jour la destination en place, sans temporaire :
+ *
+ *    x += alpha * p;            // noyau axpy
+ *    r -= alpha * q;            // noyau axpy
+ *    p = r + beta * p;          // une passe
+ *    p = a * r + b * p;         // noyau axpby
+ *
+ * Les produits matriciels (gemm, gemv) ne sont pas paresseux ; une opérande
+ * qui est une expression peut être évaluée au préalable avec eval().
+ *
+ */
+
+#include "MatrixView.h"
+#include "Simd.h"
+
+#include <type_traits>
+
+namespace gti320
+{
+    /**
+     * Ordre de stockage d'une expression dont les feuilles n'ont pas toutes
+     * le même ordre de stockage : elle n'est lue qu'entrée par entrée.
+     */
+    static const int MixedStorage = -1;
+
+    template<typename _Scalar, int _StorageType> class LeafExpression;
+    template<typename _Op, typename _Lhs, typename _Rhs> class BinaryExpression;
+    template<typename _Expr> class ScaledExpression;
+
+    namespace internal
+    {
+        /**
+         * Type des entrées (Scalar) et ordre de stockage commun des feuilles
+         * (StorageType) d'une expression.
+         */
+        template<typename _Expr> struct ExpressionTraits;
+
+        template<typename _Scalar, int _StorageType>
+        struct ExpressionTraits< LeafExpression<_Scalar, _StorageType> >
+        {
+            typedef _Scalar Scalar;
+            static const int StorageType = _StorageType;
+        };
+
+        template<typename _Op, typename _Lhs, typename _Rhs>
+        struct ExpressionTraits< BinaryExpression<_Op, _Lhs, _Rhs> >
+        {
+            typedef typename ExpressionTraits<_Lhs>::Scalar Scalar;
+            static const int StorageType = (int)ExpressionTraits<_Lhs>::StorageType == (int)ExpressionTraits<_Rhs>::StorageType
+                ? (int)ExpressionTraits<_Lhs>::StorageType : MixedStorage;
+        };
+
+        template<typename _Expr>
+        struct ExpressionTraits< ScaledExpression<_Expr> >
+        {
+            typedef typename ExpressionTraits<_Expr>::Scalar Scalar;
+            static const int StorageType = ExpressionTraits<_Expr>::StorageType;
+        };
+    }
+
+    /**
+     * Classe de base (CRTP) des expressions.
+     *
+     * Une expression `_Derived` fournit :
+     *
+     *    Scalar, StorageType    : type des entrées, ordre de stockage commun
+     *                             (voir internal::ExpressionTraits)
+     *    rows(), cols()         : dimensions
+     *    coeff(i, j)            : entrée (i, j)
+     *    coeff(k)               : k-ième entrée dans l'ordre StorageType
+     *                             (utilisé seulement si StorageType n'est
+     *                             pas MixedStorage)
+     */
+    template<typename _Derived>
+    class MatrixExpression
+    {
+    public:
+
+        typedef typename internal::ExpressionTraits<_Derived>::Scalar Scalar;
+        static const int StorageType = internal::ExpressionTraits<_Derived>::StorageType;
+
+        inline const _Derived& derived() const { return static_cast<const _Derived&>(*this); }
+
+        inline Index size() const { return derived().rows() * derived().cols(); }
+
+        /**
+         * Entrée (i, j) de l'expression.
+         */
+        inline Scalar operator()(Index i, Index j) const
+        {
+            assert(0 <= i && i < derived().rows() && 0 <= j && j < derived().cols());
+            return derived().coeff(i, j);
+        }
+
+        /**
+         * Entrée i d'une expression vectorielle (une seule colonne).
+         */
+        inline Scalar operator()(Index i) const
+        {
+            assert(derived().cols() == 1);
+            return (*this)(i, 0);
+        }
+
+        /**
+         * Évalue l'expression dans une nouvelle matrice dynamique.
+         */
+        Matrix<Scalar, Dynamic, Dynamic, StorageType == RowStorage ? RowStorage : ColumnStorage> eval() const
+        {
+            return Matrix<Scalar, Dynamic, Dynamic, StorageType == RowStorage ? RowStorage : ColumnStorage>(*this);
+        }
+    };
+
+    /**
+     * Feuille : une matrice ou un vecteur, lu à travers une vue contiguë.
+     */
+    template<typename _Scalar, int _StorageType>
+    class LeafExpression : public MatrixExpression< LeafExpression<_Scalar, _StorageType> >
+    {
+    public:
+
+        explicit LeafExpression(const MatrixView<const _Scalar, _StorageType>& view) : m_view(view)
+        {
+            assert(view.isContiguous());
+        }
+
+        inline Index rows() const { return m_view.rows(); }
+        inline Index cols() const { return m_view.cols(); }
+
+        inline _Scalar coeff(Index i, Index j) const { return m_view(i, j); }
+        inline _Scalar coeff(Index k) const { return m_view.data()[k]; }
+
+        inline const _Scalar* data() const { return m_view.data(); }
+
+    private:
+
+        MatrixView<const _Scalar, _StorageType> m_view;
+    };
+
+    namespace internal
+    {
+        struct SumOp
+        {
+            template<typename _Scalar>
+            static inline _Scalar apply(_Scalar a, _Scalar b) { return a + b; }
+        };
+
+        struct DifferenceOp
+        {
+            template<typename _Scalar>
+            static inline _Scalar apply(_Scalar a, _Scalar b) { return a - b; }
+        };
+    }
+
+    /**
+     * Opération élément par élément entre deux expressions de mêmes dimensions.
+     */
+    template<typename _Op, typename _Lhs, typename _Rhs>
+    class BinaryExpression : public MatrixExpression< BinaryExpression<_Op, _Lhs, _Rhs> >
+    {
+    public:
+
+        typedef typename internal::ExpressionTraits<BinaryExpression>::Scalar Scalar;
+
+        BinaryExpression(const _Lhs& lhs, const _Rhs& rhs) : m_lhs(lhs), m_rhs(rhs)
+        {
+            static_assert(std::is_same<typename _Lhs::Scalar, typename _Rhs::Scalar>::value, "Les operandes doivent avoir le meme type");
+            assert(lhs.rows() == rhs.rows() && lhs.cols() == rhs.cols());
+        }
+
+        inline Index rows() const { return m_lhs.rows(); }
+        inline Index cols() const { return m_lhs.cols(); }
+
+        inline Scalar coeff(Index i, Index j) const { return _Op::apply(m_lhs.coeff(i, j), m_rhs.coeff(i, j)); }
+        inline Scalar coeff(Index k) const { return _Op::apply(m_lhs.coeff(k), m_rhs.coeff(k)); }
+
+        inline const _Lhs& lhs() const { return m_lhs; }
+        inline const _Rhs& rhs() const { return m_rhs; }
+
+    private:
+
+        _Lhs m_lhs;
+        _Rhs m_rhs;
+    };
+
+    /**
+     * Produit d'une expression par un scalaire.
+     */
+    template<typename _Expr>
+    class ScaledExpression : public MatrixExpression< ScaledExpression<_Expr> >
+    {
+    public:
+
+        typedef typename internal::ExpressionTraits<ScaledExpression>::Scalar Scalar;
+
+        ScaledExpression(Scalar a, const _Expr& expr) : m_a(a), m_expr(expr) { }
+
+        inline Index rows() const { return m_expr.rows(); }
+        inline Index cols() const { return m_expr.cols(); }
+
+        inline Scalar coeff(Index i, Index j) const { return m_a * m_expr.coeff(i, j); }
+        inline Scalar coeff(Index k) const { return m_a * m_expr.coeff(k); }
+
+        inline Scalar scalar() const { return m_a; }
+        inline const _Expr& nested() const { return m_expr; }
+
+    private:
+
+        Scalar m_a;
+        _Expr m_expr;
+    };
+
+    namespace internal
+    {
+        /**
+         * d[l] = e.coeff(offset + l), pour 0 <= l < n.
+         */
+        template<typename _Scalar, typename _Derived>
+        inline void evaluateLinear(_Scalar* d, const _Derived& e, Index offset, Index n)
+        {
+            for (Index l = 0; l < n; ++l) {
+                d[l] = e.coeff(offset + l);
+            }
+        }
+
+        /**
+         * Somme de deux feuilles : noyau vectoriel add (voir Simd.h).
+         */
+        template<typename _Scalar, int _StorageType>
+        inline void evaluateLinear(_Scalar* d, const BinaryExpression< SumOp, LeafExpression<_Scalar, _StorageType>, LeafExpression<_Scalar, _StorageType> >& e,
+                                   Index offset, Index n)
+        {
+            add(n, e.lhs().data() + offset, e.rhs().data() + offset, d);
+        }
+
+        /**
+         * Feuille multipliée par un scalaire : noyau vectoriel scale.
+         */
+        template<typename _Scalar, int _StorageType>
+        inline void evaluateLinear(_Scalar* d, const ScaledExpression< LeafExpression<_Scalar, _StorageType> >& e, Index offset, Index n)
+        {
+            scale(n, e.scalar(), e.nested().data() + offset, d);
+        }
+
+        /**
+         * Combinaison linéaire de deux feuilles : noyau axpby lorsque la
+         * destination est l'une des feuilles (y = a * x + b * y).
+         */
+        template<typename _Scalar, int _StorageType>
+        inline void evaluateLinear(_Scalar* d, const BinaryExpression< SumOp, ScaledExpression< LeafExpression<_Scalar, _StorageType> >,
+                                                                      ScaledExpression< LeafExpression<_Scalar, _StorageType> > >& e,
+                                   Index offset, Index n)
+        {
+            const _Scalar a = e.lhs().scalar(), b = e.rhs().scalar();
+            const _Scalar* x = e.lhs().nested().data() + offset;
+            const _Scalar* y = e.rhs().nested().data() + offset;
+            if (d == y) {
+                axpby(n, a, x, b, d);
+            }
+            else if (d == x) {
+                axpby(n, b, y, a, d);
+            }
+            else {
+                for (Index l = 0; l < n; ++l) {
+                    d[l] = a * x[l] + b * y[l];
+                }
+            }
+        }
+
+        /**
+         * d[l] = op(d[l], e.coeff(offset + l)), pour 0 <= l < n.
+         */
+        template<typename _Op, typename _Scalar, typename _Derived>
+        inline void updateLinear(_Op, _Scalar* d, const _Derived& e, Index offset, Index n)
+        {
+            for (Index l = 0; l < n; ++l) {
+                d[l] = _Op::apply(d[l], e.coeff(offset + l));
+            }
+        }
+
+        /**
+         * d += A et d -= A : noyau axpy (a = 1 ou -1, résultat exact).
+         */
+        template<typename _Scalar, int _StorageType>
+        inline void updateLinear(SumOp, _Scalar* d, const LeafExpression<_Scalar, _StorageType>& e, Index offset, Index n)
+        {
+            axpy(n, _Scalar(1), e.data() + offset, d);
+        }
+
+        template<typename _Scalar, int _StorageType>
+        inline void updateLinear(DifferenceOp, _Scalar* d, const LeafExpression<_Scalar, _StorageType>& e, Index offset, Index n)
+        {
+            axpy(n, _Scalar(-1), e.data() + offset, d);
+        }
+
+        /**
+         * d += a * A et d -= a * A : noyau axpy (avec FMA, le produit n'est
+         * pas arrondi séparément).
+         */
+        template<typename _Scalar, int _StorageType>
+        inline void updateLinear(SumOp, _Scalar* d, const ScaledExpression< LeafExpression<_Scalar, _StorageType> >& e, Index offset, Index n)
+        {
+            axpy(n, e.scalar(), e.nested().data() + offset, d);
+        }
+
+        template<typename _Scalar, int _StorageType>
+        inline void updateLinear(DifferenceOp, _Scalar* d, const ScaledExpression< LeafExpression<_Scalar, _StorageType> >& e, Index offset, Index n)
+        {
+            axpy(n, -e.scalar(), e.nested().data() + offset, d);
+        }
+    }
+
+    /**
+     * Évalue `expr` dans le bloc `dst`, en une seule passe dans l'ordre de
+     * stockage de la destination. Les feuilles sont lues linéairement
+     * lorsqu'elles ont toutes l'ordre de stockage de la destination ; les
+     * formes `A + B` et `a * A` passent alors par les noyaux de Simd.h.
+     */
+    template<typename _Scalar, int _StorageType, typename _Derived>
+    void evaluate(const MatrixView<_Scalar, _StorageType>& dst, const MatrixExpression<_Derived>& expr)
+    {
+        const _Derived& e = expr.derived();
+        assert(dst.rows() == e.rows() && dst.cols() == e.cols());
+
+        const Index outer = _StorageType == ColumnStorage ? dst.cols() : dst.rows();
+        const Index inner = _StorageType == ColumnStorage ? dst.rows() : dst.cols();
+
+        if ((int)_Derived::StorageType == _StorageType) {
+            if (dst.isContiguous()) {
+                internal::evaluateLinear(dst.data(), e, 0, outer * inner);
+                return;
+            }
+            for (Index k = 0; k < outer; ++k) {
+                internal::evaluateLinear(dst.data() + k * dst.outerStride(), e, k * inner, inner);
+            }
+        }
+        else {
+            for (Index k = 0; k < outer; ++k) {
+                _Scalar* d = dst.data() + k * dst.outerStride();
+                for (Index l = 0; l < inner; ++l) {
+                    d[l] = _StorageType == ColumnStorage ? e.coeff(l, k) : e.coeff(k, l);
+                }
+            }
+        }
+    }
+
+    namespace internal
+    {
+        /**
+         * Mise à jour en place `dst = op(dst, expr)` (opérateurs += et -=),
+         * avec le même parcours que evaluate().
+         */
+        template<typename _Op, typename _Scalar, int _StorageType, typename _Derived>
+        void compoundAssign(_Op op, const MatrixView<_Scalar, _StorageType>& dst, const MatrixExpression<_Derived>& expr)
+        {
+            const _Derived& e = expr.derived();
+            assert(dst.rows() == e.rows() && dst.cols() == e.cols());
+
+            const Index outer = _StorageType == ColumnStorage ? dst.cols() : dst.rows();
+            const Index inner = _StorageType == ColumnStorage ? dst.rows() : dst.cols();
+
+            if ((int)_Derived::StorageType == _StorageType) {
+                if (dst.isContiguous()) {
+                    updateLinear(op, dst.data(), e, 0, outer * inner);
+                    return;
+                }
+                for (Index k = 0; k < outer; ++k) {
+                    updateLinear(op, dst.data() + k * dst.outerStride(), e, k * inner, inner);
+                }
+            }
+            else {
+                for (Index k = 0; k < outer; ++k) {
+                    _Scalar* d = dst.data() + k * dst.outerStride();
+                    for (Index l = 0; l < inner; ++l) {
+                        d[l] = _Op::apply(d[l], _StorageType == ColumnStorage ? e.coeff(l, k) : e.coeff(k, l));
+                    }
+                }
+            }
+        }
+    }
+}
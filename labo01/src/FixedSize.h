@@ -0,0 +1,256 @@
+#pragma once
+
+/**
+ * @file FixedSize.h
+ *
+ * @brief Noyaux déroulés à la compilation pour les petites matrices de
+ *        taille fixe (Matrix3f, Matrix4f, Vector3f, ...).
+ *
+ * Lorsque toutes les dimensions d'une opération sont connues à la
+ * compilation, les boucles sont remplacées par une suite d'instructions
+ * générée par récursion de patrons (Unroll) : les indices sont des
+ * constantes, il n'y a ni compteur de boucle, ni appel indirect vers les
+ * noyaux de Simd.h, ni vérification de bornes.
+ *
+ *    produit        C = A * B           (R x K) * (K x C)
+ *    gemv           y = A * x
+ *    transposée     B = A^T
+ *    élément par élément : affectation d'une expression, +=, -=, *=
+ *
+ * La sélection est automatique (voir les opérateurs de Matrix, Vector et
+ * Operators.h). Un noyau n'est déroulé que s'il compte au plus
+ * GTI320_UNROLL_LIMIT opérations (multiplications-additions pour un
+ * produit, entrées pour les autres) ; au-delà, les noyaux génériques sont
+ * utilisés.
+ *
+ */
+
+#include "Types.h"
+#include "MatrixView.h"
+#include "Expression.h"
+
+#include <type_traits>
+
+#ifndef GTI320_UNROLL_LIMIT
+#define GTI320_UNROLL_LIMIT 128
+#endif
+
+namespace gti320
+{
+    namespace internal
+    {
+        /**
+         * Appelle f(std::integral_constant<int, k>()) pour k = _Begin, ...,
+         * _End - 1.
+         */
+        template<int _Begin, int _End>
+        struct Unroll
+        {
+            template<typename _Func>
+            static inline void run(_Func& f)
+            {
+                f(std::integral_constant<int, _Begin>());
+                Unroll<_Begin + 1, _End>::run(f);
+            }
+        };
+
+        template<int _End>
+        struct Unroll<_End, _End>
+        {
+            template<typename _Func>
+            static inline void run(_Func&) { }
+        };
+
+        /**
+         * Position de l'entrée (i, j) d'une matrice rows x cols contiguë.
+         */
+        constexpr int fixedIndex(int i, int j, int rows, int cols, int storage)
+        {
+            return storage == ColumnStorage ? i + j * rows : i * cols + j;
+        }
+
+        /**
+         * Vrai si le produit (R x K) * (K x C) est déroulé.
+         */
+        template<int _Rows, int _Inner, int _Cols>
+        struct UnrollProduct
+        {
+            static const bool value = _Rows > 0 && _Inner > 0 && _Cols > 0 && _Rows * _Inner * _Cols <= GTI320_UNROLL_LIMIT;
+        };
+
+        /**
+         * Vrai si une opération élément par élément sur une matrice R x C est
+         * déroulée.
+         */
+        template<int _Rows, int _Cols>
+        struct UnrollElementwise
+        {
+            static const bool value = _Rows > 0 && _Cols > 0 && _Rows * _Cols <= GTI320_UNROLL_LIMIT;
+        };
+
+        /**
+         * Produit scalaire de la ligne _I de A et de la colonne _J de B,
+         * accumulé dans l'ordre k = 0, 1, ... (comme la boucle générique).
+         */
+        template<typename _Scalar, int _Rows, int _Inner, int _Cols, int _StorageA, int _StorageB, int _I, int _J>
+        struct FixedDot
+        {
+            const _Scalar* a;
+            const _Scalar* b;
+            _Scalar sum;
+
+            template<int _K>
+            inline void operator()(std::integral_constant<int, _K>)
+            {
+                sum += a[fixedIndex(_I, _K, _Rows, _Inner, _StorageA)] * b[fixedIndex(_K, _J, _Inner, _Cols, _StorageB)];
+            }
+        };
+
+        /**
+         * Entrée _E de C (dans l'ordre de stockage de C) : C = A * B.
+         */
+        template<typename _Scalar, int _Rows, int _Inner, int _Cols, int _StorageA, int _StorageB, int _StorageC>
+        struct FixedProductEntry
+        {
+            const _Scalar* a;
+            const _Scalar* b;
+            _Scalar* c;
+
+            template<int _E>
+            inline void operator()(std::integral_constant<int, _E>)
+            {
+                static const int i = _StorageC == ColumnStorage ? _E % _Rows : _E / _Cols;
+                static const int j = _StorageC == ColumnStorage ? _E / _Rows : _E % _Cols;
+                FixedDot<_Scalar, _Rows, _Inner, _Cols, _StorageA, _StorageB, i, j> dot = {
+                    a, b, a[fixedIndex(i, 0, _Rows, _Inner, _StorageA)] * b[fixedIndex(0, j, _Inner, _Cols, _StorageB)]
+                };
+                Unroll<1, _Inner>::run(dot);
+                c[_E] = dot.sum;
+            }
+        };
+
+        /**
+         * C = A * B, pour des tampons contigus (C ne doit pas chevaucher A
+         * ni B).
+         */
+        template<int _Rows, int _Inner, int _Cols, int _StorageA, int _StorageB, int _StorageC, typename _Scalar>
+        inline void fixedProduct(const _Scalar* a, const _Scalar* b, _Scalar* c)
+        {
+            FixedProductEntry<_Scalar, _Rows, _Inner, _Cols, _StorageA, _StorageB, _StorageC> entry = { a, b, c };
+            Unroll<0, _Rows * _Cols>::run(entry);
+        }
+
+        /**
+         * Transposée : b (cols x rows, ordre _StorageB) = a^T.
+         */
+        template<typename _ScalarA, typename _ScalarB, int _Rows, int _Cols, int _StorageA, int _StorageB>
+        struct FixedTransposeEntry
+        {
+            const _ScalarA* a;
+            _ScalarB* b;
+
+            template<int _E>
+            inline void operator()(std::integral_constant<int, _E>)
+            {
+                // (i, j) : position dans b, de dimensions _Cols x _Rows.
+                static const int i = _StorageB == ColumnStorage ? _E % _Cols : _E / _Rows;
+                static const int j = _StorageB == ColumnStorage ? _E / _Cols : _E % _Rows;
+                b[_E] = static_cast<_ScalarB>(a[fixedIndex(j, i, _Rows, _Cols, _StorageA)]);
+            }
+        };
+
+        template<int _Rows, int _Cols, int _StorageA, int _StorageB, typename _ScalarA, typename _ScalarB>
+        inline void fixedTranspose(const _ScalarA* a, _ScalarB* b)
+        {
+            FixedTransposeEntry<_ScalarA, _ScalarB, _Rows, _Cols, _StorageA, _StorageB> entry = { a, b };
+            Unroll<0, _Rows * _Cols>::run(entry);
+        }
+
+        template<int _Rows, int _Cols, typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB>
+        inline void transposeDispatch(const MatrixView<const _ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B, std::true_type)
+        {
+            assert(A.isContiguous() && B.isContiguous());
+            fixedTranspose<_Rows, _Cols, _StorageA, _StorageB>(A.data(), B.data());
+        }
+
+        template<int _Rows, int _Cols, typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB>
+        inline void transposeDispatch(const MatrixView<const _ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B, std::false_type)
+        {
+            for (Index i = 0; i < A.rows(); ++i) {
+                for (Index j = 0; j < A.cols(); ++j) {
+                    B(j, i) = static_cast<typename MatrixView<_ScalarB, _StorageB>::Scalar>(A(i, j));
+                }
+            }
+        }
+
+        /**
+         * B = A^T, où A a les dimensions (_Rows, _Cols) à la compilation.
+         */
+        template<int _Rows, int _Cols, typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB>
+        inline void transpose(const MatrixView<const _ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B)
+        {
+            assert(B.rows() == A.cols() && B.cols() == A.rows());
+            transposeDispatch<_Rows, _Cols>(A, B, std::integral_constant<bool, UnrollElementwise<_Rows, _Cols>::value>());
+        }
+
+        /**
+         * Affectation élément par élément (voir Expression.h), en plus des
+         * opérations SumOp et DifferenceOp des opérateurs composés.
+         */
+        struct AssignOp
+        {
+            template<typename _Scalar>
+            static inline _Scalar apply(_Scalar, _Scalar b) { return b; }
+        };
+
+        /**
+         * d[k] = op(d[k], e.coeff(k)).
+         */
+        template<typename _Op, typename _Scalar, typename _Derived>
+        struct FixedAssignEntry
+        {
+            _Scalar* d;
+            const _Derived& e;
+
+            template<int _K>
+            inline void operator()(std::integral_constant<int, _K>)
+            {
+                d[_K] = _Op::apply(d[_K], e.coeff(_K));
+            }
+        };
+
+        template<int _Rows, int _Cols, typename _Op, typename _Scalar, int _StorageType, typename _Derived>
+        inline void assignDispatch(_Op, const MatrixView<_Scalar, _StorageType>& dst, const _Derived& e, std::true_type)
+        {
+            assert(dst.rows() == _Rows && dst.cols() == _Cols && dst.isContiguous());
+            assert(e.rows() == _Rows && e.cols() == _Cols);
+            FixedAssignEntry<_Op, _Scalar, _Derived> entry = { dst.data(), e };
+            Unroll<0, _Rows * _Cols>::run(entry);
+        }
+
+        template<int _Rows, int _Cols, typename _Scalar, int _StorageType, typename _Derived>
+        inline void assignDispatch(AssignOp, const MatrixView<_Scalar, _StorageType>& dst, const _Derived& e, std::false_type)
+        {
+            evaluate(dst, e);
+        }
+
+        template<int _Rows, int _Cols, typename _Op, typename _Scalar, int _StorageType, typename _Derived>
+        inline void assignDispatch(_Op op, const MatrixView<_Scalar, _StorageType>& dst, const _Derived& e, std::false_type)
+        {
+            compoundAssign(op, dst, e);
+        }
+
+        /**
+         * dst = op(dst, expr) pour une destination de dimensions
+         * (_Rows, _Cols) à la compilation : déroulé si les dimensions sont
+         * fixes et petites et si l'expression a l'ordre de stockage de la
+         * destination, evaluate() ou compoundAssign() sinon.
+         */
+        template<int _Rows, int _Cols, typename _Op, typename _Scalar, int _StorageType, typename _Derived>
+        inline void assign(_Op op, const MatrixView<_Scalar, _StorageType>& dst, const MatrixExpression<_Derived>& expr)
+        {
+            typedef std::integral_constant<bool, UnrollElementwise<_Rows, _Cols>::value && (int)_Derived::StorageType == _StorageType> Unrolled;
+            assignDispatch<_Rows, _Cols>(op, dst, expr.derived(), Unrolled());
+        }
+    }
+}
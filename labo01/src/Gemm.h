@@ -0,0 +1,625 @@
+#pragma once
+
+/**
+ * @file Gemm.h
+ *
+ * @brief Produit matriciel par blocs, avec panneaux compactés.
+ *
+ * Organisation classique (Goto / BLIS) du produit C += alpha * A * B :
+ *
+ *    pour chaque bloc de NC colonnes de C et de B                (L3)
+ *      pour chaque tranche de KC colonnes de A / lignes de B
+ *        compacter B(KC x NC) en panneaux de NR colonnes
+ *        pour chaque bloc de MC lignes de A et de C                (L2)
+ *          compacter alpha * A(MC x KC) en panneaux de MR lignes
+ *          pour chaque tuile MR x NR de C :                        (L1)
+ *            micro-noyau : KC mises à jour de rang 1 dans des registres
+ *
+ * Le compactage recopie les blocs dans l'ordre exact où le micro-noyau les
+ * lit : les accès sont contigus quel que soit l'ordre de stockage de A et de
+ * B (ou le pas d'une vue). Les quatre combinaisons de stockage partagent
+ * donc le même moteur. Les panneaux incomplets (bords) sont complétés par
+ * des zéros ; seule l'écriture de la tuile dans C en tient compte.
+ *
+ * Les paramètres de blocage peuvent être redéfinis à la compilation :
+ *
+ *    GTI320_GEMM_MC, GTI320_GEMM_KC, GTI320_GEMM_NC   taille des blocs
+ *    GTI320_GEMM_MR, GTI320_GEMM_NR                   tuile portable
+ *
+ * Les valeurs par défaut visent des doubles avec 32 à 48 Kio de L1, 1 à 2 Mio
+ * de L2 et quelques Mio de L3 : un panneau de B (KC x NR) tient dans L1, un
+ * bloc de A (MC x KC) dans L2 et un bloc de B (KC x NC) dans L3. MC et NC
+ * sont ramenés aux multiples de MR et NR de la tuile utilisée.
+ *
+ * La tuile MR x NR et son micro-noyau suivent simdLevel() (voir Simd.h) :
+ *
+ *    niveau        double     float      accumulateurs
+ *    AVX-512       16 x 12    32 x 12    24 registres zmm sur 32
+ *    AVX2 + FMA     8 x 6     16 x 6     12 registres ymm sur 16
+ *    SSE2, scalaire MR x NR (GTI320_GEMM_MR x GTI320_GEMM_NR, 4 x 2)
+ *
+ * Les micro-noyaux vectoriels chargent une colonne de la tuile de A en deux
+ * registres et diffusent chaque entrée de la ligne de B : une tuile coûte
+ * 2 lectures, NR diffusions et 2 * NR multiplications-additions par pas k.
+ * La tuile portable (4 x 2) tient dans les registres SSE2 ; elle sert aussi
+ * aux types autres que float et double.
+ *
+ * gemm() (Operators.h) n'emprunte ce chemin qu'à partir de
+ * GTI320_GEMM_THRESHOLD multiplications (m * n * p) : en deçà, le coût du
+ * compactage n'est pas amorti.
+ *
+ * Les tampons de compactage sont propres à chaque fil et conservés d'un
+ * appel à l'autre (voir GemmWorkspace) : en régime permanent, un produit
+ * n'alloue que son résultat. Les fils de gemm() parallèle (Operators.h)
+ * traitent chacun une tranche de lignes ou de colonnes de C et compactent
+ * dans leurs propres tampons. Ils ne passent pas par DenseStorage et ne sont
+ * donc pas comptés par Instrumentation.h.
+ *
+ */
+
+#include "Types.h"
+#include "Memory.h"
+#include "Allocator.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#ifndef GTI320_GEMM_MR
+#define GTI320_GEMM_MR 4
+#endif
+
+#ifndef GTI320_GEMM_NR
+#define GTI320_GEMM_NR 2
+#endif
+
+#ifndef GTI320_GEMM_MC
+#define GTI320_GEMM_MC 128
+#endif
+
+#ifndef GTI320_GEMM_KC
+#define GTI320_GEMM_KC 256
+#endif
+
+#ifndef GTI320_GEMM_NC
+#define GTI320_GEMM_NC 2048
+#endif
+
+#ifndef GTI320_GEMM_THRESHOLD
+#define GTI320_GEMM_THRESHOLD (32 * 32 * 32)
+#endif
+
+namespace gti320
+{
+    namespace internal
+    {
+        static const int GemmMR = GTI320_GEMM_MR;
+        static const int GemmNR = GTI320_GEMM_NR;
+        static const Index GemmMC = GTI320_GEMM_MC;
+        static const Index GemmKC = GTI320_GEMM_KC;
+        static const Index GemmNC = GTI320_GEMM_NC;
+
+        static_assert(GTI320_GEMM_MC % GTI320_GEMM_MR == 0, "GTI320_GEMM_MC doit etre un multiple de GTI320_GEMM_MR");
+        static_assert(GTI320_GEMM_NC % GTI320_GEMM_NR == 0, "GTI320_GEMM_NC doit etre un multiple de GTI320_GEMM_NR");
+
+        /**
+         * Tampons de compactage d'un fil d'exécution. Ils grandissent à la
+         * demande et ne sont libérés qu'à la fin du fil. Le troisième tampon
+         * reçoit les résultats partiels de gemv() parallèle : il n'est
+         * accessible que par un Partial (voir plus bas).
+         */
+        template<typename _Scalar>
+        class GemmWorkspace
+        {
+        public:
+
+            GemmWorkspace() : m_a(nullptr), m_b(nullptr), m_partial(nullptr), m_aSize(0), m_bSize(0), m_partialSize(0), m_partialBusy(false) { }
+
+            ~GemmWorkspace()
+            {
+                HeapAllocator::deallocate(m_a);
+                HeapAllocator::deallocate(m_b);
+                HeapAllocator::deallocate(m_partial);
+            }
+
+            _Scalar* a(size_t size) { return reserve(m_a, m_aSize, size); }
+            _Scalar* b(size_t size) { return reserve(m_b, m_bSize, size); }
+
+            /**
+             * Tampon des résultats partiels, prêté pour la durée d'un appel.
+             *
+             * Le fil qui attend la fin d'un parallel_for exécute d'autres
+             * tâches (voir TaskGroup::wait()), dont peut-être un autre gemv()
+             * parallèle : le tampon du fil est alors déjà prêté, et le second
+             * appel reçoit un tampon à lui, libéré à la fin de l'appel.
+             */
+            class Partial
+            {
+            public:
+
+                explicit Partial(size_t size) : m_workspace(local()), m_owned(nullptr)
+                {
+                    if (m_workspace.m_partialBusy) {
+                        m_owned = static_cast<_Scalar*>(HeapAllocator::allocate(sizeof(_Scalar) * size, Aligned64));
+                        m_data = m_owned;
+                    }
+                    else {
+                        m_workspace.m_partialBusy = true;
+                        m_data = reserve(m_workspace.m_partial, m_workspace.m_partialSize, size);
+                    }
+                }
+
+                ~Partial()
+                {
+                    if (m_owned != nullptr) {
+                        HeapAllocator::deallocate(m_owned);
+                    }
+                    else {
+                        m_workspace.m_partialBusy = false;
+                    }
+                }
+
+                _Scalar* data() const { return m_data; }
+
+            private:
+
+                Partial(const Partial&);
+                Partial& operator=(const Partial&);
+
+                GemmWorkspace& m_workspace;
+                _Scalar* m_owned;
+                _Scalar* m_data;
+            };
+
+            /**
+             * Espace de travail du fil courant.
+             */
+            static GemmWorkspace& local()
+            {
+                static thread_local GemmWorkspace s_workspace;
+                return s_workspace;
+            }
+
+        private:
+
+            GemmWorkspace(const GemmWorkspace&);
+            GemmWorkspace& operator=(const GemmWorkspace&);
+
+            static _Scalar* reserve(_Scalar*& buffer, size_t& capacity, size_t size)
+            {
+                if (size > capacity) {
+                    HeapAllocator::deallocate(buffer);
+                    buffer = static_cast<_Scalar*>(HeapAllocator::allocate(sizeof(_Scalar) * size, Aligned64));
+                    capacity = size;
+                }
+                return buffer;
+            }
+
+            _Scalar* m_a;
+            _Scalar* m_b;
+            _Scalar* m_partial;
+            size_t m_aSize;
+            size_t m_bSize;
+            size_t m_partialSize;
+            bool m_partialBusy;
+        };
+
+        /**
+         * Compacte alpha * A(0:mc, 0:kc) en panneaux de _MR lignes : pour
+         * chaque panneau, les _MR entrées de la colonne 0, puis celles de la
+         * colonne 1, etc. L'entrée (i, k) de A est a[i * rs + k * cs].
+         */
+        template<int _MR, typename _Scalar, typename _ScalarA>
+        void gemmPackA(Index mc, Index kc, _Scalar alpha, const _ScalarA* a, Index rs, Index cs, _Scalar* packed)
+        {
+            for (Index ir = 0; ir < mc; ir += _MR) {
+                const Index mr = std::min<Index>(_MR, mc - ir);
+                const _ScalarA* panel = a + ir * rs;
+                if (mr == _MR && rs == 1) {
+                    for (Index k = 0; k < kc; ++k) {
+                        const _ScalarA* col = panel + k * cs;
+                        for (int i = 0; i < _MR; ++i) {
+                            packed[i] = alpha * col[i];
+                        }
+                        packed += _MR;
+                    }
+                }
+                else {
+                    for (Index k = 0; k < kc; ++k) {
+                        for (Index i = 0; i < mr; ++i) {
+                            packed[i] = alpha * panel[i * rs + k * cs];
+                        }
+                        for (Index i = mr; i < _MR; ++i) {
+                            packed[i] = _Scalar(0);
+                        }
+                        packed += _MR;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Compacte B(0:kc, 0:nc) en panneaux de _NR colonnes : pour chaque
+         * panneau, les _NR entrées de la ligne 0, puis celles de la ligne 1,
+         * etc. L'entrée (k, j) de B est b[k * rs + j * cs].
+         */
+        template<int _NR, typename _Scalar, typename _ScalarB>
+        void gemmPackB(Index kc, Index nc, const _ScalarB* b, Index rs, Index cs, _Scalar* packed)
+        {
+            for (Index jr = 0; jr < nc; jr += _NR) {
+                const Index nr = std::min<Index>(_NR, nc - jr);
+                const _ScalarB* panel = b + jr * cs;
+                if (nr == _NR && cs == 1) {
+                    for (Index k = 0; k < kc; ++k) {
+                        const _ScalarB* row = panel + k * rs;
+                        for (int j = 0; j < _NR; ++j) {
+                            packed[j] = row[j];
+                        }
+                        packed += _NR;
+                    }
+                }
+                else {
+                    for (Index k = 0; k < kc; ++k) {
+                        for (Index j = 0; j < nr; ++j) {
+                            packed[j] = panel[k * rs + j * cs];
+                        }
+                        for (Index j = nr; j < _NR; ++j) {
+                            packed[j] = _Scalar(0);
+                        }
+                        packed += _NR;
+                    }
+                }
+            }
+        }
+
+        /**
+         * C(0:mr, 0:nr) += AB, où AB est une tuile _MR x _NR stockée par
+         * colonnes (ab[i + j * _MR]) ; l'entrée (i, j) de C est
+         * c[i * rs + j * cs].
+         */
+        template<int _MR, int _NR, typename _Scalar>
+        inline void gemmStoreTile(const _Scalar* ab, _Scalar* c, Index rs, Index cs, Index mr, Index nr)
+        {
+            if (rs == 1 && mr == _MR) {
+                for (Index j = 0; j < nr; ++j) {
+                    _Scalar* cj = c + j * cs;
+                    for (int i = 0; i < _MR; ++i) {
+                        cj[i] += ab[i + j * _MR];
+                    }
+                }
+            }
+            else if (cs == 1 && nr == _NR) {
+                for (Index i = 0; i < mr; ++i) {
+                    _Scalar* ci = c + i * rs;
+                    for (int j = 0; j < _NR; ++j) {
+                        ci[j] += ab[i + j * _MR];
+                    }
+                }
+            }
+            else {
+                for (Index j = 0; j < nr; ++j) {
+                    for (Index i = 0; i < mr; ++i) {
+                        c[i * rs + j * cs] += ab[i + j * _MR];
+                    }
+                }
+            }
+        }
+
+        /**
+         * Micro-noyau portable : C(0:mr, 0:nr) += Ap * Bp, où Ap est un
+         * panneau compacté de _MR x kc et Bp un panneau compacté de kc x _NR.
+         * La tuile est accumulée dans des variables locales (registres).
+         */
+        template<typename _Scalar, int _MR, int _NR>
+        void gemmMicroKernel(Index kc, const _Scalar* ap, const _Scalar* bp, _Scalar* c, Index rs, Index cs, Index mr, Index nr)
+        {
+            _Scalar ab[_NR * _MR];
+            for (int e = 0; e < _NR * _MR; ++e) {
+                ab[e] = _Scalar(0);
+            }
+
+            for (Index k = 0; k < kc; ++k) {
+                for (int j = 0; j < _NR; ++j) {
+                    const _Scalar bj = bp[j];
+                    for (int i = 0; i < _MR; ++i) {
+                        ab[i + j * _MR] += ap[i] * bj;
+                    }
+                }
+                ap += _MR;
+                bp += _NR;
+            }
+
+            gemmStoreTile<_MR, _NR>(ab, c, rs, cs, mr, nr);
+        }
+
+#if GTI320_SIMD
+        namespace simd
+        {
+            namespace avx2
+            {
+                template<typename _Scalar> struct GemmVector;
+                template<> struct GemmVector<double> { typedef __m256d Type; };
+                template<> struct GemmVector<float> { typedef __m256 Type; };
+
+                GTI320_TARGET_AVX2 inline __m256d gemmZero(double) { return _mm256_setzero_pd(); }
+                GTI320_TARGET_AVX2 inline __m256 gemmZero(float) { return _mm256_setzero_ps(); }
+                GTI320_TARGET_AVX2 inline __m256d gemmLoad(const double* p) { return _mm256_load_pd(p); }
+                GTI320_TARGET_AVX2 inline __m256 gemmLoad(const float* p) { return _mm256_load_ps(p); }
+                GTI320_TARGET_AVX2 inline __m256d gemmBroadcast(const double* p) { return _mm256_broadcast_sd(p); }
+                GTI320_TARGET_AVX2 inline __m256 gemmBroadcast(const float* p) { return _mm256_broadcast_ss(p); }
+                GTI320_TARGET_AVX2 inline __m256d gemmFma(__m256d a, __m256d b, __m256d c) { return _mm256_fmadd_pd(a, b, c); }
+                GTI320_TARGET_AVX2 inline __m256 gemmFma(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+                GTI320_TARGET_AVX2 inline void gemmAccumulate(double* p, __m256d a) { _mm256_storeu_pd(p, _mm256_add_pd(_mm256_loadu_pd(p), a)); }
+                GTI320_TARGET_AVX2 inline void gemmAccumulate(float* p, __m256 a) { _mm256_storeu_ps(p, _mm256_add_ps(_mm256_loadu_ps(p), a)); }
+                GTI320_TARGET_AVX2 inline void gemmStore(double* p, __m256d a) { _mm256_storeu_pd(p, a); }
+                GTI320_TARGET_AVX2 inline void gemmStore(float* p, __m256 a) { _mm256_storeu_ps(p, a); }
+
+                /**
+                 * Micro-noyau AVX2 + FMA : tuile de (_MV registres) x _NR,
+                 * soit _MV * 4 lignes pour double et _MV * 8 pour float.
+                 */
+                template<int _MV, int _NR, typename _Scalar>
+                GTI320_TARGET_AVX2 void gemmKernel(Index kc, const _Scalar* ap, const _Scalar* bp, _Scalar* c, Index rs, Index cs, Index mr, Index nr)
+                {
+                    typedef typename GemmVector<_Scalar>::Type Packet;
+                    const int width = (int)(sizeof(Packet) / sizeof(_Scalar));
+                    const int rows = _MV * width;
+
+                    Packet acc[_NR][_MV];
+                    GTI320_UNROLL
+                    for (int j = 0; j < _NR; ++j) {
+                        GTI320_UNROLL
+                        for (int v = 0; v < _MV; ++v) {
+                            acc[j][v] = gemmZero(_Scalar());
+                        }
+                    }
+
+                    for (Index k = 0; k < kc; ++k) {
+                        Packet a[_MV];
+                        GTI320_UNROLL
+                        for (int v = 0; v < _MV; ++v) {
+                            a[v] = gemmLoad(ap + v * width);
+                        }
+                        GTI320_UNROLL
+                        for (int j = 0; j < _NR; ++j) {
+                            const Packet b = gemmBroadcast(bp + j);
+                            GTI320_UNROLL
+                            for (int v = 0; v < _MV; ++v) {
+                                acc[j][v] = gemmFma(a[v], b, acc[j][v]);
+                            }
+                        }
+                        ap += rows;
+                        bp += _NR;
+                    }
+
+                    if (rs == 1 && mr == rows && nr == _NR) {
+                        GTI320_UNROLL
+                        for (int j = 0; j < _NR; ++j) {
+                            GTI320_UNROLL
+                            for (int v = 0; v < _MV; ++v) {
+                                gemmAccumulate(c + j * cs + v * width, acc[j][v]);
+                            }
+                        }
+                    }
+                    else {
+                        _Scalar ab[_NR * _MV * (int)(sizeof(Packet) / sizeof(_Scalar))];
+                        GTI320_UNROLL
+                        for (int j = 0; j < _NR; ++j) {
+                            GTI320_UNROLL
+                            for (int v = 0; v < _MV; ++v) {
+                                gemmStore(ab + j * rows + v * width, acc[j][v]);
+                            }
+                        }
+                        gemmStoreTile<_MV * (int)(sizeof(Packet) / sizeof(_Scalar)), _NR>(ab, c, rs, cs, mr, nr);
+                    }
+                }
+            }
+
+            namespace avx512
+            {
+                template<typename _Scalar> struct GemmVector;
+                template<> struct GemmVector<double> { typedef __m512d Type; };
+                template<> struct GemmVector<float> { typedef __m512 Type; };
+
+                GTI320_TARGET_AVX512 inline __m512d gemmZero(double) { return _mm512_setzero_pd(); }
+                GTI320_TARGET_AVX512 inline __m512 gemmZero(float) { return _mm512_setzero_ps(); }
+                GTI320_TARGET_AVX512 inline __m512d gemmLoad(const double* p) { return _mm512_load_pd(p); }
+                GTI320_TARGET_AVX512 inline __m512 gemmLoad(const float* p) { return _mm512_load_ps(p); }
+                GTI320_TARGET_AVX512 inline __m512d gemmBroadcast(const double* p) { return _mm512_set1_pd(*p); }
+                GTI320_TARGET_AVX512 inline __m512 gemmBroadcast(const float* p) { return _mm512_set1_ps(*p); }
+                GTI320_TARGET_AVX512 inline __m512d gemmFma(__m512d a, __m512d b, __m512d c) { return _mm512_fmadd_pd(a, b, c); }
+                GTI320_TARGET_AVX512 inline __m512 gemmFma(__m512 a, __m512 b, __m512 c) { return _mm512_fmadd_ps(a, b, c); }
+                GTI320_TARGET_AVX512 inline void gemmAccumulate(double* p, __m512d a) { _mm512_storeu_pd(p, _mm512_add_pd(_mm512_loadu_pd(p), a)); }
+                GTI320_TARGET_AVX512 inline void gemmAccumulate(float* p, __m512 a) { _mm512_storeu_ps(p, _mm512_add_ps(_mm512_loadu_ps(p), a)); }
+                GTI320_TARGET_AVX512 inline void gemmStore(double* p, __m512d a) { _mm512_storeu_pd(p, a); }
+                GTI320_TARGET_AVX512 inline void gemmStore(float* p, __m512 a) { _mm512_storeu_ps(p, a); }
+
+                /**
+                 * Micro-noyau AVX-512 : tuile de (_MV registres) x _NR, soit
+                 * _MV * 8 lignes pour double et _MV * 16 pour float.
+                 */
+                template<int _MV, int _NR, typename _Scalar>
+                GTI320_TARGET_AVX512 void gemmKernel(Index kc, const _Scalar* ap, const _Scalar* bp, _Scalar* c, Index rs, Index cs, Index mr, Index nr)
+                {
+                    typedef typename GemmVector<_Scalar>::Type Packet;
+                    const int width = (int)(sizeof(Packet) / sizeof(_Scalar));
+                    const int rows = _MV * width;
+
+                    Packet acc[_NR][_MV];
+                    GTI320_UNROLL
+                    for (int j = 0; j < _NR; ++j) {
+                        GTI320_UNROLL
+                        for (int v = 0; v < _MV; ++v) {
+                            acc[j][v] = gemmZero(_Scalar());
+                        }
+                    }
+
+                    for (Index k = 0; k < kc; ++k) {
+                        Packet a[_MV];
+                        GTI320_UNROLL
+                        for (int v = 0; v < _MV; ++v) {
+                            a[v] = gemmLoad(ap + v * width);
+                        }
+                        GTI320_UNROLL
+                        for (int j = 0; j < _NR; ++j) {
+                            const Packet b = gemmBroadcast(bp + j);
+                            GTI320_UNROLL
+                            for (int v = 0; v < _MV; ++v) {
+                                acc[j][v] = gemmFma(a[v], b, acc[j][v]);
+                            }
+                        }
+                        ap += rows;
+                        bp += _NR;
+                    }
+
+                    if (rs == 1 && mr == rows && nr == _NR) {
+                        GTI320_UNROLL
+                        for (int j = 0; j < _NR; ++j) {
+                            GTI320_UNROLL
+                            for (int v = 0; v < _MV; ++v) {
+                                gemmAccumulate(c + j * cs + v * width, acc[j][v]);
+                            }
+                        }
+                    }
+                    else {
+                        _Scalar ab[_NR * _MV * (int)(sizeof(Packet) / sizeof(_Scalar))];
+                        GTI320_UNROLL
+                        for (int j = 0; j < _NR; ++j) {
+                            GTI320_UNROLL
+                            for (int v = 0; v < _MV; ++v) {
+                                gemmStore(ab + j * rows + v * width, acc[j][v]);
+                            }
+                        }
+                        gemmStoreTile<_MV * (int)(sizeof(Packet) / sizeof(_Scalar)), _NR>(ab, c, rs, cs, mr, nr);
+                    }
+                }
+            }
+        }
+#endif
+
+        /**
+         * Tuile de _MR x _NR et son micro-noyau.
+         */
+        template<typename _Scalar, int _MR, int _NR, void (*_Kernel)(Index, const _Scalar*, const _Scalar*, _Scalar*, Index, Index, Index, Index)>
+        struct GemmTile
+        {
+            static const int MR = _MR;
+            static const int NR = _NR;
+
+            static inline void kernel(Index kc, const _Scalar* ap, const _Scalar* bp, _Scalar* c, Index rs, Index cs, Index mr, Index nr)
+            {
+                _Kernel(kc, ap, bp, c, rs, cs, mr, nr);
+            }
+        };
+
+        /**
+         * C(0:m, 0:n) += alpha * A(0:m, 0:p) * B(0:p, 0:n) avec la tuile
+         * _Tile. MC et NC sont ramenés à des multiples de MR et NR.
+         */
+        template<typename _Tile, typename _Scalar, typename _ScalarA, typename _ScalarB>
+        void gemmBlockedTile(Index m, Index n, Index p, _Scalar alpha,
+                             const _ScalarA* a, Index rsa, Index csa,
+                             const _ScalarB* b, Index rsb, Index csb,
+                             _Scalar* c, Index rsc, Index csc)
+        {
+            const int MR = _Tile::MR;
+            const int NR = _Tile::NR;
+            const Index blockM = std::max<Index>(MR, GemmMC / MR * MR);
+            const Index blockN = std::max<Index>(NR, GemmNC / NR * NR);
+
+            GemmWorkspace<_Scalar>& workspace = GemmWorkspace<_Scalar>::local();
+            const Index kcMax = std::min(GemmKC, p);
+            const Index mcMax = std::min(blockM, (m + MR - 1) / MR * MR);
+            const Index ncMax = std::min(blockN, (n + NR - 1) / NR * NR);
+            _Scalar* packedA = workspace.a((size_t)(mcMax * kcMax));
+            _Scalar* packedB = workspace.b((size_t)(kcMax * ncMax));
+
+            for (Index jc = 0; jc < n; jc += blockN) {
+                const Index nc = std::min(blockN, n - jc);
+                for (Index pc = 0; pc < p; pc += GemmKC) {
+                    const Index kc = std::min(GemmKC, p - pc);
+                    gemmPackB<NR>(kc, nc, b + pc * rsb + jc * csb, rsb, csb, packedB);
+
+                    for (Index ic = 0; ic < m; ic += blockM) {
+                        const Index mc = std::min(blockM, m - ic);
+                        gemmPackA<MR>(mc, kc, alpha, a + ic * rsa + pc * csa, rsa, csa, packedA);
+
+                        for (Index jr = 0; jr < nc; jr += NR) {
+                            const Index nr = std::min<Index>(NR, nc - jr);
+                            for (Index ir = 0; ir < mc; ir += MR) {
+                                const Index mr = std::min<Index>(MR, mc - ir);
+                                _Tile::kernel(kc, packedA + ir * kc, packedB + jr * kc,
+                                              c + (ic + ir) * rsc + (jc + jr) * csc, rsc, csc, mr, nr);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * Tuiles de chaque niveau SIMD. Pour les types autres que float et
+         * double, la tuile portable sert à tous les niveaux.
+         */
+        template<typename _Scalar, bool _Vectorized = std::is_same<_Scalar, float>::value || std::is_same<_Scalar, double>::value>
+        struct GemmTiles
+        {
+            typedef GemmTile<_Scalar, GemmMR, GemmNR, &gemmMicroKernel<_Scalar, GemmMR, GemmNR> > Portable;
+
+            template<typename _ScalarA, typename _ScalarB>
+            static void run(Index m, Index n, Index p, _Scalar alpha, const _ScalarA* a, Index rsa, Index csa,
+                            const _ScalarB* b, Index rsb, Index csb, _Scalar* c, Index rsc, Index csc)
+            {
+                gemmBlockedTile<Portable>(m, n, p, alpha, a, rsa, csa, b, rsb, csb, c, rsc, csc);
+            }
+        };
+
+        template<typename _Scalar>
+        struct GemmTiles<_Scalar, true>
+        {
+            typedef GemmTile<_Scalar, GemmMR, GemmNR, &gemmMicroKernel<_Scalar, GemmMR, GemmNR> > Portable;
+#if GTI320_SIMD
+            // AVX2 : 2 x 6 registres accumulateurs (12 sur 16).
+            typedef GemmTile<_Scalar, 2 * 32 / (int)sizeof(_Scalar), 6, &simd::avx2::gemmKernel<2, 6, _Scalar> > AVX2;
+            // AVX-512 : 2 x 12 registres accumulateurs (24 sur 32).
+            typedef GemmTile<_Scalar, 2 * 64 / (int)sizeof(_Scalar), 12, &simd::avx512::gemmKernel<2, 12, _Scalar> > AVX512;
+#endif
+
+            template<typename _ScalarA, typename _ScalarB>
+            static void run(Index m, Index n, Index p, _Scalar alpha, const _ScalarA* a, Index rsa, Index csa,
+                            const _ScalarB* b, Index rsb, Index csb, _Scalar* c, Index rsc, Index csc)
+            {
+#if GTI320_SIMD
+                switch (simdLevel()) {
+                case SimdAVX512:
+                    gemmBlockedTile<AVX512>(m, n, p, alpha, a, rsa, csa, b, rsb, csb, c, rsc, csc);
+                    return;
+                case SimdAVX2:
+                    gemmBlockedTile<AVX2>(m, n, p, alpha, a, rsa, csa, b, rsb, csb, c, rsc, csc);
+                    return;
+                default:
+                    break;
+                }
+#endif
+                gemmBlockedTile<Portable>(m, n, p, alpha, a, rsa, csa, b, rsb, csb, c, rsc, csc);
+            }
+        };
+
+        /**
+         * C(0:m, 0:n) += alpha * A(0:m, 0:p) * B(0:p, 0:n)
+         *
+         * Chaque opérande est décrite par un pointeur et le pas entre deux
+         * lignes (rs) et deux colonnes (cs). C doit déjà contenir beta * C.
+         * La tuile et son micro-noyau suivent simdLevel().
+         */
+        template<typename _Scalar, typename _ScalarA, typename _ScalarB>
+        void gemmBlocked(Index m, Index n, Index p, _Scalar alpha,
+                         const _ScalarA* a, Index rsa, Index csa,
+                         const _ScalarB* b, Index rsb, Index csb,
+                         _Scalar* c, Index rsc, Index csc)
+        {
+            GemmTiles<_Scalar>::run(m, n, p, alpha, a, rsa, csa, b, rsb, csb, c, rsc, csc);
+        }
+    }
+}
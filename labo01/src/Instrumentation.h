@@ -0,0 +1,203 @@
+#pragma once
+
+/**
+ * @file Instrumentation.h
+ *
+ * @brief Compteurs d'allocations et de copies des tampons de données.
+ *
+ * Lorsque GTI320_INSTRUMENTATION est non nul, DenseStorage (taille fixe et
+ * dynamique) alimente des compteurs globaux :
+ *
+ *    allocations    : tampons alloués sur le tas (ou dans une arène)
+ *    frees          : tampons rendus
+ *    bytesAllocated : octets alloués (remplissage compris)
+ *    copies         : copies profondes du contenu d'un tampon (copie,
+ *                     affectation, déplacement d'un tampon interne,
+ *                     détachement d'un tampon partagé, réallocation qui
+ *                     conserve les éléments)
+ *    bytesCopied    : octets copiés par ces copies
+ *    liveBytes      : octets alloués et pas encore rendus
+ *    peakBytes      : maximum de liveBytes depuis la dernière remise à zéro
+ *
+ * Les matrices creuses (SparseMatrixBase) stockent leurs valeurs et leurs
+ * indices dans des DenseStorage : elles sont comptées de la même façon.
+ *
+ * Par défaut, l'instrumentation suit assert() : active sans NDEBUG, absente
+ * d'une compilation optimisée avec NDEBUG. Désactivée, elle ne coûte rien :
+ * les fonctions de comptage sont vides. Les compteurs sont atomiques et
+ * peuvent être alimentés par plusieurs fils.
+ *
+ *    resetMemoryCounters();
+ *    C = A * B;
+ *    EXPECT_LE(memoryCounters().allocations, 1u);
+ *
+ */
+
+#include <atomic>
+#include <cstddef>
+
+#ifndef GTI320_INSTRUMENTATION
+#ifdef NDEBUG
+#define GTI320_INSTRUMENTATION 0
+#else
+#define GTI320_INSTRUMENTATION 1
+#endif
+#endif
+
+namespace gti320
+{
+    /**
+     * Valeurs des compteurs à un instant donné.
+     */
+    struct MemoryCounters
+    {
+        size_t allocations;
+        size_t frees;
+        size_t bytesAllocated;
+        size_t copies;
+        size_t bytesCopied;
+        size_t liveBytes;
+        size_t peakBytes;
+    };
+
+    namespace internal
+    {
+        struct AtomicMemoryCounters
+        {
+            std::atomic<size_t> allocations;
+            std::atomic<size_t> frees;
+            std::atomic<size_t> bytesAllocated;
+            std::atomic<size_t> copies;
+            std::atomic<size_t> bytesCopied;
+            std::atomic<size_t> liveBytes;
+            std::atomic<size_t> peakBytes;
+        };
+
+        inline AtomicMemoryCounters& memoryCountersStorage()
+        {
+            static AtomicMemoryCounters s_counters = { {0}, {0}, {0}, {0}, {0}, {0}, {0} };
+            return s_counters;
+        }
+
+        /**
+         * Un tampon de `bytes` octets vient d'être alloué.
+         */
+        inline void countAllocation(size_t bytes)
+        {
+#if GTI320_INSTRUMENTATION
+            AtomicMemoryCounters& c = memoryCountersStorage();
+            c.allocations.fetch_add(1, std::memory_order_relaxed);
+            c.bytesAllocated.fetch_add(bytes, std::memory_order_relaxed);
+            const size_t live = c.liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            size_t peak = c.peakBytes.load(std::memory_order_relaxed);
+            while (live > peak && !c.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) { }
+#else
+            (void)bytes;
+#endif
+        }
+
+        /**
+         * Un tampon de `bytes` octets vient d'être rendu.
+         */
+        inline void countFree(size_t bytes)
+        {
+#if GTI320_INSTRUMENTATION
+            AtomicMemoryCounters& c = memoryCountersStorage();
+            c.frees.fetch_add(1, std::memory_order_relaxed);
+            c.liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+#else
+            (void)bytes;
+#endif
+        }
+
+        /**
+         * Le contenu d'un tampon (`bytes` octets) vient d'être copié.
+         */
+        inline void countCopy(size_t bytes)
+        {
+#if GTI320_INSTRUMENTATION
+            AtomicMemoryCounters& c = memoryCountersStorage();
+            c.copies.fetch_add(1, std::memory_order_relaxed);
+            c.bytesCopied.fetch_add(bytes, std::memory_order_relaxed);
+#else
+            (void)bytes;
+#endif
+        }
+    }
+
+    /**
+     * Vrai si les compteurs sont alimentés (GTI320_INSTRUMENTATION).
+     */
+    inline bool instrumentationEnabled()
+    {
+        return GTI320_INSTRUMENTATION != 0;
+    }
+
+    /**
+     * Lit les compteurs.
+     */
+    inline MemoryCounters memoryCounters()
+    {
+        const internal::AtomicMemoryCounters& c = internal::memoryCountersStorage();
+        MemoryCounters counters;
+        counters.allocations = c.allocations.load(std::memory_order_relaxed);
+        counters.frees = c.frees.load(std::memory_order_relaxed);
+        counters.bytesAllocated = c.bytesAllocated.load(std::memory_order_relaxed);
+        counters.copies = c.copies.load(std::memory_order_relaxed);
+        counters.bytesCopied = c.bytesCopied.load(std::memory_order_relaxed);
+        counters.liveBytes = c.liveBytes.load(std::memory_order_relaxed);
+        counters.peakBytes = c.peakBytes.load(std::memory_order_relaxed);
+        return counters;
+    }
+
+    /**
+     * Remet les compteurs à zéro. Les octets vivants sont conservés (les
+     * tampons existants seront rendus plus tard) et le pic repart de leur
+     * valeur courante.
+     */
+    inline void resetMemoryCounters()
+    {
+        internal::AtomicMemoryCounters& c = internal::memoryCountersStorage();
+        c.allocations.store(0, std::memory_order_relaxed);
+        c.frees.store(0, std::memory_order_relaxed);
+        c.bytesAllocated.store(0, std::memory_order_relaxed);
+        c.copies.store(0, std::memory_order_relaxed);
+        c.bytesCopied.store(0, std::memory_order_relaxed);
+        c.peakBytes.store(c.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    /**
+     * Mesure les allocations et les copies faites pendant la durée de vie de
+     * l'objet, sans remettre les compteurs globaux à zéro (les mesures
+     * peuvent donc être imbriquées).
+     */
+    class MemoryScope
+    {
+    public:
+
+        MemoryScope() : m_start(memoryCounters())
+        {
+            // Le pic est mesuré relativement aux octets vivants au début.
+            internal::memoryCountersStorage().peakBytes.store(m_start.liveBytes, std::memory_order_relaxed);
+        }
+
+        size_t allocations() const { return memoryCounters().allocations - m_start.allocations; }
+        size_t frees() const { return memoryCounters().frees - m_start.frees; }
+        size_t bytesAllocated() const { return memoryCounters().bytesAllocated - m_start.bytesAllocated; }
+        size_t copies() const { return memoryCounters().copies - m_start.copies; }
+        size_t bytesCopied() const { return memoryCounters().bytesCopied - m_start.bytesCopied; }
+
+        /**
+         * Octets vivants au-delà de ceux du début de la mesure, au pire moment.
+         */
+        size_t peakBytes() const
+        {
+            const size_t peak = memoryCounters().peakBytes;
+            return peak > m_start.liveBytes ? peak - m_start.liveBytes : 0;
+        }
+
+    private:
+
+        MemoryCounters m_start;
+    };
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+/**
+ * @file Map.h
+ *
+ * @brief Vues non propriétaires de matrices et de vecteurs sur un tampon externe.
+ *
+ * Une Map interprète un tampon existant (tableau C, données d'un fichier
+ * BVH, matrice nanogui, fichier projeté, ...) comme une matrice ou un
+ * vecteur de dimensions et d'ordre de stockage donnés, sans copier les
+ * données :
+ *
+ *    float m[16];
+ *    Map<Matrix<float, 4, 4> > M(m);
+ *    M = A * B;                      // écrit directement dans m
+ *
+ * Map<Matrix<_Scalar, R, C, Storage> > dérive de la matrice dynamique
+ * Matrix<_Scalar, Dynamic, Dynamic, Storage> (et Map<Vector<_Scalar, R> >
+ * de Vector<_Scalar, Dynamic>) : tous les opérateurs de Operators.h
+ * l'acceptent tels quels. Les dimensions fixes `R` et `C` ne sont vérifiées
+ * qu'à la construction.
+ *
+ * Le tampon n'est jamais libéré ni réalloué par la vue ; l'appelant doit le
+ * garder valide tant que la vue est utilisée. Une affectation copie les
+ * valeurs dans le tampon (les dimensions doivent correspondre), et une copie
+ * de la vue partage le même tampon. Pour obtenir une copie propriétaire, il
+ * suffit de construire une matrice ordinaire à partir de la vue.
+ *
+ * La vue peut être redimensionnée (par resize() ou par un opérateur qui fixe
+ * les dimensions de son résultat) tant que le nombre d'entrées ne dépasse pas
+ * celui donné à la construction ; au-delà, l'opération lance
+ * std::length_error plutôt que d'écrire ailleurs que dans le tampon :
+ *
+ *    double buf[4];
+ *    Map<Vector<double> > y(buf, 4);
+ *    multiply(M, x, y);              // M de 3 lignes : y.rows() == 3, dans buf
+ *    multiply(N, x, y);              // N de 5 lignes : std::length_error
+ *
+ */
+
+#include "Matrix.h"
+#include "Vector.h"
+
+#include <cstring>
+
+namespace gti320
+{
+    template<typename _PlainObject> class Map;
+
+    /**
+     * Vue d'un tampon externe comme une matrice.
+     */
+    template<typename _Scalar, int _RowsAtCompile, int _ColsAtCompile, int _StorageType>
+    class Map< Matrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType> > : public Matrix<_Scalar, Dynamic, Dynamic, _StorageType>
+    {
+    public:
+
+        typedef Matrix<_Scalar, Dynamic, Dynamic, _StorageType> Base;
+
+        /**
+         * Vue de `data` comme une matrice (rows, cols).
+         */
+        Map(_Scalar* data, Index rows, Index cols) : Base()
+        {
+            assert(_RowsAtCompile == Dynamic || rows == _RowsAtCompile);
+            assert(_ColsAtCompile == Dynamic || cols == _ColsAtCompile);
+            this->wrap(data, rows, cols);
+        }
+
+        /**
+         * Vue de `data` comme une matrice de taille fixe.
+         */
+        explicit Map(_Scalar* data) : Base()
+        {
+            static_assert(_RowsAtCompile != Dynamic && _ColsAtCompile != Dynamic, "Les dimensions doivent etre fixes");
+            this->wrap(data, _RowsAtCompile, _ColsAtCompile);
+        }
+
+        /**
+         * Constructeur de copie : la nouvelle vue partage le tampon de `other`.
+         */
+        Map(const Map& other) : Base()
+        {
+            this->wrap(const_cast<_Scalar*>(other.data()), other.rows(), other.cols());
+        }
+
+        /**
+         * Copie les entrées de `other` dans le tampon.
+         */
+        Map& operator=(const Map& other)
+        {
+            return assign(other);
+        }
+
+        /**
+         * Copie les entrées d'une matrice de même ordre de stockage dans le
+         * tampon. Les dimensions doivent correspondre.
+         */
+        template<int _OtherRows, int _OtherCols>
+        Map& operator=(const Matrix<_Scalar, _OtherRows, _OtherCols, _StorageType>& other)
+        {
+            return assign(other);
+        }
+
+        /**
+         * Évalue une expression élément par élément (voir Expression.h)
+         * directement dans le tampon.
+         */
+        template<typename _Derived>
+        Map& operator=(const MatrixExpression<_Derived>& expr)
+        {
+            evaluate(this->view(), expr);
+            return *this;
+        }
+
+    private:
+
+        template<typename _Other>
+        Map& assign(const _Other& other)
+        {
+            assert(other.rows() == this->rows() && other.cols() == this->cols());
+            const Index size = this->rows() * this->cols();
+            if (size > 0 && other.data() != this->data())
+                memmove(this->data(), other.data(), sizeof(_Scalar) * size);
+            return *this;
+        }
+    };
+
+    /**
+     * Vue d'un tampon externe comme un vecteur.
+     */
+    template<typename _Scalar, int _Rows>
+    class Map< Vector<_Scalar, _Rows> > : public Vector<_Scalar, Dynamic>
+    {
+    public:
+
+        typedef Vector<_Scalar, Dynamic> Base;
+
+        /**
+         * Vue de `data` comme un vecteur de `rows` entrées.
+         */
+        Map(_Scalar* data, Index rows) : Base()
+        {
+            assert(_Rows == Dynamic || rows == _Rows);
+            this->wrap(data, rows, 1);
+        }
+
+        /**
+         * Vue de `data` comme un vecteur de taille fixe.
+         */
+        explicit Map(_Scalar* data) : Base()
+        {
+            static_assert(_Rows != Dynamic, "La dimension doit etre fixe");
+            this->wrap(data, _Rows, 1);
+        }
+
+        /**
+         * Constructeur de copie : la nouvelle vue partage le tampon de `other`.
+         */
+        Map(const Map& other) : Base()
+        {
+            this->wrap(const_cast<_Scalar*>(other.data()), other.rows(), 1);
+        }
+
+        /**
+         * Copie les entrées de `other` dans le tampon.
+         */
+        Map& operator=(const Map& other)
+        {
+            return assign(other);
+        }
+
+        /**
+         * Copie les entrées d'un vecteur dans le tampon. Les dimensions
+         * doivent correspondre.
+         */
+        template<int _OtherRows>
+        Map& operator=(const Vector<_Scalar, _OtherRows>& other)
+        {
+            return assign(other);
+        }
+
+        /**
+         * Évalue une expression vectorielle (voir Expression.h) directement
+         * dans le tampon.
+         */
+        template<typename _Derived>
+        Map& operator=(const MatrixExpression<_Derived>& expr)
+        {
+            evaluate(this->view(), expr);
+            return *this;
+        }
+
+    private:
+
+        template<typename _Other>
+        Map& assign(const _Other& other)
+        {
+            assert(other.rows() == this->rows());
+            const Index size = this->rows();
+            if (size > 0 && other.data() != this->data())
+                memmove(this->data(), other.data(), sizeof(_Scalar) * size);
+            return *this;
+        }
+    };
+}
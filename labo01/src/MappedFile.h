@@ -0,0 +1,317 @@
+#pragma once
+
+/**
+ * @file MappedFile.h
+ *
+ * @brief Fichiers projetés en mémoire (mmap) et format des matrices sur disque.
+ *
+ * Un MappedFile projette un fichier entier dans l'espace d'adressage. Les
+ * pages sont lues à la demande et le cache de pages du système se charge de
+ * les évincer : une matrice plus grande que la mémoire vive reste utilisable
+ * et son « chargement » est quasi instantané.
+ *
+ * Trois modes d'ouverture :
+ *
+ *    MapReadOnly  : fichier existant, projection privée (copie sur écriture).
+ *                   Les écritures sont permises mais ne modifient jamais le
+ *                   fichier.
+ *    MapReadWrite : fichier existant, projection partagée. Les écritures sont
+ *                   reportées dans le fichier.
+ *    MapCreate    : crée (ou tronque) un fichier de la longueur demandée,
+ *                   projection partagée.
+ *
+ * Une matrice sur disque est un en-tête de 64 octets (MatrixFileHeader) suivi
+ * des coefficients, dans l'ordre de stockage de la matrice. Le tampon de
+ * données est donc aligné sur 64 octets, comme les tampons alloués (voir
+ * Memory.h).
+ *
+ */
+
+#include "Types.h"
+#include "Memory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gti320
+{
+    enum MapMode
+    {
+        MapReadOnly = 0,
+        MapReadWrite = 1,
+        MapCreate = 2
+    };
+
+    /**
+     * Projection en mémoire d'un fichier complet.
+     *
+     * L'objet possède la projection : elle est défaite à la destruction ou par
+     * close(). Il peut être déplacé mais pas copié.
+     */
+    class MappedFile
+    {
+    public:
+
+        MappedFile() : m_data(nullptr), m_length(0), m_mode(MapReadOnly) { }
+
+        MappedFile(MappedFile&& other) noexcept :
+            m_data(other.m_data), m_length(other.m_length), m_mode(other.m_mode)
+        {
+            other.m_data = nullptr;
+            other.m_length = 0;
+        }
+
+        MappedFile& operator=(MappedFile&& other) noexcept
+        {
+            if (this != &other)
+            {
+                close();
+                m_data = other.m_data;
+                m_length = other.m_length;
+                m_mode = other.m_mode;
+                other.m_data = nullptr;
+                other.m_length = 0;
+            }
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+            close();
+        }
+
+        /**
+         * Projette le fichier `path`.
+         *
+         * En mode MapCreate, le fichier est créé (ou tronqué) à `length`
+         * octets ; dans les autres modes, `length` est ignoré et le fichier
+         * est projeté en entier.
+         *
+         * Retourne faux si le fichier ne peut pas être ouvert ou projeté.
+         */
+        bool open(const char* path, MapMode mode, size_t length = 0)
+        {
+            close();
+            m_mode = mode;
+
+#if defined(_WIN32)
+            const DWORD access = mode == MapReadOnly ? GENERIC_READ : (GENERIC_READ | GENERIC_WRITE);
+            const DWORD disposition = mode == MapCreate ? CREATE_ALWAYS : OPEN_EXISTING;
+            HANDLE file = CreateFileA(path, access, FILE_SHARE_READ, NULL, disposition, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+
+            if (mode != MapCreate)
+            {
+                LARGE_INTEGER size;
+                if (!GetFileSizeEx(file, &size))
+                {
+                    CloseHandle(file);
+                    return false;
+                }
+                length = (size_t)size.QuadPart;
+            }
+            if (length == 0)
+            {
+                CloseHandle(file);
+                return false;
+            }
+
+            // CreateFileMapping agrandit le fichier créé à la longueur demandée.
+            const DWORD protect = mode == MapReadOnly ? PAGE_WRITECOPY : PAGE_READWRITE;
+            HANDLE mapping = CreateFileMappingA(file, NULL, protect, (DWORD)((uint64_t)length >> 32), (DWORD)((uint64_t)length & 0xFFFFFFFFu), NULL);
+            CloseHandle(file);
+            if (mapping == NULL)
+                return false;
+
+            void* data = MapViewOfFile(mapping, mode == MapReadOnly ? FILE_MAP_COPY : FILE_MAP_WRITE, 0, 0, length);
+            CloseHandle(mapping);
+            if (data == NULL)
+                return false;
+#else
+            const int flags = mode == MapReadOnly ? O_RDONLY : (mode == MapCreate ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR);
+            const int fd = ::open(path, flags, 0644);
+            if (fd < 0)
+                return false;
+
+            if (mode == MapCreate)
+            {
+                if (::ftruncate(fd, (off_t)length) != 0)
+                {
+                    ::close(fd);
+                    return false;
+                }
+            }
+            else
+            {
+                struct stat st;
+                if (::fstat(fd, &st) != 0)
+                {
+                    ::close(fd);
+                    return false;
+                }
+                length = (size_t)st.st_size;
+            }
+            if (length == 0)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            // La projection reste valide après la fermeture du descripteur.
+            // Une projection privée ne réserve pas d'espace d'échange pour
+            // toute sa longueur : seules les pages écrites sont copiées, et un
+            // fichier plus grand que la mémoire reste projetable.
+            int share = mode == MapReadOnly ? MAP_PRIVATE : MAP_SHARED;
+#ifdef MAP_NORESERVE
+            if (mode == MapReadOnly)
+                share |= MAP_NORESERVE;
+#endif
+            void* data = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, share, fd, 0);
+            ::close(fd);
+            if (data == MAP_FAILED)
+                return false;
+#endif
+
+            m_data = data;
+            m_length = length;
+            return true;
+        }
+
+        /**
+         * Défait la projection. Les modifications d'une projection partagée
+         * sont conservées dans le fichier.
+         */
+        void close()
+        {
+            if (m_data == nullptr)
+                return;
+
+#if defined(_WIN32)
+            UnmapViewOfFile(m_data);
+#else
+            ::munmap(m_data, m_length);
+#endif
+            m_data = nullptr;
+            m_length = 0;
+        }
+
+        /**
+         * Écrit sur le disque les pages modifiées d'une projection partagée.
+         */
+        void flush()
+        {
+            if (m_data == nullptr || m_mode == MapReadOnly)
+                return;
+
+#if defined(_WIN32)
+            FlushViewOfFile(m_data, m_length);
+#else
+            ::msync(m_data, m_length, MS_SYNC);
+#endif
+        }
+
+        inline bool isOpen() const { return m_data != nullptr; }
+        inline MapMode mode() const { return m_mode; }
+        inline size_t length() const { return m_length; }
+        inline void* data() { return m_data; }
+        inline const void* data() const { return m_data; }
+
+    private:
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        void* m_data;       // Début de la projection
+        size_t m_length;    // Longueur de la projection (octets)
+        MapMode m_mode;
+    };
+
+    /**
+     * En-tête d'une matrice sur disque (64 octets).
+     */
+    struct MatrixFileHeader
+    {
+        char magic[8];          // "GTI320M"
+        uint32_t scalarSize;    // sizeof(_Scalar)
+        uint32_t storage;       // ColumnStorage ou RowStorage
+        int64_t rows;
+        int64_t cols;
+        char reserved[32];
+    };
+
+    static_assert(sizeof(MatrixFileHeader) == 64, "L'en-tete doit conserver l'alignement des donnees");
+
+    /**
+     * Longueur d'un fichier contenant une matrice `rows` x `cols`.
+     *
+     * Les données sont suivies du même remplissage que les tampons alloués,
+     * pour que le dernier paquet puisse être lu par un chargement vectoriel.
+     */
+    template<typename _Scalar>
+    inline size_t matrixFileLength(Index rows, Index cols)
+    {
+        return sizeof(MatrixFileHeader) + sizeof(_Scalar) * (size_t)paddedSize<_Scalar, DefaultAlignment>(rows * cols);
+    }
+
+    /**
+     * Écrit l'en-tête d'une matrice au début d'un fichier projeté.
+     */
+    template<typename _Scalar>
+    inline void writeMatrixHeader(MappedFile& file, int storage, Index rows, Index cols)
+    {
+        MatrixFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "GTI320M", 8);
+        header.scalarSize = (uint32_t)sizeof(_Scalar);
+        header.storage = (uint32_t)storage;
+        header.rows = (int64_t)rows;
+        header.cols = (int64_t)cols;
+        memcpy(file.data(), &header, sizeof(header));
+    }
+
+    /**
+     * Lit et valide l'en-tête d'une matrice projetée.
+     *
+     * Retourne faux si le fichier n'est pas une matrice de `_Scalar` stockée
+     * selon `storage`, s'il est tronqué ou si sa taille dépasse Index.
+     */
+    template<typename _Scalar>
+    inline bool readMatrixHeader(const MappedFile& file, int storage, Index& rows, Index& cols)
+    {
+        if (!file.isOpen() || file.length() < sizeof(MatrixFileHeader))
+            return false;
+
+        MatrixFileHeader header;
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, "GTI320M", 8) != 0 || header.scalarSize != sizeof(_Scalar) || header.storage != (uint32_t)storage)
+            return false;
+        if (header.rows < 0 || header.cols < 0)
+            return false;
+        if (header.cols > 0 && header.rows > (int64_t)(std::numeric_limits<Index>::max() / header.cols))
+            return false;
+        if (file.length() < matrixFileLength<_Scalar>((Index)header.rows, (Index)header.cols))
+            return false;
+
+        rows = (Index)header.rows;
+        cols = (Index)header.cols;
+        return true;
+    }
+}
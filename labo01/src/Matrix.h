@@ -12,6 +12,9 @@
  */
 
 #include "MatrixBase.h"
+#include "MatrixView.h"
+#include "Expression.h"
+#include "FixedSize.h"
 
 namespace gti320
 {
@@ -38,16 +41,107 @@ namespace gti320
          */
         Matrix(const Matrix& other) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(other) {}
 
+        /**
+         * Constructeur de déplacement
+         */
+        Matrix(Matrix&& other) noexcept : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(std::move(other)) {}
+
         /**
          * Constructeur avec spécification du nombre de ligne et de colonnes
          */
-        explicit Matrix(int _rows, int _cols) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(_rows, _cols) {}
+        explicit Matrix(Index _rows, Index _cols) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(_rows, _cols) {}
+
+        /**
+         * Constructeur sans initialisation des entrées
+         */
+        Matrix(Index _rows, Index _cols, UninitializedTag) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(_rows, _cols, Uninitialized) {}
+
+        /**
+         * Constructeur à partir d'une expression élément par élément (voir
+         * Expression.h), évaluée en une seule passe.
+         */
+        template<typename _Derived>
+        Matrix(const MatrixExpression<_Derived>& expr) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(expr.derived().rows(), expr.derived().cols(), Uninitialized)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::AssignOp(), view(), expr);
+        }
 
         /**
          * Destructeur
          */
         ~Matrix() {}
 
+        /**
+         * Opérateur de copie
+         */
+        Matrix& operator=(const Matrix& other)
+        {
+            MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>::operator=(other);
+            return *this;
+        }
+
+        /**
+         * Opérateur de déplacement
+         */
+        Matrix& operator=(Matrix&& other) noexcept
+        {
+            MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>::operator=(std::move(other));
+            return *this;
+        }
+
+        /**
+         * Affectation d'une expression élément par élément (voir Expression.h).
+         * La matrice est redimensionnée au besoin ; le tampon courant est
+         * réutilisé si sa capacité suffit.
+         */
+        template<typename _Derived>
+        Matrix& operator=(const MatrixExpression<_Derived>& expr)
+        {
+            this->resize(expr.derived().rows(), expr.derived().cols(), Uninitialized);
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::AssignOp(), view(), expr);
+            return *this;
+        }
+
+        /**
+         * Opérateurs composés : mise à jour en place, sans temporaire (voir
+         * Expression.h). L'opérande est une matrice de mêmes dimensions, quel
+         * que soit son ordre de stockage, ou une expression.
+         */
+        template<int _OtherRows, int _OtherCols, int _OtherStorage>
+        Matrix& operator+=(const Matrix<_Scalar, _OtherRows, _OtherCols, _OtherStorage>& other)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::SumOp(), view(), LeafExpression<_Scalar, _OtherStorage>(other.view()));
+            return *this;
+        }
+
+        template<typename _Derived>
+        Matrix& operator+=(const MatrixExpression<_Derived>& expr)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::SumOp(), view(), expr);
+            return *this;
+        }
+
+        template<int _OtherRows, int _OtherCols, int _OtherStorage>
+        Matrix& operator-=(const Matrix<_Scalar, _OtherRows, _OtherCols, _OtherStorage>& other)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::DifferenceOp(), view(), LeafExpression<_Scalar, _OtherStorage>(other.view()));
+            return *this;
+        }
+
+        template<typename _Derived>
+        Matrix& operator-=(const MatrixExpression<_Derived>& expr)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::DifferenceOp(), view(), expr);
+            return *this;
+        }
+
+        Matrix& operator*=(_Scalar a)
+        {
+            const LeafExpression<_Scalar, _StorageType> leaf(static_cast<const Matrix&>(*this).view());
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::AssignOp(), view(), ScaledExpression< LeafExpression<_Scalar, _StorageType> >(a, leaf));
+            return *this;
+        }
+
         /**
          * Opérateur de copie à partir d'une sous-matrice.
          *
@@ -63,15 +157,15 @@ namespace gti320
             // TODO copier les données de la sous-matrice.
             //   Note : si les dimensions ne correspondent pas, la matrice doit être redimensionnée.
             //   Vous pouvez présumer qu'il s'agit d'un stockage par colonnes.
-            int rows = submatrix.rows();
-            int columns = submatrix.cols();
+            Index rows = submatrix.rows();
+            Index columns = submatrix.cols();
 
             if (this->rows() != rows || this->cols() != columns) {
                 this->resize(rows, columns);
             }
 
-            for (int i = 0; i < columns; ++i ) {
-                for (int j = 0; j < rows; ++j) {
+            for (Index i = 0; i < columns; ++i ) {
+                for (Index j = 0; j < rows; ++j) {
                     (*this)(i, j) = submatrix(i, j);
                 }
             }
@@ -81,32 +175,91 @@ namespace gti320
         /**
          * Accesseur à une entrée de la matrice (lecture seule)
          */
-        _Scalar operator()(int i, int j) const
+        _Scalar operator()(Index i, Index j) const
         {
             // TODO implementer
-            int rows = this->rows();
+            Index rows = this->rows();
             return this->m_storage[i + j * rows];
         }
 
         /**
          * Accesseur à une entrée de la matrice (lecture ou écriture)
          */
-        _Scalar& operator()(int i, int j)
+        _Scalar& operator()(Index i, Index j)
         {
             // TODO implementer
             //      Indice : l'implémentation est identique à celle de la fonction précédente.
-            int rows = this->rows();
+            Index rows = this->rows();
             return this->m_storage[i + j * rows];
         }
 
+        /**
+         * Projette en mémoire la matrice enregistrée dans le fichier `path`
+         * (voir MappedFile.h), sans copier les données. En mode MapReadOnly,
+         * les modifications ne sont jamais écrites dans le fichier.
+         *
+         * Retourne faux si le fichier ne peut pas être projeté ou ne contient
+         * pas une matrice de ce type.
+         */
+        bool openMapped(const char* path, MapMode mode = MapReadOnly)
+        {
+            assert(mode != MapCreate);
+            MappedFile file;
+            Index rows, cols;
+            if (!file.open(path, mode) || !readMatrixHeader<_Scalar>(file, ColumnStorage, rows, cols))
+                return false;
+            return this->map(std::move(file), sizeof(MatrixFileHeader), rows, cols);
+        }
+
+        /**
+         * Crée (ou remplace) le fichier `path` pour une matrice de taille
+         * (rows, cols) et y associe la matrice en lecture-écriture. Les
+         * entrées valent zéro.
+         */
+        bool createMapped(const char* path, Index rows, Index cols)
+        {
+            MappedFile file;
+            if (!file.open(path, MapCreate, matrixFileLength<_Scalar>(rows, cols)))
+                return false;
+            writeMatrixHeader<_Scalar>(file, ColumnStorage, rows, cols);
+            return this->map(std::move(file), sizeof(MatrixFileHeader), rows, cols);
+        }
+
         /**
          * Crée une sous-matrice pour un block de taille (rows, cols) à partir de l'index (i,j).
          */
-        SubMatrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType> block(int i, int j, int rows, int cols) const
+        SubMatrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType> block(Index i, Index j, Index rows, Index cols) const
         {
             return SubMatrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType>(*this, i, j, rows, cols);
         }
 
+        /**
+         * Vue à pas de la matrice entière, sans copie (voir MatrixView.h).
+         */
+        MatrixView<_Scalar, _StorageType> view()
+        {
+            return MatrixView<_Scalar, _StorageType>(this->data(), this->rows(), this->cols());
+        }
+
+        MatrixView<const _Scalar, _StorageType> view() const
+        {
+            return MatrixView<const _Scalar, _StorageType>(this->data(), this->rows(), this->cols());
+        }
+
+        /**
+         * Vue à pas du bloc (rows, cols) commençant à l'entrée (i,j). Contrairement
+         * à block(), la vue peut être passée directement aux noyaux de Operators.h.
+         */
+        MatrixView<_Scalar, _StorageType> view(Index i, Index j, Index rows, Index cols)
+        {
+            return view().block(i, j, rows, cols);
+        }
+
+        MatrixView<const _Scalar, _StorageType> view(Index i, Index j, Index rows, Index cols) const
+        {
+            return view().block(i, j, rows, cols);
+        }
+
         /**
          * Calcule l'inverse de la matrice
          */
@@ -123,15 +276,10 @@ namespace gti320
         Matrix<_OtherScalar, _OtherRows, _OtherCols, _OtherStorage> transpose() const
         {
             // TODO calcule et retourne la transposée de la matrice.
-            const int cols = this->cols();
-            const int rows = this->rows();
-            Matrix <_OtherScalar,  _OtherRows,  _OtherCols, _OtherStorage> matrixT(cols, rows);
-            for (int i = 0; i < rows; ++i) {
-                for (int j = 0; j < cols; ++j) {
-                    matrixT(j,i) = (*this)(i,j);
-                }
-
-            }
+            const Index cols = this->cols();
+            const Index rows = this->rows();
+            Matrix <_OtherScalar,  _OtherRows,  _OtherCols, _OtherStorage> matrixT(cols, rows, Uninitialized);
+            internal::transpose<_RowsAtCompile, _ColsAtCompile>(view(), matrixT.view());
             return  matrixT;
         }
 
@@ -144,10 +292,10 @@ namespace gti320
             // TODO affecter la valeur 0.0 partour, sauf sur la diagonale principale où c'est 1.0..
             //      Votre implémentation devrait aussi fonctionner pour des matrices qui ne sont pas carrées.
             this->setZero();
-            int rows = this->rows();
-            int cols = this->cols();
-            int diag = (rows <= cols) ? rows : cols;
-            for (int i  = 0; i < diag ; ++i) {
+            Index rows = this->rows();
+            Index cols = this->cols();
+            Index diag = (rows <= cols) ? rows : cols;
+            for (Index i  = 0; i < diag ; ++i) {
                 (*this)(i,i) = 1.0;
             }
         }
@@ -171,16 +319,107 @@ namespace gti320
          */
         Matrix(const Matrix& other) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(other) {}
 
+        /**
+         * Constructeur de déplacement
+         */
+        Matrix(Matrix&& other) noexcept : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(std::move(other)) {}
+
         /**
          * Constructeur avec spécification du nombre de ligne et de colonnes
          */
-        explicit Matrix(int rows, int cols) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(rows, cols) {}
+        explicit Matrix(Index rows, Index cols) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(rows, cols) {}
+
+        /**
+         * Constructeur sans initialisation des entrées
+         */
+        Matrix(Index rows, Index cols, UninitializedTag) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(rows, cols, Uninitialized) {}
+
+        /**
+         * Constructeur à partir d'une expression élément par élément (voir
+         * Expression.h), évaluée en une seule passe.
+         */
+        template<typename _Derived>
+        Matrix(const MatrixExpression<_Derived>& expr) : MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>(expr.derived().rows(), expr.derived().cols(), Uninitialized)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::AssignOp(), view(), expr);
+        }
 
         /**
          * Destructeur
          */
         ~Matrix() {}
 
+        /**
+         * Opérateur de copie
+         */
+        Matrix& operator=(const Matrix& other)
+        {
+            MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>::operator=(other);
+            return *this;
+        }
+
+        /**
+         * Opérateur de déplacement
+         */
+        Matrix& operator=(Matrix&& other) noexcept
+        {
+            MatrixBase<_Scalar, _RowsAtCompile, _ColsAtCompile>::operator=(std::move(other));
+            return *this;
+        }
+
+        /**
+         * Affectation d'une expression élément par élément (voir Expression.h).
+         * La matrice est redimensionnée au besoin ; le tampon courant est
+         * réutilisé si sa capacité suffit.
+         */
+        template<typename _Derived>
+        Matrix& operator=(const MatrixExpression<_Derived>& expr)
+        {
+            this->resize(expr.derived().rows(), expr.derived().cols(), Uninitialized);
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::AssignOp(), view(), expr);
+            return *this;
+        }
+
+        /**
+         * Opérateurs composés : mise à jour en place, sans temporaire (voir
+         * Expression.h). L'opérande est une matrice de mêmes dimensions, quel
+         * que soit son ordre de stockage, ou une expression.
+         */
+        template<int _OtherRows, int _OtherCols, int _OtherStorage>
+        Matrix& operator+=(const Matrix<_Scalar, _OtherRows, _OtherCols, _OtherStorage>& other)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::SumOp(), view(), LeafExpression<_Scalar, _OtherStorage>(other.view()));
+            return *this;
+        }
+
+        template<typename _Derived>
+        Matrix& operator+=(const MatrixExpression<_Derived>& expr)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::SumOp(), view(), expr);
+            return *this;
+        }
+
+        template<int _OtherRows, int _OtherCols, int _OtherStorage>
+        Matrix& operator-=(const Matrix<_Scalar, _OtherRows, _OtherCols, _OtherStorage>& other)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::DifferenceOp(), view(), LeafExpression<_Scalar, _OtherStorage>(other.view()));
+            return *this;
+        }
+
+        template<typename _Derived>
+        Matrix& operator-=(const MatrixExpression<_Derived>& expr)
+        {
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::DifferenceOp(), view(), expr);
+            return *this;
+        }
+
+        Matrix& operator*=(_Scalar a)
+        {
+            const LeafExpression<_Scalar, RowStorage> leaf(static_cast<const Matrix&>(*this).view());
+            internal::assign<_RowsAtCompile, _ColsAtCompile>(internal::AssignOp(), view(), ScaledExpression< LeafExpression<_Scalar, RowStorage> >(a, leaf));
+            return *this;
+        }
+
         /**
          * Opérateur de copie à partir d'une sous-matrice.
          *
@@ -196,15 +435,15 @@ namespace gti320
             //   Note : si les dimensions ne correspondent pas, la matrice doit être redimensionnée.
             //   Vous pouvez présumer qu'il s'agit d'un stockage par lignes.
 
-            int rows = submatrix.rows();
-            int cols = submatrix.cols();
+            Index rows = submatrix.rows();
+            Index cols = submatrix.cols();
 
             if (this->rows() != rows || this->cols() != cols) {
                 this->resize(rows, cols);
             }
 
-            for (int i = 0; i < rows; ++i) {
-                for (int j = 0; j < cols; ++j) {
+            for (Index i = 0; i < rows; ++i) {
+                for (Index j = 0; j < cols; ++j) {
                     (*this)(i,j) = submatrix(i,j);
                 }
 
@@ -215,30 +454,89 @@ namespace gti320
         /**
          * Accesseur à une entrée de la matrice (lecture seule)
          */
-        _Scalar operator()(int i, int j) const
+        _Scalar operator()(Index i, Index j) const
         {
             // TODO implementer
-            int cols = this->cols();
+            Index cols = this->cols();
             return this->m_storage[i*cols + j];
         }
 
         /**
          * Accesseur à une entrée de la matrice (lecture ou écriture)
          */
-        _Scalar& operator()(int i, int j)
+        _Scalar& operator()(Index i, Index j)
         {
             // TODO implementer
-            int cols = this->cols();
+            Index cols = this->cols();
             return this->m_storage[i*cols + j];
         }
 
+        /**
+         * Projette en mémoire la matrice enregistrée dans le fichier `path`
+         * (voir MappedFile.h), sans copier les données. En mode MapReadOnly,
+         * les modifications ne sont jamais écrites dans le fichier.
+         *
+         * Retourne faux si le fichier ne peut pas être projeté ou ne contient
+         * pas une matrice de ce type.
+         */
+        bool openMapped(const char* path, MapMode mode = MapReadOnly)
+        {
+            assert(mode != MapCreate);
+            MappedFile file;
+            Index rows, cols;
+            if (!file.open(path, mode) || !readMatrixHeader<_Scalar>(file, RowStorage, rows, cols))
+                return false;
+            return this->map(std::move(file), sizeof(MatrixFileHeader), rows, cols);
+        }
+
+        /**
+         * Crée (ou remplace) le fichier `path` pour une matrice de taille
+         * (rows, cols) et y associe la matrice en lecture-écriture. Les
+         * entrées valent zéro.
+         */
+        bool createMapped(const char* path, Index rows, Index cols)
+        {
+            MappedFile file;
+            if (!file.open(path, MapCreate, matrixFileLength<_Scalar>(rows, cols)))
+                return false;
+            writeMatrixHeader<_Scalar>(file, RowStorage, rows, cols);
+            return this->map(std::move(file), sizeof(MatrixFileHeader), rows, cols);
+        }
+
         /**
          * Crée une sous-matrice pour un block de taille (rows, cols) à partir de l'index (i,j).
          */
-        SubMatrix<_Scalar, _RowsAtCompile, _ColsAtCompile, RowStorage> block(int i, int j, int rows, int cols) const {
+        SubMatrix<_Scalar, _RowsAtCompile, _ColsAtCompile, RowStorage> block(Index i, Index j, Index rows, Index cols) const {
             return SubMatrix<_Scalar, _RowsAtCompile, _ColsAtCompile, RowStorage>(*this, i, j, rows, cols);
         }
 
+        /**
+         * Vue à pas de la matrice entière, sans copie (voir MatrixView.h).
+         */
+        MatrixView<_Scalar, RowStorage> view()
+        {
+            return MatrixView<_Scalar, RowStorage>(this->data(), this->rows(), this->cols());
+        }
+
+        MatrixView<const _Scalar, RowStorage> view() const
+        {
+            return MatrixView<const _Scalar, RowStorage>(this->data(), this->rows(), this->cols());
+        }
+
+        /**
+         * Vue à pas du bloc (rows, cols) commençant à l'entrée (i,j). Contrairement
+         * à block(), la vue peut être passée directement aux noyaux de Operators.h.
+         */
+        MatrixView<_Scalar, RowStorage> view(Index i, Index j, Index rows, Index cols)
+        {
+            return view().block(i, j, rows, cols);
+        }
+
+        MatrixView<const _Scalar, RowStorage> view(Index i, Index j, Index rows, Index cols) const
+        {
+            return view().block(i, j, rows, cols);
+        }
+
         /**
          * Calcule l'inverse de la matrice
          */
@@ -255,14 +553,10 @@ namespace gti320
         {
             // TODO calcule et retourne la transposée de la matrice.
             //    Optimisez cette fonction en tenant compte du type de stockage utilisé.
-            const int rows = this->rows();
-            const int cols = this->cols();
-            Matrix<_Scalar, _ColsAtCompile, _RowsAtCompile, ColumnStorage> matrixT (cols, rows);
-            for (int i = 0; i < rows; ++i) {
-                for (int j = 0; j < cols; ++j) {
-                    matrixT(j, i) = (*this)(i, j);
-                }
-            }
+            const Index rows = this->rows();
+            const Index cols = this->cols();
+            Matrix<_Scalar, _ColsAtCompile, _RowsAtCompile, ColumnStorage> matrixT (cols, rows, Uninitialized);
+            internal::transpose<_RowsAtCompile, _ColsAtCompile>(view(), matrixT.view());
 
             return matrixT;
         }
@@ -274,11 +568,11 @@ namespace gti320
         {
             // TODO affecter la valeur 0.0 partour, sauf sur la diagonale principale où c'est 1.0..
             //      Votre implémentation devrait aussi fonctionner pour des matrices qui ne sont pas carrées.
-            int rows = this->rows();
-            int cols = this->cols();
-            int diag = (rows < cols) ? rows : cols;
+            Index rows = this->rows();
+            Index cols = this->cols();
+            Index diag = (rows < cols) ? rows : cols;
             this->setZero();
-            for (int i = 0; i < diag; ++i) {
+            for (Index i = 0; i < diag; ++i) {
                 (*this)(i,i) = 1.0;
             }
         }
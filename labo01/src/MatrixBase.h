@@ -12,6 +12,8 @@
 
 #include "DenseStorage.h"
 
+#include <utility>
+
 namespace gti320
 {
 
@@ -38,7 +40,14 @@ namespace gti320
 		 */
 		MatrixBase(const MatrixBase& other) : m_storage(other.m_storage) { }
 
-		explicit MatrixBase(int _rows, int _cols) : m_storage() { }
+		/**
+		 * Constructeur de déplacement
+		 */
+		MatrixBase(MatrixBase&& other) noexcept : m_storage(std::move(other.m_storage)) { }
+
+		explicit MatrixBase(Index _rows, Index _cols) : m_storage() { }
+
+		MatrixBase(Index _rows, Index _cols, UninitializedTag) : m_storage() { }
 
 		/**
 		 * Destructeur
@@ -49,7 +58,12 @@ namespace gti320
 		/**
 		 * Redimensionne la matrice
 		 */
-		void resize(int _rows, int _cols)
+		void resize(Index _rows, Index _cols)
+		{
+			// Ne rien faire.
+		}
+
+		void resize(Index _rows, Index _cols, UninitializedTag)
 		{
 			// Ne rien faire.
 		}
@@ -66,18 +80,50 @@ namespace gti320
 			return *this;
 		}
 
+		/**
+		 * Opérateur de déplacement
+		 */
+		MatrixBase& operator=(MatrixBase&& other) noexcept
+		{
+			if (this != &other)
+			{
+				m_storage = std::move(other.m_storage);
+			}
+			return *this;
+		}
+
 		inline void setZero() { m_storage.setZero(); }
-		static inline int cols() { return _Cols; }
-		static inline int rows() { return _Rows; }
+		static inline Index cols() { return _Cols; }
+		static inline Index rows() { return _Rows; }
 
 		/**
 		 * Nombre d'éléments stockés dans le tampon.
 		 */
-		inline int size() const
+		inline Index size() const
 		{
 			return m_storage.size();
 		}
 
+		/**
+		 * Nombre d'éléments que peut contenir le tampon sans réallocation.
+		 */
+		static inline Index capacity() { return _Rows * _Cols; }
+
+		/**
+		 * Réserve de la place pour une matrice _rows x _cols (sans effet ici).
+		 */
+		void reserve(Index _rows, Index _cols) { }
+
+		/**
+		 * Libère la mémoire inutilisée (sans effet ici).
+		 */
+		void shrink_to_fit() { }
+
+		/**
+		 * Alignement (en octets) garanti pour le tampon de données.
+		 */
+		static inline int alignment() { return DenseStorage<_Scalar, _Rows* _Cols>::alignment(); }
+
 		/**
 		 * Accès au tampon de données (lecture seule)
 		 */
@@ -106,7 +152,7 @@ namespace gti320
 	protected:
 
 		DenseStorage<_Scalar, Dynamic> m_storage;
-		int m_rows;
+		Index m_rows;
 
 	public:
 
@@ -117,13 +163,26 @@ namespace gti320
 		 */
 		MatrixBase() : m_storage(), m_rows(0) { }
 
-		explicit MatrixBase(int _rows, int _cols) : m_storage(_rows* _Cols), m_rows(_rows) { }
+		explicit MatrixBase(Index _rows, Index _cols) : m_storage(_rows* _Cols), m_rows(_rows) { }
+
+		/**
+		 * Constructeur sans initialisation des entrées
+		 */
+		MatrixBase(Index _rows, Index _cols, UninitializedTag) : m_storage(_rows* _Cols, Uninitialized), m_rows(_rows) { }
 
 		/**
 		 * Constructeur de copie
 		 */
 		MatrixBase(const MatrixBase& other) : m_storage(other.m_storage), m_rows(other.m_rows) { }
 
+		/**
+		 * Constructeur de déplacement
+		 */
+		MatrixBase(MatrixBase&& other) noexcept : m_storage(std::move(other.m_storage)), m_rows(other.m_rows)
+		{
+			other.m_rows = 0;
+		}
+
 		/**
 		 * Destructeur
 		 */
@@ -142,20 +201,83 @@ namespace gti320
 			return *this;
 		}
 
+		/**
+		 * Opérateur de déplacement
+		 */
+		MatrixBase& operator=(MatrixBase&& other) noexcept
+		{
+			if (this != &other)
+			{
+				m_storage = std::move(other.m_storage);
+				m_rows = other.m_rows;
+				other.m_rows = 0;
+			}
+			return *this;
+		}
+
 		/**
 		 * Redimensionne la matrice
 		 */
-		void resize(int _rows, int _cols)
+		void resize(Index _rows, Index _cols)
 		{
 			assert(_cols == _Cols);
 			m_storage.resize(_rows * _Cols);
 			m_rows = _rows;
 		}
 
+		/**
+		 * Redimensionne la matrice sans initialiser les entrées
+		 */
+		void resize(Index _rows, Index _cols, UninitializedTag)
+		{
+			assert(_cols == _Cols);
+			m_storage.resize(_rows * _Cols, Uninitialized);
+			m_rows = _rows;
+		}
+
+		/**
+		 * Associe la matrice à une région d'un fichier projeté en mémoire,
+		 * sans copie (voir DenseStorage::map).
+		 */
+		bool map(MappedFile&& file, size_t offset, Index _rows, Index _cols)
+		{
+			assert(_cols == _Cols);
+			if (!m_storage.map(std::move(file), offset, _rows * _Cols))
+				return false;
+			m_rows = _rows;
+			return true;
+		}
+
+		/**
+		 * Vrai si les données sont celles d'un fichier projeté.
+		 */
+		inline bool isMapped() const { return m_storage.isMapped(); }
+
+		/**
+		 * Écrit sur le disque les modifications d'une matrice projetée.
+		 */
+		void flush() { m_storage.flush(); }
+
+		/**
+		 * Utilise le tampon externe `data` comme données de la matrice, sans
+		 * copie ni prise de possession (voir DenseStorage::wrap et Map.h).
+		 */
+		void wrap(_Scalar* data, Index _rows, Index _cols)
+		{
+			assert(_cols == _Cols);
+			m_storage.wrap(data, _rows * _Cols);
+			m_rows = _rows;
+		}
+
+		/**
+		 * Vrai si les données sont dans un tampon externe.
+		 */
+		inline bool isExternal() const { return m_storage.isExternal(); }
+
 		inline void setZero() { m_storage.setZero(); }
 
-		static inline int cols() { return _Cols; }
-		inline int rows() const { return m_rows; }
+		static inline Index cols() { return _Cols; }
+		inline Index rows() const { return m_rows; }
 
 		/**
 		 * Accès à la donnée membre de stockage (en lecture seule)
@@ -168,11 +290,32 @@ namespace gti320
 		/**
 		 * Nombre d'éléments stockés dans le tampon.
 		 */
-		inline int size() const
+		inline Index size() const
 		{
 			return m_storage.size();
 		}
 
+		/**
+		 * Nombre d'éléments que peut contenir le tampon sans réallocation.
+		 */
+		inline Index capacity() const { return m_storage.capacity(); }
+
+		/**
+		 * Réserve de la place pour une matrice _rows x _cols. Les redimensionnements
+		 * qui tiennent dans cette capacité ne réallouent pas le tampon.
+		 */
+		void reserve(Index _rows, Index _cols) { m_storage.reserve(_rows * _Cols); }
+
+		/**
+		 * Libère la mémoire inutilisée par la taille courante.
+		 */
+		void shrink_to_fit() { m_storage.shrink_to_fit(); }
+
+		/**
+		 * Alignement (en octets) garanti pour le tampon de données.
+		 */
+		static inline int alignment() { return DenseStorage<_Scalar, Dynamic>::alignment(); }
+
 		/**
 		 * Accès au tampon de données ((lecture seule))
 		 */
@@ -199,7 +342,7 @@ namespace gti320
 	protected:
 
 		DenseStorage<_Scalar, Dynamic> m_storage;
-		int m_cols;
+		Index m_cols;
 
 	public:
 
@@ -208,15 +351,28 @@ namespace gti320
 		/**
 		 * Constructeur par défaut
 		 */
-		MatrixBase() : m_storage() { }
+		MatrixBase() : m_storage(), m_cols(0) { }
 
-		explicit MatrixBase(int _rows, int _cols) : m_storage(_rows* _cols), m_cols(_cols) { }
+		explicit MatrixBase(Index _rows, Index _cols) : m_storage(_rows* _cols), m_cols(_cols) { }
+
+		/**
+		 * Constructeur sans initialisation des entrées
+		 */
+		MatrixBase(Index _rows, Index _cols, UninitializedTag) : m_storage(_rows* _cols, Uninitialized), m_cols(_cols) { }
 
 		/**
 		 * Constructeur de copie
 		 */
 		MatrixBase(const MatrixBase& other) : m_storage(other.m_storage), m_cols(other.m_cols) { }
 
+		/**
+		 * Constructeur de déplacement
+		 */
+		MatrixBase(MatrixBase&& other) noexcept : m_storage(std::move(other.m_storage)), m_cols(other.m_cols)
+		{
+			other.m_cols = 0;
+		}
+
 		/**
 		 * Destructeur
 		 */
@@ -235,29 +391,121 @@ namespace gti320
 			return *this;
 		}
 
+		/**
+		 * Opérateur de déplacement
+		 */
+		MatrixBase& operator=(MatrixBase&& other) noexcept
+		{
+			if (this != &other) {
+				m_storage = std::move(other.m_storage);
+				m_cols = other.m_cols;
+				other.m_cols = 0;
+			}
+
+			return *this;
+		}
+
 		/**
 		 * Redimensionne la matrice
 		 */
-		void resize(int _rows, int _cols)
+		void resize(Index _rows, Index _cols)
 		{
 			assert(_rows == _Rows);
 			m_storage.resize(_Rows * _cols);
 			m_cols = _cols;
 		}
 
+		/**
+		 * Redimensionne la matrice sans initialiser les entrées
+		 */
+		void resize(Index _rows, Index _cols, UninitializedTag)
+		{
+			assert(_rows == _Rows);
+			m_storage.resize(_Rows * _cols, Uninitialized);
+			m_cols = _cols;
+		}
+
+		/**
+		 * Associe la matrice à une région d'un fichier projeté en mémoire,
+		 * sans copie (voir DenseStorage::map).
+		 */
+		bool map(MappedFile&& file, size_t offset, Index _rows, Index _cols)
+		{
+			assert(_rows == _Rows);
+			if (!m_storage.map(std::move(file), offset, _Rows * _cols))
+				return false;
+			m_cols = _cols;
+			return true;
+		}
+
+		/**
+		 * Vrai si les données sont celles d'un fichier projeté.
+		 */
+		inline bool isMapped() const { return m_storage.isMapped(); }
+
+		/**
+		 * Écrit sur le disque les modifications d'une matrice projetée.
+		 */
+		void flush() { m_storage.flush(); }
+
+		/**
+		 * Utilise le tampon externe `data` comme données de la matrice, sans
+		 * copie ni prise de possession (voir DenseStorage::wrap et Map.h).
+		 */
+		void wrap(_Scalar* data, Index _rows, Index _cols)
+		{
+			assert(_rows == _Rows);
+			m_storage.wrap(data, _Rows * _cols);
+			m_cols = _cols;
+		}
+
+		/**
+		 * Vrai si les données sont dans un tampon externe.
+		 */
+		inline bool isExternal() const { return m_storage.isExternal(); }
+
 		inline void setZero() { m_storage.setZero(); }
 
-		inline int cols() const { return m_cols; }
-		static inline int rows() { return _Rows; }
+		inline Index cols() const { return m_cols; }
+		static inline Index rows() { return _Rows; }
+
+		/**
+		 * Accès à la donnée membre de stockage (en lecture seule)
+		 */
+		const DenseStorage<_Scalar, Dynamic>& storage() const
+		{
+			return m_storage;
+		}
 
 		/**
 		 * Nombre d'éléments stockés dans le tampon.
 		 */
-		inline int size() const
+		inline Index size() const
 		{
 			return m_storage.size();
 		}
 
+		/**
+		 * Nombre d'éléments que peut contenir le tampon sans réallocation.
+		 */
+		inline Index capacity() const { return m_storage.capacity(); }
+
+		/**
+		 * Réserve de la place pour une matrice _rows x _cols. Les redimensionnements
+		 * qui tiennent dans cette capacité ne réallouent pas le tampon.
+		 */
+		void reserve(Index _rows, Index _cols) { m_storage.reserve(_Rows * _cols); }
+
+		/**
+		 * Libère la mémoire inutilisée par la taille courante.
+		 */
+		void shrink_to_fit() { m_storage.shrink_to_fit(); }
+
+		/**
+		 * Alignement (en octets) garanti pour le tampon de données.
+		 */
+		static inline int alignment() { return DenseStorage<_Scalar, Dynamic>::alignment(); }
+
 		/**
 		 * Accès au tampon de données ((lecture seule))
 		 */
@@ -286,8 +534,8 @@ namespace gti320
 	protected:
 
 		DenseStorage<_Scalar, Dynamic> m_storage;
-		int m_cols;
-		int m_rows;
+		Index m_cols;
+		Index m_rows;
 
 	public:
 		typedef _Scalar Scalar;
@@ -295,14 +543,28 @@ namespace gti320
 		/**
 		 * Constructeur par défaut
 		 */
-		MatrixBase() : m_storage(), m_rows(0), m_cols(0) { }
+		MatrixBase() : m_storage(), m_cols(0), m_rows(0) { }
 
-		explicit MatrixBase(int _rows, int _cols) : m_storage(_rows* _cols), m_rows(_rows), m_cols(_cols) { }
+		explicit MatrixBase(Index _rows, Index _cols) : m_storage(_rows* _cols), m_cols(_cols), m_rows(_rows) { }
+
+		/**
+		 * Constructeur sans initialisation des entrées
+		 */
+		MatrixBase(Index _rows, Index _cols, UninitializedTag) : m_storage(_rows* _cols, Uninitialized), m_cols(_cols), m_rows(_rows) { }
 
 		/**
 		 * Constructeur de copie
 		 */
-		MatrixBase(const MatrixBase& other) : m_storage(other.m_storage), m_rows(other.m_rows), m_cols(other.m_cols) { }
+		MatrixBase(const MatrixBase& other) : m_storage(other.m_storage), m_cols(other.m_cols), m_rows(other.m_rows) { }
+
+		/**
+		 * Constructeur de déplacement
+		 */
+		MatrixBase(MatrixBase&& other) noexcept : m_storage(std::move(other.m_storage)), m_cols(other.m_cols), m_rows(other.m_rows)
+		{
+			other.m_cols = 0;
+			other.m_rows = 0;
+		}
 
 		/**
 		 * Destructeur
@@ -316,8 +578,25 @@ namespace gti320
 		{
 			if (this != &other)
 			{
-				resize(other.m_rows, other.m_cols);
 				m_storage = other.m_storage;
+				m_rows = other.m_rows;
+				m_cols = other.m_cols;
+			}
+			return *this;
+		}
+
+		/**
+		 * Opérateur de déplacement
+		 */
+		MatrixBase& operator=(MatrixBase&& other) noexcept
+		{
+			if (this != &other)
+			{
+				m_storage = std::move(other.m_storage);
+				m_rows = other.m_rows;
+				m_cols = other.m_cols;
+				other.m_rows = 0;
+				other.m_cols = 0;
 			}
 			return *this;
 		}
@@ -325,26 +604,104 @@ namespace gti320
 		/**
 		 * Redimensionne la matrice
 		 */
-		void resize(int _rows, int _cols)
+		void resize(Index _rows, Index _cols)
 		{
 			m_storage.resize(_rows * _cols);
 			m_rows = _rows;
 			m_cols = _cols;
 		}
 
+		/**
+		 * Redimensionne la matrice sans initialiser les entrées
+		 */
+		void resize(Index _rows, Index _cols, UninitializedTag)
+		{
+			m_storage.resize(_rows * _cols, Uninitialized);
+			m_rows = _rows;
+			m_cols = _cols;
+		}
+
+		/**
+		 * Associe la matrice à une région d'un fichier projeté en mémoire,
+		 * sans copie (voir DenseStorage::map).
+		 */
+		bool map(MappedFile&& file, size_t offset, Index _rows, Index _cols)
+		{
+			if (!m_storage.map(std::move(file), offset, _rows * _cols))
+				return false;
+			m_rows = _rows;
+			m_cols = _cols;
+			return true;
+		}
+
+		/**
+		 * Vrai si les données sont celles d'un fichier projeté.
+		 */
+		inline bool isMapped() const { return m_storage.isMapped(); }
+
+		/**
+		 * Écrit sur le disque les modifications d'une matrice projetée.
+		 */
+		void flush() { m_storage.flush(); }
+
+		/**
+		 * Utilise le tampon externe `data` comme données de la matrice, sans
+		 * copie ni prise de possession (voir DenseStorage::wrap et Map.h).
+		 */
+		void wrap(_Scalar* data, Index _rows, Index _cols)
+		{
+			m_storage.wrap(data, _rows * _cols);
+			m_rows = _rows;
+			m_cols = _cols;
+		}
+
+		/**
+		 * Vrai si les données sont dans un tampon externe.
+		 */
+		inline bool isExternal() const { return m_storage.isExternal(); }
+
 		inline void setZero() { m_storage.setZero(); }
 
-		inline int cols() const { return m_cols; }
-		inline int rows() const { return m_rows; }
+		inline Index cols() const { return m_cols; }
+		inline Index rows() const { return m_rows; }
+
+		/**
+		 * Accès à la donnée membre de stockage (en lecture seule)
+		 */
+		const DenseStorage<_Scalar, Dynamic>& storage() const
+		{
+			return m_storage;
+		}
 
 		/**
 		 * Nombre d'éléments stockés dans le tampon.
 		 */
-		inline int size() const
+		inline Index size() const
 		{
 			return m_storage.size();
 		}
 
+		/**
+		 * Nombre d'éléments que peut contenir le tampon sans réallocation.
+		 */
+		inline Index capacity() const { return m_storage.capacity(); }
+
+		/**
+		 * Réserve de la place pour une matrice _rows x _cols. Les redimensionnements
+		 * qui tiennent dans cette capacité ne réallouent pas le tampon.
+		 */
+		void reserve(Index _rows, Index _cols) { m_storage.reserve(_rows * _cols); }
+
+		/**
+		 * Libère la mémoire inutilisée par la taille courante.
+		 */
+		void shrink_to_fit() { m_storage.shrink_to_fit(); }
+
+		/**
+		 * Alignement (en octets) garanti pour le tampon de données.
+		 */
+		static inline int alignment() { return DenseStorage<_Scalar, Dynamic>::alignment(); }
+
 		/**
 		 * Accès au tampon de données ((lecture seule))
 		 */
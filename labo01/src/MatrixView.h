@@ -0,0 +1,224 @@
+#pragma once
+
+/**
+ * @file MatrixView.h
+ *
+ * @brief Vues à pas (leading dimension) sur un bloc de matrice.
+ *
+ * Une MatrixView décrit un bloc rows x cols d'un tampon quelconque par un
+ * pointeur, ses dimensions et son pas externe (outerStride, la « leading
+ * dimension » de BLAS) :
+ *
+ *    stockage par colonnes : (i, j) -> data[i + j * outerStride]
+ *    stockage par lignes   : (i, j) -> data[i * outerStride + j]
+ *
+ * Un bloc d'un bloc, une colonne, une ligne ou la transposée d'une vue sont
+ * encore des vues, obtenues sans copie. Les noyaux gemm(), gemv() et add()
+ * de Operators.h travaillent directement sur des vues : les algorithmes par
+ * blocs (LU, SVD, produit tuilé) opèrent sur les sous-blocs en place.
+ *
+ * Une vue ne possède pas ses données. Une vue sur des données constantes a
+ * le type MatrixView<const _Scalar, ...> ; une vue modifiable se convertit
+ * implicitement en vue constante. Comme pour Map, l'affectation à une vue
+ * copie les valeurs dans le bloc (les dimensions doivent correspondre), alors
+ * que la construction par copie désigne le même bloc.
+ *
+ */
+
+#include "Types.h"
+
+#include <cassert>
+#include <type_traits>
+
+namespace gti320
+{
+    // Déclaration avancée
+    template <typename _Scalar, int _RowsAtCompile, int _ColsAtCompile, int _StorageType> class Matrix;
+    template <typename _Derived> class MatrixExpression;
+
+    template<typename _Scalar, int _StorageType = ColumnStorage>
+    class MatrixView
+    {
+    public:
+
+        typedef typename std::remove_const<_Scalar>::type Scalar;
+
+        /**
+         * Vue vide
+         */
+        MatrixView() : m_data(nullptr), m_rows(0), m_cols(0), m_outerStride(0) { }
+
+        /**
+         * Vue d'un bloc (rows, cols) dont les colonnes (ou les lignes, selon
+         * le stockage) sont espacées de `outerStride` éléments.
+         */
+        MatrixView(_Scalar* data, Index rows, Index cols, Index outerStride) :
+            m_data(data), m_rows(rows), m_cols(cols), m_outerStride(outerStride)
+        {
+            assert(rows >= 0 && cols >= 0);
+            assert(outerStride >= (_StorageType == ColumnStorage ? rows : cols));
+        }
+
+        /**
+         * Vue d'un tampon contigu (rows, cols).
+         */
+        MatrixView(_Scalar* data, Index rows, Index cols) :
+            m_data(data), m_rows(rows), m_cols(cols), m_outerStride(_StorageType == ColumnStorage ? rows : cols)
+        {
+        }
+
+        /**
+         * Conversion d'une vue modifiable en vue constante.
+         */
+        template<typename _OtherScalar>
+        MatrixView(const MatrixView<_OtherScalar, _StorageType>& other) :
+            m_data(other.data()), m_rows(other.rows()), m_cols(other.cols()), m_outerStride(other.outerStride())
+        {
+        }
+
+        MatrixView(const MatrixView& other) :
+            m_data(other.m_data), m_rows(other.m_rows), m_cols(other.m_cols), m_outerStride(other.m_outerStride)
+        {
+        }
+
+        /**
+         * Copie les entrées de `other` dans le bloc.
+         */
+        const MatrixView& operator=(const MatrixView& other) const
+        {
+            return assign(other);
+        }
+
+        /**
+         * Copie les entrées d'une autre vue (tout ordre de stockage) dans le bloc.
+         */
+        template<typename _OtherScalar, int _OtherStorage>
+        const MatrixView& operator=(const MatrixView<_OtherScalar, _OtherStorage>& other) const
+        {
+            return assign(other);
+        }
+
+        /**
+         * Copie les entrées d'une matrice dans le bloc.
+         */
+        template<typename _OtherScalar, int _OtherRows, int _OtherCols, int _OtherStorage>
+        const MatrixView& operator=(const Matrix<_OtherScalar, _OtherRows, _OtherCols, _OtherStorage>& other) const
+        {
+            return assign(other);
+        }
+
+        /**
+         * Évalue une expression élément par élément (voir Expression.h) dans
+         * le bloc.
+         */
+        template<typename _Derived>
+        const MatrixView& operator=(const MatrixExpression<_Derived>& expr) const
+        {
+            evaluate(*this, expr);
+            return *this;
+        }
+
+        inline Index rows() const { return m_rows; }
+        inline Index cols() const { return m_cols; }
+        inline Index size() const { return m_rows * m_cols; }
+
+        /**
+         * Distance (en éléments) entre deux colonnes consécutives (stockage
+         * par colonnes) ou deux lignes consécutives (stockage par lignes).
+         */
+        inline Index outerStride() const { return m_outerStride; }
+
+        /**
+         * Distance entre deux entrées consécutives d'une vue à une seule
+         * ligne ou une seule colonne (voir gemv()).
+         */
+        inline Index increment() const
+        {
+            assert(m_rows == 1 || m_cols == 1);
+            if (_StorageType == ColumnStorage)
+                return m_cols == 1 ? 1 : m_outerStride;
+            return m_rows == 1 ? 1 : m_outerStride;
+        }
+
+        /**
+         * Vrai si les entrées du bloc sont contiguës en mémoire.
+         */
+        inline bool isContiguous() const
+        {
+            return m_outerStride == (_StorageType == ColumnStorage ? m_rows : m_cols)
+                || (_StorageType == ColumnStorage ? m_cols : m_rows) <= 1;
+        }
+
+        inline _Scalar* data() const { return m_data; }
+
+        /**
+         * Accesseur à une entrée du bloc.
+         */
+        inline _Scalar& operator()(Index i, Index j) const
+        {
+            assert(0 <= i && i < m_rows && 0 <= j && j < m_cols);
+            return _StorageType == ColumnStorage ? m_data[i + j * m_outerStride] : m_data[i * m_outerStride + j];
+        }
+
+        /**
+         * Sous-bloc (rows, cols) commençant à l'entrée (i, j).
+         */
+        MatrixView block(Index i, Index j, Index rows, Index cols) const
+        {
+            assert(0 <= i && 0 <= j && rows >= 0 && cols >= 0 && i + rows <= m_rows && j + cols <= m_cols);
+            _Scalar* p = m_data + (_StorageType == ColumnStorage ? i + j * m_outerStride : i * m_outerStride + j);
+            return MatrixView(p, rows, cols, m_outerStride);
+        }
+
+        MatrixView col(Index j) const { return block(0, j, m_rows, 1); }
+        MatrixView row(Index i) const { return block(i, 0, 1, m_cols); }
+
+        /**
+         * Transposée, sans copie : le même tampon lu dans l'autre ordre de
+         * stockage.
+         */
+        MatrixView<_Scalar, 1 - _StorageType> transpose() const
+        {
+            return MatrixView<_Scalar, 1 - _StorageType>(m_data, m_cols, m_rows, m_outerStride);
+        }
+
+        /**
+         * Met toutes les entrées du bloc à zéro.
+         */
+        void setZero() const
+        {
+            const Index outer = _StorageType == ColumnStorage ? m_cols : m_rows;
+            const Index inner = _StorageType == ColumnStorage ? m_rows : m_cols;
+            for (Index k = 0; k < outer; ++k) {
+                _Scalar* p = m_data + k * m_outerStride;
+                for (Index l = 0; l < inner; ++l) {
+                    p[l] = Scalar(0);
+                }
+            }
+        }
+
+    private:
+
+        template<typename _Other>
+        const MatrixView& assign(const _Other& other) const
+        {
+            assert(other.rows() == m_rows && other.cols() == m_cols);
+            if (_StorageType == ColumnStorage) {
+                for (Index j = 0; j < m_cols; ++j)
+                    for (Index i = 0; i < m_rows; ++i)
+                        (*this)(i, j) = other(i, j);
+            }
+            else {
+                for (Index i = 0; i < m_rows; ++i)
+                    for (Index j = 0; j < m_cols; ++j)
+                        (*this)(i, j) = other(i, j);
+            }
+            return *this;
+        }
+
+        _Scalar* m_data;
+        Index m_rows;
+        Index m_cols;
+        Index m_outerStride;
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file Memory.h
+ *
+ * @brief Primitives d'allocation alignée pour les tampons de données.
+ *
+ * L'alignement par défaut des tampons est donné par GTI320_ALIGNMENT (en
+ * octets). La valeur 64 convient aux chargements alignés AVX2 (32 octets) et
+ * AVX-512 (64 octets) et correspond à la taille d'une ligne de cache.
+ *
+ */
+
+#include "Types.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#ifndef GTI320_ALIGNMENT
+#define GTI320_ALIGNMENT 64
+#endif
+
+namespace gti320
+{
+    enum AlignmentType
+    {
+        NoAlignment = 0,
+        Aligned16 = 16,
+        Aligned32 = 32,
+        Aligned64 = 64,
+        DefaultAlignment = GTI320_ALIGNMENT
+    };
+
+    /**
+     * Retourne vrai si `ptr` est aligné sur `alignment` octets.
+     *
+     * Les noyaux de calcul s'en servent pour choisir un chemin utilisant des
+     * chargements alignés.
+     */
+    inline bool isAligned(const void* ptr, size_t alignment)
+    {
+        return alignment == 0 || (reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) == 0;
+    }
+
+    /**
+     * Nombre de scalaires contenus dans un registre vectoriel de `_Align` octets.
+     */
+    template<typename _Scalar, int _Align>
+    struct VectorWidth
+    {
+        static const int value = (_Align > (int)sizeof(_Scalar)) ? _Align / (int)sizeof(_Scalar) : 1;
+    };
+
+    /**
+     * Arrondit `n` au multiple supérieur de la largeur vectorielle.
+     *
+     * Un tampon de cette taille permet de traiter le dernier paquet incomplet
+     * avec un chargement vectoriel complet, sans sortir de la mémoire allouée.
+     */
+    template<typename _Scalar, int _Align>
+    inline Index paddedSize(Index n)
+    {
+        const Index w = VectorWidth<_Scalar, _Align>::value;
+        return ((n + w - 1) / w) * w;
+    }
+
+    /**
+     * Alignement effectif d'un tampon fixe de `_Size` scalaires.
+     *
+     * Les petits tampons (plus petits qu'un registre vectoriel) conservent
+     * l'alignement naturel du scalaire afin de ne pas gonfler les petits
+     * objets comme Vector3f.
+     */
+    template<typename _Scalar, int _Size, int _Align>
+    struct FixedAlignment
+    {
+        static const int value = (_Align > (int)alignof(_Scalar) && (int)sizeof(_Scalar) * _Size >= _Align) ? _Align : (int)alignof(_Scalar);
+    };
+
+    /**
+     * Alloue `bytes` octets alignés sur `alignment` octets.
+     *
+     * Le pointeur retourné par operator new[] est conservé juste avant le bloc
+     * aligné pour être libéré par alignedFree(). Lance std::bad_alloc en cas
+     * d'échec, comme new[].
+     */
+    inline void* alignedMalloc(size_t bytes, size_t alignment)
+    {
+        assert((alignment & (alignment - 1)) == 0);
+        if (alignment < 2 * sizeof(void*))
+            alignment = 2 * sizeof(void*);
+
+        void* raw = ::operator new[](bytes + alignment);
+        const uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + alignment) & ~(uintptr_t)(alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    /**
+     * Libère un bloc obtenu avec alignedMalloc().
+     */
+    inline void alignedFree(void* ptr)
+    {
+        if (ptr != nullptr)
+        {
+            ::operator delete[](reinterpret_cast<void**>(ptr)[-1]);
+        }
+    }
+}
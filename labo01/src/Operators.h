@@ -14,7 +14,15 @@
 #include "Matrix.h"
 #include "Vector.h"
 #include "SparseMatrix.h"
+#include "SellMatrix.h"
+#include "BlockSparseMatrix.h"
+#include "Gemm.h"
+#include "Simd.h"
+#include "Parallel.h"
+#include "FixedSize.h"
 #include <algorithm>
+#include <cstdint>
+#include <utility>
 
  /**
   * Implémentation de divers opérateurs arithmétiques pour les matrices et les vecteurs.
@@ -22,233 +30,694 @@
 namespace gti320 {
 
     /**
-     * Multiplication : Matrice * Matrice (générique) - testé
+     * Noyaux sur des vues à pas (voir MatrixView.h).
+     *
+     * Les opérateurs des matrices dynamiques s'y ramènent ; ils acceptent aussi
+     * directement des blocs de matrices, sans copie. La sortie ne doit pas
+     * chevaucher les opérandes.
      */
-    template <typename _Scalar, int RowsA, int ColsA, int StorageA, int RowsB, int ColsB, int StorageB>
-    Matrix<_Scalar, RowsA, ColsB> operator*(const Matrix<_Scalar, RowsA, ColsA, StorageA>& A, const Matrix<_Scalar, RowsB, ColsB, StorageB>& B)
+
+    namespace internal
     {
-        // TODO implémenter
+        /**
+         * C = beta * C ; si beta est nul, C n'est pas lu.
+         */
+        template<typename _Scalar, int _Storage>
+        void scaleBlock(typename MatrixView<_Scalar, _Storage>::Scalar beta, const MatrixView<_Scalar, _Storage>& C)
+        {
+            typedef typename MatrixView<_Scalar, _Storage>::Scalar Scalar;
 
-        int rowsA = A.rows();
-        int colsA = A.cols();
+            if (beta == Scalar(0)) {
+                C.setZero();
+            }
+            else if (beta != Scalar(1)) {
+                const Index outer = _Storage == ColumnStorage ? C.cols() : C.rows();
+                const Index inner = _Storage == ColumnStorage ? C.rows() : C.cols();
+                for (Index k = 0; k < outer; ++k) {
+                    Scalar* c = C.data() + k * C.outerStride();
+                    scale(inner, beta, c, c);
+                }
+            }
+        }
 
-        int rowsB = B.rows();
-        int colsB = B.cols();
+        /**
+         * Entrées [begin, begin + size) d'une vue à une seule ligne ou une
+         * seule colonne.
+         */
+        template<typename _Scalar, int _Storage>
+        MatrixView<_Scalar, _Storage> segment(const MatrixView<_Scalar, _Storage>& v, Index begin, Index size)
+        {
+            return v.rows() == 1 ? v.block(0, begin, 1, size) : v.block(begin, 0, size, 1);
+        }
 
-        assert(colsA == rowsB);
+        /**
+         * Produit sans blocage : C = alpha * A * B + beta * C
+         *
+         * La boucle la plus interne parcourt la dimension contiguë de C
+         * lorsque c'est possible. Utilisé pour les petits produits, où le
+         * compactage de gemmBlocked() ne serait pas amorti.
+         */
+        template<typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB, typename _ScalarC, int _StorageC>
+        void gemmUnblocked(typename MatrixView<_ScalarC, _StorageC>::Scalar alpha, const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B,
+                           typename MatrixView<_ScalarC, _StorageC>::Scalar beta, const MatrixView<_ScalarC, _StorageC>& C)
+        {
+            typedef typename MatrixView<_ScalarC, _StorageC>::Scalar Scalar;
 
-        Matrix<_Scalar, RowsA, ColsB> result(rowsA, colsB);
+            const Index m = C.rows();
+            const Index n = C.cols();
+            const Index p = A.cols();
 
-        for (int i = 0; i < rowsA; ++i) {
-            for (int j = 0; j < colsB; ++j) {
-                _Scalar sum = _Scalar(0);
-                for (int k = 0; k < colsA; ++k) {
-                    sum += A(i, k) * B(k, j);
+            if (_StorageC == ColumnStorage && _StorageA == ColumnStorage) {
+                // C(:,j) = beta * C(:,j) + sum_k A(:,k) * (alpha * B(k,j))
+                for (Index j = 0; j < n; ++j) {
+                    Scalar* c = C.data() + j * C.outerStride();
+                    Index k = 0;
+                    if (beta == Scalar(0)) {
+                        // Le premier terme initialise la colonne : aucune passe de mise à zéro.
+                        const Scalar b = alpha * B(0, j);
+                        const _ScalarA* a = A.data();
+                        for (Index i = 0; i < m; ++i) {
+                            c[i] = a[i] * b;
+                        }
+                        k = 1;
+                    }
+                    else if (beta != Scalar(1)) {
+                        for (Index i = 0; i < m; ++i) {
+                            c[i] *= beta;
+                        }
+                    }
+                    for (; k < p; ++k) {
+                        const Scalar b = alpha * B(k, j);
+                        const _ScalarA* a = A.data() + k * A.outerStride();
+                        for (Index i = 0; i < m; ++i) {
+                            c[i] += a[i] * b;
+                        }
+                    }
+                }
+            }
+            else if (_StorageC == RowStorage && _StorageB == RowStorage) {
+                // C(i,:) = beta * C(i,:) + sum_k (alpha * A(i,k)) * B(k,:)
+                for (Index i = 0; i < m; ++i) {
+                    Scalar* c = C.data() + i * C.outerStride();
+                    Index k = 0;
+                    if (beta == Scalar(0)) {
+                        const Scalar a = alpha * A(i, 0);
+                        const _ScalarB* b = B.data();
+                        for (Index j = 0; j < n; ++j) {
+                            c[j] = a * b[j];
+                        }
+                        k = 1;
+                    }
+                    else if (beta != Scalar(1)) {
+                        for (Index j = 0; j < n; ++j) {
+                            c[j] *= beta;
+                        }
+                    }
+                    for (; k < p; ++k) {
+                        const Scalar a = alpha * A(i, k);
+                        const _ScalarB* b = B.data() + k * B.outerStride();
+                        for (Index j = 0; j < n; ++j) {
+                            c[j] += a * b[j];
+                        }
+                    }
+                }
+            }
+            else {
+                // Produits scalaires d'une ligne de A et d'une colonne de B.
+                for (Index i = 0; i < m; ++i) {
+                    for (Index j = 0; j < n; ++j) {
+                        Scalar sum = Scalar(0);
+                        for (Index k = 0; k < p; ++k) {
+                            sum += A(i, k) * B(k, j);
+                        }
+                        C(i, j) = (beta == Scalar(0)) ? alpha * sum : alpha * sum + beta * C(i, j);
+                    }
                 }
-                result(i, j) = sum;
             }
         }
-        return result;
     }
 
     /**
-     * Multiplication : Matrice (colonne) * Matrice (ligne)
+     * Produit général : C = alpha * A * B + beta * C
      *
-     * Spécialisation de l'opérateur de multiplication pour le cas où les matrices
-     * ont un stockage à taille dynamique et où la matrice de gauche utilise un
-     * stockage par colonnes et celle de droite un stockage par lignes.
+     * Si beta est nul, C n'est pas lu (il peut être non initialisé). Au-delà
+     * de GTI320_GEMM_THRESHOLD multiplications, le produit est calculé par
+     * blocs sur des panneaux compactés (voir Gemm.h), quel que soit l'ordre de
+     * stockage des opérandes ; en deçà, par internal::gemmUnblocked(). Le
+     * calcul par blocs est réparti entre les fils (voir Parallel.h) par
+     * tranches de colonnes de C, ou de lignes si C est plus haute que large.
      */
-    template <typename _Scalar>
-    Matrix<_Scalar, Dynamic, Dynamic> operator*(const Matrix<_Scalar, Dynamic, Dynamic, ColumnStorage>& A, const Matrix<_Scalar, Dynamic, Dynamic, RowStorage>& B)
+    template<typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB, typename _ScalarC, int _StorageC>
+    void gemm(typename MatrixView<_ScalarC, _StorageC>::Scalar alpha, const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B,
+              typename MatrixView<_ScalarC, _StorageC>::Scalar beta, const MatrixView<_ScalarC, _StorageC>& C)
     {
-        // TODO : implémenter
-        const int rowsA = A.rows();
-        const int colsA = A.cols();
-        const int rowsB = B.rows();
-        const int colsB = B.cols();
+        typedef typename MatrixView<_ScalarC, _StorageC>::Scalar Scalar;
 
-        assert(colsA == rowsB);
+        const Index m = C.rows();
+        const Index n = C.cols();
+        const Index p = A.cols();
+        assert(A.rows() == m && B.rows() == p && B.cols() == n);
+
+        if (p == 0 || alpha == Scalar(0)) {
+            internal::scaleBlock(beta, C);
+            return;
+        }
 
-        Matrix<_Scalar, Dynamic, Dynamic> C(rowsA, colsB);
-        C.setZero();
+        if ((double)m * (double)n * (double)p >= GTI320_GEMM_THRESHOLD) {
+            const Index rsa = _StorageA == ColumnStorage ? 1 : A.outerStride();
+            const Index csa = _StorageA == ColumnStorage ? A.outerStride() : 1;
+            const Index rsb = _StorageB == ColumnStorage ? 1 : B.outerStride();
+            const Index csb = _StorageB == ColumnStorage ? B.outerStride() : 1;
+            const Index rsc = _StorageC == ColumnStorage ? 1 : C.outerStride();
+            const Index csc = _StorageC == ColumnStorage ? C.outerStride() : 1;
 
-        for (int i = 0; i < rowsA; ++i) {
-            for (int k = 0; k < colsA; ++k) {
-                const _Scalar a = A(i, k);
-                for (int j = 0; j < colsB; ++j) {
-                    C(i, j) += a * B(k, j);
+            // Chaque fil traite une tranche de la plus grande dimension de C :
+            // C(:, J) = beta * C(:, J) + alpha * A * B(:, J), ou de même pour
+            // une tranche de lignes I. Les tranches sont indépendantes.
+            const bool byColumns = n >= m;
+            parallel_for(byColumns ? n : m, [&](Index begin, Index end) {
+                if (byColumns) {
+                    internal::scaleBlock(beta, C.block(0, begin, m, end - begin));
+                    internal::gemmBlocked(m, end - begin, p, alpha, A.data(), rsa, csa,
+                                          B.data() + begin * csb, rsb, csb, C.data() + begin * csc, rsc, csc);
                 }
-            }
+                else {
+                    internal::scaleBlock(beta, C.block(begin, 0, end - begin, n));
+                    internal::gemmBlocked(end - begin, n, p, alpha, A.data() + begin * rsa, rsa, csa,
+                                          B.data(), rsb, csb, C.data() + begin * rsc, rsc, csc);
+                }
+            }, parallelGrain((double)(byColumns ? m : n) * (double)p));
+            return;
         }
 
-        return C;
+        internal::gemmUnblocked(alpha, A, B, beta, C);
+    }
+
+    namespace internal
+    {
+        /**
+         * gemv() sur le fil appelant.
+         */
+        template<typename _ScalarA, int _StorageA, typename _ScalarX, int _StorageX, typename _ScalarY, int _StorageY>
+        void gemvSerial(typename MatrixView<_ScalarY, _StorageY>::Scalar alpha, const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarX, _StorageX>& x,
+                        typename MatrixView<_ScalarY, _StorageY>::Scalar beta, const MatrixView<_ScalarY, _StorageY>& y)
+        {
+            typedef typename MatrixView<_ScalarY, _StorageY>::Scalar Scalar;
+
+            const Index m = A.rows();
+            const Index n = A.cols();
+            assert(x.size() == n && y.size() == m);
+            if (m == 0)
+                return;
+
+            const _ScalarX* px = x.data();
+            const Index incx = n > 0 ? x.increment() : 1;
+            Scalar* py = y.data();
+            const Index incy = y.increment();
+
+            if (_StorageA == ColumnStorage) {
+                // y = beta * y + sum_j A(:,j) * (alpha * x(j))
+                Index j = 0;
+                if (beta == Scalar(0)) {
+                    if (n == 0) {
+                        for (Index i = 0; i < m; ++i) {
+                            py[i * incy] = Scalar(0);
+                        }
+                        return;
+                    }
+                    // La première colonne initialise le résultat : aucune passe de mise à zéro.
+                    const Scalar x0 = alpha * px[0];
+                    const _ScalarA* a = A.data();
+                    if (incy == 1) {
+                        internal::scale(m, x0, a, py);
+                    }
+                    else {
+                        for (Index i = 0; i < m; ++i) {
+                            py[i * incy] = a[i] * x0;
+                        }
+                    }
+                    j = 1;
+                }
+                else if (beta != Scalar(1)) {
+                    if (incy == 1) {
+                        internal::scale(m, beta, py, py);
+                    }
+                    else {
+                        for (Index i = 0; i < m; ++i) {
+                            py[i * incy] *= beta;
+                        }
+                    }
+                }
+                for (; j < n; ++j) {
+                    const Scalar xj = alpha * px[j * incx];
+                    const _ScalarA* a = A.data() + j * A.outerStride();
+                    if (incy == 1) {
+                        internal::axpy(m, xj, a, py);
+                    }
+                    else {
+                        for (Index i = 0; i < m; ++i) {
+                            py[i * incy] += a[i] * xj;
+                        }
+                    }
+                }
+            }
+            else {
+                // Produit scalaire de chaque ligne de A avec x.
+                for (Index i = 0; i < m; ++i) {
+                    const _ScalarA* a = A.data() + i * A.outerStride();
+                    Scalar sum = Scalar(0);
+                    if (incx == 1) {
+                        sum = internal::dot<Scalar>(n, a, px);
+                    }
+                    else {
+                        for (Index j = 0; j < n; ++j) {
+                            sum += a[j] * px[j * incx];
+                        }
+                    }
+                    py[i * incy] = (beta == Scalar(0)) ? alpha * sum : alpha * sum + beta * py[i * incy];
+                }
+            }
+        }
     }
 
     /**
-     * Multiplication : Matrice (ligne) * Matrice (colonne)
+     * Produit matrice * vecteur : y = alpha * A * x + beta * y
      *
-     * Spécialisation de l'opérateur de multiplication pour le cas où les matrices
-     * ont un stockage à taille dynamique et où la matrice de gauche utilise un
-     * stockage par lignes et celle de droite un stockage par colonnes.
+     * `x` et `y` sont des vues à une seule ligne ou une seule colonne (un
+     * segment de vecteur, une ligne ou une colonne de matrice). Si beta est
+     * nul, y n'est pas lu. Les colonnes (stockage par colonnes) ou les lignes
+     * (stockage par lignes) de A sont traitées par les noyaux vectoriels de
+     * Simd.h lorsque y, respectivement x, est contigu.
+     *
+     * Au-delà de 2 * GTI320_PARALLEL_MIN_WORK entrées, le produit est réparti
+     * entre les fils (voir Parallel.h) :
+     *
+     *    stockage par lignes     chaque fil calcule une tranche de y ;
+     *    stockage par colonnes   chaque fil calcule le produit d'une tranche
+     *                            de colonnes de A dans un tampon partiel, puis
+     *                            les tampons sont additionnés (réduction) par
+     *                            tranches de y.
+     *
+     * Les tranches sont placées avec parallel_for_static() : la tranche k de
+     * A est toujours lue par le même fil, celui qui a mis à zéro les mêmes
+     * pages à l'allocation de A (premier contact, voir DenseStorage).
      */
-    template <typename _Scalar>
-    Matrix<_Scalar, Dynamic, Dynamic> operator*(const Matrix<_Scalar, Dynamic, Dynamic, RowStorage>& A, const Matrix<_Scalar, Dynamic, Dynamic, ColumnStorage>& B)
+    template<typename _ScalarA, int _StorageA, typename _ScalarX, int _StorageX, typename _ScalarY, int _StorageY>
+    void gemv(typename MatrixView<_ScalarY, _StorageY>::Scalar alpha, const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarX, _StorageX>& x,
+              typename MatrixView<_ScalarY, _StorageY>::Scalar beta, const MatrixView<_ScalarY, _StorageY>& y)
     {
-        // TODO : implémenter
-        const int rowsA = A.rows();
-        const int colsA = A.cols();
-        const int rowsB = B.rows();
-        const int colsB = B.cols();
+        typedef typename MatrixView<_ScalarY, _StorageY>::Scalar Scalar;
 
-        assert (colsA == rowsB);
+        const Index m = A.rows();
+        const Index n = A.cols();
+        assert(x.size() == n && y.size() == m);
 
-        Matrix<_Scalar, Dynamic, Dynamic> C(rowsA, colsB);
-        C.setZero();
+        const int threads = parallelThreads();
+        if (threads <= 1 || (double)m * (double)n < 2.0 * GTI320_PARALLEL_MIN_WORK) {
+            internal::gemvSerial(alpha, A, x, beta, y);
+            return;
+        }
 
-        for (int i = 0; i < rowsA; ++i) {
-            for (int j = 0; j < colsB; ++j) {
-                _Scalar sum = _Scalar(0);
-                for (int k = 0; k < colsA; ++k) {
-                    sum += A(i, k) * B(k, j);
+        if (_StorageA == RowStorage) {
+            parallel_for_static(m, [&](Index begin, Index end) {
+                internal::gemvSerial(alpha, A.block(begin, 0, end - begin, n), x, beta, internal::segment(y, begin, end - begin));
+            }, parallelGrain((double)n));
+            return;
+        }
+
+        const Index grain = parallelGrain((double)m);
+        const int parts = n / grain < threads ? (int)(n / grain) : threads;
+        if (parts <= 1) {
+            internal::gemvSerial(alpha, A, x, beta, y);
+            return;
+        }
+
+        // Tampons partiels : parts colonnes de m entrées, empruntés à
+        // l'espace de travail du fil appelant pour la durée de l'appel.
+        const typename internal::GemmWorkspace<Scalar>::Partial buffer((size_t)parts * (size_t)m);
+        Scalar* partial = buffer.data();
+        parallel_for_static(parts, [&](Index kbegin, Index kend) {
+            for (Index k = kbegin; k < kend; ++k) {
+                Index begin, end;
+                partition(n, parts, (int)k, begin, end);
+                internal::gemvSerial(alpha, A.block(0, begin, m, end - begin), internal::segment(x, begin, end - begin),
+                                     Scalar(0), MatrixView<Scalar>(partial + k * m, m, 1));
+            }
+        });
+
+        Scalar* py = y.data();
+        const Index incy = y.increment();
+        parallel_for_static(m, [&](Index begin, Index end) {
+            Scalar* sum = partial + begin;
+            for (int k = 1; k < parts; ++k) {
+                internal::add(end - begin, sum, partial + k * m + begin, sum);
+            }
+            for (Index i = begin; i < end; ++i) {
+                py[i * incy] = (beta == Scalar(0)) ? sum[i - begin] : sum[i - begin] + beta * py[i * incy];
+            }
+        }, parallelGrain((double)parts));
+    }
+
+    /**
+     * Addition : C = A + B
+     *
+     * Lorsque les trois blocs sont contigus et de même ordre de stockage,
+     * l'addition est faite sur un seul tampon linéaire (voir Simd.h).
+     */
+    template<typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB, typename _ScalarC, int _StorageC>
+    void add(const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B, const MatrixView<_ScalarC, _StorageC>& C)
+    {
+        const Index rows = C.rows();
+        const Index cols = C.cols();
+        assert(A.rows() == rows && A.cols() == cols);
+        assert(B.rows() == rows && B.cols() == cols);
+
+        if (_StorageA == _StorageC && _StorageB == _StorageC && A.isContiguous() && B.isContiguous() && C.isContiguous()) {
+            const _ScalarA* a = A.data();
+            const _ScalarB* b = B.data();
+            _ScalarC* c = C.data();
+            internal::add(rows * cols, a, b, c);
+        }
+        else if (_StorageC == ColumnStorage) {
+            for (Index j = 0; j < cols; ++j) {
+                for (Index i = 0; i < rows; ++i) {
+                    C(i, j) = A(i, j) + B(i, j);
+                }
+            }
+        }
+        else {
+            for (Index i = 0; i < rows; ++i) {
+                for (Index j = 0; j < cols; ++j) {
+                    C(i, j) = A(i, j) + B(i, j);
                 }
-                C(i, j) = sum;
             }
         }
+    }
 
-        return C;
+    /**
+     * Mise à jour : Y = alpha * X + Y
+     *
+     * Lorsque X et Y ont le même ordre de stockage, chaque tranche contiguë
+     * (ou le bloc entier, si les deux sont contigus) passe par le noyau axpy
+     * de Simd.h.
+     */
+    template<typename _ScalarX, int _StorageX, typename _ScalarY, int _StorageY>
+    void axpy(typename MatrixView<_ScalarY, _StorageY>::Scalar alpha, const MatrixView<_ScalarX, _StorageX>& X, const MatrixView<_ScalarY, _StorageY>& Y)
+    {
+        const Index rows = Y.rows();
+        const Index cols = Y.cols();
+        assert(X.rows() == rows && X.cols() == cols);
+
+        if (_StorageX == _StorageY) {
+            if (X.isContiguous() && Y.isContiguous()) {
+                internal::axpy(rows * cols, alpha, X.data(), Y.data());
+                return;
+            }
+            const Index outer = _StorageY == ColumnStorage ? cols : rows;
+            const Index inner = _StorageY == ColumnStorage ? rows : cols;
+            for (Index k = 0; k < outer; ++k) {
+                internal::axpy(inner, alpha, X.data() + k * X.outerStride(), Y.data() + k * Y.outerStride());
+            }
+        }
+        else {
+            for (Index i = 0; i < rows; ++i) {
+                for (Index j = 0; j < cols; ++j) {
+                    Y(i, j) += alpha * X(i, j);
+                }
+            }
+        }
     }
 
+    /**
+     * Combinaison linéaire en place : Y = alpha * X + beta * Y
+     *
+     * Une seule passe sur Y (noyau axpby de Simd.h), comme axpy().
+     */
+    template<typename _ScalarX, int _StorageX, typename _ScalarY, int _StorageY>
+    void axpby(typename MatrixView<_ScalarY, _StorageY>::Scalar alpha, const MatrixView<_ScalarX, _StorageX>& X,
+               typename MatrixView<_ScalarY, _StorageY>::Scalar beta, const MatrixView<_ScalarY, _StorageY>& Y)
+    {
+        const Index rows = Y.rows();
+        const Index cols = Y.cols();
+        assert(X.rows() == rows && X.cols() == cols);
+
+        if (_StorageX == _StorageY) {
+            if (X.isContiguous() && Y.isContiguous()) {
+                internal::axpby(rows * cols, alpha, X.data(), beta, Y.data());
+                return;
+            }
+            const Index outer = _StorageY == ColumnStorage ? cols : rows;
+            const Index inner = _StorageY == ColumnStorage ? rows : cols;
+            for (Index k = 0; k < outer; ++k) {
+                internal::axpby(inner, alpha, X.data() + k * X.outerStride(), beta, Y.data() + k * Y.outerStride());
+            }
+        }
+        else {
+            for (Index i = 0; i < rows; ++i) {
+                for (Index j = 0; j < cols; ++j) {
+                    Y(i, j) = alpha * X(i, j) + beta * Y(i, j);
+                }
+            }
+        }
+    }
 
     /**
-     * Addition : Matrice + Matrice (générique) - teste
+     * axpy() et axpby() sur des vecteurs et des matrices de mêmes dimensions.
      */
-    template <typename _Scalar, int Rows, int Cols, int StorageA, int StorageB>
-    Matrix<_Scalar, Rows, Cols> operator+(const Matrix<_Scalar, Rows, Cols, StorageA>& A, const Matrix<_Scalar, Rows, Cols, StorageB>& B)
+    template<typename _Scalar, int _RowsX, int _RowsY>
+    void axpy(_Scalar alpha, const Vector<_Scalar, _RowsX>& x, Vector<_Scalar, _RowsY>& y)
     {
-        // TODO : implémenter
-        const int rowsA = A.rows();
-        const int colsA = A.cols();
-        const int rowsB = B.rows();
-        const int colsB = B.cols();
+        axpy(alpha, x.view(), y.view());
+    }
 
-        assert (rowsA == rowsB);
-        assert (colsA == colsB);
+    template<typename _Scalar, int _RowsX, int _RowsY>
+    void axpby(_Scalar alpha, const Vector<_Scalar, _RowsX>& x, _Scalar beta, Vector<_Scalar, _RowsY>& y)
+    {
+        axpby(alpha, x.view(), beta, y.view());
+    }
 
-        Matrix <_Scalar, Rows, Cols> C(rowsA, colsA);
+    template<typename _Scalar, int _RowsX, int _ColsX, int _StorageX, int _RowsY, int _ColsY, int _StorageY>
+    void axpy(_Scalar alpha, const Matrix<_Scalar, _RowsX, _ColsX, _StorageX>& X, Matrix<_Scalar, _RowsY, _ColsY, _StorageY>& Y)
+    {
+        axpy(alpha, X.view(), Y.view());
+    }
 
-        for (int i = 0; i < rowsA; ++i) {
-            for (int j = 0; j < colsA; ++j) {
-                C(i,j) = A(i,j) + B(i,j);
-            }
+    template<typename _Scalar, int _RowsX, int _ColsX, int _StorageX, int _RowsY, int _ColsY, int _StorageY>
+    void axpby(_Scalar alpha, const Matrix<_Scalar, _RowsX, _ColsX, _StorageX>& X, _Scalar beta, Matrix<_Scalar, _RowsY, _ColsY, _StorageY>& Y)
+    {
+        axpby(alpha, X.view(), beta, Y.view());
+    }
+
+    namespace internal
+    {
+        /**
+         * Vrai si les tampons [a, a + na) et [b, b + nb) se chevauchent.
+         */
+        template<typename _ScalarA, typename _ScalarB>
+        inline bool overlaps(const _ScalarA* a, Index na, const _ScalarB* b, Index nb)
+        {
+            const std::uintptr_t pa = reinterpret_cast<std::uintptr_t>(a);
+            const std::uintptr_t pb = reinterpret_cast<std::uintptr_t>(b);
+            return na > 0 && nb > 0 && pa < pb + nb * sizeof(_ScalarB) && pb < pa + na * sizeof(_ScalarA);
         }
 
+        template<int _Rows, int _Inner, int _Cols, typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB, typename _ScalarC, int _StorageC>
+        inline void productDispatch(const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B, const MatrixView<_ScalarC, _StorageC>& C, std::true_type)
+        {
+            assert(A.isContiguous() && B.isContiguous() && C.isContiguous());
+            fixedProduct<_Rows, _Inner, _Cols, _StorageA, _StorageB, _StorageC>(A.data(), B.data(), C.data());
+        }
 
-        return C;
+        template<int _Rows, int _Inner, int _Cols, typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB, typename _ScalarC, int _StorageC>
+        inline void productDispatch(const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B, const MatrixView<_ScalarC, _StorageC>& C, std::false_type)
+        {
+            typedef typename MatrixView<_ScalarC, _StorageC>::Scalar Scalar;
+            if (_Cols == 1) {
+                gemv(Scalar(1), A, B, Scalar(0), C);
+            }
+            else {
+                gemm(Scalar(1), A, B, Scalar(0), C);
+            }
+        }
+
+        /**
+         * C = A * B, où A est _Rows x _Inner et B est _Inner x _Cols à la
+         * compilation (Dynamic si inconnu) : noyau déroulé de FixedSize.h
+         * pour les petites tailles fixes, gemm() ou gemv() (_Cols == 1)
+         * sinon. C ne doit pas chevaucher A ni B.
+         */
+        template<int _Rows, int _Inner, int _Cols, typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB, typename _ScalarC, int _StorageC>
+        inline void product(const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B, const MatrixView<_ScalarC, _StorageC>& C)
+        {
+            assert(A.cols() == B.rows() && C.rows() == A.rows() && C.cols() == B.cols());
+            productDispatch<_Rows, _Inner, _Cols>(A, B, C, std::integral_constant<bool, UnrollProduct<_Rows, _Inner, _Cols>::value>());
+        }
     }
 
     /**
-     * Addition : Matrice (colonne) + Matrice (colonne)
+     * Produits dans une destination existante : C = A * B, y = A * x
      *
-     * Spécialisation de l'opérateur d'addition pour le cas où les deux matrices
-     * sont stockées par colonnes.
+     * La destination est redimensionnée au besoin ; son tampon est réutilisé
+     * si sa capacité suffit, de sorte qu'un produit répété dans une boucle
+     * n'alloue rien. Si la destination partage sa mémoire avec une opérande
+     * (par exemple multiply(A, x, x)), le produit est calculé dans un
+     * temporaire puis déplacé dans la destination.
      */
-    template <typename _Scalar>
-    Matrix<_Scalar, Dynamic, Dynamic> operator+(const Matrix<_Scalar, Dynamic, Dynamic, ColumnStorage>& A, const Matrix<_Scalar, Dynamic, Dynamic, ColumnStorage>& B)
+    template<typename _Scalar, int _RowsA, int _ColsA, int _StorageA, int _RowsB, int _ColsB, int _StorageB, int _RowsC, int _ColsC, int _StorageC>
+    void multiply(const Matrix<_Scalar, _RowsA, _ColsA, _StorageA>& A, const Matrix<_Scalar, _RowsB, _ColsB, _StorageB>& B, Matrix<_Scalar, _RowsC, _ColsC, _StorageC>& C)
     {
-        // TODO : implémenter
-        const int rowsA = A.rows();
-        const int colsA = A.cols();
-        const int rowsB = B.rows();
-        const int colsB = B.cols();
-
-        assert (rowsA == rowsB);
-        assert (colsA == colsB);
+        assert(A.cols() == B.rows());
 
-        Matrix <_Scalar, Dynamic, Dynamic> C(rowsA, colsA);
+        const _Scalar* c = static_cast<const Matrix<_Scalar, _RowsC, _ColsC, _StorageC>&>(C).data();
+        if (internal::overlaps(c, C.size(), A.data(), A.size()) || internal::overlaps(c, C.size(), B.data(), B.size())) {
+            Matrix<_Scalar, _RowsC, _ColsC, _StorageC> result(A.rows(), B.cols(), Uninitialized);
+            internal::product<_RowsA, _ColsA, _ColsB>(A.view(), B.view(), result.view());
+            C = std::move(result);
+            return;
+        }
 
-        const _Scalar*  a = A.data();
-        const _Scalar*  b = B.data();
-        _Scalar* c = C.data();
+        C.resize(A.rows(), B.cols(), Uninitialized);
+        internal::product<_RowsA, _ColsA, _ColsB>(A.view(), B.view(), C.view());
+    }
 
+    template<typename _Scalar, int _Rows, int _Cols, int _Storage, int _RowsX, int _RowsY>
+    void multiply(const Matrix<_Scalar, _Rows, _Cols, _Storage>& A, const Vector<_Scalar, _RowsX>& x, Vector<_Scalar, _RowsY>& y)
+    {
+        assert(A.cols() == x.rows());
 
-        const int n = rowsA * colsA;
-        for (int i = 0; i < n; ++i) {
-            c[i] = a[i] + b[i];
+        const _Scalar* py = static_cast<const Vector<_Scalar, _RowsY>&>(y).data();
+        if (internal::overlaps(py, y.size(), x.data(), x.size()) || internal::overlaps(py, y.size(), A.data(), A.size())) {
+            Vector<_Scalar, _RowsY> result(A.rows(), Uninitialized);
+            internal::product<_Rows, _Cols, 1>(A.view(), x.view(), result.view());
+            y = std::move(result);
+            return;
         }
-        return C;
+
+        y.resize(A.rows(), Uninitialized);
+        internal::product<_Rows, _Cols, 1>(A.view(), x.view(), y.view());
     }
 
+    /**
+     * Multiplication : Matrice * Matrice (générique) - testé
+     *
+     * Toutes les combinaisons d'ordres de stockage passent par gemm(), sauf
+     * les petites matrices de taille fixe (noyau déroulé, voir FixedSize.h).
+     */
+    template <typename _Scalar, int RowsA, int ColsA, int StorageA, int RowsB, int ColsB, int StorageB>
+    Matrix<_Scalar, RowsA, ColsB> operator*(const Matrix<_Scalar, RowsA, ColsA, StorageA>& A, const Matrix<_Scalar, RowsB, ColsB, StorageB>& B)
+    {
+        assert(A.cols() == B.rows());
 
+        Matrix<_Scalar, RowsA, ColsB> result(A.rows(), B.cols(), Uninitialized);
+        internal::product<RowsA, ColsA, ColsB>(A.view(), B.view(), result.view());
+        return result;
+    }
 
+    /**
+     * Multiplication : Matrice (colonne) * Matrice (ligne)
+     *
+     * Spécialisation de l'opérateur de multiplication pour le cas où les matrices
+     * ont un stockage à taille dynamique et où la matrice de gauche utilise un
+     * stockage par colonnes et celle de droite un stockage par lignes.
+     */
+    template <typename _Scalar>
+    Matrix<_Scalar, Dynamic, Dynamic> operator*(const Matrix<_Scalar, Dynamic, Dynamic, ColumnStorage>& A, const Matrix<_Scalar, Dynamic, Dynamic, RowStorage>& B)
+    {
+        // TODO : implémenter
+        assert(A.cols() == B.rows());
+
+        Matrix<_Scalar, Dynamic, Dynamic> C(A.rows(), B.cols(), Uninitialized);
+        gemm(_Scalar(1), A.view(), B.view(), _Scalar(0), C.view());
+        return C;
+    }
 
     /**
-     * Addition : Matrice (ligne) + Matrice (ligne)
+     * Multiplication : Matrice (ligne) * Matrice (colonne)
      *
-     * Spécialisation de l'opérateur d'addition pour le cas où les deux matrices
-     * sont stockées par lignes.
+     * Spécialisation de l'opérateur de multiplication pour le cas où les matrices
+     * ont un stockage à taille dynamique et où la matrice de gauche utilise un
+     * stockage par lignes et celle de droite un stockage par colonnes.
      */
     template <typename _Scalar>
-    Matrix<_Scalar, Dynamic, Dynamic, RowStorage> operator+(const Matrix<_Scalar, Dynamic, Dynamic, RowStorage>& A, const Matrix<_Scalar, Dynamic, Dynamic, RowStorage>& B)
+    Matrix<_Scalar, Dynamic, Dynamic> operator*(const Matrix<_Scalar, Dynamic, Dynamic, RowStorage>& A, const Matrix<_Scalar, Dynamic, Dynamic, ColumnStorage>& B)
     {
         // TODO : implémenter
+        assert (A.cols() == B.rows());
 
-        int rows = A.rows();
-        int cols = A.cols();
+        Matrix<_Scalar, Dynamic, Dynamic> C(A.rows(), B.cols(), Uninitialized);
+        gemm(_Scalar(1), A.view(), B.view(), _Scalar(0), C.view());
+        return C;
+    }
 
-        assert(rows == B.rows());
-        assert(cols == B.cols());
 
-        Matrix<_Scalar, Dynamic, Dynamic, RowStorage> C(rows,cols);
+    /**
+     * Opérations élément par élément : Matrice + Matrice, Matrice - Matrice,
+     * Scalaire * Matrice (et de même pour les vecteurs).
+     *
+     * Ces opérateurs retournent une expression paresseuse (voir Expression.h),
+     * évaluée en une seule passe lorsqu'elle est affectée à une matrice ou à
+     * un vecteur. Chaque opérande peut être une matrice (dynamique, fixe,
+     * Map), un vecteur ou une autre expression, quel que soit son ordre de
+     * stockage.
+     */
+    namespace internal
+    {
+        template<typename _Scalar, int _Rows, int _Cols, int _Storage>
+        LeafExpression<_Scalar, _Storage> leaf(const Matrix<_Scalar, _Rows, _Cols, _Storage>& A)
+        {
+            return LeafExpression<_Scalar, _Storage>(A.view());
+        }
 
-        for (int i = 0; i < rows; ++i) {
-            for (int j = 0; j < cols; ++j) {
-                C(i,j) = A(i,j) + B(i,j);
-            }
+        template<typename _Scalar, int _Rows>
+        LeafExpression<_Scalar, ColumnStorage> leaf(const Vector<_Scalar, _Rows>& v)
+        {
+            return LeafExpression<_Scalar, ColumnStorage>(v.view());
         }
 
-        return C;
+        template<typename _Derived>
+        const _Derived& leaf(const MatrixExpression<_Derived>& expr)
+        {
+            return expr.derived();
+        }
+
+        /**
+         * Type du nœud qui représente une opérande dans une expression.
+         */
+        template<typename _Operand>
+        struct Leaf
+        {
+            typedef typename std::decay<decltype(leaf(std::declval<const _Operand&>()))>::type type;
+        };
     }
 
     /**
-     * Multiplication  : Scalaire * Matrice (colonne) - testé
-     *
-     * Spécialisation de l'opérateur de multiplication par un scalaire pour le
-     * cas d'une matrice stockée par colonnes.
+     * Addition : A + B
      */
-    template <typename _Scalar, int _Rows, int _Cols>
-    Matrix<_Scalar, _Rows, _Cols, ColumnStorage> operator*(const _Scalar& a, const Matrix<_Scalar, _Rows, _Cols, ColumnStorage>& A)
+    template<typename _Lhs, typename _Rhs>
+    auto operator+(const _Lhs& A, const _Rhs& B)
+        -> BinaryExpression<internal::SumOp, typename std::decay<decltype(internal::leaf(A))>::type, typename std::decay<decltype(internal::leaf(B))>::type>
     {
-        // TODO : implémenter
-        const int rows = A.rows();
-        const int cols = A.cols();
-        Matrix<_Scalar, _Rows, _Cols, ColumnStorage> result(rows, cols);
-        for (int j = 0; j < cols; ++j) {
-            for (int i = 0; i < rows; ++i) {
-                result(i,j) = a * A(i,j);
-            }
-        }
-        return result;
+        return BinaryExpression<internal::SumOp, typename internal::Leaf<_Lhs>::type, typename internal::Leaf<_Rhs>::type>(internal::leaf(A), internal::leaf(B));
     }
 
     /**
-     * Multiplication  : Scalaire * Matrice (ligne)
-     *
-     * Spécialisation de l'opérateur de multiplication par un scalaire pour le
-     * cas d'une matrice stockée par lignes.
+     * Soustraction : A - B
      */
-    template <typename _Scalar, int _Rows, int _Cols>
-    Matrix<_Scalar, _Rows, _Cols, RowStorage> operator*(const _Scalar& a, const Matrix<_Scalar, _Rows, _Cols, RowStorage>& A)
+    template<typename _Lhs, typename _Rhs>
+    auto operator-(const _Lhs& A, const _Rhs& B)
+        -> BinaryExpression<internal::DifferenceOp, typename std::decay<decltype(internal::leaf(A))>::type, typename std::decay<decltype(internal::leaf(B))>::type>
     {
-        // TODO : implémenter
-        const int rows = A.rows();
-        const int cols = A.cols();
-        Matrix<_Scalar, _Rows, _Cols, RowStorage> result(rows, cols);
-        for (int i = 0; i < rows; ++i) {
-            for (int j = 0; j < cols; ++j) {
-                result(i, j) = a * A(i, j);
-            }
-        }
-        return result;
+        return BinaryExpression<internal::DifferenceOp, typename internal::Leaf<_Lhs>::type, typename internal::Leaf<_Rhs>::type>(internal::leaf(A), internal::leaf(B));
+    }
+
+    /**
+     * Multiplication : Scalaire * A
+     */
+    template<typename _Operand>
+    auto operator*(const typename std::decay<decltype(internal::leaf(std::declval<const _Operand&>()))>::type::Scalar& a, const _Operand& A)
+        -> ScaledExpression<typename std::decay<decltype(internal::leaf(A))>::type>
+    {
+        return ScaledExpression<typename internal::Leaf<_Operand>::type>(a, internal::leaf(A));
     }
 
     /**
@@ -261,18 +730,9 @@ namespace gti320 {
     Vector<_Scalar, _Rows> operator*(const Matrix<_Scalar, _Rows, _Cols, RowStorage>& A, const Vector<_Scalar, _Cols>& v)
     {
         // TODO : implémenter
-        const int rows = A.rows();
-        const int cols = A.cols();
-        assert(cols == v.rows());
-        Vector<_Scalar, _Rows> result(rows);
-        result.setZero();
-        for (int i = 0; i < rows; ++i) {
-            _Scalar sum = _Scalar(0);
-            for (int j = 0; j < cols; ++j) {
-                sum += v(j) * A(i,j);
-            }
-            result(i) = sum;
-        }
+        assert(A.cols() == v.rows());
+        Vector<_Scalar, _Rows> result(A.rows(), Uninitialized);
+        internal::product<_Rows, _Cols, 1>(A.view(), v.view(), result.view());
         return result;
     }
 
@@ -286,73 +746,143 @@ namespace gti320 {
     Vector<_Scalar, _Rows> operator*(const Matrix<_Scalar, _Rows, _Cols, ColumnStorage>& A, const Vector<_Scalar, _Cols>& v)
     {
         // TODO : implémenter
-        const int rows = A.rows();
-        const int cols = A.cols();
-        assert(cols == v.rows());
-        Vector<_Scalar, _Rows> result(rows);
-        result.setZero();
-        for (int j = 0; j < cols; ++j) {
-            const _Scalar x = v(j);
-            for (int i = 0; i < rows; ++i) {
-                result(i) += A(i, j) * x;
-            }
-        }
-
+        assert(A.cols() == v.rows());
+        Vector<_Scalar, _Rows> result(A.rows(), Uninitialized);
+        internal::product<_Rows, _Cols, 1>(A.view(), v.view(), result.view());
         return result;
     }
 
     /**
-     * Multiplication : Scalaire * Vecteur
+     * Multiplication : Vue * Vue
+     *
+     * Les blocs sont lus en place ; le résultat est une nouvelle matrice.
      */
-    template <typename _Scalar, int _Rows>
-    Vector<_Scalar, _Rows> operator*(const _Scalar& a, const Vector<_Scalar, _Rows>& v)
+    template<typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB>
+    Matrix<typename MatrixView<_ScalarA, _StorageA>::Scalar, Dynamic, Dynamic> operator*(const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B)
     {
-        // TODO : implémenter
-        const int rows = v.rows();
-        Vector<_Scalar, _Rows> result(rows);
+        typedef typename MatrixView<_ScalarA, _StorageA>::Scalar Scalar;
+        assert(A.cols() == B.rows());
 
-        for (int i = 0; i < rows; ++i) {
-            result(i) = v(i) * a;
-        }
+        Matrix<Scalar, Dynamic, Dynamic> C(A.rows(), B.cols(), Uninitialized);
+        gemm(Scalar(1), A, B, Scalar(0), C.view());
+        return C;
+    }
 
-        return result;
+    /**
+     * Addition : Vue + Vue
+     */
+    template<typename _ScalarA, int _StorageA, typename _ScalarB, int _StorageB>
+    Matrix<typename MatrixView<_ScalarA, _StorageA>::Scalar, Dynamic, Dynamic> operator+(const MatrixView<_ScalarA, _StorageA>& A, const MatrixView<_ScalarB, _StorageB>& B)
+    {
+        typedef typename MatrixView<_ScalarA, _StorageA>::Scalar Scalar;
+
+        Matrix<Scalar, Dynamic, Dynamic> C(A.rows(), A.cols(), Uninitialized);
+        add(A, B, C.view());
+        return C;
     }
 
+    /**
+     * Multiplication : Scalaire * Vue
+     */
+    template<typename _Scalar, int _Storage>
+    Matrix<typename MatrixView<_Scalar, _Storage>::Scalar, Dynamic, Dynamic, _Storage> operator*(const typename MatrixView<_Scalar, _Storage>::Scalar& a, const MatrixView<_Scalar, _Storage>& A)
+    {
+        Matrix<typename MatrixView<_Scalar, _Storage>::Scalar, Dynamic, Dynamic, _Storage> result(A.rows(), A.cols(), Uninitialized);
+        const MatrixView<typename MatrixView<_Scalar, _Storage>::Scalar, _Storage> R = result.view();
+        const Index outer = _Storage == ColumnStorage ? A.cols() : A.rows();
+        const Index inner = _Storage == ColumnStorage ? A.rows() : A.cols();
+        for (Index k = 0; k < outer; ++k) {
+            const _Scalar* p = A.data() + k * A.outerStride();
+            for (Index l = 0; l < inner; ++l) {
+                R.data()[k * R.outerStride() + l] = a * p[l];
+            }
+        }
+        return result;
+    }
 
     /**
-     * Addition : Vecteur + Vecteur
+     * Multiplication : Vue * Vecteur
      */
-    template <typename _Scalar, int _RowsA, int _RowsB>
-    Vector<_Scalar, _RowsA> operator+(const Vector<_Scalar, _RowsA>& a, const Vector<_Scalar, _RowsB>& b)
+    template<typename _ScalarA, int _StorageA, int _Rows>
+    Vector<typename MatrixView<_ScalarA, _StorageA>::Scalar> operator*(const MatrixView<_ScalarA, _StorageA>& A, const Vector<typename MatrixView<_ScalarA, _StorageA>::Scalar, _Rows>& v)
     {
-        // TODO : implémenter
-        const int rows = a.rows();
-        assert (rows == b.rows());
+        typedef typename MatrixView<_ScalarA, _StorageA>::Scalar Scalar;
+        assert(A.cols() == v.rows());
 
-        Vector<_Scalar, _RowsA> result(rows);
-        for (int i = 0; i < rows; ++i) {
-            result(i) = a(i) + b(i);
-        }
+        Vector<Scalar> result(A.rows(), Uninitialized);
+        gemv(Scalar(1), A, v.view(), Scalar(0), result.view());
         return result;
     }
 
+    namespace internal
+    {
+        /**
+         * y[i] = (A * x)[i] pour les lignes [begin, end) de A.
+         */
+        template<typename _Scalar, int _Rows, int _Cols>
+        inline void spmvRows(const SparseMatrix<_Scalar, _Cols, _Rows>& A, const _Scalar* x, _Scalar* y, Index begin, Index end)
+        {
+            const Index* start = A.outer();
+            const Index* inner = A.inner();
+            const _Scalar* values = A.values();
+            for (Index i = begin; i < end; ++i)
+            {
+                _Scalar sum = _Scalar(0);
+                for (Index k = start[i]; k < start[i + 1]; ++k)
+                    sum += values[k] * x[inner[k]];
+                y[i] = sum;
+            }
+        }
+    }
+
     /**
-     * Soustraction : Vecteur - Vecteur
+     * Produit creux dans une destination existante : y = A * x (voir
+     * multiply() ci-dessus).
+     *
+     * Au-delà de 2 * GTI320_PARALLEL_MIN_WORK entrées, les lignes sont
+     * réparties entre les fils en tranches de nombre d'entrées à peu près
+     * égal (voir SparseMatrix::rowPartition()), et non de nombre de lignes
+     * égal : quelques lignes très longues ne retardent pas un seul fil.
+     * Chaque ligne est calculée par un seul fil, dans le même ordre : le
+     * résultat ne dépend pas du nombre de fils.
      */
-    template <typename _Scalar, int _RowsA, int _RowsB>
-    Vector<_Scalar, _RowsA> operator-(const Vector<_Scalar, _RowsA>& a, const Vector<_Scalar, _RowsB>& b)
+    template<typename _Scalar, int _Rows, int _Cols, int _RowsX, int _RowsY>
+    void multiply(const SparseMatrix<_Scalar, _Cols, _Rows>& A, const Vector<_Scalar, _RowsX>& x, Vector<_Scalar, _RowsY>& y)
     {
-        // TODO : implémenter
-        const int rows = a.rows();
-        assert (rows == b.rows());
+        const Index m = A.rows();
+        const Index n = A.cols();
+
+        assert(n == x.rows());
 
-        Vector<_Scalar, _RowsA> result(rows);
-        for (int i = 0; i < rows; ++i) {
-            result(i) = a(i) - b(i);
+        const _Scalar* py = static_cast<const Vector<_Scalar, _RowsY>&>(y).data();
+        if (internal::overlaps(py, y.size(), x.data(), x.size())) {
+            Vector<_Scalar, _RowsY> result;
+            multiply(A, x, result);
+            y = std::move(result);
+            return;
         }
-        return result;
+
+        y.resize(m, Uninitialized);
+        const _Scalar* v = x.data();
+        _Scalar* out = y.data();
+
+        const double work = (double)A.getInnerSize() + (double)m;
+        const Index grain = parallelGrain(1.0);
+        int parts = parallelThreads();
+        if (work / (double)grain < parts)
+            parts = (int)(work / (double)grain);
+        if (parts <= 1 || work < 2.0 * GTI320_PARALLEL_MIN_WORK) {
+            internal::spmvRows(A, v, out, 0, m);
+            return;
+        }
+
+        const std::shared_ptr<const std::vector<Index> > partition = A.rowPartition(parts);
+        const Index* split = partition->data();
+        parallel_for(parts, [&](Index kbegin, Index kend) {
+            for (Index k = kbegin; k < kend; ++k)
+                internal::spmvRows(A, v, out, split[k], split[k + 1]);
+        });
     }
-    
 
     /**
      * Multiplication : SparseMatrix * Vecteur : slide 21 (page 22 du cours 3 a appliquer), eviter de call operator() ici (big-o va augmenter insanely
@@ -360,31 +890,198 @@ namespace gti320 {
     template<typename _Scalar, int _Rows, int _Cols>
     Vector<_Scalar, _Rows> operator*(const SparseMatrix<_Scalar, _Cols, _Rows>& A, const Vector<_Scalar, _Cols>& v)
     {
-        const int m = (int)A.rows();
-        const int n = (int)A.cols();
+        Vector<_Scalar, _Rows> y;
+        multiply(A, v, y);
+        return y;
+    }
 
-        assert(n == v.rows());
+    /**
+     * Produit SELL-C-σ dans une destination existante : y = A * x (voir
+     * SellMatrix.h). Au-delà de 2 * GTI320_PARALLEL_MIN_WORK entrées
+     * stockées, les paquets de lignes sont répartis entre les fils.
+     */
+    template<typename _Scalar, int _RowsX, int _RowsY>
+    void multiply(const SellMatrix<_Scalar>& A, const Vector<_Scalar, _RowsX>& x, Vector<_Scalar, _RowsY>& y)
+    {
+        assert(A.cols() == x.rows());
 
-        Vector<_Scalar, _Rows> y(m);
-        y.setZero();
+        const _Scalar* py = static_cast<const Vector<_Scalar, _RowsY>&>(y).data();
+        if (internal::overlaps(py, y.size(), x.data(), x.size())) {
+            Vector<_Scalar, _RowsY> result;
+            multiply(A, x, result);
+            y = std::move(result);
+            return;
+        }
 
-        for (unsigned int i = 0; i < (unsigned int)m; ++i)
-        {
-            const unsigned int begin = A.outer()[i];
-            const unsigned int end = (i + 1 < (unsigned int)m) ? A.outer()[i + 1] : (unsigned int)A.getInnerSize();
+        y.resize(A.rows(), Uninitialized);
+        const _Scalar* v = x.data();
+        _Scalar* out = y.data();
 
-            _Scalar sum = _Scalar(0);
+        const Index chunks = A.chunks();
+        if (parallelThreads() <= 1 || (double)A.storedEntries() < 2.0 * GTI320_PARALLEL_MIN_WORK) {
+            A.multiplyChunks(0, chunks, v, out);
+            return;
+        }
+        const double perChunk = (double)A.storedEntries() / (double)chunks;
+        parallel_for(chunks, [&](Index first, Index last) {
+            A.multiplyChunks(first, last, v, out);
+        }, parallelGrain(perChunk));
+    }
 
-            for (unsigned int k = begin; k < end; ++k)
-            {
-                const unsigned int j = A.inner()[k];
-                sum += A.values()[k] * v((int)j);
+    template<typename _Scalar>
+    Vector<_Scalar> operator*(const SellMatrix<_Scalar>& A, const Vector<_Scalar>& v)
+    {
+        Vector<_Scalar> y;
+        multiply(A, v, y);
+        return y;
+    }
+
+    /**
+     * Format de stockage d'un SparseOperator.
+     */
+    enum SparseFormat
+    {
+        SparseFormatAuto = 0,       // choisi à la construction
+        SparseFormatCRS = 1,        // SparseMatrix
+        SparseFormatSELL = 2        // SellMatrix
+    };
+
+    /**
+     * Opérateur creux pour des produits répétés y = A * x (solveurs
+     * itératifs) : conserve A en CRS ou la convertit en SELL-C-σ.
+     *
+     * Avec SparseFormatAuto, la conversion est faite puis mesurée : SELL-C-σ
+     * est retenu si les noyaux AVX2 ou AVX-512 sont disponibles et si la
+     * variance des longueurs de lignes dans les paquets
+     * (SellMatrix::rowLengthVariation()) ne dépasse pas
+     * GTI320_SELL_MAX_VARIATION ; sinon la matrice reste en CRS. Une
+     * matrice dont les colonnes ne tiennent pas sur 32 bits
+     * (SellMatrix::supports()) reste aussi en CRS ; avec SparseFormatSELL,
+     * la conversion lève alors std::length_error.
+     */
+    template<typename _Scalar = double>
+    class SparseOperator
+    {
+    public:
+
+        explicit SparseOperator(const SparseMatrix<_Scalar>& A, SparseFormat format = SparseFormatAuto, Index sigma = GTI320_SELL_SIGMA) :
+            m_format(SparseFormatCRS)
+        {
+            if (format == SparseFormatCRS || (format == SparseFormatAuto && !SellMatrix<_Scalar>::supports(A))) {
+                m_crs = A;
+                return;
             }
 
-            y((int)i) = sum;
+            m_sell = SellMatrix<_Scalar>(A, sigma);
+            if (format == SparseFormatAuto && (simdLevel() < SimdAVX2 || m_sell.rowLengthVariation() > GTI320_SELL_MAX_VARIATION)) {
+                m_sell = SellMatrix<_Scalar>();
+                m_crs = A;
+                return;
+            }
+            m_format = SparseFormatSELL;
         }
 
+        SparseFormat format() const { return m_format; }
+
+        Index rows() const { return m_format == SparseFormatSELL ? m_sell.rows() : m_crs.rows(); }
+
+        Index cols() const { return m_format == SparseFormatSELL ? m_sell.cols() : m_crs.cols(); }
+
+        const SparseMatrix<_Scalar>& crs() const { return m_crs; }
+
+        const SellMatrix<_Scalar>& sell() const { return m_sell; }
+
+    private:
+
+        SparseFormat m_format;
+        SparseMatrix<_Scalar> m_crs;
+        SellMatrix<_Scalar> m_sell;
+    };
+
+    template<typename _Scalar, int _RowsX, int _RowsY>
+    void multiply(const SparseOperator<_Scalar>& A, const Vector<_Scalar, _RowsX>& x, Vector<_Scalar, _RowsY>& y)
+    {
+        if (A.format() == SparseFormatSELL) {
+            multiply(A.sell(), x, y);
+        }
+        else {
+            multiply(A.crs(), x, y);
+        }
+    }
+
+    template<typename _Scalar>
+    Vector<_Scalar> operator*(const SparseOperator<_Scalar>& A, const Vector<_Scalar>& v)
+    {
+        Vector<_Scalar> y;
+        multiply(A, v, y);
+        return y;
+    }
+
+    /**
+     * Produit creux par blocs dans une destination existante : y = A * x
+     * (voir BlockSparseMatrix.h). Au-delà de 2 * GTI320_PARALLEL_MIN_WORK
+     * entrées stockées, les lignes de blocs sont réparties entre les fils ;
+     * chaque ligne est calculée par un seul fil.
+     */
+    template<typename _Scalar, int _BlockRows, int _BlockCols, int _RowsX, int _RowsY>
+    void multiply(const BlockSparseMatrix<_Scalar, _BlockRows, _BlockCols>& A, const Vector<_Scalar, _RowsX>& x, Vector<_Scalar, _RowsY>& y)
+    {
+        assert(A.cols() == x.rows());
+
+        const _Scalar* py = static_cast<const Vector<_Scalar, _RowsY>&>(y).data();
+        if (internal::overlaps(py, y.size(), x.data(), x.size())) {
+            Vector<_Scalar, _RowsY> result;
+            multiply(A, x, result);
+            y = std::move(result);
+            return;
+        }
+
+        y.resize(A.rows(), Uninitialized);
+        const _Scalar* v = x.data();
+        _Scalar* out = y.data();
+
+        const Index blockRows = A.blockRows();
+        const double work = (double)A.nonZeroBlocks() * _BlockRows * _BlockCols + (double)A.rows();
+        if (parallelThreads() <= 1 || work < 2.0 * GTI320_PARALLEL_MIN_WORK) {
+            A.multiplyRows(0, blockRows, v, out);
+            return;
+        }
+        parallel_for(blockRows, [&](Index first, Index last) {
+            A.multiplyRows(first, last, v, out);
+        }, parallelGrain(work / (double)blockRows));
+    }
+
+    template<typename _Scalar, int _BlockRows, int _BlockCols>
+    Vector<_Scalar> operator*(const BlockSparseMatrix<_Scalar, _BlockRows, _BlockCols>& A, const Vector<_Scalar>& v)
+    {
+        Vector<_Scalar> y;
+        multiply(A, v, y);
         return y;
     }
 
+    /**
+     * Produit par la transposée : y = A^T * x, sans former A^T.
+     *
+     * Le bloc (bi, bj) contribue à la tranche bj de y : les contributions
+     * d'une même tranche viennent de lignes de blocs quelconques, le produit
+     * est donc séquentiel.
+     */
+    template<typename _Scalar, int _BlockRows, int _BlockCols, int _RowsX, int _RowsY>
+    void multiplyTransposed(const BlockSparseMatrix<_Scalar, _BlockRows, _BlockCols>& A, const Vector<_Scalar, _RowsX>& x, Vector<_Scalar, _RowsY>& y)
+    {
+        assert(A.rows() == x.rows());
+
+        const _Scalar* py = static_cast<const Vector<_Scalar, _RowsY>&>(y).data();
+        if (internal::overlaps(py, y.size(), x.data(), x.size())) {
+            Vector<_Scalar, _RowsY> result;
+            multiplyTransposed(A, x, result);
+            y = std::move(result);
+            return;
+        }
+
+        y.resize(A.cols(), Uninitialized);
+        y.setZero();
+        A.multiplyTransposedRows(0, A.blockRows(), x.data(), y.data());
+    }
+
 }
@@ -0,0 +1,297 @@
+#pragma once
+
+/**
+ * @file Parallel.h
+ *
+ * @brief Partitionnement statique et boucles parallèles sur la réserve de
+ *        fils globale (ThreadPool.h).
+ *
+ * Toutes les opérations parallèles de la bibliothèque découpent leur domaine
+ * avec partition() : l'intervalle [0, n) est divisé en `parts` tranches
+ * contiguës de tailles égales (à un élément près).
+ *
+ * parallel_for() distribue ses tranches par vol de tâches : un fil libre
+ * prend la suivante, quel qu'il soit. parallel_for_static() donne au
+ * contraire la tranche k au participant k (le fil appelant pour k = 0, le
+ * fil k de la réserve sinon). Le premier contact avec un nouveau grand
+ * tampon (voir DenseStorage) et gemv utilisent tous deux ce placement : avec
+ * des fils épinglés (setParallelPinning()), chaque fil de gemv trouve ainsi
+ * ses pages sur le nœud NUMA de son cœur.
+ *
+ * Le nombre de fils est donné par GTI320_NUM_THREADS (0 : nombre de cœurs
+ * matériels) et peut être modifié à l'exécution avec setParallelThreads().
+ * Les tranches sont des tâches de la réserve globale : les fils sont créés
+ * une seule fois, et une boucle parallèle imbriquée dans une autre réutilise
+ * les mêmes fils au lieu d'en lancer de nouveaux.
+ *
+ * Les noyaux de calcul (gemm, gemv) ne créent une tranche que si elle
+ * compte au moins GTI320_PARALLEL_MIN_WORK multiplications-additions (voir
+ * parallelGrain()) : en deçà, la synchronisation coûte plus qu'elle ne
+ * rapporte.
+ *
+ */
+
+#include "Types.h"
+#include "ThreadPool.h"
+
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef GTI320_NUM_THREADS
+#define GTI320_NUM_THREADS 0
+#endif
+
+#ifndef GTI320_PIN_THREADS
+#define GTI320_PIN_THREADS 0
+#endif
+
+#ifndef GTI320_PARALLEL_MIN_WORK
+#define GTI320_PARALLEL_MIN_WORK (1 << 18)
+#endif
+
+namespace gti320
+{
+    namespace internal
+    {
+        inline int& parallelThreadsSetting()
+        {
+            static int s_threads = GTI320_NUM_THREADS;
+            return s_threads;
+        }
+
+        inline bool& parallelPinningSetting()
+        {
+            static bool s_pin = GTI320_PIN_THREADS != 0;
+            return s_pin;
+        }
+    }
+
+    /**
+     * Nombre de fils utilisés par les opérations parallèles.
+     */
+    inline int parallelThreads()
+    {
+        const int n = internal::parallelThreadsSetting();
+        if (n > 0)
+            return n;
+
+        const unsigned int hw = std::thread::hardware_concurrency();
+        return hw > 0 ? (int)hw : 1;
+    }
+
+    /**
+     * Fixe le nombre de fils (0 : nombre de cœurs matériels, 1 : séquentiel).
+     */
+    inline void setParallelThreads(int n)
+    {
+        assert(n >= 0);
+        internal::parallelThreadsSetting() = n;
+    }
+
+    /**
+     * Vrai si les fils de la réserve globale sont épinglés sur un cœur.
+     */
+    inline bool parallelPinning()
+    {
+        return internal::parallelPinningSetting();
+    }
+
+    /**
+     * Active ou désactive l'épinglage des fils (Linux seulement).
+     */
+    inline void setParallelPinning(bool pin)
+    {
+        internal::parallelPinningSetting() = pin;
+    }
+
+    /**
+     * Réserve de fils utilisée par les opérations parallèles.
+     *
+     * Elle est recréée lorsque parallelThreads() ou parallelPinning() a
+     * changé ; ces réglages ne doivent donc pas être modifiés pendant une
+     * région parallèle. Appelée depuis une tâche, retourne la réserve qui
+     * exécute cette tâche.
+     */
+    inline ThreadPool& globalThreadPool()
+    {
+        ThreadPool* current = internal::currentWorker().pool;
+        if (current != nullptr)
+            return *current;
+
+        static std::mutex s_mutex;
+        static std::unique_ptr<ThreadPool> s_pool;
+
+        const int threads = parallelThreads();
+        const bool pin = parallelPinning();
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (!s_pool || s_pool->size() != threads || s_pool->pinned() != pin)
+        {
+            s_pool.reset();
+            s_pool.reset(new ThreadPool(threads, pin));
+        }
+        return *s_pool;
+    }
+
+    /**
+     * Tranche `k` (parmi `parts`) de l'intervalle [0, n).
+     */
+    inline void partition(Index n, int parts, int k, Index& begin, Index& end)
+    {
+        assert(parts > 0 && 0 <= k && k < parts);
+        begin = n / parts * k + (n % parts) * k / parts;
+        end = n / parts * (k + 1) + (n % parts) * (k + 1) / parts;
+    }
+
+    /**
+     * Nombre minimal d'éléments par tranche lorsque chaque élément coûte
+     * `work` multiplications-additions (voir GTI320_PARALLEL_MIN_WORK).
+     */
+    inline Index parallelGrain(double work)
+    {
+        if (work <= 0.0)
+            return 1;
+        const double grain = (double)GTI320_PARALLEL_MIN_WORK / work;
+        return grain < 1.0 ? 1 : (Index)grain + 1;
+    }
+
+    /**
+     * Appelle `f(begin, end)` sur chaque tranche de [0, n), en parallèle.
+     *
+     * Au plus parallelThreads() tranches sont créées, chacune d'au moins
+     * `grain` éléments. La dernière tranche est traitée par le fil appelant,
+     * qui exécute ensuite d'autres tâches en attendant la fin des tranches.
+     */
+    template<typename _Func>
+    void parallel_for(Index n, const _Func& f, Index grain = 1)
+    {
+        if (n <= 0)
+            return;
+
+        int parts = parallelThreads();
+        if (grain > 0 && n / grain < parts)
+            parts = (int)(n / grain);
+
+        if (parts <= 1)
+        {
+            f(0, n);
+            return;
+        }
+
+        TaskGroup group(globalThreadPool());
+        for (int k = 0; k < parts - 1; ++k)
+        {
+            Index begin, end;
+            partition(n, parts, k, begin, end);
+            group.spawn([&f, begin, end]() { f(begin, end); });
+        }
+
+        Index begin, end;
+        partition(n, parts, parts - 1, begin, end);
+        try
+        {
+            f(begin, end);
+        }
+        catch (...)
+        {
+            group.wait();
+            throw;
+        }
+        group.wait();
+    }
+
+    /**
+     * Appelle `f(begin, end)` sur chaque tranche de [0, n), en parallèle, la
+     * tranche k étant toujours traitée par le même fil : le fil appelant
+     * pour k = 0, le fil de rang k de la réserve globale sinon.
+     *
+     * Le nombre de tranches est celui de parallel_for() (au plus
+     * parallelThreads(), chacune d'au moins `grain` éléments). Deux appels
+     * avec le même nombre de tranches depuis le même fil placent donc les
+     * mêmes éléments sur les mêmes fils. Dans une tâche de la réserve (région
+     * imbriquée), le placement n'a plus de sens : l'appel se ramène à
+     * parallel_for().
+     */
+    template<typename _Func>
+    void parallel_for_static(Index n, const _Func& f, Index grain = 1)
+    {
+        if (n <= 0)
+            return;
+
+        int parts = parallelThreads();
+        if (grain > 0 && n / grain < parts)
+            parts = (int)(n / grain);
+
+        if (parts <= 1)
+        {
+            f(0, n);
+            return;
+        }
+        if (internal::currentWorker().pool != nullptr)
+        {
+            parallel_for(n, f, grain);
+            return;
+        }
+
+        ThreadPool& pool = globalThreadPool();
+        assert(pool.size() >= parts);
+        TaskGroup group(pool);
+        for (int k = 1; k < parts; ++k)
+        {
+            Index begin, end;
+            partition(n, parts, k, begin, end);
+            group.spawnOn(k, [&f, begin, end]() { f(begin, end); });
+        }
+
+        Index begin, end;
+        partition(n, parts, 0, begin, end);
+        try
+        {
+            f(begin, end);
+        }
+        catch (...)
+        {
+            group.wait();
+            throw;
+        }
+        group.wait();
+    }
+
+    /**
+     * Réduction parallèle : `map(begin, end)` calcule la valeur d'une tranche
+     * et les valeurs sont combinées de gauche à droite à partir de
+     * `identity`, avec `combine(a, b)`.
+     *
+     * Le découpage est celui de parallel_for() ; pour un nombre de fils
+     * donné, le résultat ne dépend donc pas de l'ordonnancement.
+     */
+    template<typename _Value, typename _Map, typename _Combine>
+    _Value parallel_reduce(Index n, const _Value& identity, const _Map& map, const _Combine& combine, Index grain = 1)
+    {
+        if (n <= 0)
+            return identity;
+
+        int parts = parallelThreads();
+        if (grain > 0 && n / grain < parts)
+            parts = (int)(n / grain);
+        if (parts < 1)
+            parts = 1;
+
+        std::vector<_Value> partials((size_t)parts, identity);
+        parallel_for(parts, [&](Index first, Index last) {
+            for (Index k = first; k < last; ++k)
+            {
+                Index begin, end;
+                partition(n, parts, (int)k, begin, end);
+                partials[(size_t)k] = map(begin, end);
+            }
+        });
+
+        _Value result = identity;
+        for (int k = 0; k < parts; ++k)
+            result = combine(result, partials[(size_t)k]);
+        return result;
+    }
+}
@@ -0,0 +1,395 @@
+#pragma once
+
+/**
+ * @file SellMatrix.h
+ *
+ * @brief Matrice creuse au format SELL-C-σ (ELLPACK par tranches, lignes
+ *        triées par fenêtres), pour un produit matrice * vecteur vectoriel.
+ *
+ * Le produit CRS (voir multiply() dans Operators.h) traite une ligne à la
+ * fois : la boucle interne est une somme de longueur variable, qui ne se
+ * vectorise pas d'une ligne à l'autre. Le format SELL-C-σ regroupe les
+ * lignes par paquets de C = 8 ; dans un paquet, la k-ième entrée des 8
+ * lignes est stockée de façon contiguë :
+ *
+ *    paquet p, entrée k :   vals[start[p] + 8 * k + l],  l = 0, ..., 7
+ *                           cols[start[p] + 8 * k + l]
+ *
+ * Un registre (AVX-512 pour double, AVX2 pour float ; deux registres AVX2
+ * pour double) accumule ainsi 8 lignes à la fois : une multiplication-
+ * addition par entrée k, avec une lecture groupée (gather) des 8 x[cols].
+ * Les indices de colonne sont sur 32 bits, ce qui divise par deux leur
+ * bande passante.
+ *
+ * Les lignes plus courtes que la plus longue de leur paquet sont complétées
+ * par des zéros. Pour limiter ce remplissage, les lignes sont triées par
+ * longueur décroissante à l'intérieur de fenêtres de σ lignes ; le produit
+ * écrit chaque résultat à la position d'origine de sa ligne.
+ *
+ * Le format n'est avantageux que si le remplissage est faible, c'est-à-dire
+ * si les longueurs des lignes d'un même paquet varient peu : voir
+ * rowLengthVariation() et SparseOperator (Operators.h), qui choisit le
+ * format automatiquement.
+ *
+ */
+
+#include "Types.h"
+#include "DenseStorage.h"
+#include "SparseMatrix.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#ifndef GTI320_SELL_SIGMA
+#define GTI320_SELL_SIGMA 256
+#endif
+
+// Variation des longueurs de lignes (rowLengthVariation()) au-delà de
+// laquelle SparseOperator conserve le format CRS.
+#ifndef GTI320_SELL_MAX_VARIATION
+#define GTI320_SELL_MAX_VARIATION 0.1
+#endif
+
+namespace gti320
+{
+    namespace internal
+    {
+        namespace simd
+        {
+            /**
+             * Produit SELL-8 pour les paquets [first, last) :
+             * y[perm[8 p + l]] = somme sur k de vals[.] * x[cols[.]].
+             * Les positions de remplissage de perm valent -1.
+             */
+            namespace scalar
+            {
+                template<typename _Scalar>
+                inline void sellSpmv(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                                     const _Scalar* vals, const Index* perm, const _Scalar* x, _Scalar* y)
+                {
+                    for (Index p = first; p < last; ++p) {
+                        _Scalar acc[8] = { _Scalar(0), _Scalar(0), _Scalar(0), _Scalar(0), _Scalar(0), _Scalar(0), _Scalar(0), _Scalar(0) };
+                        const _Scalar* v = vals + start[p];
+                        const std::int32_t* j = cols + start[p];
+                        for (Index k = 0; k < width[p]; ++k, v += 8, j += 8) {
+                            for (int l = 0; l < 8; ++l) {
+                                acc[l] += v[l] * x[j[l]];
+                            }
+                        }
+                        for (int l = 0; l < 8; ++l) {
+                            const Index r = perm[8 * p + l];
+                            if (r >= 0) {
+                                y[r] = acc[l];
+                            }
+                        }
+                    }
+                }
+            }
+
+#if GTI320_SIMD
+            namespace avx2
+            {
+                GTI320_TARGET_AVX2 inline void sellSpmv(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                                                        const double* vals, const Index* perm, const double* x, double* y)
+                {
+                    // Lectures groupées masquées, à source explicite : les versions
+                    // sans masque de GCC 12 déclenchent -Wmaybe-uninitialized
+                    // sous l'attribut target.
+                    const __m256d zero = _mm256_setzero_pd();
+                    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+                    for (Index p = first; p < last; ++p) {
+                        __m256d a0 = zero, a1 = zero;
+                        const double* v = vals + start[p];
+                        const std::int32_t* j = cols + start[p];
+                        for (Index k = 0; k < width[p]; ++k, v += 8, j += 8) {
+                            const __m128i j0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(j));
+                            const __m128i j1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(j + 4));
+                            a0 = _mm256_fmadd_pd(_mm256_loadu_pd(v), _mm256_mask_i32gather_pd(zero, x, j0, all, 8), a0);
+                            a1 = _mm256_fmadd_pd(_mm256_loadu_pd(v + 4), _mm256_mask_i32gather_pd(zero, x, j1, all, 8), a1);
+                        }
+                        double acc[8];
+                        _mm256_storeu_pd(acc, a0);
+                        _mm256_storeu_pd(acc + 4, a1);
+                        for (int l = 0; l < 8; ++l) {
+                            const Index r = perm[8 * p + l];
+                            if (r >= 0) {
+                                y[r] = acc[l];
+                            }
+                        }
+                    }
+                }
+
+                GTI320_TARGET_AVX2 inline void sellSpmv(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                                                        const float* vals, const Index* perm, const float* x, float* y)
+                {
+                    const __m256 zero = _mm256_setzero_ps();
+                    const __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+                    for (Index p = first; p < last; ++p) {
+                        __m256 a = zero;
+                        const float* v = vals + start[p];
+                        const std::int32_t* j = cols + start[p];
+                        for (Index k = 0; k < width[p]; ++k, v += 8, j += 8) {
+                            const __m256i jj = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(j));
+                            a = _mm256_fmadd_ps(_mm256_loadu_ps(v), _mm256_mask_i32gather_ps(zero, x, jj, all, 4), a);
+                        }
+                        float acc[8];
+                        _mm256_storeu_ps(acc, a);
+                        for (int l = 0; l < 8; ++l) {
+                            const Index r = perm[8 * p + l];
+                            if (r >= 0) {
+                                y[r] = acc[l];
+                            }
+                        }
+                    }
+                }
+            }
+
+            namespace avx512
+            {
+                GTI320_TARGET_AVX512 inline void sellSpmv(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                                                          const double* vals, const Index* perm, const double* x, double* y)
+                {
+                    const __m512d zero = _mm512_setzero_pd();
+                    for (Index p = first; p < last; ++p) {
+                        __m512d a = zero;
+                        const double* v = vals + start[p];
+                        const std::int32_t* j = cols + start[p];
+                        for (Index k = 0; k < width[p]; ++k, v += 8, j += 8) {
+                            const __m256i jj = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(j));
+                            a = _mm512_fmadd_pd(_mm512_loadu_pd(v), _mm512_mask_i32gather_pd(zero, 0xff, jj, x, 8), a);
+                        }
+                        double acc[8];
+                        _mm512_storeu_pd(acc, a);
+                        for (int l = 0; l < 8; ++l) {
+                            const Index r = perm[8 * p + l];
+                            if (r >= 0) {
+                                y[r] = acc[l];
+                            }
+                        }
+                    }
+                }
+
+                // Un paquet de 8 float tient dans un registre AVX2.
+                inline void sellSpmv(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                                     const float* vals, const Index* perm, const float* x, float* y)
+                {
+                    avx2::sellSpmv(first, last, start, width, cols, vals, perm, x, y);
+                }
+            }
+#endif
+        }
+
+        /**
+         * Produit SELL-8 des paquets [first, last), au niveau simdLevel().
+         */
+        template<typename _Scalar>
+        inline void sellSpmv(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                             const _Scalar* vals, const Index* perm, const _Scalar* x, _Scalar* y)
+        {
+            simd::scalar::sellSpmv(first, last, start, width, cols, vals, perm, x, y);
+        }
+
+#if GTI320_SIMD
+        template<typename _Scalar>
+        inline void sellSpmvVectorized(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                                       const _Scalar* vals, const Index* perm, const _Scalar* x, _Scalar* y)
+        {
+            switch (simdLevel()) {
+            case SimdAVX512:
+                simd::avx512::sellSpmv(first, last, start, width, cols, vals, perm, x, y);
+                break;
+            case SimdAVX2:
+                simd::avx2::sellSpmv(first, last, start, width, cols, vals, perm, x, y);
+                break;
+            default:
+                simd::scalar::sellSpmv(first, last, start, width, cols, vals, perm, x, y);
+                break;
+            }
+        }
+
+        template<>
+        inline void sellSpmv<double>(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                                     const double* vals, const Index* perm, const double* x, double* y)
+        {
+            sellSpmvVectorized(first, last, start, width, cols, vals, perm, x, y);
+        }
+
+        template<>
+        inline void sellSpmv<float>(Index first, Index last, const Index* start, const Index* width, const std::int32_t* cols,
+                                    const float* vals, const Index* perm, const float* x, float* y)
+        {
+            sellSpmvVectorized(first, last, start, width, cols, vals, perm, x, y);
+        }
+#endif
+    }
+
+    /**
+     * Matrice creuse SELL-C-σ (C = Chunk = 8), construite à partir d'une
+     * SparseMatrix. La structure est figée : pour modifier la matrice, il
+     * faut modifier la SparseMatrix puis la convertir de nouveau.
+     */
+    template<typename _Scalar = double>
+    class SellMatrix
+    {
+    public:
+
+        static const int Chunk = 8;
+
+        SellMatrix() : m_rows(0), m_cols(0), m_nnz(0), m_sigma(Chunk), m_variation(0.0) { }
+
+        /**
+         * Vrai si A peut être convertie : ses indices de colonne tiennent
+         * sur 32 bits.
+         */
+        static bool supports(const SparseMatrix<_Scalar>& A)
+        {
+            return A.cols() <= (Index)std::numeric_limits<std::int32_t>::max();
+        }
+
+        /**
+         * Conversion : les lignes de A sont triées par longueur décroissante
+         * dans chaque fenêtre de `sigma` lignes (arrondi à un multiple de
+         * Chunk), puis regroupées par paquets de Chunk lignes.
+         *
+         * Lève std::length_error si A a trop de colonnes pour des indices
+         * sur 32 bits (voir supports()).
+         */
+        explicit SellMatrix(const SparseMatrix<_Scalar>& A, Index sigma = GTI320_SELL_SIGMA) :
+            m_rows(A.rows()), m_cols(A.cols()), m_nnz(A.getInnerSize()), m_variation(0.0)
+        {
+            if (!supports(A))
+                throw std::length_error("SellMatrix : plus de colonnes que d'indices sur 32 bits");
+
+            m_sigma = sigma < Chunk ? Chunk : (sigma + Chunk - 1) / Chunk * Chunk;
+            const Index chunks = (m_rows + Chunk - 1) / Chunk;
+            const Index* outer = A.outer();
+
+            // Permutation : fenêtres de σ lignes triées par longueur
+            // décroissante (tri stable : à longueur égale, l'ordre d'origine).
+            m_perm.resize(chunks * Chunk, Uninitialized);
+            Index* perm = m_perm.data();
+            for (Index r = 0; r < chunks * Chunk; ++r)
+                perm[r] = r < m_rows ? r : -1;
+            for (Index w = 0; w < m_rows; w += m_sigma)
+            {
+                const Index end = std::min(w + m_sigma, m_rows);
+                std::stable_sort(perm + w, perm + end, [outer](Index a, Index b) {
+                    return outer[a + 1] - outer[a] > outer[b + 1] - outer[b];
+                });
+            }
+
+            // Largeur de chaque paquet et variance des longueurs autour de la
+            // moyenne de leur paquet.
+            m_width.resize(chunks, Uninitialized);
+            m_start.resize(chunks + 1, Uninitialized);
+            double spread = 0.0;
+            Index stored = 0;
+            for (Index p = 0; p < chunks; ++p)
+            {
+                Index width = 0, sum = 0, count = 0;
+                for (int l = 0; l < Chunk; ++l)
+                {
+                    const Index r = perm[p * Chunk + l];
+                    if (r < 0)
+                        continue;
+                    const Index length = outer[r + 1] - outer[r];
+                    width = std::max(width, length);
+                    sum += length;
+                    ++count;
+                }
+                const double mean = (double)sum / (double)count;
+                for (int l = 0; l < Chunk; ++l)
+                {
+                    const Index r = perm[p * Chunk + l];
+                    if (r >= 0)
+                    {
+                        const double d = (double)(outer[r + 1] - outer[r]) - mean;
+                        spread += d * d;
+                    }
+                }
+                m_width[p] = width;
+                m_start[p] = stored;
+                stored += width * Chunk;
+            }
+            m_start[chunks] = stored;
+
+            if (m_nnz > 0)
+            {
+                const double mean = (double)m_nnz / (double)m_rows;
+                m_variation = spread / (double)m_rows / (mean * mean);
+            }
+
+            // Entrées, paquet par paquet. Le remplissage a une valeur nulle et
+            // reprend la dernière colonne de la ligne (0 pour une ligne vide) :
+            // il ne lit aucune autre entrée de x, qui reste en cache.
+            m_vals.resize(stored, Uninitialized);
+            m_inner.resize(stored, Uninitialized);
+            const Index* inner = A.inner();
+            const _Scalar* values = A.values();
+            for (Index p = 0; p < chunks; ++p)
+            {
+                for (int l = 0; l < Chunk; ++l)
+                {
+                    const Index r = perm[p * Chunk + l];
+                    const Index begin = r < 0 ? 0 : outer[r];
+                    const Index length = r < 0 ? 0 : outer[r + 1] - outer[r];
+                    const std::int32_t pad = length > 0 ? (std::int32_t)inner[begin + length - 1] : 0;
+                    for (Index k = 0; k < m_width[p]; ++k)
+                    {
+                        const Index pos = m_start[p] + k * Chunk + l;
+                        m_vals[pos] = k < length ? values[begin + k] : _Scalar(0);
+                        m_inner[pos] = k < length ? (std::int32_t)inner[begin + k] : pad;
+                    }
+                }
+            }
+        }
+
+        Index rows() const { return m_rows; }
+
+        Index cols() const { return m_cols; }
+
+        // Nombre d'entrées de la matrice d'origine
+        Index nonZeros() const { return m_nnz; }
+
+        // Nombre d'entrées stockées, remplissage compris
+        Index storedEntries() const { return m_start.size() > 0 ? m_start[m_start.size() - 1] : 0; }
+
+        Index sigma() const { return m_sigma; }
+
+        Index chunks() const { return m_width.size(); }
+
+        /**
+         * Variance des longueurs de lignes autour de la moyenne de leur
+         * paquet (après le tri par fenêtres), relative au carré de la
+         * longueur moyenne. Nulle si toutes les lignes d'un paquet ont la
+         * même longueur ; le remplissage croît avec elle.
+         */
+        double rowLengthVariation() const { return m_variation; }
+
+        /**
+         * y = A * x pour les paquets [first, last) ; les lignes absentes de
+         * ces paquets ne sont pas écrites.
+         */
+        void multiplyChunks(Index first, Index last, const _Scalar* x, _Scalar* y) const
+        {
+            assert(0 <= first && first <= last && last <= chunks());
+            internal::sellSpmv(first, last, m_start.data(), m_width.data(), m_inner.data(), m_vals.data(), m_perm.data(), x, y);
+        }
+
+    private:
+
+        Index m_rows, m_cols, m_nnz;
+        Index m_sigma;
+        double m_variation;
+        DenseStorage<_Scalar, Dynamic> m_vals;          // entrées, paquet par paquet, 8 lignes entrelacées
+        DenseStorage<std::int32_t, Dynamic> m_inner;    // colonnes des entrées
+        DenseStorage<Index, Dynamic> m_start;           // début de chaque paquet (chunks() + 1 entrées)
+        DenseStorage<Index, Dynamic> m_width;           // longueur de la plus longue ligne du paquet
+        DenseStorage<Index, Dynamic> m_perm;            // ligne d'origine de chaque position (-1 : remplissage)
+    };
+}
@@ -0,0 +1,860 @@
+#pragma once
+
+/**
+ * @file Simd.h
+ *
+ * @brief Noyaux vectoriels (SSE2, AVX2, AVX-512) des opérations de niveau 1,
+ *        choisis à l'exécution selon le processeur.
+ *
+ * Cinq noyaux sur des tampons contigus, pour float et double :
+ *
+ *    dot(n, x, y)           somme des x[i] * y[i]
+ *    axpy(n, a, x, y)       y[i] += a * x[i]
+ *    axpby(n, a, x, b, y)   y[i] = a * x[i] + b * y[i]
+ *    scale(n, a, x, y)      y[i] = a * x[i]        (x et y peuvent coïncider)
+ *    add(n, x, y, z)        z[i] = x[i] + y[i]     (z peut coïncider avec x ou y)
+ *
+ * Vector::dot(), Vector::norm(), gemv(), add(), axpy(), axpby(), les
+ * opérateurs composés (+=, -=, *=) et l'évaluation des expressions `A + B`,
+ * `a * A` et `a * x + b * y` (voir Expression.h) s'y ramènent.
+ *
+ * Chaque jeu d'instructions a sa propre version, compilée avec l'attribut
+ * `target` : aucune option de compilation (-mavx2, /arch) n'est nécessaire,
+ * et un même exécutable utilise AVX-512 sur les machines qui l'offrent tout
+ * en restant correct sur un x86-64 de base (SSE2). Le niveau est détecté une
+ * fois avec CPUID (et XGETBV, pour vérifier que le système sauvegarde les
+ * registres étendus) ; setSimdLevel() permet de le restreindre, par exemple
+ * pour comparer les versions entre elles.
+ *
+ * Pour les autres types (int, ...), hors x86-64 ou si GTI320_SIMD est nul,
+ * les noyaux sont des boucles scalaires.
+ *
+ * Les sommes vectorielles (dot) regroupent les termes dans un autre ordre
+ * que la boucle scalaire : les résultats peuvent différer de quelques ulp.
+ *
+ */
+
+#include "Types.h"
+
+#include <cassert>
+#include <type_traits>
+
+#ifndef GTI320_SIMD
+#if defined(__x86_64__) || defined(_M_X64)
+#define GTI320_SIMD 1
+#else
+#define GTI320_SIMD 0
+#endif
+#endif
+
+#if GTI320_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define GTI320_TARGET_AVX2
+#define GTI320_TARGET_AVX512
+#else
+#include <cpuid.h>
+#define GTI320_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define GTI320_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+#endif
+
+// Déroulement complet d'une boucle à bornes constantes (micro-noyaux de
+// Gemm.h) : les accumulateurs restent dans des registres.
+#ifndef GTI320_UNROLL
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8)
+#define GTI320_UNROLL _Pragma("GCC unroll 32")
+#else
+#define GTI320_UNROLL
+#endif
+#endif
+
+namespace gti320
+{
+    /**
+     * Jeux d'instructions vectorielles, du moins au plus large.
+     */
+    enum SimdLevel
+    {
+        SimdScalar = 0,
+        SimdSSE2 = 1,
+        SimdAVX2 = 2,       // avec FMA
+        SimdAVX512 = 3      // AVX-512F
+    };
+
+    inline const char* simdLevelName(SimdLevel level)
+    {
+        switch (level) {
+        case SimdSSE2: return "SSE2";
+        case SimdAVX2: return "AVX2";
+        case SimdAVX512: return "AVX-512";
+        default: return "scalaire";
+        }
+    }
+
+    namespace internal
+    {
+        /**
+         * Niveau offert par le processeur et le système.
+         */
+        inline SimdLevel detectSimdLevel()
+        {
+#if GTI320_SIMD
+#if defined(_MSC_VER) && !defined(__clang__)
+            int r[4];
+            __cpuid(r, 1);
+            const unsigned int ecx1 = (unsigned int)r[2];
+            __cpuidex(r, 7, 0);
+            const unsigned int ebx7 = (unsigned int)r[1];
+#else
+            unsigned int eax, ebx, ecx, edx, ecx1, ebx7 = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx1, &edx))
+                return SimdSSE2;
+            if (__get_cpuid_max(0, nullptr) >= 7) {
+                __cpuid_count(7, 0, eax, ebx7, ecx, edx);
+            }
+#endif
+            const bool osxsave = (ecx1 & (1u << 27)) != 0;
+            const bool avx = (ecx1 & (1u << 28)) != 0;
+            const bool fma = (ecx1 & (1u << 12)) != 0;
+            if (!osxsave || !avx || !fma)
+                return SimdSSE2;
+
+            // Registres sauvegardés par le système : XMM, YMM (bits 1-2),
+            // puis masques et ZMM (bits 5-7).
+#if defined(_MSC_VER) && !defined(__clang__)
+            const unsigned long long xcr0 = _xgetbv(0);
+#else
+            unsigned int lo, hi;
+            __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+            const unsigned long long xcr0 = ((unsigned long long)hi << 32) | lo;
+#endif
+            const bool avx2 = (ebx7 & (1u << 5)) != 0;
+            const bool avx512f = (ebx7 & (1u << 16)) != 0;
+            if ((xcr0 & 0x6) != 0x6 || !avx2)
+                return SimdSSE2;
+            if (avx512f && (xcr0 & 0xe6) == 0xe6)
+                return SimdAVX512;
+            return SimdAVX2;
+#else
+            return SimdScalar;
+#endif
+        }
+
+        inline SimdLevel supportedSimdLevelCache()
+        {
+            static const SimdLevel s_level = detectSimdLevel();
+            return s_level;
+        }
+
+        inline int& simdLevelSetting()
+        {
+            static int s_level = supportedSimdLevelCache();
+            return s_level;
+        }
+    }
+
+    /**
+     * Niveau le plus large utilisable sur cette machine.
+     */
+    inline SimdLevel supportedSimdLevel()
+    {
+        return internal::supportedSimdLevelCache();
+    }
+
+    /**
+     * Niveau utilisé par les noyaux.
+     */
+    inline SimdLevel simdLevel()
+    {
+        return (SimdLevel)internal::simdLevelSetting();
+    }
+
+    /**
+     * Restreint les noyaux à `level` (au plus supportedSimdLevel()).
+     */
+    inline void setSimdLevel(SimdLevel level)
+    {
+        internal::simdLevelSetting() = level < supportedSimdLevel() ? level : supportedSimdLevel();
+    }
+
+    namespace internal
+    {
+        namespace simd
+        {
+            /**
+             * Versions portables, pour tous les types.
+             */
+            namespace scalar
+            {
+                template<typename _Scalar>
+                inline _Scalar dot(Index n, const _Scalar* x, const _Scalar* y)
+                {
+                    _Scalar sum = _Scalar(0);
+                    for (Index i = 0; i < n; ++i) {
+                        sum += x[i] * y[i];
+                    }
+                    return sum;
+                }
+
+                template<typename _Scalar>
+                inline void axpy(Index n, _Scalar a, const _Scalar* x, _Scalar* y)
+                {
+                    for (Index i = 0; i < n; ++i) {
+                        y[i] += a * x[i];
+                    }
+                }
+
+                template<typename _Scalar>
+                inline void axpby(Index n, _Scalar a, const _Scalar* x, _Scalar b, _Scalar* y)
+                {
+                    for (Index i = 0; i < n; ++i) {
+                        y[i] = a * x[i] + b * y[i];
+                    }
+                }
+
+                template<typename _Scalar>
+                inline void scale(Index n, _Scalar a, const _Scalar* x, _Scalar* y)
+                {
+                    for (Index i = 0; i < n; ++i) {
+                        y[i] = a * x[i];
+                    }
+                }
+
+                template<typename _Scalar>
+                inline void add(Index n, const _Scalar* x, const _Scalar* y, _Scalar* z)
+                {
+                    for (Index i = 0; i < n; ++i) {
+                        z[i] = x[i] + y[i];
+                    }
+                }
+            }
+
+#if GTI320_SIMD
+            /**
+             * SSE2 : toujours présent sur x86-64.
+             */
+            namespace sse2
+            {
+                inline double hsum(__m128d a)
+                {
+                    return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a)));
+                }
+
+                inline float hsum(__m128 a)
+                {
+                    a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+                    return _mm_cvtss_f32(_mm_add_ss(a, _mm_shuffle_ps(a, a, 1)));
+                }
+
+                inline double dot(Index n, const double* x, const double* y)
+                {
+                    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd(), s3 = _mm_setzero_pd();
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+                        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+                        s2 = _mm_add_pd(s2, _mm_mul_pd(_mm_loadu_pd(x + i + 4), _mm_loadu_pd(y + i + 4)));
+                        s3 = _mm_add_pd(s3, _mm_mul_pd(_mm_loadu_pd(x + i + 6), _mm_loadu_pd(y + i + 6)));
+                    }
+                    for (; i + 2 <= n; i += 2) {
+                        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+                    }
+                    double sum = hsum(_mm_add_pd(_mm_add_pd(s0, s1), _mm_add_pd(s2, s3)));
+                    for (; i < n; ++i) {
+                        sum += x[i] * y[i];
+                    }
+                    return sum;
+                }
+
+                inline float dot(Index n, const float* x, const float* y)
+                {
+                    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps(), s2 = _mm_setzero_ps(), s3 = _mm_setzero_ps();
+                    Index i = 0;
+                    for (; i + 16 <= n; i += 16) {
+                        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+                        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+                        s2 = _mm_add_ps(s2, _mm_mul_ps(_mm_loadu_ps(x + i + 8), _mm_loadu_ps(y + i + 8)));
+                        s3 = _mm_add_ps(s3, _mm_mul_ps(_mm_loadu_ps(x + i + 12), _mm_loadu_ps(y + i + 12)));
+                    }
+                    for (; i + 4 <= n; i += 4) {
+                        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+                    }
+                    float sum = hsum(_mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+                    for (; i < n; ++i) {
+                        sum += x[i] * y[i];
+                    }
+                    return sum;
+                }
+
+                inline void axpy(Index n, double a, const double* x, double* y)
+                {
+                    const __m128d va = _mm_set1_pd(a);
+                    Index i = 0;
+                    for (; i + 4 <= n; i += 4) {
+                        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+                        _mm_storeu_pd(y + i + 2, _mm_add_pd(_mm_loadu_pd(y + i + 2), _mm_mul_pd(va, _mm_loadu_pd(x + i + 2))));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] += a * x[i];
+                    }
+                }
+
+                inline void axpy(Index n, float a, const float* x, float* y)
+                {
+                    const __m128 va = _mm_set1_ps(a);
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(va, _mm_loadu_ps(x + i))));
+                        _mm_storeu_ps(y + i + 4, _mm_add_ps(_mm_loadu_ps(y + i + 4), _mm_mul_ps(va, _mm_loadu_ps(x + i + 4))));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] += a * x[i];
+                    }
+                }
+
+                inline void axpby(Index n, double a, const double* x, double b, double* y)
+                {
+                    const __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b);
+                    Index i = 0;
+                    for (; i + 2 <= n; i += 2) {
+                        _mm_storeu_pd(y + i, _mm_add_pd(_mm_mul_pd(va, _mm_loadu_pd(x + i)), _mm_mul_pd(vb, _mm_loadu_pd(y + i))));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] = a * x[i] + b * y[i];
+                    }
+                }
+
+                inline void axpby(Index n, float a, const float* x, float b, float* y)
+                {
+                    const __m128 va = _mm_set1_ps(a), vb = _mm_set1_ps(b);
+                    Index i = 0;
+                    for (; i + 4 <= n; i += 4) {
+                        _mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(va, _mm_loadu_ps(x + i)), _mm_mul_ps(vb, _mm_loadu_ps(y + i))));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] = a * x[i] + b * y[i];
+                    }
+                }
+
+                inline void scale(Index n, double a, const double* x, double* y)
+                {
+                    const __m128d va = _mm_set1_pd(a);
+                    Index i = 0;
+                    for (; i + 2 <= n; i += 2) {
+                        _mm_storeu_pd(y + i, _mm_mul_pd(va, _mm_loadu_pd(x + i)));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] = a * x[i];
+                    }
+                }
+
+                inline void scale(Index n, float a, const float* x, float* y)
+                {
+                    const __m128 va = _mm_set1_ps(a);
+                    Index i = 0;
+                    for (; i + 4 <= n; i += 4) {
+                        _mm_storeu_ps(y + i, _mm_mul_ps(va, _mm_loadu_ps(x + i)));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] = a * x[i];
+                    }
+                }
+
+                inline void add(Index n, const double* x, const double* y, double* z)
+                {
+                    Index i = 0;
+                    for (; i + 2 <= n; i += 2) {
+                        _mm_storeu_pd(z + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+                    }
+                    for (; i < n; ++i) {
+                        z[i] = x[i] + y[i];
+                    }
+                }
+
+                inline void add(Index n, const float* x, const float* y, float* z)
+                {
+                    Index i = 0;
+                    for (; i + 4 <= n; i += 4) {
+                        _mm_storeu_ps(z + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+                    }
+                    for (; i < n; ++i) {
+                        z[i] = x[i] + y[i];
+                    }
+                }
+            }
+
+            /**
+             * AVX2 + FMA : registres de 256 bits.
+             */
+            namespace avx2
+            {
+                GTI320_TARGET_AVX2 inline double hsum(__m256d a)
+                {
+                    const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+                    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+                }
+
+                GTI320_TARGET_AVX2 inline float hsum(__m256 a)
+                {
+                    __m128 s = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+                    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+                    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+                }
+
+                GTI320_TARGET_AVX2 inline double dot(Index n, const double* x, const double* y)
+                {
+                    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+                    Index i = 0;
+                    for (; i + 16 <= n; i += 16) {
+                        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+                        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), s1);
+                        s2 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 8), _mm256_loadu_pd(y + i + 8), s2);
+                        s3 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 12), _mm256_loadu_pd(y + i + 12), s3);
+                    }
+                    for (; i + 4 <= n; i += 4) {
+                        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+                    }
+                    double sum = hsum(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+                    for (; i < n; ++i) {
+                        sum += x[i] * y[i];
+                    }
+                    return sum;
+                }
+
+                GTI320_TARGET_AVX2 inline float dot(Index n, const float* x, const float* y)
+                {
+                    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+                    Index i = 0;
+                    for (; i + 32 <= n; i += 32) {
+                        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), s0);
+                        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), s1);
+                        s2 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 16), _mm256_loadu_ps(y + i + 16), s2);
+                        s3 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 24), _mm256_loadu_ps(y + i + 24), s3);
+                    }
+                    for (; i + 8 <= n; i += 8) {
+                        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), s0);
+                    }
+                    float sum = hsum(_mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+                    for (; i < n; ++i) {
+                        sum += x[i] * y[i];
+                    }
+                    return sum;
+                }
+
+                GTI320_TARGET_AVX2 inline void axpy(Index n, double a, const double* x, double* y)
+                {
+                    const __m256d va = _mm256_set1_pd(a);
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+                        _mm256_storeu_pd(y + i + 4, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] += a * x[i];
+                    }
+                }
+
+                GTI320_TARGET_AVX2 inline void axpy(Index n, float a, const float* x, float* y)
+                {
+                    const __m256 va = _mm256_set1_ps(a);
+                    Index i = 0;
+                    for (; i + 16 <= n; i += 16) {
+                        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+                        _mm256_storeu_ps(y + i + 8, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8)));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] += a * x[i];
+                    }
+                }
+
+                GTI320_TARGET_AVX2 inline void axpby(Index n, double a, const double* x, double b, double* y)
+                {
+                    const __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+                    Index i = 0;
+                    for (; i + 4 <= n; i += 4) {
+                        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_mul_pd(vb, _mm256_loadu_pd(y + i))));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] = a * x[i] + b * y[i];
+                    }
+                }
+
+                GTI320_TARGET_AVX2 inline void axpby(Index n, float a, const float* x, float b, float* y)
+                {
+                    const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_mul_ps(vb, _mm256_loadu_ps(y + i))));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] = a * x[i] + b * y[i];
+                    }
+                }
+
+                GTI320_TARGET_AVX2 inline void scale(Index n, double a, const double* x, double* y)
+                {
+                    const __m256d va = _mm256_set1_pd(a);
+                    Index i = 0;
+                    for (; i + 4 <= n; i += 4) {
+                        _mm256_storeu_pd(y + i, _mm256_mul_pd(va, _mm256_loadu_pd(x + i)));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] = a * x[i];
+                    }
+                }
+
+                GTI320_TARGET_AVX2 inline void scale(Index n, float a, const float* x, float* y)
+                {
+                    const __m256 va = _mm256_set1_ps(a);
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm256_storeu_ps(y + i, _mm256_mul_ps(va, _mm256_loadu_ps(x + i)));
+                    }
+                    for (; i < n; ++i) {
+                        y[i] = a * x[i];
+                    }
+                }
+
+                GTI320_TARGET_AVX2 inline void add(Index n, const double* x, const double* y, double* z)
+                {
+                    Index i = 0;
+                    for (; i + 4 <= n; i += 4) {
+                        _mm256_storeu_pd(z + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+                    }
+                    for (; i < n; ++i) {
+                        z[i] = x[i] + y[i];
+                    }
+                }
+
+                GTI320_TARGET_AVX2 inline void add(Index n, const float* x, const float* y, float* z)
+                {
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm256_storeu_ps(z + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+                    }
+                    for (; i < n; ++i) {
+                        z[i] = x[i] + y[i];
+                    }
+                }
+            }
+
+            /**
+             * AVX-512F : registres de 512 bits ; les restes sont traités
+             * avec des chargements et des écritures masqués.
+             */
+            namespace avx512
+            {
+                GTI320_TARGET_AVX512 inline __mmask8 tail8(Index count) { return (__mmask8)((1u << count) - 1u); }
+                GTI320_TARGET_AVX512 inline __mmask16 tail16(Index count) { return (__mmask16)((1u << count) - 1u); }
+
+                // Somme horizontale par un tampon : les intrinsèques d'extraction
+                // de GCC 12 déclenchent -Wuninitialized sous l'attribut target.
+                GTI320_TARGET_AVX512 inline double hsum(__m512d a)
+                {
+                    double t[8];
+                    _mm512_storeu_pd(t, a);
+                    return ((t[0] + t[4]) + (t[2] + t[6])) + ((t[1] + t[5]) + (t[3] + t[7]));
+                }
+
+                GTI320_TARGET_AVX512 inline float hsum(__m512 a)
+                {
+                    float t[16];
+                    _mm512_storeu_ps(t, a);
+                    for (int k = 0; k < 8; ++k) {
+                        t[k] += t[k + 8];
+                    }
+                    return ((t[0] + t[4]) + (t[2] + t[6])) + ((t[1] + t[5]) + (t[3] + t[7]));
+                }
+
+                GTI320_TARGET_AVX512 inline double dot(Index n, const double* x, const double* y)
+                {
+                    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd(), s2 = _mm512_setzero_pd(), s3 = _mm512_setzero_pd();
+                    Index i = 0;
+                    for (; i + 32 <= n; i += 32) {
+                        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), s0);
+                        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), s1);
+                        s2 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 16), _mm512_loadu_pd(y + i + 16), s2);
+                        s3 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 24), _mm512_loadu_pd(y + i + 24), s3);
+                    }
+                    for (; i + 8 <= n; i += 8) {
+                        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), s0);
+                    }
+                    if (i < n) {
+                        const __mmask8 m = tail8(n - i);
+                        s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, y + i), s1);
+                    }
+                    return hsum(_mm512_add_pd(_mm512_add_pd(s0, s1), _mm512_add_pd(s2, s3)));
+                }
+
+                GTI320_TARGET_AVX512 inline float dot(Index n, const float* x, const float* y)
+                {
+                    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps(), s2 = _mm512_setzero_ps(), s3 = _mm512_setzero_ps();
+                    Index i = 0;
+                    for (; i + 64 <= n; i += 64) {
+                        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+                        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), s1);
+                        s2 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 32), _mm512_loadu_ps(y + i + 32), s2);
+                        s3 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 48), _mm512_loadu_ps(y + i + 48), s3);
+                    }
+                    for (; i + 16 <= n; i += 16) {
+                        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+                    }
+                    if (i < n) {
+                        const __mmask16 m = tail16(n - i);
+                        s1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, x + i), _mm512_maskz_loadu_ps(m, y + i), s1);
+                    }
+                    return hsum(_mm512_add_ps(_mm512_add_ps(s0, s1), _mm512_add_ps(s2, s3)));
+                }
+
+                GTI320_TARGET_AVX512 inline void axpy(Index n, double a, const double* x, double* y)
+                {
+                    const __m512d va = _mm512_set1_pd(a);
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+                    }
+                    if (i < n) {
+                        const __mmask8 m = tail8(n - i);
+                        _mm512_mask_storeu_pd(y + i, m, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, y + i)));
+                    }
+                }
+
+                GTI320_TARGET_AVX512 inline void axpy(Index n, float a, const float* x, float* y)
+                {
+                    const __m512 va = _mm512_set1_ps(a);
+                    Index i = 0;
+                    for (; i + 16 <= n; i += 16) {
+                        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+                    }
+                    if (i < n) {
+                        const __mmask16 m = tail16(n - i);
+                        _mm512_mask_storeu_ps(y + i, m, _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, x + i), _mm512_maskz_loadu_ps(m, y + i)));
+                    }
+                }
+
+                GTI320_TARGET_AVX512 inline void axpby(Index n, double a, const double* x, double b, double* y)
+                {
+                    const __m512d va = _mm512_set1_pd(a), vb = _mm512_set1_pd(b);
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_mul_pd(vb, _mm512_loadu_pd(y + i))));
+                    }
+                    if (i < n) {
+                        const __mmask8 m = tail8(n - i);
+                        _mm512_mask_storeu_pd(y + i, m, _mm512_fmadd_pd(va, _mm512_maskz_loadu_pd(m, x + i), _mm512_mul_pd(vb, _mm512_maskz_loadu_pd(m, y + i))));
+                    }
+                }
+
+                GTI320_TARGET_AVX512 inline void axpby(Index n, float a, const float* x, float b, float* y)
+                {
+                    const __m512 va = _mm512_set1_ps(a), vb = _mm512_set1_ps(b);
+                    Index i = 0;
+                    for (; i + 16 <= n; i += 16) {
+                        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_mul_ps(vb, _mm512_loadu_ps(y + i))));
+                    }
+                    if (i < n) {
+                        const __mmask16 m = tail16(n - i);
+                        _mm512_mask_storeu_ps(y + i, m, _mm512_fmadd_ps(va, _mm512_maskz_loadu_ps(m, x + i), _mm512_mul_ps(vb, _mm512_maskz_loadu_ps(m, y + i))));
+                    }
+                }
+
+                GTI320_TARGET_AVX512 inline void scale(Index n, double a, const double* x, double* y)
+                {
+                    const __m512d va = _mm512_set1_pd(a);
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm512_storeu_pd(y + i, _mm512_mul_pd(va, _mm512_loadu_pd(x + i)));
+                    }
+                    if (i < n) {
+                        const __mmask8 m = tail8(n - i);
+                        _mm512_mask_storeu_pd(y + i, m, _mm512_mul_pd(va, _mm512_maskz_loadu_pd(m, x + i)));
+                    }
+                }
+
+                GTI320_TARGET_AVX512 inline void scale(Index n, float a, const float* x, float* y)
+                {
+                    const __m512 va = _mm512_set1_ps(a);
+                    Index i = 0;
+                    for (; i + 16 <= n; i += 16) {
+                        _mm512_storeu_ps(y + i, _mm512_mul_ps(va, _mm512_loadu_ps(x + i)));
+                    }
+                    if (i < n) {
+                        const __mmask16 m = tail16(n - i);
+                        _mm512_mask_storeu_ps(y + i, m, _mm512_mul_ps(va, _mm512_maskz_loadu_ps(m, x + i)));
+                    }
+                }
+
+                GTI320_TARGET_AVX512 inline void add(Index n, const double* x, const double* y, double* z)
+                {
+                    Index i = 0;
+                    for (; i + 8 <= n; i += 8) {
+                        _mm512_storeu_pd(z + i, _mm512_add_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+                    }
+                    if (i < n) {
+                        const __mmask8 m = tail8(n - i);
+                        _mm512_mask_storeu_pd(z + i, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, x + i), _mm512_maskz_loadu_pd(m, y + i)));
+                    }
+                }
+
+                GTI320_TARGET_AVX512 inline void add(Index n, const float* x, const float* y, float* z)
+                {
+                    Index i = 0;
+                    for (; i + 16 <= n; i += 16) {
+                        _mm512_storeu_ps(z + i, _mm512_add_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+                    }
+                    if (i < n) {
+                        const __mmask16 m = tail16(n - i);
+                        _mm512_mask_storeu_ps(z + i, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, x + i), _mm512_maskz_loadu_ps(m, y + i)));
+                    }
+                }
+            }
+#endif
+        }
+
+        /**
+         * Table des noyaux d'un niveau.
+         */
+        template<typename _Scalar>
+        struct SimdKernels
+        {
+            _Scalar (*dot)(Index, const _Scalar*, const _Scalar*);
+            void (*axpy)(Index, _Scalar, const _Scalar*, _Scalar*);
+            void (*axpby)(Index, _Scalar, const _Scalar*, _Scalar, _Scalar*);
+            void (*scale)(Index, _Scalar, const _Scalar*, _Scalar*);
+            void (*add)(Index, const _Scalar*, const _Scalar*, _Scalar*);
+        };
+
+        /**
+         * Tables de tous les niveaux. Pour les types autres que float et
+         * double, tous les niveaux utilisent les versions scalaires.
+         */
+        template<typename _Scalar, bool _Vectorized = std::is_same<_Scalar, float>::value || std::is_same<_Scalar, double>::value>
+        struct SimdKernelTables
+        {
+            static const SimdKernels<_Scalar>& get(SimdLevel)
+            {
+                static const SimdKernels<_Scalar> s_scalar = { &simd::scalar::dot<_Scalar>, &simd::scalar::axpy<_Scalar>, &simd::scalar::axpby<_Scalar>,
+                                                               &simd::scalar::scale<_Scalar>, &simd::scalar::add<_Scalar> };
+                return s_scalar;
+            }
+        };
+
+        template<typename _Scalar>
+        struct SimdKernelTables<_Scalar, true>
+        {
+            static const SimdKernels<_Scalar>& get(SimdLevel level)
+            {
+#if GTI320_SIMD
+                static const SimdKernels<_Scalar> s_sse2 = { &simd::sse2::dot, &simd::sse2::axpy, &simd::sse2::axpby, &simd::sse2::scale, &simd::sse2::add };
+                static const SimdKernels<_Scalar> s_avx2 = { &simd::avx2::dot, &simd::avx2::axpy, &simd::avx2::axpby, &simd::avx2::scale, &simd::avx2::add };
+                static const SimdKernels<_Scalar> s_avx512 = { &simd::avx512::dot, &simd::avx512::axpy, &simd::avx512::axpby, &simd::avx512::scale, &simd::avx512::add };
+                switch (level) {
+                case SimdSSE2: return s_sse2;
+                case SimdAVX2: return s_avx2;
+                case SimdAVX512: return s_avx512;
+                default: break;
+                }
+#endif
+                return SimdKernelTables<_Scalar, false>::get(level);
+            }
+        };
+
+        /**
+         * Noyaux d'un niveau donné (au plus supportedSimdLevel()).
+         */
+        template<typename _Scalar>
+        inline const SimdKernels<_Scalar>& simdKernels(SimdLevel level)
+        {
+            assert(level <= supportedSimdLevel());
+            return SimdKernelTables<_Scalar>::get(level);
+        }
+
+        /**
+         * Noyaux du niveau courant (simdLevel()).
+         */
+        template<typename _Scalar>
+        inline const SimdKernels<_Scalar>& simdKernels()
+        {
+            return simdKernels<_Scalar>(simdLevel());
+        }
+
+        /**
+         * Points d'entrée des opérateurs. Les versions génériques acceptent
+         * des types différents (par exemple une vue `const`) ; elles passent
+         * par la table lorsque les types coïncident.
+         */
+        template<typename _Scalar, typename _ScalarX, typename _ScalarY>
+        inline _Scalar dot(Index n, const _ScalarX* x, const _ScalarY* y)
+        {
+            _Scalar sum = _Scalar(0);
+            for (Index i = 0; i < n; ++i) {
+                sum += x[i] * y[i];
+            }
+            return sum;
+        }
+
+        template<typename _Scalar>
+        inline _Scalar dot(Index n, const _Scalar* x, const _Scalar* y)
+        {
+            return simdKernels<_Scalar>().dot(n, x, y);
+        }
+
+        template<typename _Scalar, typename _ScalarX>
+        inline void axpy(Index n, _Scalar a, const _ScalarX* x, _Scalar* y)
+        {
+            for (Index i = 0; i < n; ++i) {
+                y[i] += a * x[i];
+            }
+        }
+
+        template<typename _Scalar>
+        inline void axpy(Index n, _Scalar a, const _Scalar* x, _Scalar* y)
+        {
+            simdKernels<_Scalar>().axpy(n, a, x, y);
+        }
+
+        template<typename _Scalar, typename _ScalarX>
+        inline void axpby(Index n, _Scalar a, const _ScalarX* x, _Scalar b, _Scalar* y)
+        {
+            for (Index i = 0; i < n; ++i) {
+                y[i] = a * x[i] + b * y[i];
+            }
+        }
+
+        template<typename _Scalar>
+        inline void axpby(Index n, _Scalar a, const _Scalar* x, _Scalar b, _Scalar* y)
+        {
+            simdKernels<_Scalar>().axpby(n, a, x, b, y);
+        }
+
+        template<typename _Scalar, typename _ScalarX>
+        inline void scale(Index n, _Scalar a, const _ScalarX* x, _Scalar* y)
+        {
+            for (Index i = 0; i < n; ++i) {
+                y[i] = a * x[i];
+            }
+        }
+
+        template<typename _Scalar>
+        inline void scale(Index n, _Scalar a, const _Scalar* x, _Scalar* y)
+        {
+            simdKernels<_Scalar>().scale(n, a, x, y);
+        }
+
+        template<typename _ScalarX, typename _ScalarY, typename _Scalar>
+        inline void add(Index n, const _ScalarX* x, const _ScalarY* y, _Scalar* z)
+        {
+            for (Index i = 0; i < n; ++i) {
+                z[i] = x[i] + y[i];
+            }
+        }
+
+        template<typename _Scalar>
+        inline void add(Index n, const _Scalar* x, const _Scalar* y, _Scalar* z)
+        {
+            simdKernels<_Scalar>().add(n, x, y, z);
+        }
+    }
+}
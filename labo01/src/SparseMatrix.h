@@ -14,26 +14,49 @@
  */
 
 #include "SparseMatrixBase.h"
+#include "Parallel.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cassert>
+#include <memory>
+#include <mutex>
 #include <vector>
+#include <utility>
+
+#ifndef GTI320_SPARSE_LINEAR_SEARCH
+#define GTI320_SPARSE_LINEAR_SEARCH 8
+#endif
 
 namespace gti320
 {
 
     // Matrice creuse de type compressed row storage (CRS) sparse matrix avec taille dynamique.
     //
+    // Invariant : dans chaque ligne, les indices de colonne sont distincts et
+    // en ordre croissant (établi par setFromTriplets() et setIdentity()).
+    //
+    // Le tableau des débuts de lignes (outer()) compte rows() + 1 entrées :
+    // la ligne i occupe les positions [outer()[i], outer()[i + 1]) et la
+    // dernière entrée vaut getInnerSize().
+    //
     template <typename _Scalar = double, int _ColsAtCompile = Dynamic, int _RowsAtCompile = Dynamic>
     class SparseMatrix : public SparseMatrixBase<_Scalar, _ColsAtCompile, _RowsAtCompile>
     {
     private:
-        unsigned int m_rows, m_cols;
+        Index m_rows, m_cols;
+
+        // Tranches de lignes de coût équilibré (voir rowPartition()),
+        // recalculées après toute modification de la structure. Un
+        // découpage publié n'est jamais modifié : il est remplacé.
+        mutable std::shared_ptr<const std::vector<Index> > m_split;
+        mutable std::mutex m_splitMutex;
+
     public:
 
         // Constructeur par d�faut
         SparseMatrix() :
-            SparseMatrixBase<_Scalar, Dynamic, Dynamic>(),
+            SparseMatrixBase<_Scalar, Dynamic, Dynamic>(1, 0),
             m_rows(0), m_cols(0)
         { }
 
@@ -43,49 +66,113 @@ namespace gti320
             m_rows(other.m_rows), m_cols(other.m_cols)
         { }
 
+        // Constructeur de déplacement
+        SparseMatrix(SparseMatrix&& other) noexcept :
+            SparseMatrixBase<_Scalar, Dynamic, Dynamic>(std::move(other)),
+            m_rows(other.m_rows), m_cols(other.m_cols)
+        {
+            other.m_rows = 0;
+            other.m_cols = 0;
+            other.invalidatePartition();
+        }
+
         // Constructeur avec des dimensions
-        explicit SparseMatrix(int _rows, int _cols) :
-            SparseMatrixBase<_Scalar, Dynamic, Dynamic>(_rows, 0),
+        explicit SparseMatrix(Index _rows, Index _cols) :
+            SparseMatrixBase<_Scalar, Dynamic, Dynamic>(_rows + 1, 0),
             m_rows(_rows), m_cols(_cols)
         { }
 
         // Destructeur
         ~SparseMatrix() { }
 
+        // Opérateur de copie
+        SparseMatrix& operator=(const SparseMatrix& other)
+        {
+            if (this != &other)
+            {
+                SparseMatrixBase<_Scalar, Dynamic, Dynamic>::operator=(other);
+                m_rows = other.m_rows;
+                m_cols = other.m_cols;
+                invalidatePartition();
+            }
+            return *this;
+        }
+
+        // Opérateur de déplacement
+        SparseMatrix& operator=(SparseMatrix&& other) noexcept
+        {
+            if (this != &other)
+            {
+                SparseMatrixBase<_Scalar, Dynamic, Dynamic>::operator=(std::move(other));
+                m_rows = other.m_rows;
+                m_cols = other.m_cols;
+                other.m_rows = 0;
+                other.m_cols = 0;
+                invalidatePartition();
+                other.invalidatePartition();
+            }
+            return *this;
+        }
+
 
         // Il faut cette fonction
-        // TODO access operator (read-only)
-        _Scalar operator()(int i, int j) const
+        // Coefficient (i, j), 0 s'il est hors de la structure creuse.
+        _Scalar operator()(Index i, Index j) const
+        {
+            const Index k = find(i, j);
+            return k < 0 ? _Scalar(0) : this->m_vals[k];
+        }
+
+        // Référence vers le coefficient (i, j), qui doit faire partie de la
+        // structure creuse (voir find()) : la structure n'est jamais modifiée.
+        _Scalar& coeffRef(Index i, Index j)
+        {
+            const Index k = find(i, j);
+            assert(k >= 0 && "coefficient hors de la structure creuse");
+            return this->m_vals[k];
+        }
+
+        // Position de (i, j) dans values() et inner(), -1 si le coefficient
+        // est hors de la structure creuse.
+        //
+        // Les colonnes de chaque ligne sont en ordre croissant (voir
+        // setFromTriplets()) : une ligne courte est parcourue, une ligne de
+        // plus de GTI320_SPARSE_LINEAR_SEARCH entrées est d'abord bornée par
+        // bonds doublés depuis son début (recherche galopante), puis l'entrée
+        // est cherchée par dichotomie entre ces bornes. Le coût est
+        // O(log d), où d est le rang de la colonne j dans la ligne.
+        Index find(Index i, Index j) const
         {
-            // TODO : impl�menter
             assert(i >= 0 && i < m_rows);
             assert(j >= 0 && j < m_cols);
 
-            const  int row = i;
-            const int col = j;
+            const Index* inner = this->m_inner.data();
+            Index begin = this->m_start[i];
+            Index end = this->m_start[i + 1];
 
-            const unsigned int begin = this->m_start[row];
-            int end;
-
-            if (row + 1 < m_rows) {
-                 end = this->m_start[row + 1];
-            }
-            else {
-                end = this->m_vals.size();
+            if (end - begin > GTI320_SPARSE_LINEAR_SEARCH)
+            {
+                Index step = 1;
+                while (begin + step < end && inner[begin + step] < j)
+                {
+                    begin += step;
+                    step *= 2;
+                }
+                if (begin + step < end)
+                    end = begin + step + 1;
+                begin = std::lower_bound(inner + begin, inner + end, j) - inner;
             }
-
-            for (int k = begin; k < end; ++k)
+            else
             {
-                if (this->m_inner[k] == col)
-                    return this->m_vals[k];
+                while (begin < end && inner[begin] < j)
+                    ++begin;
             }
-
-            return 0.0;
+            return (begin < end && inner[begin] == j) ? begin : -1;
         }
 
-        unsigned int rows() const { return m_rows; }
+        Index rows() const { return m_rows; }
 
-        unsigned int cols() const { return m_cols; }
+        Index cols() const { return m_cols; }
 
         // Set this matrix to the identity matrix.
         void setIdentity()
@@ -95,14 +182,16 @@ namespace gti320
 
             assert(m_rows == m_cols);
 
-            const unsigned int n = m_rows;
+            const Index n = m_rows;
 
             this->m_vals.resize(n);
             this->m_inner.resize(n);
-            this->m_start.resize(n);
+            this->m_start.resize(n + 1);
             this->m_start.setZero();
+            this->m_start[n] = n;
+            invalidatePartition();
 
-            for (unsigned int i = 0; i < n; ++i)
+            for (Index i = 0; i < n; ++i)
             {
                 this->m_start[i] = i;
                 this->m_vals[i] = _Scalar(1);
@@ -111,60 +200,241 @@ namespace gti320
 
         }
 
-        void setFromTriplets(TripletType<_Scalar>* _triplets, unsigned int _size) {
+        // Construit la matrice à partir de `_size` triplets (i, j, val), en
+        // O(nnz + rows) : un tri par dénombrement stable groupe les entrées
+        // par ligne, puis chaque ligne est triée par colonne (tri stable,
+        // les lignes sont courtes) et les entrées répétées (i, j) sont
+        // additionnées dans l'ordre des triplets. Le nombre de colonnes
+        // n'intervient ni dans le temps ni dans la mémoire.
+        //
+        // Au-delà de GTI320_PARALLEL_MIN_WORK triplets par fil, le tri par
+        // lignes est réparti sur la réserve de fils : chaque tranche de
+        // triplets a son propre histogramme (rows() entrées), et les décalages
+        // sont calculés dans l'ordre (ligne, tranche). Le tri et la fusion de
+        // chaque ligne sont eux aussi répartis par lignes. Le résultat est
+        // identique au calcul séquentiel.
+        void setFromTriplets(const TripletType<_Scalar>* _triplets, Index _size)
+        {
             assert((_triplets != nullptr) || (_size == 0));
 
-            this->m_vals.resize(_size);
-            this->m_inner.resize(_size);
-            this->m_start.resize(m_rows);
+            this->m_start.resize(m_rows + 1);
             this->m_start.setZero();
+            invalidatePartition();
 
             if (m_rows == 0 || m_cols == 0 || _size == 0)
+            {
+                this->setInnerSize(0);
                 return;
+            }
 
-            for (unsigned int r = 0; r < m_rows; ++r)
+            int parts = parallelThreads();
+            const Index grain = parallelGrain(1.0);
+            if (_size / grain < parts)
+                parts = (int)(_size / grain);
+            if (parts < 1)
+                parts = 1;
+
+            // Passe 1 : entrées (colonne, valeur) groupées par ligne, dans
+            // l'ordre des triplets.
+            typedef std::pair<Index, _Scalar> Entry;
+            std::vector<Entry> entries((size_t)_size);
+            std::vector<Index> rowBegin((size_t)m_rows + 1);
             {
-                unsigned int countBefore = 0;
+                std::vector<Index> histogram((size_t)parts * (size_t)m_rows);
+                countingSort(parts, _size, m_rows, histogram,
+                    [_triplets](Index t) { return _triplets[t].i; },
+                    [this, _triplets, &entries](Index t, Index pos) {
+                        const TripletType<_Scalar>& triplet = _triplets[t];
+                        assert(0 <= triplet.j && triplet.j < m_cols);
+                        entries[(size_t)pos] = Entry(triplet.j, triplet.val);
+                    }, &rowBegin);
+            }
 
-                for (unsigned int t = 0; t < _size; ++t)
+            // Passe 2 : tri de chaque ligne par colonne, puis décompte des
+            // colonnes distinctes.
+            const Index rowGrain = parallelGrain((double)_size / (double)m_rows);
+            std::vector<Index> distinct((size_t)m_rows);
+            parallel_for(m_rows, [&](Index first, Index last) {
+                for (Index r = first; r < last; ++r)
                 {
-                    const unsigned int row = _triplets[t].i;
-                    const unsigned int col = _triplets[t].j;
+                    Entry* row = entries.data() + rowBegin[(size_t)r];
+                    const Index n = rowBegin[(size_t)r + 1] - rowBegin[(size_t)r];
+                    sortByColumn(row, n);
 
-                    assert(row < m_rows);
-                    assert(col < m_cols);
+                    Index count = 0;
+                    for (Index k = 0; k < n; ++k)
+                    {
+                        if (k == 0 || row[k].first != row[k - 1].first)
+                            ++count;
+                    }
+                    distinct[(size_t)r] = count;
+                }
+            }, rowGrain);
 
-                    if (row < r)
-                        countBefore++;
+            Index nnz = 0;
+            for (Index r = 0; r < m_rows; ++r)
+            {
+                this->m_start[r] = nnz;
+                nnz += distinct[(size_t)r];
+            }
+            this->m_start[m_rows] = nnz;
+            this->setInnerSize(nnz);
+
+            Index* inner = this->m_inner.data();
+            _Scalar* values = this->m_vals.data();
+            const Index* start = this->m_start.data();
+            parallel_for(m_rows, [&](Index first, Index last) {
+                for (Index r = first; r < last; ++r)
+                {
+                    Index pos = start[r] - 1;
+                    for (Index k = rowBegin[(size_t)r]; k < rowBegin[(size_t)r + 1]; ++k)
+                    {
+                        const Entry& entry = entries[(size_t)k];
+                        if (k == rowBegin[(size_t)r] || entry.first != entries[(size_t)k - 1].first)
+                        {
+                            ++pos;
+                            inner[pos] = entry.first;
+                            values[pos] = entry.second;
+                        }
+                        else
+                        {
+                            values[pos] += entry.second;
+                        }
+                    }
                 }
+            }, rowGrain);
+        }
 
-                this->m_start[r] = countBefore;
+        // Bornes de `parts` tranches de lignes consécutives de coût à peu près
+        // égal : la tranche k couvre les lignes [split[k], split[k + 1]). Le
+        // coût d'une ligne est son nombre d'entrées plus un ; une ligne n'est
+        // jamais coupée.
+        //
+        // Le découpage est calculé au premier appel (O(parts * log rows)) et
+        // conservé dans la matrice jusqu'à la prochaine modification de la
+        // structure ou un appel avec un autre nombre de tranches. Le résultat
+        // est une référence partagée sur le découpage en cache (parts + 1
+        // entrées), qui n'est jamais modifié : un appel qui le remplace (autre
+        // nombre de tranches) ne touche pas au découpage qu'un produit
+        // concurrent est en train de lire. Un appel qui trouve le découpage
+        // en cache n'alloue rien ; le calcul d'un nouveau découpage est
+        // compté comme une allocation (voir Instrumentation.h).
+        std::shared_ptr<const std::vector<Index> > rowPartition(int parts) const
+        {
+            assert(parts > 0);
+            std::lock_guard<std::mutex> lock(m_splitMutex);
+            if (!m_split || m_split->size() != (size_t)parts + 1)
+            {
+                const Index* start = this->m_start.data();
+                const double cost = (double)(start[m_rows] + m_rows);
+                const size_t bytes = sizeof(Index) * ((size_t)parts + 1);
+                std::shared_ptr<std::vector<Index> > split(new std::vector<Index>((size_t)parts + 1),
+                    [bytes](std::vector<Index>* p) { internal::countFree(bytes); delete p; });
+                internal::countAllocation(bytes);
+                (*split)[0] = 0;
+                for (int k = 1; k < parts; ++k)
+                {
+                    // Première ligne r telle que start[r] + r >= k * cost / parts.
+                    const double target = cost * k / parts;
+                    Index lo = (*split)[(size_t)k - 1], hi = m_rows;
+                    while (lo < hi)
+                    {
+                        const Index mid = lo + (hi - lo) / 2;
+                        if ((double)(start[mid] + mid) < target)
+                            lo = mid + 1;
+                        else
+                            hi = mid;
+                    }
+                    (*split)[(size_t)k] = lo;
+                }
+                (*split)[(size_t)parts] = m_rows;
+                m_split = split;
             }
+            return m_split;
+        }
+
+    private:
 
-            unsigned int pos = 0;
+        void invalidatePartition()
+        {
+            std::lock_guard<std::mutex> lock(m_splitMutex);
+            m_split.reset();
+        }
 
-            for (unsigned int r = 0; r < m_rows; ++r)
+        // Tri stable des `_size` entrées d'une ligne par colonne : tri par
+        // insertion pour les lignes courtes (le cas courant), std::stable_sort
+        // au-delà.
+        template<typename _Entry>
+        static void sortByColumn(_Entry* _row, Index _size)
+        {
+            if (_size > 32)
             {
-                for (unsigned int t = 0; t < _size; ++t)
-                {
-                    const unsigned int row = _triplets[t].i;
-                    const unsigned int col = _triplets[t].j;
+                std::stable_sort(_row, _row + _size,
+                    [](const _Entry& a, const _Entry& b) { return a.first < b.first; });
+                return;
+            }
+            for (Index k = 1; k < _size; ++k)
+            {
+                const _Entry entry = _row[k];
+                Index q = k;
+                for (; q > 0 && entry.first < _row[q - 1].first; --q)
+                    _row[q] = _row[q - 1];
+                _row[q] = entry;
+            }
+        }
 
-                    assert(row < m_rows);
-                    assert(col < m_cols);
+        // Tri par dénombrement stable des éléments [0, _size) selon
+        // key(e) dans [0, _keys) : place(e, pos) reçoit la position de e.
+        // Chaque tranche (parmi `parts`) compte ses clés dans sa propre
+        // ligne de `histogram` ; si `begin` est fourni, il reçoit le début
+        // de chaque clé (et _size en dernière position).
+        template<typename _Key, typename _Place>
+        static void countingSort(int parts, Index _size, Index _keys, std::vector<Index>& histogram,
+            const _Key& key, const _Place& place, std::vector<Index>* begin = nullptr)
+        {
+            std::fill(histogram.begin(), histogram.begin() + (size_t)parts * (size_t)_keys, Index(0));
 
-                    if (row == r)
+            parallel_for(parts, [&](Index first, Index last) {
+                for (Index k = first; k < last; ++k)
+                {
+                    Index* count = histogram.data() + (size_t)k * (size_t)_keys;
+                    Index e0, e1;
+                    partition(_size, parts, (int)k, e0, e1);
+                    for (Index e = e0; e < e1; ++e)
                     {
-                        assert(pos < _size);
-
-                        this->m_vals[pos]  = _triplets[t].val;
-                        this->m_inner[pos] = col;
-                        pos++;
+                        const Index c = key(e);
+                        assert(0 <= c && c < _keys);
+                        ++count[c];
                     }
                 }
+            });
+
+            Index offset = 0;
+            for (Index c = 0; c < _keys; ++c)
+            {
+                if (begin != nullptr)
+                    (*begin)[(size_t)c] = offset;
+                for (int k = 0; k < parts; ++k)
+                {
+                    Index& count = histogram[(size_t)k * (size_t)_keys + (size_t)c];
+                    const Index n = count;
+                    count = offset;
+                    offset += n;
+                }
             }
+            if (begin != nullptr)
+                (*begin)[(size_t)_keys] = offset;
 
-            assert(pos == _size);
+            parallel_for(parts, [&](Index first, Index last) {
+                for (Index k = first; k < last; ++k)
+                {
+                    Index* next = histogram.data() + (size_t)k * (size_t)_keys;
+                    Index e0, e1;
+                    partition(_size, parts, (int)k, e0, e1);
+                    for (Index e = e0; e < e1; ++e)
+                        place(e, next[key(e)]++);
+                }
+            });
         }
 
     };
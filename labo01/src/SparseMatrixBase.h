@@ -13,6 +13,8 @@
 
 #include "DenseStorage.h"
 
+#include <utility>
+
 namespace gti320
 {
     // Classe de base pour une matrice creuse.
@@ -22,8 +24,8 @@ namespace gti320
     {
     protected:
         DenseStorage<_ScalarType, _InnerSize> m_vals;       // Stocke les coefficients de valeur non zro
-        DenseStorage<unsigned int, _InnerSize> m_inner;     // Stocke les indices de colonne des coefficients non zro
-        DenseStorage<unsigned int, _OuterSize> m_start;     // Stocke pour chaque ligne l'array index du premier lment non zro dans m_vals et m_inner
+        DenseStorage<Index, _InnerSize> m_inner;     // Stocke les indices de colonne des coefficients non zro
+        DenseStorage<Index, _OuterSize> m_start;     // Stocke pour chaque ligne l'array index du premier lment non zro dans m_vals et m_inner
 
     public:
 
@@ -33,8 +35,12 @@ namespace gti320
         // Copy constructor
         SparseMatrixBase(const SparseMatrixBase& other) : m_vals(other.m_vals), m_inner(other.m_inner), m_start(other.m_start) { }
 
+        // Move constructor
+        SparseMatrixBase(SparseMatrixBase&& other) noexcept :
+            m_vals(std::move(other.m_vals)), m_inner(std::move(other.m_inner)), m_start(std::move(other.m_start)) { }
+
         // Parameter constructor
-        SparseMatrixBase(int _outerSize, unsigned int _innerSize)
+        SparseMatrixBase(Index _outerSize, Index _innerSize)
         {
             // TODO : implmenter
             m_inner.resize(_innerSize);
@@ -60,26 +66,54 @@ namespace gti320
             return *this;
         }
 
-        void setInnerSize(unsigned int _nnz)
+        // Move assignment operator
+        SparseMatrixBase& operator=(SparseMatrixBase&& other) noexcept
+        {
+            if (this != &other)
+            {
+                m_vals = std::move(other.m_vals);
+                m_inner = std::move(other.m_inner);
+                m_start = std::move(other.m_start);
+            }
+            return *this;
+        }
+
+        void setInnerSize(Index _nnz)
         {
             // TODO : implmenter
             m_inner.resize(_nnz);
             m_vals.resize(_nnz);
         }
 
+        // Reserve room for @a _nnz non-zero coefficients. Subsequent calls to
+        // setInnerSize() that fit in this capacity do not reallocate.
+        void reserve(Index _nnz)
+        {
+            m_inner.reserve(_nnz);
+            m_vals.reserve(_nnz);
+        }
+
+        // Release the memory not used by the current number of non-zeros.
+        void shrink_to_fit()
+        {
+            m_inner.shrink_to_fit();
+            m_vals.shrink_to_fit();
+            m_start.shrink_to_fit();
+        }
+
         // Number of elements
-        inline unsigned int getInnerSize() const
+        inline Index getInnerSize() const
         {
             return m_inner.size();
         }
 
-        void setOuterSize(unsigned int _outerSize) 
+        void setOuterSize(Index _outerSize) 
         { 
             // TODO : implmenter
             m_start.resize(_outerSize);
         }
 
-        unsigned int getOuterSize() const
+        Index getOuterSize() const
         {
             return m_start.size();
         }
@@ -99,13 +133,13 @@ namespace gti320
         }
 
         // Access to the @a m_start buffer (read only)
-        const unsigned int* outer() const
+        const Index* outer() const
         {
             return m_start.data();
         }
 
         // Access to the @a m_inner buffer (read only)
-        const unsigned int* inner() const
+        const Index* inner() const
         {
             return m_inner.data();
         }
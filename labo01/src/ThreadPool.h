@@ -0,0 +1,413 @@
+#pragma once
+
+/**
+ * @file ThreadPool.h
+ *
+ * @brief Réserve de fils à vol de tâches (work stealing).
+ *
+ * Chaque fil de la réserve possède une file de tâches : il empile et dépile
+ * ses propres tâches par la fin (les plus récentes, encore chaudes dans le
+ * cache) et, lorsqu'elle est vide, vole la tâche la plus ancienne d'un
+ * autre fil. Un fil extérieur à la réserve dépose ses tâches dans une file
+ * commune.
+ *
+ * Un fil qui attend la fin d'un groupe de tâches (TaskGroup::wait()) ne
+ * s'endort pas : il exécute d'autres tâches en attendant. Une région
+ * parallèle imbriquée (un parallel_for dans une tâche) réutilise donc les
+ * mêmes fils, sans en créer de nouveaux et sans interblocage.
+ *
+ *    TaskGroup group(globalThreadPool());
+ *    group.spawn([&]() { gauche(); });
+ *    droite();
+ *    group.wait();
+ *
+ * Les fils peuvent être épinglés chacun sur un cœur (Linux seulement) avec
+ * GTI320_PIN_THREADS ou setParallelPinning() (voir Parallel.h). Une tâche
+ * peut aussi être confiée à un fil précis (TaskGroup::spawnOn()) : elle est
+ * déposée dans une file réservée à ce fil, qu'aucun autre ne vole. C'est ce
+ * qui permet à parallel_for_static() de donner toujours la même tranche au
+ * même fil.
+ *
+ */
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace gti320
+{
+    class ThreadPool;
+
+    namespace internal
+    {
+        /**
+         * Tâche en attente : une fonction et le compteur du groupe auquel
+         * elle appartient.
+         */
+        class Task
+        {
+        public:
+
+            explicit Task(std::atomic<int>* pending) : m_pending(pending) { }
+            virtual ~Task() { }
+            virtual void run() = 0;
+
+            std::atomic<int>* pending() const { return m_pending; }
+
+        private:
+
+            std::atomic<int>* m_pending;
+        };
+
+        template<typename _Func>
+        class FunctionTask : public Task
+        {
+        public:
+
+            FunctionTask(const _Func& f, std::atomic<int>* pending) : Task(pending), m_func(f) { }
+            void run() override { m_func(); }
+
+        private:
+
+            _Func m_func;
+        };
+
+        /**
+         * File de tâches protégée par un verrou.
+         */
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<Task*> tasks;
+
+            void push(Task* task)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back(task);
+            }
+
+            Task* popBack()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (tasks.empty())
+                    return nullptr;
+                Task* task = tasks.back();
+                tasks.pop_back();
+                return task;
+            }
+
+            Task* popFront()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (tasks.empty())
+                    return nullptr;
+                Task* task = tasks.front();
+                tasks.pop_front();
+                return task;
+            }
+        };
+
+        /**
+         * Réserve et rang du fil courant (nullptr hors d'une réserve).
+         */
+        struct WorkerIdentity
+        {
+            ThreadPool* pool;
+            int index;
+        };
+
+        inline WorkerIdentity& currentWorker()
+        {
+            static thread_local WorkerIdentity s_worker = { nullptr, -1 };
+            return s_worker;
+        }
+    }
+
+    /**
+     * Réserve de `size() - 1` fils ; le fil qui attend un groupe de tâches
+     * est le size()-ième participant.
+     */
+    class ThreadPool
+    {
+    public:
+
+        /**
+         * Crée une réserve pour `threads` participants (au moins 1). Si
+         * `pin` est vrai, le fil k est épinglé sur le cœur k (modulo le
+         * nombre de cœurs) ; le fil appelant n'est pas modifié.
+         */
+        explicit ThreadPool(int threads, bool pin = false) :
+            m_size(threads > 0 ? threads : 1), m_pinned(pin), m_queues(m_size), m_bound(m_size), m_epoch(0), m_sleepers(0), m_stop(false)
+        {
+            m_threads.reserve(m_size - 1);
+            for (int k = 1; k < m_size; ++k) {
+                m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, k));
+            }
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                m_stop = true;
+            }
+            m_sleepCondition.notify_all();
+            for (size_t k = 0; k < m_threads.size(); ++k) {
+                m_threads[k].join();
+            }
+        }
+
+        /**
+         * Nombre de participants (fils de la réserve + fil appelant).
+         */
+        int size() const { return m_size; }
+
+        bool pinned() const { return m_pinned; }
+
+        /**
+         * Vrai si le fil courant est un fil de cette réserve.
+         */
+        bool isWorker() const { return internal::currentWorker().pool == this; }
+
+        /**
+         * Dépose une tâche : dans la file du fil courant s'il appartient à
+         * la réserve, sinon dans la file commune (rang 0).
+         */
+        void submit(internal::Task* task)
+        {
+            const internal::WorkerIdentity& worker = internal::currentWorker();
+            m_queues[worker.pool == this ? worker.index : 0].push(task);
+
+            m_epoch.fetch_add(1);
+            if (m_sleepers.load() > 0) {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                m_sleepCondition.notify_one();
+            }
+        }
+
+        /**
+         * Dépose une tâche que seul le fil de rang `index` (1 <= index <
+         * size()) exécutera.
+         */
+        void submitTo(int index, internal::Task* task)
+        {
+            assert(0 < index && index < m_size);
+            m_bound[index].push(task);
+
+            // Tous les fils endormis sont réveillés : notify_one() pourrait
+            // choisir un autre fil que le destinataire.
+            m_epoch.fetch_add(1);
+            if (m_sleepers.load() > 0) {
+                std::lock_guard<std::mutex> lock(m_sleepMutex);
+                m_sleepCondition.notify_all();
+            }
+        }
+
+        /**
+         * Exécute une tâche en attente, s'il y en a une : d'abord celles
+         * réservées au fil courant, puis celles de sa file, puis celles des
+         * autres files.
+         */
+        bool runPendingTask()
+        {
+            internal::Task* task = findTask();
+            if (task == nullptr)
+                return false;
+            execute(task);
+            return true;
+        }
+
+    private:
+
+        ThreadPool(const ThreadPool&);
+        ThreadPool& operator=(const ThreadPool&);
+
+        internal::Task* findTask()
+        {
+            const internal::WorkerIdentity& worker = internal::currentWorker();
+            const int self = worker.pool == this ? worker.index : 0;
+            if (self > 0) {
+                if (internal::Task* task = m_bound[self].popFront())
+                    return task;
+            }
+            if (internal::Task* task = m_queues[self].popBack())
+                return task;
+            for (int k = 1; k < m_size; ++k) {
+                if (internal::Task* task = m_queues[(self + k) % m_size].popFront())
+                    return task;
+            }
+            return nullptr;
+        }
+
+        static void execute(internal::Task* task)
+        {
+            std::atomic<int>* pending = task->pending();
+            task->run();
+            delete task;
+            pending->fetch_sub(1);
+        }
+
+        void workerLoop(int index)
+        {
+            internal::currentWorker().pool = this;
+            internal::currentWorker().index = index;
+            if (m_pinned) {
+                pin(index);
+            }
+
+            for (;;) {
+                const unsigned int epoch = m_epoch.load();
+                if (runPendingTask())
+                    continue;
+
+                // Quelques tentatives avant de s'endormir : les régions
+                // parallèles se suivent souvent de près.
+                bool found = false;
+                for (int spin = 0; spin < 64 && !found; ++spin) {
+                    std::this_thread::yield();
+                    found = runPendingTask();
+                }
+                if (found)
+                    continue;
+
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+                if (m_stop)
+                    return;
+                m_sleepers.fetch_add(1);
+                m_sleepCondition.wait(lock, [this, epoch]() { return m_stop || m_epoch.load() != epoch; });
+                m_sleepers.fetch_sub(1);
+                if (m_stop)
+                    return;
+            }
+        }
+
+        static void pin(int index)
+        {
+#if defined(__linux__)
+            const unsigned int cores = std::thread::hardware_concurrency();
+            if (cores == 0)
+                return;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET((unsigned int)index % cores, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+            (void)index;
+#endif
+        }
+
+        const int m_size;
+        const bool m_pinned;
+        std::vector<internal::WorkQueue> m_queues;
+        std::vector<internal::WorkQueue> m_bound;  // tâches réservées à un fil (submitTo())
+        std::vector<std::thread> m_threads;
+
+        std::atomic<unsigned int> m_epoch;      // incrémenté à chaque dépôt
+        std::atomic<int> m_sleepers;
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleepCondition;
+        bool m_stop;
+    };
+
+    /**
+     * Groupe de tâches : spawn() dépose une tâche dans la réserve, wait()
+     * attend la fin de toutes les tâches du groupe en aidant à les exécuter.
+     * Une exception levée par une tâche est relancée par wait().
+     */
+    class TaskGroup
+    {
+    public:
+
+        explicit TaskGroup(ThreadPool& pool) : m_pool(pool), m_pending(0) { }
+
+        ~TaskGroup()
+        {
+            assert(m_pending.load() == 0 && "TaskGroup detruit avant wait()");
+        }
+
+        ThreadPool& pool() const { return m_pool; }
+
+        template<typename _Func>
+        void spawn(const _Func& f)
+        {
+            m_pending.fetch_add(1);
+            m_pool.submit(new internal::FunctionTask<Guarded<_Func> >(Guarded<_Func>(f, this), &m_pending));
+        }
+
+        /**
+         * Comme spawn(), mais la tâche est exécutée par le fil de rang
+         * `index` de la réserve (voir ThreadPool::submitTo()).
+         */
+        template<typename _Func>
+        void spawnOn(int index, const _Func& f)
+        {
+            m_pending.fetch_add(1);
+            m_pool.submitTo(index, new internal::FunctionTask<Guarded<_Func> >(Guarded<_Func>(f, this), &m_pending));
+        }
+
+        void wait()
+        {
+            while (m_pending.load() > 0) {
+                if (!m_pool.runPendingTask()) {
+                    std::this_thread::yield();
+                }
+            }
+
+            std::exception_ptr error;
+            {
+                std::lock_guard<std::mutex> lock(m_errorMutex);
+                std::swap(error, m_error);
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+
+        TaskGroup(const TaskGroup&);
+        TaskGroup& operator=(const TaskGroup&);
+
+        /**
+         * Conserve la première exception levée par une tâche du groupe.
+         */
+        template<typename _Func>
+        struct Guarded
+        {
+            Guarded(const _Func& f, TaskGroup* group) : func(f), group(group) { }
+
+            void operator()()
+            {
+                try {
+                    func();
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(group->m_errorMutex);
+                    if (!group->m_error) {
+                        group->m_error = std::current_exception();
+                    }
+                }
+            }
+
+            _Func func;
+            TaskGroup* group;
+        };
+
+        ThreadPool& m_pool;
+        std::atomic<int> m_pending;
+        std::mutex m_errorMutex;
+        std::exception_ptr m_error;
+    };
+}
@@ -7,8 +7,27 @@
  *
  */
 
+#include <cstddef>
+
+/**
+ * Type des dimensions et des indices (voir gti320::Index). Doit tre un
+ * entier sign ; la valeur par dfaut permet de dpasser 2^31 lments sur
+ * une plateforme 64 bits.
+ */
+#ifndef GTI320_INDEX
+#define GTI320_INDEX std::ptrdiff_t
+#endif
+
 namespace gti320 
 {
+    /**
+     * Entier utilis pour les dimensions, les tailles de tampon et les indices
+     * des matrices et des vecteurs (denses et creux). Les produits comme
+     * `i + j * rows` sont calculs dans ce type.
+     */
+    typedef GTI320_INDEX Index;
+
+    static_assert(Index(-1) < Index(0), "GTI320_INDEX doit etre un entier signe");
 
     enum SizeType
     {
@@ -21,11 +40,20 @@ namespace gti320
         RowStorage = 1
     };
 
+    /**
+     * tiquette pour construire ou redimensionner un tampon sans initialiser
+     * ses valeurs.  utiliser lorsque toutes les entres sont crites ensuite.
+     *
+     *    Matrix<double> C(rows, cols, Uninitialized);
+     */
+    struct UninitializedTag {};
+    static const UninitializedTag Uninitialized = UninitializedTag();
+
     template<typename _ScalarType>
     struct TripletType
     {
         _ScalarType val;
-        unsigned int i, j;
+        Index i, j;
     };
 
 }
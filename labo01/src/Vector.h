@@ -13,6 +13,10 @@
 
 #include <cmath>
 #include "MatrixBase.h"
+#include "MatrixView.h"
+#include "Expression.h"
+#include "FixedSize.h"
+#include "Simd.h"
 
 namespace gti320 {
 
@@ -34,22 +38,169 @@ namespace gti320 {
         /**
          * Contructeur à partir d'un taille (rows).
          */
-        explicit Vector(int rows) : MatrixBase<_Scalar, _Rows, 1>(rows, 1) {}
+        explicit Vector(Index rows) : MatrixBase<_Scalar, _Rows, 1>(rows, 1) {}
+
+        /**
+         * Contructeur à partir d'une taille (rows), sans initialisation des entrées.
+         */
+        Vector(Index rows, UninitializedTag) : MatrixBase<_Scalar, _Rows, 1>(rows, 1, Uninitialized) {}
 
         /**
          * Constructeur de copie
          */
         Vector(const Vector& other) : MatrixBase<_Scalar, _Rows, 1>(other) {}
 
+        /**
+         * Constructeur de déplacement
+         */
+        Vector(Vector&& other) noexcept : MatrixBase<_Scalar, _Rows, 1>(std::move(other)) {}
+
+        /**
+         * Constructeur à partir d'une expression vectorielle (voir
+         * Expression.h), évaluée en une seule passe.
+         */
+        template<typename _Derived>
+        Vector(const MatrixExpression<_Derived>& expr) : MatrixBase<_Scalar, _Rows, 1>(expr.derived().rows(), 1, Uninitialized)
+        {
+            assert(expr.derived().cols() == 1);
+            internal::assign<_Rows, 1>(internal::AssignOp(), view(), expr);
+        }
+
         /**
          * Destructeur
          */
         ~Vector() {}
 
+        /**
+         * Opérateur de copie
+         */
+        Vector& operator=(const Vector& other)
+        {
+            MatrixBase<_Scalar, _Rows, 1>::operator=(other);
+            return *this;
+        }
+
+        /**
+         * Opérateur de déplacement
+         */
+        Vector& operator=(Vector&& other) noexcept
+        {
+            MatrixBase<_Scalar, _Rows, 1>::operator=(std::move(other));
+            return *this;
+        }
+
+        /**
+         * Affectation d'une expression vectorielle (voir Expression.h). Le
+         * tampon courant est réutilisé si sa capacité suffit.
+         */
+        template<typename _Derived>
+        Vector& operator=(const MatrixExpression<_Derived>& expr)
+        {
+            assert(expr.derived().cols() == 1);
+            this->resize(expr.derived().rows(), Uninitialized);
+            internal::assign<_Rows, 1>(internal::AssignOp(), view(), expr);
+            return *this;
+        }
+
+        /**
+         * Opérateurs composés : mise à jour en place, sans temporaire (voir
+         * Expression.h).
+         *
+         *    x += alpha * p;
+         *    r -= alpha * q;
+         */
+        template<int _OtherRows>
+        Vector& operator+=(const Vector<_Scalar, _OtherRows>& other)
+        {
+            internal::assign<_Rows, 1>(internal::SumOp(), view(), LeafExpression<_Scalar, ColumnStorage>(other.view()));
+            return *this;
+        }
+
+        template<typename _Derived>
+        Vector& operator+=(const MatrixExpression<_Derived>& expr)
+        {
+            internal::assign<_Rows, 1>(internal::SumOp(), view(), expr);
+            return *this;
+        }
+
+        template<int _OtherRows>
+        Vector& operator-=(const Vector<_Scalar, _OtherRows>& other)
+        {
+            internal::assign<_Rows, 1>(internal::DifferenceOp(), view(), LeafExpression<_Scalar, ColumnStorage>(other.view()));
+            return *this;
+        }
+
+        template<typename _Derived>
+        Vector& operator-=(const MatrixExpression<_Derived>& expr)
+        {
+            internal::assign<_Rows, 1>(internal::DifferenceOp(), view(), expr);
+            return *this;
+        }
+
+        Vector& operator*=(_Scalar a)
+        {
+            const LeafExpression<_Scalar, ColumnStorage> leaf(static_cast<const Vector&>(*this).view());
+            internal::assign<_Rows, 1>(internal::AssignOp(), view(), ScaledExpression< LeafExpression<_Scalar, ColumnStorage> >(a, leaf));
+            return *this;
+        }
+
+        /**
+         * Projette en mémoire le vecteur enregistré dans le fichier `path`
+         * (voir Matrix::openMapped).
+         */
+        bool openMapped(const char* path, MapMode mode = MapReadOnly)
+        {
+            assert(mode != MapCreate);
+            MappedFile file;
+            Index rows, cols;
+            if (!file.open(path, mode) || !readMatrixHeader<_Scalar>(file, ColumnStorage, rows, cols) || cols != 1)
+                return false;
+            return this->map(std::move(file), sizeof(MatrixFileHeader), rows, 1);
+        }
+
+        /**
+         * Crée (ou remplace) le fichier `path` pour un vecteur de taille
+         * `rows` et y associe le vecteur en lecture-écriture.
+         */
+        bool createMapped(const char* path, Index rows)
+        {
+            MappedFile file;
+            if (!file.open(path, MapCreate, matrixFileLength<_Scalar>(rows, 1)))
+                return false;
+            writeMatrixHeader<_Scalar>(file, ColumnStorage, rows, 1);
+            return this->map(std::move(file), sizeof(MatrixFileHeader), rows, 1);
+        }
+
+        /**
+         * Vue du vecteur comme une matrice colonne (voir MatrixView.h).
+         */
+        MatrixView<_Scalar, ColumnStorage> view()
+        {
+            return MatrixView<_Scalar, ColumnStorage>(this->data(), this->rows(), 1);
+        }
+
+        MatrixView<const _Scalar, ColumnStorage> view() const
+        {
+            return MatrixView<const _Scalar, ColumnStorage>(this->data(), this->rows(), 1);
+        }
+
+        /**
+         * Vue des `size` entrées commençant à l'indice `i`.
+         */
+        MatrixView<_Scalar, ColumnStorage> segment(Index i, Index size)
+        {
+            return view().block(i, 0, size, 1);
+        }
+
+        MatrixView<const _Scalar, ColumnStorage> segment(Index i, Index size) const
+        {
+            return view().block(i, 0, size, 1);
+        }
+
         /**
          * Accesseur à une entrée du vecteur (lecture seule)
          */
-        _Scalar operator()(int i) const
+        _Scalar operator()(Index i) const
         {
             // TODO implémenter
             return this->data()[i];
@@ -58,7 +209,7 @@ namespace gti320 {
         /**
          * Accesseur à une entrée du vecteur (lecture et écriture)
          */
-        _Scalar& operator()(int i)
+        _Scalar& operator()(Index i)
         {
             // TODO implémenter
             return this->data()[i];
@@ -67,27 +218,46 @@ namespace gti320 {
         /**
          * Modifie le nombre de lignes du vecteur
          */
-        void resize(int _rows)
+        void resize(Index _rows)
         {
             MatrixBase<_Scalar, _Rows, 1>::resize(_rows, 1);
         }
 
+        /**
+         * Réserve de la place pour `_rows` lignes sans changer la taille
+         */
+        void reserve(Index _rows)
+        {
+            MatrixBase<_Scalar, _Rows, 1>::reserve(_rows, 1);
+        }
+
+        /**
+         * Modifie le nombre de lignes du vecteur sans initialiser les entrées
+         */
+        void resize(Index _rows, UninitializedTag)
+        {
+            MatrixBase<_Scalar, _Rows, 1>::resize(_rows, 1, Uninitialized);
+        }
+
         /**
          * Produit scalaire de *this et other.
+         *
+         * Pour les vecteurs dynamiques, le calcul est confié aux noyaux
+         * vectoriels (voir Simd.h).
          */
         inline _Scalar dot(const Vector& other) const
         {
-            // TODO implémenter
-            int rows = this->rows();
-            _Scalar result = _Scalar(0);
-
+            Index rows = this->rows();
             assert(rows == other.rows());
 
-            for (int i = 0; i < rows; ++i) {
-                result += this->data()[i] * other.data()[i];
+            if (_Rows == Dynamic) {
+                return internal::dot(rows, this->data(), other.data());
             }
 
-
+            _Scalar result = _Scalar(0);
+            for (Index i = 0; i < rows; ++i) {
+                result += this->data()[i] * other.data()[i];
+            }
             return result;
         }
 
@@ -96,15 +266,7 @@ namespace gti320 {
          */
         inline _Scalar norm() const
         {
-            // TODO implémenter
-            int rows = this->rows();
-            _Scalar resultCaree = _Scalar(0);
-            for (int i = 0; i < rows; ++i) {
-                _Scalar v = this->data()[i];
-                resultCaree += v * v;
-            }
-
-            return std::sqrt(resultCaree);
+            return std::sqrt(dot(*this));
         }
     };
 }
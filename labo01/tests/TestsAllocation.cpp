@@ -0,0 +1,610 @@
+/**
+ * @file TestsAllocation.cpp
+ *
+ * @brief Mesure des allocations et des copies profondes effectuées par les
+ *        expressions matricielles.
+ *
+ * Les opérateurs globaux new[] et delete[] sont remplacés dans ce fichier afin
+ * de compter les allocations faites par les tampons dynamiques. Une copie
+ * profonde se traduit toujours par une allocation de la taille du tampon copié :
+ * toute allocation au-delà de celle du résultat est donc une copie évitable.
+ *
+ */
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Operators.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace gti320;
+
+namespace {
+
+    /**
+     * Compteurs alimentés par les opérateurs new[] et delete[] globaux.
+     */
+    struct AllocationCounter
+    {
+        bool enabled;
+        size_t allocations;
+        size_t bytes;
+    };
+
+    AllocationCounter g_counter = { false, 0, 0 };
+
+    /**
+     * Active le comptage des allocations pour la durée de vie de l'objet.
+     */
+    class CountAllocations
+    {
+    public:
+        CountAllocations()
+        {
+            g_counter.allocations = 0;
+            g_counter.bytes = 0;
+            g_counter.enabled = true;
+        }
+
+        ~CountAllocations() { g_counter.enabled = false; }
+
+        size_t allocations() const { return g_counter.allocations; }
+        size_t bytes() const { return g_counter.bytes; }
+    };
+
+    /**
+     * Affiche une ligne du rapport : nombre d'allocations, octets alloués,
+     * octets copiés inutilement (allocations au-delà de `expected`) et temps.
+     */
+    void report(const char* expression, size_t allocations, size_t bytes, size_t bytesPerBuffer, size_t expected, double ms)
+    {
+        const size_t copies = allocations > expected ? allocations - expected : 0;
+        std::cout << "  " << std::left << std::setw(28) << expression
+            << " allocations: " << std::setw(3) << allocations
+            << " octets alloues: " << std::setw(10) << bytes
+            << " octets copies: " << std::setw(10) << copies * bytesPerBuffer
+            << " temps: " << ms << " ms" << std::endl;
+    }
+
+    double elapsedMs(const std::chrono::high_resolution_clock::time_point& t)
+    {
+        using namespace std::chrono;
+        return duration_cast<duration<double, std::milli>>(high_resolution_clock::now() - t).count();
+    }
+
+    /**
+     * Retourne une matrice par valeur (NRVO impossible : deux chemins de retour).
+     */
+    Matrix<double> pick(bool first, const Matrix<double>& A, const Matrix<double>& B)
+    {
+        Matrix<double> a(A);
+        Matrix<double> b(B);
+        if (first)
+            return a;
+        return b;
+    }
+
+} // namespace
+
+void* operator new[](std::size_t size)
+{
+    if (g_counter.enabled)
+    {
+        ++g_counter.allocations;
+        g_counter.bytes += size;
+    }
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Nombre d'allocations et d'octets copiés par expression.
+ *
+ * Les produits n'allouent que leur résultat, qui est déplacé dans la
+ * destination. Les expressions élément par élément (voir Expression.h) sont
+ * évaluées directement dans la destination : elles n'allouent rien si la
+ * destination a déjà la bonne taille.
+ */
+TEST(TestsAllocation, AllocationsParExpression)
+{
+    using namespace std::chrono;
+
+    const int n = 1024;
+    const size_t matrixBytes = sizeof(double) * n * n;
+    const size_t vectorBytes = sizeof(double) * n;
+
+    Matrix<double> A(n, n), B(n, n), C(n, n);
+    Vector<double> u(n), v(n), w(n);
+    const double alpha = 2.0;
+
+    std::cout << "Allocations par expression (" << n << "x" << n << ", double) :" << std::endl;
+
+    {
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        CountAllocations counter;
+        Matrix<double> D = A + B;
+        report("Matrix D = A + B", counter.allocations(), counter.bytes(), matrixBytes, 1, elapsedMs(t));
+        EXPECT_EQ(counter.allocations(), 1u);
+    }
+    {
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        CountAllocations counter;
+        C = A + B;
+        report("C = A + B", counter.allocations(), counter.bytes(), matrixBytes, 0, elapsedMs(t));
+        EXPECT_EQ(counter.allocations(), 0u);
+    }
+    {
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        CountAllocations counter;
+        C = alpha * A + B;
+        report("C = alpha * A + B", counter.allocations(), counter.bytes(), matrixBytes, 0, elapsedMs(t));
+        EXPECT_EQ(counter.allocations(), 0u);
+    }
+    {
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        CountAllocations counter;
+        w = A * v;
+        report("w = A * v", counter.allocations(), counter.bytes(), vectorBytes, 1, elapsedMs(t));
+        EXPECT_EQ(counter.allocations(), 1u);
+    }
+    {
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        CountAllocations counter;
+        w = alpha * u + v - w;
+        report("w = alpha * u + v - w", counter.allocations(), counter.bytes(), vectorBytes, 0, elapsedMs(t));
+        EXPECT_EQ(counter.allocations(), 0u);
+    }
+    {
+        // Deux copies explicites, puis le retour est déplacé.
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        CountAllocations counter;
+        C = pick(false, A, B);
+        report("C = pick(false, A, B)", counter.allocations(), counter.bytes(), matrixBytes, 2, elapsedMs(t));
+        EXPECT_EQ(counter.allocations(), 2u);
+    }
+    {
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        CountAllocations counter;
+        Matrix<double> D(std::move(C));
+        C = std::move(D);
+        report("Matrix D(move(C)); C = move(D)", counter.allocations(), counter.bytes(), matrixBytes, 0, elapsedMs(t));
+        EXPECT_EQ(counter.allocations(), 0u);
+        EXPECT_EQ(C.rows(), n);
+        EXPECT_EQ(C.cols(), n);
+        EXPECT_EQ(D.size(), 0);
+        EXPECT_EQ(D.capacity(), (DenseStorage<double, Dynamic>::inlineCapacity()));
+    }
+}
+
+/**
+ * Une matrice déplacée est vide : ses dimensions sont remises à zéro avec son
+ * stockage, pour chaque combinaison de dimensions dynamiques.
+ */
+TEST(TestsAllocation, DeplacementSourceVide)
+{
+    Matrix<double> A(100, 100);
+    Matrix<double> B(std::move(A));
+    EXPECT_EQ(A.rows(), 0);
+    EXPECT_EQ(A.cols(), 0);
+    EXPECT_EQ(B.rows(), 100);
+    EXPECT_EQ(B.cols(), 100);
+
+    Matrix<double, Dynamic, 4> tall(100, 4);
+    Matrix<double, Dynamic, 4> tall2(std::move(tall));
+    EXPECT_EQ(tall.rows(), 0);
+    EXPECT_EQ(tall2.rows(), 100);
+
+    Matrix<double, 4, Dynamic> wide(4, 100);
+    Matrix<double, 4, Dynamic> wide2(std::move(wide));
+    EXPECT_EQ(wide.cols(), 0);
+    EXPECT_EQ(wide2.cols(), 100);
+
+    Vector<double> u(100);
+    Vector<double> v(std::move(u));
+    EXPECT_EQ(u.rows(), 0);
+    EXPECT_EQ(v.rows(), 100);
+
+    // La source vide se réutilise normalement.
+    A.resize(100, 100);
+    A.setZero();
+    A += B;
+    EXPECT_EQ(A.rows(), 100);
+}
+
+/**
+ * Les conteneurs standards déplacent les matrices lors d'une réallocation,
+ * puisque les opérations de déplacement sont noexcept.
+ */
+TEST(TestsAllocation, DeplacementDansUnConteneur)
+{
+    std::vector< Matrix<double> > matrices;
+    matrices.reserve(1);
+    matrices.push_back(Matrix<double>(64, 64));
+
+    const double* data = matrices[0].data();
+    {
+        CountAllocations counter;
+        matrices.push_back(Matrix<double>());
+        // Le nouveau tableau de std::vector passe par operator new (non compté
+        // ici) : la matrice existante est déplacée, pas copiée.
+        EXPECT_EQ(counter.allocations(), 0u);
+    }
+    EXPECT_EQ(matrices[0].data(), data);
+    EXPECT_EQ(matrices[0].rows(), 64);
+}
+
+/**
+ * Déplacement des matrices creuses.
+ */
+TEST(TestsAllocation, DeplacementMatriceCreuse)
+{
+    SparseMatrix<double> A(3, 3);
+    TripletType<double> triplets[] = { { 1.0, 1, 1 }, { 2.5, 2, 1 }, { -0.1, 2, 2 }, { 6.0, 0, 0 } };
+    // Force les coefficients sur le tas (sinon ils tiennent dans le tampon interne).
+    A.reserve(64);
+    A.setFromTriplets(triplets, 4);
+
+    const double* values = A.values();
+    {
+        CountAllocations counter;
+        SparseMatrix<double> B(std::move(A));
+        EXPECT_EQ(counter.allocations(), 0u);
+        EXPECT_EQ(B.values(), values);
+        EXPECT_EQ(B.rows(), 3u);
+        EXPECT_DOUBLE_EQ(B(2, 1), 2.5);
+        EXPECT_DOUBLE_EQ(B(0, 0), 6.0);
+
+        A = std::move(B);
+        EXPECT_EQ(counter.allocations(), 0u);
+    }
+    EXPECT_EQ(A.values(), values);
+    EXPECT_EQ(A.rows(), 3u);
+    EXPECT_EQ(A.cols(), 3u);
+    EXPECT_DOUBLE_EQ(A(2, 2), -0.1);
+}
+
+namespace {
+
+    /**
+     * Politique d'allocation qui compte les appels avant de déléguer au tas.
+     */
+    struct CountingAllocator
+    {
+        static size_t allocations;
+        static size_t deallocations;
+
+        static void* allocate(size_t bytes, size_t alignment)
+        {
+            ++allocations;
+            return HeapAllocator::allocate(bytes, alignment);
+        }
+
+        static void deallocate(void* ptr)
+        {
+            if (ptr != nullptr)
+                ++deallocations;
+            HeapAllocator::deallocate(ptr);
+        }
+    };
+
+    size_t CountingAllocator::allocations = 0;
+    size_t CountingAllocator::deallocations = 0;
+
+    /**
+     * Calculs typiques d'une trame : quelques temporaires dynamiques.
+     */
+    double computeFrame(int n)
+    {
+        Matrix<double> A(n, n), B(n, n);
+        A.setIdentity();
+        B.setIdentity();
+        Vector<double> v(n);
+        for (int i = 0; i < n; ++i)
+            v(i) = (double)i;
+
+        const Matrix<double> C = A * B + 2.0 * A;
+        const Vector<double> w = C * v;
+        return w.dot(v);
+    }
+
+} // namespace
+
+/**
+ * La politique d'allocation de DenseStorage est interchangeable.
+ */
+TEST(TestsAllocation, PolitiqueAllocation)
+{
+    typedef DenseStorage<double, Dynamic, DefaultAlignment, CountingAllocator> CountedStorage;
+
+    CountingAllocator::allocations = 0;
+    CountingAllocator::deallocations = 0;
+    {
+        CountedStorage buf(32);
+        EXPECT_TRUE(isAligned(buf.data(), DefaultAlignment));
+        CountedStorage buf2(buf);
+        buf.resize(64);
+        CountedStorage buf3(std::move(buf2));
+        EXPECT_EQ(CountingAllocator::allocations, 3u);
+        EXPECT_EQ(CountingAllocator::deallocations, 1u);
+    }
+    EXPECT_EQ(CountingAllocator::deallocations, 3u);
+}
+
+/**
+ * En régime permanent, les temporaires d'une trame sont servis par l'arène :
+ * aucune allocation sur le tas.
+ */
+TEST(TestsAllocation, ArenaParTrame)
+{
+    const int n = 32;
+    ArenaAllocator arena;
+    double reference = 0.0;
+
+    for (int frame = 0; frame < 8; ++frame)
+    {
+        CountAllocations counter;
+        double result = 0.0;
+        {
+            ArenaScope scope(arena);
+            result = computeFrame(n);
+        }
+        if (frame == 0)
+        {
+            // Première trame : l'arène est vide, tout passe par le tas, puis
+            // l'arène est agrandie à la demande observée.
+            reference = result;
+            EXPECT_GT(counter.allocations(), 0u);
+            EXPECT_GT(arena.capacity(), 0u);
+        }
+        else
+        {
+            EXPECT_EQ(counter.allocations(), 0u) << "trame " << frame;
+            EXPECT_DOUBLE_EQ(result, reference);
+        }
+        EXPECT_EQ(arena.live(), 0u);
+        EXPECT_EQ(arena.used(), 0u);
+    }
+
+    // Hors de la portée, les allocations retournent sur le tas.
+    EXPECT_EQ(ArenaAllocator::active(), nullptr);
+    {
+        CountAllocations counter;
+        Vector<double> v(n);
+        EXPECT_EQ(counter.allocations(), 1u);
+    }
+}
+
+/**
+ * Les portées d'arène s'imbriquent ; un bloc libéré après la sortie de la
+ * portée est rendu à la bonne arène.
+ */
+TEST(TestsAllocation, ArenasImbriquees)
+{
+    ArenaAllocator outer(1 << 16), inner(1 << 16);
+    {
+        ArenaScope outerScope(outer);
+        Vector<float> a(100);
+        {
+            ArenaScope innerScope(inner);
+            EXPECT_EQ(ArenaAllocator::active(), &inner);
+            Vector<float> b(100);
+            EXPECT_EQ(inner.live(), 1u);
+            EXPECT_EQ(outer.live(), 1u);
+        }
+        EXPECT_EQ(ArenaAllocator::active(), &outer);
+        EXPECT_EQ(inner.live(), 0u);
+        EXPECT_EQ(outer.live(), 1u);
+        EXPECT_TRUE(isAligned(a.data(), DefaultAlignment));
+    }
+    EXPECT_EQ(outer.live(), 0u);
+    EXPECT_EQ(outer.overflows(), 0u);
+}
+
+/**
+ * Un objet durable redimensionné dans une trame reçoit un bloc de l'arène :
+ * tant qu'il vit, les trames suivantes ne réutilisent pas sa mémoire.
+ */
+TEST(TestsAllocation, ArenaBlocsVivants)
+{
+    ArenaAllocator arena;
+
+    // Trame 0 : l'arène s'agrandit à la demande observée.
+    {
+        ArenaScope scope(arena);
+        Vector<double> a(1000), b(1000);
+    }
+    ASSERT_GT(arena.capacity(), 0u);
+
+    {
+        Vector<double> persistent;
+
+        // Trame 1 : l'objet durable est servi par l'arène.
+        {
+            ArenaScope scope(arena);
+            persistent.resize(1000);
+            for (Index i = 0; i < persistent.size(); ++i)
+                persistent(i) = 1.0;
+        }
+        EXPECT_EQ(arena.live(), 1u);
+        EXPECT_EQ(arena.deferredResets(), 1u);
+        EXPECT_GT(arena.used(), 0u);
+
+        // Trame 2 : un temporaire ne recouvre pas l'objet durable.
+        {
+            ArenaScope scope(arena);
+            Vector<double> temporary(1000);
+            for (Index i = 0; i < temporary.size(); ++i)
+                temporary(i) = 42.0;
+        }
+        for (Index i = 0; i < persistent.size(); ++i)
+            ASSERT_EQ(persistent(i), 1.0) << i;
+    }
+
+    // Une fois l'objet libéré, l'arène est remise à zéro.
+    EXPECT_EQ(arena.live(), 0u);
+    {
+        ArenaScope scope(arena);
+        Vector<double> temporary(1000);
+    }
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.deferredResets(), 2u);
+}
+
+/**
+ * Des blocs de l'arène libérés par d'autres fils, en même temps : le
+ * compteur de blocs vivants reste exact et l'arène est remise à zéro.
+ */
+TEST(TestsAllocation, ArenaLiberationConcurrente)
+{
+    ArenaAllocator arena(1 << 20);
+    const int threads = 8;
+    const int perThread = 64;
+    {
+        ArenaScope scope(arena);
+        std::vector< Vector<double> > vectors((size_t)(threads * perThread));
+        for (size_t k = 0; k < vectors.size(); ++k)
+            vectors[k].resize(100);
+        EXPECT_EQ(arena.live(), (size_t)(threads * perThread));
+        EXPECT_EQ(arena.overflows(), 0u);
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.push_back(std::thread([&vectors, t, perThread]() {
+                // Le tampon passe à un temporaire, libéré par ce fil.
+                for (int k = 0; k < perThread; ++k)
+                    Vector<double> released(std::move(vectors[(size_t)(t * perThread + k)]));
+            }));
+        }
+        for (size_t t = 0; t < workers.size(); ++t)
+            workers[t].join();
+        EXPECT_EQ(arena.live(), 0u);
+    }
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.deferredResets(), 0u);
+}
+
+/**
+ * Avec une capacité réservée, les redimensionnements répétés (assemblage d'une
+ * jacobienne à chaque trame, par exemple) n'allouent plus.
+ */
+TEST(TestsAllocation, RedimensionnementSansAllocation)
+{
+    Matrix<double> J;
+    Vector<double> theta;
+    SparseMatrix<double> S(8, 8);
+    J.reserve(64, 64);
+    theta.reserve(64);
+    S.reserve(64);
+
+    CountAllocations counter;
+    for (int n = 1; n <= 64; n = 2 * n + 1)
+    {
+        J.resize(n, n);
+        theta.resize(n);
+        S.setInnerSize(n);
+        J.resize(n / 2, n);
+    }
+    EXPECT_EQ(counter.allocations(), 0u);
+    EXPECT_EQ(J.capacity(), 64 * 64);
+
+    J.shrink_to_fit();
+    EXPECT_EQ(J.capacity(), J.size());
+}
+
+/**
+ * Les grands tampons peuvent être servis en pages énormes, hors du tas.
+ */
+TEST(TestsAllocation, PagesEnormes)
+{
+    const size_t saved = HugePageAllocator::threshold();
+    const int n = (int)(HugePageAllocator::PageSize / sizeof(double)) + 5;
+
+    // Politique explicite.
+    {
+        DenseStorage<double, Dynamic, DefaultAlignment, HugePageAllocator> buf(n);
+        EXPECT_TRUE(isAligned(buf.data(), DefaultAlignment));
+        buf[0] = 1.0;
+        buf[n - 1] = 2.0;
+        EXPECT_DOUBLE_EQ(buf[n - 1], 2.0);
+    }
+
+    // Politique par défaut, au-delà du seuil.
+    HugePageAllocator::threshold() = HugePageAllocator::PageSize;
+    {
+        CountAllocations counter;
+        Matrix<double> A(n, 1);
+        Vector<double> v(8);
+        A(n - 1, 0) = 3.0;
+        Matrix<double> B(A);
+        EXPECT_DOUBLE_EQ(B(n - 1, 0), 3.0);
+        EXPECT_TRUE(isAligned(B.data(), DefaultAlignment));
+#if defined(__linux__)
+        EXPECT_EQ(counter.allocations(), 0u);
+#endif
+    }
+    HugePageAllocator::threshold() = saved;
+}
+
+/**
+ * Copie sur écriture : les copies (passage par valeur, instantanés) ne
+ * coûtent rien tant qu'elles ne sont pas modifiées.
+ */
+TEST(TestsAllocation, CopieSurEcriture)
+{
+    const bool saved = copyOnWrite();
+    setCopyOnWrite(true);
+    {
+        Matrix<double> A(512, 512);
+        A(7, 9) = 1.5;
+        const Matrix<double>& cA = A;
+        {
+            CountAllocations counter;
+            Matrix<double> B(cA);
+            Matrix<double> C = pick(false, cA, cA);
+            EXPECT_EQ(counter.allocations(), 0u);
+
+            // Première écriture : duplication du tampon modifié seulement.
+            B(0, 0) = 2.0;
+            EXPECT_EQ(counter.allocations(), 1u);
+            EXPECT_DOUBLE_EQ(cA(0, 0), 0.0);
+            EXPECT_DOUBLE_EQ(static_cast<const Matrix<double>&>(C)(7, 9), 1.5);
+        }
+
+        // Plusieurs fils copient et lisent la même matrice en parallèle.
+        std::vector<std::thread> readers;
+        std::vector<double> sums(4, 0.0);
+        for (int t = 0; t < 4; ++t)
+        {
+            readers.push_back(std::thread([&cA, &sums, t]() {
+                for (int k = 0; k < 1000; ++k)
+                {
+                    const Matrix<double> snapshot(cA);
+                    sums[t] += snapshot(7, 9);
+                }
+            }));
+        }
+        for (int t = 0; t < 4; ++t)
+        {
+            readers[t].join();
+            EXPECT_DOUBLE_EQ(sums[t], 1500.0);
+        }
+        EXPECT_FALSE(A.storage().isShared());
+    }
+    setCopyOnWrite(saved);
+}
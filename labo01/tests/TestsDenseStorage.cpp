@@ -84,4 +84,288 @@ TEST(TestsDenseStorage, DenseStorage)
         EXPECT_DOUBLE_EQ(buf2[3], -1.0f);
 
     }
-}
\ No newline at end of file
+}
+TEST(TestsDenseStorage, Alignement)
+{
+    // Test: tampon dynamique aligné sur l'alignement par défaut, quelle que soit la taille
+    {
+        for (int n = 1; n < 70; ++n)
+        {
+            DenseStorage<double, Dynamic> buf(n);
+            EXPECT_EQ(buf.alignment(), (int)DefaultAlignment);
+            EXPECT_TRUE(isAligned(buf.data(), DefaultAlignment));
+
+            DenseStorage<double, Dynamic> buf2(buf);
+            EXPECT_TRUE(isAligned(buf2.data(), DefaultAlignment));
+
+            buf.resize(n + 3);
+            EXPECT_TRUE(isAligned(buf.data(), DefaultAlignment));
+        }
+    }
+    // Test: alignement configurable
+    {
+        DenseStorage<float, Dynamic, Aligned32> buf(7);
+        EXPECT_EQ(buf.alignment(), 32);
+        EXPECT_TRUE(isAligned(buf.data(), 32));
+
+        DenseStorage<float, Dynamic, NoAlignment> buf2(7);
+        EXPECT_EQ(buf2.alignment(), (int)alignof(float));
+    }
+    // Test: tampon fixe aligné lorsqu'il couvre au moins un registre vectoriel
+    {
+        DenseStorage<float, 16, Aligned64> buf;
+        EXPECT_EQ(buf.alignment(), 64);
+        EXPECT_EQ(alignof(DenseStorage<float, 16, Aligned64>), 64u);
+        EXPECT_TRUE(isAligned(buf.data(), 64));
+
+        DenseStorage<double, 9, Aligned32> buf2;
+        EXPECT_EQ(buf2.alignment(), 32);
+        EXPECT_TRUE(isAligned(buf2.data(), 32));
+
+        // Les petits tampons gardent l'alignement naturel.
+        EXPECT_EQ((DenseStorage<float, 3, Aligned64>::alignment()), (int)alignof(float));
+        EXPECT_EQ(sizeof(DenseStorage<float, 3, Aligned64>), 3 * sizeof(float));
+    }
+    // Test: remplissage à la largeur vectorielle
+    {
+        EXPECT_EQ((paddedSize<double, Aligned32>(0)), 0);
+        EXPECT_EQ((paddedSize<double, Aligned32>(1)), 4);
+        EXPECT_EQ((paddedSize<double, Aligned32>(4)), 4);
+        EXPECT_EQ((paddedSize<double, Aligned32>(5)), 8);
+        EXPECT_EQ((paddedSize<float, Aligned64>(17)), 32);
+        EXPECT_EQ((paddedSize<float, NoAlignment>(17)), 17);
+    }
+}
+
+TEST(TestsDenseStorage, SansInitialisation)
+{
+    // Test: construction et redimensionnement sans initialisation
+    {
+        DenseStorage<double, Dynamic> buf(16, Uninitialized);
+        EXPECT_EQ(buf.size(), 16);
+        EXPECT_TRUE(isAligned(buf.data(), DefaultAlignment));
+        for (int i = 0; i < buf.size(); ++i)
+            buf[i] = 7.0;
+
+        buf.resize(16, Uninitialized);
+        EXPECT_DOUBLE_EQ(buf[15], 7.0);
+
+        buf.resize(40, Uninitialized);
+        EXPECT_EQ(buf.size(), 40);
+
+        buf.resize(0, Uninitialized);
+        EXPECT_EQ(buf.size(), 0);
+    }
+    // Test: le constructeur par défaut initialise toujours à zéro
+    {
+        {
+            DenseStorage<int, Dynamic> dirty(64, Uninitialized);
+            for (int i = 0; i < dirty.size(); ++i)
+                dirty[i] = -1;
+        }
+        DenseStorage<int, Dynamic> buf(64);
+        for (int i = 0; i < buf.size(); ++i)
+            EXPECT_EQ(buf[i], 0);
+
+        buf[3] = 5;
+        buf.resize(32);
+        for (int i = 0; i < buf.size(); ++i)
+            EXPECT_EQ(buf[i], 0);
+    }
+    // Test: tampon fixe
+    {
+        DenseStorage<float, 4> buf(4, Uninitialized);
+        EXPECT_EQ(buf.size(), 4);
+    }
+}
+
+TEST(TestsDenseStorage, Capacite)
+{
+    // Test: un redimensionnement qui tient dans la capacité réutilise le tampon
+    {
+        DenseStorage<double, Dynamic> buf(100);
+        const double* data = buf.data();
+        EXPECT_EQ(buf.capacity(), 100);
+
+        buf.resize(10);
+        EXPECT_EQ(buf.size(), 10);
+        EXPECT_EQ(buf.capacity(), 100);
+        EXPECT_EQ(buf.data(), data);
+
+        buf[3] = 1.0;
+        buf.resize(100);
+        EXPECT_EQ(buf.data(), data);
+        EXPECT_DOUBLE_EQ(buf[3], 0.0);
+
+        buf.resize(101);
+        EXPECT_EQ(buf.capacity(), 101);
+        EXPECT_TRUE(isAligned(buf.data(), DefaultAlignment));
+    }
+    // Test: reserve() conserve les éléments et la taille
+    {
+        DenseStorage<float, Dynamic> buf(3);
+        buf[0] = 1.0f;
+        buf[1] = 2.0f;
+        buf[2] = 3.0f;
+        buf.reserve(64);
+        EXPECT_EQ(buf.size(), 3);
+        EXPECT_EQ(buf.capacity(), 64);
+        EXPECT_DOUBLE_EQ(buf[0], 1.0f);
+        EXPECT_DOUBLE_EQ(buf[2], 3.0f);
+
+        const float* data = buf.data();
+        buf.reserve(8);
+        EXPECT_EQ(buf.data(), data);
+        EXPECT_EQ(buf.capacity(), 64);
+    }
+    // Test: shrink_to_fit() libère la mémoire inutilisée
+    {
+        DenseStorage<float, Dynamic> buf(64);
+        buf.resize(4, Uninitialized);
+        buf[0] = 9.0f;
+        buf.resize(32, Uninitialized);
+        buf.shrink_to_fit();
+        EXPECT_EQ(buf.capacity(), 32);
+        EXPECT_DOUBLE_EQ(buf[0], 9.0f);
+
+        // Les données reviennent dans le tampon interne.
+        buf.resize(4, Uninitialized);
+        buf.shrink_to_fit();
+        EXPECT_EQ(buf.capacity(), (DenseStorage<float, Dynamic>::inlineCapacity()));
+        EXPECT_DOUBLE_EQ(buf[0], 9.0f);
+    }
+    // Test: la copie réutilise le tampon de destination
+    {
+        DenseStorage<int, Dynamic> a(10), b(20);
+        const int* data = b.data();
+        a[9] = 4;
+        b = a;
+        EXPECT_EQ(b.data(), data);
+        EXPECT_EQ(b.size(), 10);
+        EXPECT_EQ(b[9], 4);
+    }
+}
+
+/**
+ * Tampon interne des petits stockages dynamiques.
+ */
+TEST(TestsDenseStorage, TamponInterne)
+{
+    typedef DenseStorage<double, Dynamic> Storage;
+    const int n = Storage::inlineCapacity();
+    ASSERT_GT(n, 0);
+
+    // Test: un petit tampon est stocké dans l'objet lui-même
+    {
+        Storage buf(n);
+        const char* begin = reinterpret_cast<const char*>(&buf);
+        const char* data = reinterpret_cast<const char*>(buf.data());
+        EXPECT_TRUE(begin <= data && data < begin + sizeof(Storage));
+        EXPECT_EQ(buf.capacity(), n);
+        EXPECT_TRUE(isAligned(buf.data(), Storage::alignment()));
+        for (int i = 0; i < n; ++i)
+            EXPECT_DOUBLE_EQ(buf[i], 0.0);
+    }
+    // Test: la copie et le déplacement d'un petit tampon copient les données
+    {
+        Storage a(3);
+        a[0] = 1.0; a[1] = 2.0; a[2] = 3.0;
+        Storage b(a);
+        EXPECT_NE(b.data(), a.data());
+        EXPECT_DOUBLE_EQ(b[2], 3.0);
+
+        Storage c(std::move(b));
+        EXPECT_EQ(b.size(), 0);
+        EXPECT_EQ(c.size(), 3);
+        EXPECT_DOUBLE_EQ(c[0], 1.0);
+
+        Storage d(2 * n);
+        const double* heap = d.data();
+        d = std::move(c);
+        EXPECT_EQ(d.data(), heap);
+        EXPECT_EQ(d.size(), 3);
+        EXPECT_DOUBLE_EQ(d[1], 2.0);
+    }
+    // Test: au-delà de la capacité interne, les données passent sur le tas
+    {
+        Storage buf(n);
+        buf[n - 1] = 5.0;
+        buf.reserve(n + 1);
+        EXPECT_EQ(buf.capacity(), n + 1);
+        EXPECT_DOUBLE_EQ(buf[n - 1], 5.0);
+        EXPECT_TRUE(isAligned(buf.data(), DefaultAlignment));
+
+        Storage moved(std::move(buf));
+        EXPECT_EQ(moved.capacity(), n + 1);
+        EXPECT_EQ(buf.capacity(), n);
+    }
+    // Test: la capacité interne est configurable
+    {
+        DenseStorage<float, Dynamic, DefaultAlignment, DefaultAllocator, 0> buf(1);
+        EXPECT_EQ(buf.capacity(), 1);
+        DenseStorage<float, Dynamic, DefaultAlignment, DefaultAllocator, 0> empty;
+        EXPECT_EQ(empty.data(), nullptr);
+    }
+}
+
+/**
+ * Copie sur écriture des tampons du tas.
+ */
+TEST(TestsDenseStorage, CopieSurEcriture)
+{
+    typedef DenseStorage<double, Dynamic> Storage;
+    const bool saved = copyOnWrite();
+
+    setCopyOnWrite(true);
+    {
+        Storage a(100);
+        a[3] = 3.0;
+        const Storage& ca = a;
+
+        // Test: la copie partage le tampon
+        const Storage b(a);
+        EXPECT_EQ(b.data(), ca.data());
+        EXPECT_TRUE(b.isShared());
+        EXPECT_DOUBLE_EQ(b[3], 3.0);
+
+        // Test: la première écriture détache le tampon modifié
+        a[3] = 4.0;
+        EXPECT_NE(b.data(), ca.data());
+        EXPECT_FALSE(a.isShared());
+        EXPECT_FALSE(b.isShared());
+        EXPECT_DOUBLE_EQ(a[3], 4.0);
+        EXPECT_DOUBLE_EQ(b[3], 3.0);
+
+        // Test: l'affectation partage aussi le tampon
+        Storage c(200);
+        c = b;
+        EXPECT_TRUE(b.isShared());
+        EXPECT_EQ(c.size(), 100);
+        c.setZero();
+        EXPECT_FALSE(b.isShared());
+        EXPECT_DOUBLE_EQ(b[3], 3.0);
+        EXPECT_DOUBLE_EQ(c[3], 0.0);
+
+        // Test: le déplacement transfère la référence
+        Storage d(b);
+        Storage e(std::move(d));
+        EXPECT_TRUE(e.isShared());
+        EXPECT_EQ(static_cast<const Storage&>(e).data(), b.data());
+
+        // Test: les petits tampons (internes) sont toujours copiés
+        Storage small(4);
+        Storage smallCopy(small);
+        EXPECT_FALSE(small.isShared());
+        EXPECT_NE(static_cast<const Storage&>(small).data(), static_cast<const Storage&>(smallCopy).data());
+    }
+
+    // Test: hors du mode copie sur écriture, les copies sont profondes
+    setCopyOnWrite(false);
+    {
+        const Storage a(100);
+        const Storage b(a);
+        EXPECT_FALSE(a.isShared());
+        EXPECT_NE(a.data(), b.data());
+    }
+    setCopyOnWrite(saved);
+}
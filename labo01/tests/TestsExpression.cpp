@@ -0,0 +1,244 @@
+/**
+ * @file TestsExpression.cpp
+ *
+ * @brief Tests unitaires des expressions paresseuses (Expression.h).
+ *
+ */
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Map.h"
+#include "Operators.h"
+#include "Instrumentation.h"
+
+#include <gtest/gtest.h>
+
+using namespace gti320;
+
+namespace {
+
+    template<typename _Matrix>
+    void fill(_Matrix& A, double seed)
+    {
+        for (Index i = 0; i < A.rows(); ++i)
+            for (Index j = 0; j < A.cols(); ++j)
+                A(i, j) = seed + 0.5 * i - 0.25 * j;
+    }
+
+} // namespace
+
+/**
+ * Combinaisons de sommes, différences et produits par un scalaire, selon
+ * l'ordre de stockage des opérandes et de la destination.
+ */
+TEST(TestsExpression, Matrices)
+{
+    Matrix<double> A(7, 5), B(7, 5);
+    Matrix<double, Dynamic, Dynamic, RowStorage> R(7, 5);
+    fill(A, 1.0);
+    fill(B, -3.0);
+    fill(R, 0.5);
+
+    const Matrix<double> C = 2.0 * A + B - R;
+    const Matrix<double, Dynamic, Dynamic, RowStorage> D = A - 0.5 * (R + B);
+    Matrix<double> E;
+    E = 3.0 * (A - B);
+    for (Index i = 0; i < 7; ++i)
+    {
+        for (Index j = 0; j < 5; ++j)
+        {
+            EXPECT_DOUBLE_EQ(C(i, j), 2.0 * A(i, j) + B(i, j) - R(i, j));
+            EXPECT_DOUBLE_EQ(D(i, j), A(i, j) - 0.5 * (R(i, j) + B(i, j)));
+            EXPECT_DOUBLE_EQ(E(i, j), 3.0 * (A(i, j) - B(i, j)));
+        }
+    }
+    EXPECT_EQ(E.rows(), 7);
+    EXPECT_EQ(E.cols(), 5);
+
+    // Lecture d'une entrée sans évaluation, évaluation explicite.
+    EXPECT_DOUBLE_EQ((A + R)(3, 4), A(3, 4) + R(3, 4));
+    const Matrix<double> F = (A + B).eval() * Matrix<double>(5, 2);
+    EXPECT_EQ(F.rows(), 7);
+    EXPECT_EQ(F.cols(), 2);
+
+    // Taille fixe.
+    Matrix<float, 3, 3> I, M;
+    I.setIdentity();
+    M = 2.0f * I - I;
+    EXPECT_FLOAT_EQ(M(1, 1), 1.0f);
+    EXPECT_FLOAT_EQ(M(0, 1), 0.0f);
+}
+
+/**
+ * La destination peut apparaître dans l'expression.
+ */
+TEST(TestsExpression, Vecteurs)
+{
+    const Index n = 33;
+    Vector<double> u(n), v(n), w(n);
+    for (Index i = 0; i < n; ++i)
+    {
+        u(i) = (double)i;
+        v(i) = 1.0 - i;
+        w(i) = 0.5 * i;
+    }
+
+    const Vector<double> w0(w);
+    w = 2.0 * u + v - w;
+    for (Index i = 0; i < n; ++i)
+        EXPECT_DOUBLE_EQ(w(i), 2.0 * u(i) + v(i) - w0(i));
+
+    w = w + w;
+    for (Index i = 0; i < n; ++i)
+        EXPECT_DOUBLE_EQ(w(i), 2.0 * (2.0 * u(i) + v(i) - w0(i)));
+
+    EXPECT_DOUBLE_EQ((u - v)(4), u(4) - v(4));
+
+    // Une expression se convertit en vecteur lorsqu'un vecteur est attendu.
+    EXPECT_DOUBLE_EQ(u.dot(u + v), (double)(n * (n - 1) / 2));
+
+    Vector<float, 3> a, b;
+    a(0) = 1.0f; a(1) = 2.0f; a(2) = 3.0f;
+    b = a + 2.0f * a;
+    EXPECT_FLOAT_EQ(b(2), 9.0f);
+}
+
+/**
+ * Évaluation dans un tampon externe et dans un bloc.
+ */
+TEST(TestsExpression, Destinations)
+{
+    Matrix<double> A(4, 4), B(4, 4);
+    fill(A, 1.0);
+    fill(B, 2.0);
+
+    double buffer[16];
+    Map< Matrix<double, 4, 4> > M(buffer);
+    M = A + B;
+    EXPECT_DOUBLE_EQ(buffer[5], A(1, 1) + B(1, 1));
+
+    Matrix<double> C(6, 6);
+    C.view(1, 2, 4, 4) = A - 2.0 * B;
+    EXPECT_DOUBLE_EQ(C(0, 0), 0.0);
+    EXPECT_DOUBLE_EQ(C(4, 5), A(3, 3) - 2.0 * B(3, 3));
+
+    double x[3] = { 1.0, 2.0, 3.0 };
+    Map< Vector<double> > X(x, 3);
+    Vector<double> y(3);
+    y(0) = 1.0;
+    X = X - y;
+    EXPECT_DOUBLE_EQ(x[0], 0.0);
+    EXPECT_DOUBLE_EQ(x[2], 3.0);
+}
+
+/**
+ * Une expression est évaluée en une seule passe : aucun temporaire.
+ */
+TEST(TestsExpression, SansTemporaire)
+{
+    if (!instrumentationEnabled())
+        GTEST_SKIP() << "GTI320_INSTRUMENTATION est desactive";
+
+    const Index n = 256;
+    Matrix<double> A(n, n), B(n, n), C(n, n);
+    Vector<double> u(n), v(n), w(n);
+
+    MemoryScope scope;
+    C = 2.0 * A + B - 0.5 * C;
+    w = u + 3.0 * v - w;
+    EXPECT_EQ(scope.allocations(), 0u);
+    EXPECT_EQ(scope.copies(), 0u);
+
+    const Matrix<double> D = A + B + C;
+    EXPECT_EQ(scope.allocations(), 1u);
+}
+
+/**
+ * Opérateurs composés : mêmes résultats que l'expression équivalente, quel
+ * que soit l'ordre de stockage ; l'opérande peut être la destination.
+ */
+TEST(TestsExpression, OperateursComposes)
+{
+    Matrix<double> A(5, 7), B(5, 7);
+    Matrix<double, Dynamic, Dynamic, RowStorage> R(5, 7);
+    fill(A, 1.0);
+    fill(B, -2.0);
+    fill(R, 0.5);
+
+    Matrix<double> C(A);
+    C += B;
+    C -= R;
+    C += 2.0 * B;
+    C -= A + R;
+    C *= 0.5;
+    for (Index i = 0; i < 5; ++i)
+        for (Index j = 0; j < 7; ++j)
+            EXPECT_NEAR(C(i, j), 0.5 * (A(i, j) + B(i, j) - R(i, j) + 2.0 * B(i, j) - (A(i, j) + R(i, j))), 1e-12);
+
+    Matrix<double, Dynamic, Dynamic, RowStorage> S(R);
+    S += A;
+    S -= 3.0 * A;
+    for (Index i = 0; i < 5; ++i)
+        for (Index j = 0; j < 7; ++j)
+            EXPECT_NEAR(S(i, j), R(i, j) - 2.0 * A(i, j), 1e-12);
+    S -= S;
+    EXPECT_EQ(S(4, 6), 0.0);
+
+    Vector<double> x(11), y(11);
+    for (Index i = 0; i < 11; ++i)
+    {
+        x(i) = 0.5 * i;
+        y(i) = 3.0 - i;
+    }
+    const Vector<double> x0(x);
+    x += y;
+    x -= 0.5 * y;
+    x *= 3.0;
+    x += x - y;
+    for (Index i = 0; i < 11; ++i)
+        EXPECT_NEAR(x(i), 2.0 * 3.0 * (x0(i) + 0.5 * y(i)) - y(i), 1e-12);
+
+    // Taille fixe.
+    Vector<float, 3> a;
+    a(0) = 1.0f; a(1) = 2.0f; a(2) = 3.0f;
+    a += a;
+    a *= 0.5f;
+    a -= 2.0f * a;
+    EXPECT_FLOAT_EQ(a(2), -3.0f);
+
+    Matrix<float, 4, 4> M, N;
+    M.setIdentity();
+    N.setIdentity();
+    M += 3.0f * N;
+    EXPECT_FLOAT_EQ(M(1, 1), 4.0f);
+    EXPECT_FLOAT_EQ(M(1, 2), 0.0f);
+}
+
+/**
+ * y = a * x + b * y en une passe (noyau axpby), que la destination soit la
+ * première ou la seconde feuille.
+ */
+TEST(TestsExpression, CombinaisonEnPlace)
+{
+    const Index n = 37;
+    Vector<double> x(n), y(n), z(n);
+    for (Index i = 0; i < n; ++i)
+    {
+        x(i) = 1.0 / (1.0 + i);
+        y(i) = 0.25 * i - 2.0;
+    }
+    const Vector<double> y0(y);
+
+    y = 2.0 * x + 0.5 * y;
+    for (Index i = 0; i < n; ++i)
+        EXPECT_NEAR(y(i), 2.0 * x(i) + 0.5 * y0(i), 1e-14);
+
+    const Vector<double> y1(y);
+    y = 0.25 * y + 3.0 * x;
+    for (Index i = 0; i < n; ++i)
+        EXPECT_NEAR(y(i), 0.25 * y1(i) + 3.0 * x(i), 1e-14);
+
+    z = 2.0 * x + 0.5 * y;
+    for (Index i = 0; i < n; ++i)
+        EXPECT_EQ(z(i), 2.0 * x(i) + 0.5 * y(i));
+}
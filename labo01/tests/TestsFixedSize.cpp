@@ -0,0 +1,209 @@
+/**
+ * @file TestsFixedSize.cpp
+ *
+ * @brief Tests unitaires des noyaux déroulés pour les petites matrices de
+ *        taille fixe (FixedSize.h).
+ *
+ * Chaque résultat est comparé au même calcul sur des matrices de taille
+ * dynamique, qui passe par les noyaux génériques.
+ *
+ */
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Operators.h"
+
+#include <gtest/gtest.h>
+
+using namespace gti320;
+
+namespace {
+
+    template<typename _Matrix>
+    void fill(_Matrix& A, double seed)
+    {
+        for (Index i = 0; i < A.rows(); ++i)
+            for (Index j = 0; j < A.cols(); ++j)
+                A(i, j) = seed + 0.5 * i - 0.25 * j + 0.125 * i * j;
+    }
+
+    template<typename _Fixed, typename _Dynamic>
+    void expectEqual(const _Fixed& F, const _Dynamic& D)
+    {
+        ASSERT_EQ(F.rows(), D.rows());
+        ASSERT_EQ(F.cols(), D.cols());
+        for (Index i = 0; i < F.rows(); ++i)
+            for (Index j = 0; j < F.cols(); ++j)
+                EXPECT_DOUBLE_EQ(F(i, j), D(i, j)) << "(" << i << ", " << j << ")";
+    }
+
+    template<int _RowsF, int _RowsD>
+    void expectEqual(const Vector<double, _RowsF>& F, const Vector<double, _RowsD>& D)
+    {
+        ASSERT_EQ(F.rows(), D.rows());
+        for (Index i = 0; i < F.rows(); ++i)
+            EXPECT_DOUBLE_EQ(F(i), D(i)) << i;
+    }
+
+    /**
+     * Produit (R x K) * (K x C) pour une combinaison d'ordres de stockage.
+     */
+    template<int _Rows, int _Inner, int _Cols, int _StorageA, int _StorageB>
+    void checkProduct()
+    {
+        Matrix<double, _Rows, _Inner, _StorageA> A;
+        Matrix<double, _Inner, _Cols, _StorageB> B;
+        fill(A, 1.0);
+        fill(B, -2.0);
+
+        Matrix<double, Dynamic, Dynamic, _StorageA> DA(_Rows, _Inner);
+        Matrix<double, Dynamic, Dynamic, _StorageB> DB(_Inner, _Cols);
+        fill(DA, 1.0);
+        fill(DB, -2.0);
+
+        const Matrix<double, _Rows, _Cols> C = A * B;
+        expectEqual(C, DA * DB);
+
+        Matrix<double, _Rows, _Cols, RowStorage> R;
+        multiply(A, B, R);
+        expectEqual(R, DA * DB);
+    }
+
+} // namespace
+
+/**
+ * Produits matrice * matrice, de toutes les combinaisons d'ordres de
+ * stockage, et produit au-delà de GTI320_UNROLL_LIMIT (noyau générique).
+ */
+TEST(TestsFixedSize, Produits)
+{
+    checkProduct<3, 3, 3, ColumnStorage, ColumnStorage>();
+    checkProduct<4, 4, 4, ColumnStorage, ColumnStorage>();
+    checkProduct<4, 4, 4, RowStorage, ColumnStorage>();
+    checkProduct<4, 4, 4, ColumnStorage, RowStorage>();
+    checkProduct<4, 4, 4, RowStorage, RowStorage>();
+    checkProduct<2, 5, 3, ColumnStorage, RowStorage>();
+    checkProduct<3, 1, 4, RowStorage, ColumnStorage>();
+    checkProduct<8, 8, 8, ColumnStorage, ColumnStorage>();
+
+    // Destination qui est aussi une opérande.
+    Matrix<double, 3, 3> A;
+    fill(A, 0.5);
+    Matrix<double> D(3, 3);
+    fill(D, 0.5);
+    multiply(A, A, A);
+    expectEqual(A, D * D);
+}
+
+/**
+ * Produits matrice * vecteur, dont la rotation d'un Vector3 par une
+ * matrice 3x3 stockée par lignes.
+ */
+TEST(TestsFixedSize, ProduitsMatriceVecteur)
+{
+    Matrix<double, 3, 3, RowStorage> R;
+    Matrix<double, 4, 4> M;
+    Matrix<double, 2, 5> W;
+    fill(R, 1.0);
+    fill(M, -1.0);
+    fill(W, 0.25);
+
+    Matrix<double, Dynamic, Dynamic, RowStorage> DR(3, 3);
+    Matrix<double> DM(4, 4), DW(2, 5);
+    fill(DR, 1.0);
+    fill(DM, -1.0);
+    fill(DW, 0.25);
+
+    Vector<double, 3> x3;
+    Vector<double, 4> x4;
+    Vector<double, 5> x5;
+    Vector<double> d3(3), d4(4), d5(5);
+    for (Index i = 0; i < 5; ++i)
+    {
+        if (i < 3) { x3(i) = d3(i) = 1.0 - i; }
+        if (i < 4) { x4(i) = d4(i) = 0.5 * i; }
+        x5(i) = d5(i) = i * i - 2.0;
+    }
+
+    expectEqual(R * x3, DR * d3);
+    expectEqual(M * x4, DM * d4);
+    expectEqual(W * x5, DW * d5);
+
+    const Vector<double> expected = DR * d3;
+    multiply(R, x3, x3);
+    expectEqual(x3, expected);
+}
+
+/**
+ * Transposées déroulées, dans les deux ordres de stockage.
+ */
+TEST(TestsFixedSize, Transposees)
+{
+    Matrix<double, 3, 4> A;
+    Matrix<double, 2, 5, RowStorage> B;
+    fill(A, 1.5);
+    fill(B, -0.5);
+
+    const Matrix<double, 4, 3> AT = A.transpose<double, 4, 3, ColumnStorage>();
+    const Matrix<double, 4, 3, RowStorage> AR = A.transpose<double, 4, 3, RowStorage>();
+    const Matrix<double, 5, 2> BT = B.transpose();
+    for (Index i = 0; i < 3; ++i)
+        for (Index j = 0; j < 4; ++j)
+        {
+            EXPECT_EQ(AT(j, i), A(i, j));
+            EXPECT_EQ(AR(j, i), A(i, j));
+        }
+    for (Index i = 0; i < 2; ++i)
+        for (Index j = 0; j < 5; ++j)
+            EXPECT_EQ(BT(j, i), B(i, j));
+}
+
+/**
+ * Affectation d'expressions et opérateurs composés déroulés, y compris
+ * une expression dont l'ordre de stockage diffère de la destination.
+ */
+TEST(TestsFixedSize, Expressions)
+{
+    Matrix<double, 4, 4> A, B;
+    Matrix<double, 4, 4, RowStorage> R;
+    fill(A, 1.0);
+    fill(B, -3.0);
+    fill(R, 0.5);
+
+    Matrix<double> DA(4, 4), DB(4, 4);
+    Matrix<double, Dynamic, Dynamic, RowStorage> DR(4, 4);
+    fill(DA, 1.0);
+    fill(DB, -3.0);
+    fill(DR, 0.5);
+
+    Matrix<double, 4, 4> C;
+    C = 2.0 * A - B;
+    expectEqual(C, Matrix<double>(2.0 * DA - DB));
+
+    C = A + R;
+    expectEqual(C, Matrix<double>(DA + DR));
+
+    C += B;
+    C -= 0.5 * A;
+    C *= 3.0;
+    Matrix<double> DC = DA + DR;
+    DC += DB;
+    DC -= 0.5 * DA;
+    DC *= 3.0;
+    expectEqual(C, DC);
+
+    Vector<double, 3> u, v;
+    Vector<double> du(3), dv(3);
+    for (Index i = 0; i < 3; ++i)
+    {
+        u(i) = du(i) = 1.0 + i;
+        v(i) = dv(i) = 2.0 - i;
+    }
+    u += 2.0 * v;
+    u -= v;
+    u *= -0.5;
+    du += 2.0 * dv;
+    du -= dv;
+    du *= -0.5;
+    expectEqual(u, du);
+}
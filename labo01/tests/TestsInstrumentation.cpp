@@ -0,0 +1,300 @@
+/**
+ * @file TestsInstrumentation.cpp
+ *
+ * @brief Budgets d'allocations et de copies des chemins critiques, mesurés
+ *        par les compteurs de Instrumentation.h.
+ *
+ * Contrairement à TestsAllocation.cpp, qui remplace operator new[], ces
+ * compteurs voient aussi les copies profondes (y compris celles qui
+ * réutilisent un tampon existant) et les tampons servis par une arène. Les
+ * tests sont ignorés si GTI320_INSTRUMENTATION est nul.
+ *
+ */
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Operators.h"
+#include "SparseMatrix.h"
+#include "Instrumentation.h"
+
+#include <gtest/gtest.h>
+#include <utility>
+#include <vector>
+
+using namespace gti320;
+
+namespace {
+
+    /**
+     * Remet les compteurs à zéro avant chaque test.
+     */
+    class TestsInstrumentation : public ::testing::Test
+    {
+    protected:
+
+        void SetUp() override
+        {
+            if (!instrumentationEnabled())
+                GTEST_SKIP() << "GTI320_INSTRUMENTATION est desactive";
+            resetMemoryCounters();
+        }
+    };
+
+} // namespace
+
+/**
+ * Allocation, copie et libération d'un tampon dynamique.
+ */
+TEST_F(TestsInstrumentation, Compteurs)
+{
+    const size_t bytes = sizeof(double) * paddedSize<double, DefaultAlignment>(100);
+    const size_t live = memoryCounters().liveBytes;
+    {
+        DenseStorage<double, Dynamic> a(100);
+        EXPECT_EQ(memoryCounters().allocations, 1u);
+        EXPECT_EQ(memoryCounters().bytesAllocated, bytes);
+        EXPECT_EQ(memoryCounters().copies, 0u);
+
+        DenseStorage<double, Dynamic> b(a);
+        EXPECT_EQ(memoryCounters().allocations, 2u);
+        EXPECT_EQ(memoryCounters().copies, 1u);
+        EXPECT_EQ(memoryCounters().bytesCopied, sizeof(double) * 100);
+        EXPECT_EQ(memoryCounters().liveBytes, live + 2 * bytes);
+
+        // Un déplacement récupère le tampon : ni allocation, ni copie.
+        DenseStorage<double, Dynamic> c(std::move(b));
+        EXPECT_EQ(memoryCounters().allocations, 2u);
+        EXPECT_EQ(memoryCounters().copies, 1u);
+
+        // Une affectation qui tient dans la capacité copie sans allouer.
+        a = c;
+        EXPECT_EQ(memoryCounters().allocations, 2u);
+        EXPECT_EQ(memoryCounters().copies, 2u);
+
+        // Le tampon interne n'alloue rien, mais sa copie est comptée.
+        DenseStorage<double, Dynamic> small(4);
+        DenseStorage<double, Dynamic> small2(small);
+        EXPECT_EQ(memoryCounters().allocations, 2u);
+        EXPECT_EQ(memoryCounters().copies, 3u);
+
+        // Stockage fixe : copies seulement.
+        DenseStorage<float, 16> f;
+        DenseStorage<float, 16> g(f);
+        EXPECT_EQ(memoryCounters().copies, 4u);
+    }
+    EXPECT_EQ(memoryCounters().frees, 2u);
+    EXPECT_EQ(memoryCounters().liveBytes, live);
+    EXPECT_EQ(memoryCounters().peakBytes, live + 2 * bytes);
+
+    resetMemoryCounters();
+    EXPECT_EQ(memoryCounters().allocations, 0u);
+    EXPECT_EQ(memoryCounters().peakBytes, live);
+}
+
+/**
+ * Produits dynamiques : une seule allocation (le résultat), aucune copie ; le
+ * résultat est déplacé dans la destination. Les sommes sont évaluées dans la
+ * destination, sans allocation.
+ */
+TEST_F(TestsInstrumentation, BudgetOperateurs)
+{
+    const int n = 64;
+    Matrix<double> A(n, n), B(n, n), C(n, n);
+    Matrix<double, Dynamic, Dynamic, RowStorage> R(n, n);
+    Vector<double> v(n), w(n);
+
+    {
+        MemoryScope scope;
+        C = A * B;
+        EXPECT_EQ(scope.allocations(), 1u) << "C = A * B";
+        EXPECT_EQ(scope.copies(), 0u) << "C = A * B";
+    }
+    {
+        MemoryScope scope;
+        C = R * A;
+        EXPECT_EQ(scope.allocations(), 1u) << "C = R * A";
+        EXPECT_EQ(scope.copies(), 0u) << "C = R * A";
+    }
+    {
+        MemoryScope scope;
+        Matrix<double> D = A * R;
+        EXPECT_EQ(scope.allocations(), 1u) << "Matrix D = A * R";
+        EXPECT_EQ(scope.copies(), 0u) << "Matrix D = A * R";
+        EXPECT_EQ(scope.peakBytes(), sizeof(double) * n * n);
+    }
+    {
+        MemoryScope scope;
+        C = A + B;
+        EXPECT_EQ(scope.allocations(), 0u) << "C = A + B";
+        EXPECT_EQ(scope.copies(), 0u) << "C = A + B";
+    }
+    {
+        MemoryScope scope;
+        w = 2.0 * v - A * v + w;
+        EXPECT_EQ(scope.allocations(), 1u) << "w = 2.0 * v - A * v + w";
+        EXPECT_EQ(scope.copies(), 0u) << "w = 2.0 * v - A * v + w";
+    }
+    {
+        MemoryScope scope;
+        w = A * v;
+        EXPECT_EQ(scope.allocations(), 1u) << "w = A * v";
+        EXPECT_EQ(scope.copies(), 0u) << "w = A * v";
+    }
+    {
+        MemoryScope scope;
+        w = R * v;
+        EXPECT_EQ(scope.allocations(), 1u) << "w = R * v";
+        EXPECT_EQ(scope.copies(), 0u) << "w = R * v";
+    }
+}
+
+/**
+ * Produits de petites matrices de taille fixe : rien n'est alloué.
+ */
+TEST_F(TestsInstrumentation, BudgetTailleFixe)
+{
+    Matrix<float, 4, 4> A, B;
+    Vector<float, 4> v;
+    A.setIdentity();
+    B.setIdentity();
+
+    MemoryScope scope;
+    for (int i = 0; i < 100; ++i)
+    {
+        A = A * B;
+        v = A * v;
+    }
+    EXPECT_EQ(scope.allocations(), 0u);
+    EXPECT_EQ(scope.bytesAllocated(), 0u);
+}
+
+/**
+ * Matrices creuses : les tampons des valeurs et des indices sont comptés. Un
+ * déplacement récupère les tampons du tas ; seuls les petits tampons internes
+ * (ici, les débuts de lignes) sont copiés.
+ */
+TEST_F(TestsInstrumentation, MatriceCreuse)
+{
+    SparseMatrix<double> A(3, 3);
+    TripletType<double> triplets[] = { { 1.0, 1, 1 }, { 2.5, 2, 1 }, { -0.1, 2, 2 }, { 6.0, 0, 0 } };
+    A.reserve(64);
+    A.setFromTriplets(triplets, 4);
+    EXPECT_GT(memoryCounters().allocations, 0u);
+
+    {
+        MemoryScope scope;
+        SparseMatrix<double> B(A);
+        EXPECT_EQ(scope.copies(), 3u);
+        EXPECT_GE(scope.bytesCopied(), sizeof(double) * 4 + sizeof(Index) * 4);
+    }
+    {
+        MemoryScope scope;
+        SparseMatrix<double> C(std::move(A));
+        EXPECT_EQ(scope.allocations(), 0u);
+        EXPECT_EQ(scope.copies(), 1u);
+        EXPECT_DOUBLE_EQ(C(2, 1), 2.5);
+    }
+}
+
+/**
+ * Gradient conjugué (matrice dense, puis creuse) : après la première
+ * itération, les produits écrivent dans des vecteurs existants et les mises
+ * à jour se font en place. La boucle n'alloue et ne copie rien.
+ */
+TEST_F(TestsInstrumentation, BudgetSolveur)
+{
+    const int n = 64;
+    Matrix<double> A(n, n);
+    std::vector< TripletType<double> > triplets;
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+            A(i, j) = (i == j) ? 4.0 : 1.0 / (1.0 + (i - j) * (i - j));
+        triplets.push_back({ 4.0, i, i });
+        if (i > 0)
+            triplets.push_back({ -1.0, i, i - 1 });
+        if (i + 1 < n)
+            triplets.push_back({ -1.0, i, i + 1 });
+    }
+    SparseMatrix<double> L(n, n);
+    L.setFromTriplets(triplets.data(), (int)triplets.size());
+
+    Vector<double> b(n);
+    for (int i = 0; i < n; ++i)
+        b(i) = 1.0 + (i % 3);
+
+    Vector<double> x(n), r(n), p(n), q(n), check(n);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        x.setZero();
+        r = b;
+        p = r;
+        double rr = r.dot(r);
+
+        MemoryScope scope;
+        for (int it = 0; it < n && rr > 1e-24; ++it)
+        {
+            if (pass == 0)
+                multiply(A, p, q);
+            else
+                multiply(L, p, q);
+            const double alpha = rr / p.dot(q);
+            x += alpha * p;
+            r -= alpha * q;
+            const double rr1 = r.dot(r);
+            axpby(1.0, r, rr1 / rr, p);
+            rr = rr1;
+        }
+        EXPECT_EQ(scope.allocations(), 0u) << (pass == 0 ? "dense" : "creuse");
+        EXPECT_EQ(scope.copies(), 0u) << (pass == 0 ? "dense" : "creuse");
+
+        if (pass == 0)
+            multiply(A, x, check);
+        else
+            multiply(L, x, check);
+        check -= b;
+        EXPECT_LT(check.norm(), 1e-9);
+    }
+}
+
+/**
+ * Produit creux parallèle : le découpage des lignes est calculé une fois
+ * et partagé par les appels suivants, qui n'allouent rien. Un nouveau
+ * nombre de fils recalcule le découpage, ce que les compteurs voient.
+ */
+TEST_F(TestsInstrumentation, DecoupageCreuxParallele)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const int n = 400000;
+    std::vector< TripletType<double> > triplets;
+    for (int i = 0; i < n; ++i)
+    {
+        triplets.push_back({ 2.0, i, i });
+        if (i > 0)
+            triplets.push_back({ -1.0, i, i - 1 });
+        if (i + 1 < n)
+            triplets.push_back({ -1.0, i, i + 1 });
+    }
+    SparseMatrix<double> L(n, n);
+    L.setFromTriplets(triplets.data(), (int)triplets.size());
+    Vector<double> x(n), y(n);
+    for (int i = 0; i < n; ++i)
+        x(i) = 1.0;
+
+    setParallelThreads(4);
+    multiply(L, x, y);
+    {
+        MemoryScope scope;
+        for (int it = 0; it < 10; ++it)
+            multiply(L, x, y);
+        EXPECT_EQ(scope.allocations(), 0u);
+
+        setParallelThreads(3);
+        multiply(L, x, y);
+        multiply(L, x, y);
+        EXPECT_EQ(scope.allocations(), 1u);
+    }
+    EXPECT_DOUBLE_EQ(y(0), 1.0);
+    EXPECT_DOUBLE_EQ(y(n / 2), 0.0);
+    setParallelThreads(saved);
+}
@@ -0,0 +1,223 @@
+/**
+ * @file TestsMap.cpp
+ *
+ * @brief Tests unitaires des vues Map sur des tampons externes.
+ *
+ */
+
+#include "Map.h"
+#include "Operators.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace gti320;
+
+/**
+ * Lecture et écriture à travers une vue, selon l'ordre de stockage.
+ */
+TEST(TestsMap, Stockage)
+{
+    double buffer[6] = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 };
+
+    Map< Matrix<double> > C(buffer, 2, 3);
+    EXPECT_TRUE(C.isExternal());
+    EXPECT_EQ(C.data(), buffer);
+    EXPECT_EQ(C.rows(), 2);
+    EXPECT_EQ(C.cols(), 3);
+    EXPECT_DOUBLE_EQ(C(1, 0), 2.0);
+    EXPECT_DOUBLE_EQ(C(0, 1), 3.0);
+
+    Map< Matrix<double, Dynamic, Dynamic, RowStorage> > R(buffer, 2, 3);
+    EXPECT_DOUBLE_EQ(R(1, 0), 4.0);
+    EXPECT_DOUBLE_EQ(R(0, 1), 2.0);
+
+    // Les écritures sont faites dans le tampon.
+    C(1, 2) = -6.0;
+    EXPECT_DOUBLE_EQ(buffer[5], -6.0);
+    EXPECT_DOUBLE_EQ(R(1, 2), -6.0);
+
+    // Une copie de la vue partage le tampon ; une matrice construite à
+    // partir de la vue possède ses données.
+    Map< Matrix<double> > C2(C);
+    EXPECT_EQ(C2.data(), buffer);
+    Matrix<double> owned(C);
+    EXPECT_FALSE(owned.isExternal());
+    EXPECT_NE(owned.data(), buffer);
+    owned(0, 0) = 10.0;
+    EXPECT_DOUBLE_EQ(buffer[0], 1.0);
+
+    // Le tampon n'est pas libéré par la vue.
+    {
+        Map< Matrix<double> > tmp(buffer, 3, 2);
+        tmp.setZero();
+    }
+    EXPECT_DOUBLE_EQ(buffer[5], 0.0);
+}
+
+/**
+ * Vues de taille fixe et vues de vecteurs.
+ */
+TEST(TestsMap, TailleFixe)
+{
+    float m[16];
+    Map< Matrix<float, 4, 4> > M(m);
+    EXPECT_EQ(M.rows(), 4);
+    EXPECT_EQ(M.cols(), 4);
+
+    Matrix<float, 4, 4> I;
+    I.setIdentity();
+    M = I;
+    for (int j = 0; j < 4; ++j)
+        for (int i = 0; i < 4; ++i)
+            EXPECT_FLOAT_EQ(m[i + 4 * j], i == j ? 1.0f : 0.0f);
+
+    float v[3] = { 1.0f, 2.0f, 3.0f };
+    Map< Vector<float, 3> > w(v);
+    EXPECT_EQ(w.rows(), 3);
+    EXPECT_FLOAT_EQ(w(2), 3.0f);
+    EXPECT_FLOAT_EQ(w.norm(), std::sqrt(14.0f));
+
+    Vector<float, 3> u;
+    u(0) = 4.0f; u(1) = 5.0f; u(2) = 6.0f;
+    w = u;
+    EXPECT_FLOAT_EQ(v[1], 5.0f);
+
+    Map< Vector<float> > x(v, 2);
+    EXPECT_EQ(x.rows(), 2);
+    EXPECT_FLOAT_EQ(x(1), 5.0f);
+}
+
+/**
+ * Les opérateurs acceptent les vues, et un résultat affecté à une vue est
+ * écrit dans son tampon.
+ */
+TEST(TestsMap, Operateurs)
+{
+    const int rows = 7, cols = 5;
+    double a[rows * cols], b[rows * cols], c[rows * cols], x[cols], y[rows];
+    for (int k = 0; k < rows * cols; ++k)
+    {
+        a[k] = 0.5 * k;
+        b[k] = 1.0 - k;
+    }
+    for (int k = 0; k < cols; ++k)
+        x[k] = k + 1.0;
+
+    Map< Matrix<double> > A(a, rows, cols);
+    Map< Matrix<double> > B(b, rows, cols);
+    Map< Matrix<double> > C(c, rows, cols);
+    Map< Vector<double> > X(x, cols);
+    Map< Vector<double> > Y(y, rows);
+
+    const Matrix<double> Acopy(A);
+    const Matrix<double> Bcopy(B);
+    const Vector<double> Xcopy(X);
+
+    C = A + B;
+    for (int k = 0; k < rows * cols; ++k)
+        EXPECT_DOUBLE_EQ(c[k], a[k] + b[k]);
+
+    C = 2.0 * A;
+    for (int k = 0; k < rows * cols; ++k)
+        EXPECT_DOUBLE_EQ(c[k], 2.0 * a[k]);
+
+    Y = A * X;
+    const Vector<double> ycopy = Acopy * Xcopy;
+    for (int i = 0; i < rows; ++i)
+        EXPECT_DOUBLE_EQ(y[i], ycopy(i));
+
+    // Produit avec une vue par lignes sur le même tampon (transposée de A).
+    Map< Matrix<double, Dynamic, Dynamic, RowStorage> > At(a, cols, rows);
+    const Matrix<double> AtA = At * A;
+    const Matrix<double> AtAcopy = Acopy.transpose<double, Dynamic, Dynamic, ColumnStorage>() * Acopy;
+    ASSERT_EQ(AtA.rows(), cols);
+    ASSERT_EQ(AtA.cols(), cols);
+    for (int j = 0; j < cols; ++j)
+        for (int i = 0; i < cols; ++i)
+            EXPECT_NEAR(AtA(i, j), AtAcopy(i, j), 1e-9);
+
+    const Vector<double> z = X + Xcopy;
+    EXPECT_DOUBLE_EQ(z(cols - 1), 2.0 * cols);
+    EXPECT_DOUBLE_EQ(X.dot(Xcopy), Xcopy.dot(Xcopy));
+
+    // Aucune opération n'a modifié les tampons des opérandes.
+    for (int k = 0; k < rows * cols; ++k)
+        EXPECT_DOUBLE_EQ(b[k], Bcopy.data()[k]);
+}
+
+/**
+ * Une vue redimensionnée au-delà de son tampon échoue au lieu de s'en
+ * détacher ; en deçà, elle continue d'écrire dans le tampon.
+ */
+TEST(TestsMap, Redimensionnement)
+{
+    Matrix<double> M(4, 3);
+    Matrix<double> N(2, 3);
+    for (int j = 0; j < 3; ++j)
+    {
+        for (int i = 0; i < 4; ++i)
+            M(i, j) = i + 10.0 * j;
+        for (int i = 0; i < 2; ++i)
+            N(i, j) = 1.0;
+    }
+    Vector<double> x(3);
+    x(0) = 1.0;
+    x(1) = 2.0;
+    x(2) = 3.0;
+
+    double buf[4] = { 0.0, 0.0, 0.0, 0.0 };
+    Map< Vector<double> > y(buf, 2);
+    EXPECT_THROW(multiply(M, x, y), std::length_error);
+    EXPECT_TRUE(y.isExternal());
+    EXPECT_EQ(y.data(), buf);
+    EXPECT_EQ(y.rows(), 2);
+
+    Map< Vector<double> > z(buf, 4);
+    multiply(N, x, z);
+    EXPECT_TRUE(z.isExternal());
+    EXPECT_EQ(z.rows(), 2);
+    EXPECT_DOUBLE_EQ(buf[0], 6.0);
+    EXPECT_DOUBLE_EQ(buf[1], 6.0);
+
+    multiply(M, x, z);
+    EXPECT_TRUE(z.isExternal());
+    EXPECT_EQ(z.data(), buf);
+    EXPECT_EQ(z.rows(), 4);
+    EXPECT_DOUBLE_EQ(buf[3], 3.0 + 2.0 * 13.0 + 3.0 * 23.0);
+
+    double m[6];
+    Map< Matrix<double> > C(m, 2, 3);
+    EXPECT_THROW(C.resize(3, 3), std::length_error);
+    EXPECT_TRUE(C.isExternal());
+    C.resize(3, 2);
+    EXPECT_EQ(C.data(), m);
+}
+
+/**
+ * Vue sur les données d'une matrice projetée en mémoire.
+ */
+TEST(TestsMap, FichierProjete)
+{
+    const char* path = "gti320_map.mat";
+    std::remove(path);
+    {
+        MappedFile file;
+        ASSERT_TRUE(file.open(path, MapCreate, matrixFileLength<double>(3, 3)));
+        writeMatrixHeader<double>(file, ColumnStorage, 3, 3);
+
+        double* data = reinterpret_cast<double*>(static_cast<char*>(file.data()) + sizeof(MatrixFileHeader));
+        Map< Matrix<double, 3, 3> > M(data);
+        M.setIdentity();
+        M = 3.0 * M;
+        file.flush();
+    }
+
+    Matrix<double> A;
+    ASSERT_TRUE(A.openMapped(path));
+    for (int j = 0; j < 3; ++j)
+        for (int i = 0; i < 3; ++i)
+            EXPECT_DOUBLE_EQ(A(i, j), i == j ? 3.0 : 0.0);
+    std::remove(path);
+}
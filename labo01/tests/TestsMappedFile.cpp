@@ -0,0 +1,249 @@
+/**
+ * @file TestsMappedFile.cpp
+ *
+ * @brief Tests unitaires des matrices projetées en mémoire (mmap).
+ *
+ */
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Operators.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using namespace gti320;
+
+namespace {
+
+    /**
+     * Supprime le fichier à la sortie de la portée.
+     */
+    struct TemporaryFile
+    {
+        explicit TemporaryFile(const char* _path) : path(_path) { std::remove(path); }
+        ~TemporaryFile() { std::remove(path); }
+        const char* path;
+    };
+
+    /**
+     * Crée le fichier d'une matrice rows x cols dont l'entrée (i,j) vaut i + 1000*j.
+     */
+    void createMatrixFile(const char* path, int rows, int cols)
+    {
+        Matrix<double> A;
+        ASSERT_TRUE(A.createMapped(path, rows, cols));
+        for (int j = 0; j < cols; ++j)
+            for (int i = 0; i < rows; ++i)
+                A(i, j) = i + 1000.0 * j;
+        A.flush();
+    }
+
+} // namespace
+
+/**
+ * Création d'un fichier, puis relecture.
+ */
+TEST(TestsMappedFile, CreationEtRelecture)
+{
+    TemporaryFile tmp("gti320_creation.mat");
+    createMatrixFile(tmp.path, 67, 45);
+
+    Matrix<double> A;
+    ASSERT_TRUE(A.openMapped(tmp.path));
+    EXPECT_TRUE(A.isMapped());
+    EXPECT_EQ(A.rows(), 67);
+    EXPECT_EQ(A.cols(), 45);
+    EXPECT_TRUE(isAligned(A.data(), A.alignment()));
+    EXPECT_DOUBLE_EQ(A(0, 0), 0.0);
+    EXPECT_DOUBLE_EQ(A(66, 0), 66.0);
+    EXPECT_DOUBLE_EQ(A(5, 44), 44005.0);
+
+    // Une copie est un stockage ordinaire.
+    Matrix<double> B(A);
+    EXPECT_FALSE(B.isMapped());
+    EXPECT_NE(B.data(), A.data());
+    EXPECT_DOUBLE_EQ(B(5, 44), 44005.0);
+
+    // Un déplacement transfère la projection.
+    Matrix<double> C(std::move(A));
+    EXPECT_TRUE(C.isMapped());
+    EXPECT_DOUBLE_EQ(C(66, 0), 66.0);
+}
+
+/**
+ * Les écritures dans une projection en lecture seule ne modifient pas le
+ * fichier ; celles d'une projection en lecture-écriture sont conservées.
+ */
+TEST(TestsMappedFile, ModesOuverture)
+{
+    TemporaryFile tmp("gti320_modes.mat");
+    createMatrixFile(tmp.path, 8, 8);
+    {
+        Matrix<double> A;
+        ASSERT_TRUE(A.openMapped(tmp.path, MapReadOnly));
+        A(3, 3) = -1.0;
+        EXPECT_DOUBLE_EQ(A(3, 3), -1.0);
+    }
+    {
+        Matrix<double> A;
+        ASSERT_TRUE(A.openMapped(tmp.path, MapReadWrite));
+        EXPECT_DOUBLE_EQ(A(3, 3), 3003.0);
+        A(3, 3) = -1.0;
+    }
+    {
+        Matrix<double> A;
+        ASSERT_TRUE(A.openMapped(tmp.path));
+        EXPECT_DOUBLE_EQ(A(3, 3), -1.0);
+    }
+}
+
+/**
+ * Les opérateurs s'appliquent sans modification aux matrices projetées, et
+ * un résultat affecté à une matrice projetée de même taille est écrit dans
+ * son fichier.
+ */
+TEST(TestsMappedFile, Operateurs)
+{
+    TemporaryFile tmpA("gti320_operateurs_A.mat");
+    TemporaryFile tmpV("gti320_operateurs_v.mat");
+    TemporaryFile tmpC("gti320_operateurs_C.mat");
+    createMatrixFile(tmpA.path, 33, 21);
+    {
+        Vector<double> v;
+        ASSERT_TRUE(v.createMapped(tmpV.path, 21));
+        for (int i = 0; i < 21; ++i)
+            v(i) = 0.5 * i;
+    }
+
+    Matrix<double> A;
+    Vector<double> v;
+    ASSERT_TRUE(A.openMapped(tmpA.path));
+    ASSERT_TRUE(v.openMapped(tmpV.path));
+    EXPECT_EQ(v.rows(), 21);
+
+    const Matrix<double> Acopy(A);
+    const Vector<double> vcopy(v);
+
+    const Vector<double> w = A * v;
+    const Vector<double> wcopy = Acopy * vcopy;
+    ASSERT_EQ(w.rows(), 33);
+    for (int i = 0; i < 33; ++i)
+        EXPECT_DOUBLE_EQ(w(i), wcopy(i));
+
+    {
+        Matrix<double> C;
+        ASSERT_TRUE(C.createMapped(tmpC.path, 33, 21));
+        C = A + A;
+        EXPECT_TRUE(C.isMapped());
+        C = 2.0 * C;
+    }
+    Matrix<double> C;
+    ASSERT_TRUE(C.openMapped(tmpC.path));
+    for (int j = 0; j < 21; ++j)
+        for (int i = 0; i < 33; ++i)
+            EXPECT_DOUBLE_EQ(C(i, j), 4.0 * Acopy(i, j));
+
+    // Un résultat de taille différente détache la matrice de son fichier.
+    C = Matrix<double>(64, 64);
+    EXPECT_FALSE(C.isMapped());
+    EXPECT_EQ(C.rows(), 64);
+}
+
+/**
+ * Fichiers absents, tronqués ou d'un autre type.
+ */
+TEST(TestsMappedFile, Erreurs)
+{
+    TemporaryFile tmp("gti320_erreurs.mat");
+
+    Matrix<double> A(2, 2);
+    EXPECT_FALSE(A.openMapped(tmp.path));
+    EXPECT_FALSE(A.isMapped());
+    EXPECT_EQ(A.rows(), 2);
+
+    {
+        Matrix<float> F;
+        ASSERT_TRUE(F.createMapped(tmp.path, 4, 4));
+    }
+    EXPECT_FALSE(A.openMapped(tmp.path));
+
+    Matrix<float, Dynamic, Dynamic, RowStorage> R;
+    EXPECT_FALSE(R.openMapped(tmp.path));
+
+    Vector<float> v;
+    EXPECT_FALSE(v.openMapped(tmp.path));
+
+    Matrix<float> F;
+    EXPECT_TRUE(F.openMapped(tmp.path));
+    EXPECT_EQ(F.rows(), 4);
+}
+
+/**
+ * Temps d'ouverture d'une matrice de 32 Mo : projection ou lecture complète.
+ */
+TEST(TestsMappedFile, TempsChargement)
+{
+    using namespace std::chrono;
+    const int n = 2048;
+
+    TemporaryFile tmp("gti320_chargement.mat");
+    createMatrixFile(tmp.path, n, n);
+
+    high_resolution_clock::time_point t = high_resolution_clock::now();
+    Matrix<double> mapped;
+    ASSERT_TRUE(mapped.openMapped(tmp.path));
+    const double mappedMs = duration_cast<duration<double, std::milli>>(high_resolution_clock::now() - t).count();
+
+    t = high_resolution_clock::now();
+    Matrix<double> loaded(n, n, Uninitialized);
+    std::FILE* file = std::fopen(tmp.path, "rb");
+    ASSERT_NE(file, (std::FILE*)nullptr);
+    std::fseek(file, (long)sizeof(MatrixFileHeader), SEEK_SET);
+    const size_t count = std::fread(loaded.data(), sizeof(double), (size_t)n * n, file);
+    std::fclose(file);
+    const double loadedMs = duration_cast<duration<double, std::milli>>(high_resolution_clock::now() - t).count();
+
+    std::cout << "  projection: " << mappedMs << " ms, lecture complete: " << loadedMs << " ms" << std::endl;
+    EXPECT_EQ(count, (size_t)n * n);
+    EXPECT_DOUBLE_EQ(mapped(n - 1, n - 1), loaded(n - 1, n - 1));
+}
+
+/**
+ * Indices au-delà de 2^31 éléments : une matrice de 70000 x 70000 (4,9
+ * milliards d'entrées) projetée sur un fichier creux. Seules les pages
+ * touchées occupent de la mémoire et du disque.
+ */
+TEST(TestsMappedFile, GrandsIndices)
+{
+    if (sizeof(Index) < 8)
+        return;
+
+    const Index n = 70000;
+    TemporaryFile tmp("gti320_grands_indices.mat");
+    {
+        Matrix<float> A;
+        if (!A.createMapped(tmp.path, n, n))
+        {
+            std::cout << "  fichier de " << (matrixFileLength<float>(n, n) >> 30) << " Go impossible a creer, test ignore" << std::endl;
+            return;
+        }
+        EXPECT_EQ(A.size(), n * n);
+        A(n - 1, n - 1) = 1.0f;
+        A(n - 2, n - 1) = 2.0f;
+        A(5, n - 3) = 3.0f;
+        EXPECT_FLOAT_EQ(A.data()[n * n - 1], 1.0f);
+        EXPECT_FLOAT_EQ(A.data()[n * n - 2], 2.0f);
+    }
+
+    Matrix<float> A;
+    ASSERT_TRUE(A.openMapped(tmp.path));
+    EXPECT_EQ(A.rows(), n);
+    EXPECT_EQ(A.cols(), n);
+    EXPECT_FLOAT_EQ(A(n - 1, n - 1), 1.0f);
+    EXPECT_FLOAT_EQ(A(n - 2, n - 1), 2.0f);
+    EXPECT_FLOAT_EQ(A(5, n - 3), 3.0f);
+    EXPECT_FLOAT_EQ(A(n - 1, n - 2), 0.0f);
+}
@@ -0,0 +1,403 @@
+/**
+ * @file TestsMatrixView.cpp
+ *
+ * @brief Tests unitaires des vues à pas et des noyaux gemm/gemv/add.
+ *
+ */
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Operators.h"
+#include "Simd.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace gti320;
+
+namespace {
+
+    /**
+     * Remplit A avec des valeurs distinctes et reproductibles.
+     */
+    template<typename _Matrix>
+    void fill(_Matrix& A, double seed)
+    {
+        for (Index i = 0; i < A.rows(); ++i)
+            for (Index j = 0; j < A.cols(); ++j)
+                A(i, j) = seed + 0.25 * i - 0.5 * j + 0.01 * i * j;
+    }
+
+    /**
+     * Produit de référence, entrée par entrée.
+     */
+    template<typename _ViewA, typename _ViewB>
+    Matrix<double> referenceProduct(const _ViewA& A, const _ViewB& B)
+    {
+        Matrix<double> C(A.rows(), B.cols());
+        for (Index i = 0; i < A.rows(); ++i)
+            for (Index j = 0; j < B.cols(); ++j)
+                for (Index k = 0; k < A.cols(); ++k)
+                    C(i, j) += A(i, k) * B(k, j);
+        return C;
+    }
+
+    template<int _StorageA, int _StorageB, int _StorageC>
+    void checkBlockProduct()
+    {
+        Matrix<double, Dynamic, Dynamic, _StorageA> A(13, 11);
+        Matrix<double, Dynamic, Dynamic, _StorageB> B(9, 14);
+        Matrix<double, Dynamic, Dynamic, _StorageC> C(10, 12);
+        fill(A, 1.0);
+        fill(B, -2.0);
+        fill(C, 3.0);
+        const Matrix<double, Dynamic, Dynamic, _StorageC> C0(C);
+
+        // C(2:8, 3:10) = 2 * A(1:7, 2:9) * B(1:8, 4:11) - C(2:8, 3:10)
+        const MatrixView<const double, _StorageA> a = A.view(1, 2, 6, 7);
+        const MatrixView<const double, _StorageB> b = B.view(1, 4, 7, 7);
+        gemm(2.0, a, b, -1.0, C.view(2, 3, 6, 7));
+
+        const Matrix<double> ref = referenceProduct(a, b);
+        for (Index i = 0; i < C.rows(); ++i)
+        {
+            for (Index j = 0; j < C.cols(); ++j)
+            {
+                const bool inside = i >= 2 && i < 8 && j >= 3 && j < 10;
+                const double expected = inside ? 2.0 * ref(i - 2, j - 3) - C0(i, j) : C0(i, j);
+                EXPECT_NEAR(C(i, j), expected, 1e-10) << "(" << i << ", " << j << ")";
+            }
+        }
+
+        // Avec beta nul, le bloc n'est pas lu.
+        gemm(1.0, a, b, 0.0, C.view(2, 3, 6, 7));
+        for (Index i = 0; i < 6; ++i)
+            for (Index j = 0; j < 7; ++j)
+                EXPECT_NEAR(C(i + 2, j + 3), ref(i, j), 1e-10);
+    }
+
+    /**
+     * Produit assez grand pour le moteur par blocs (Gemm.h) : les dimensions
+     * dépassent MC et KC et ne sont multiples ni de MR ni de NR. Les
+     * opérandes sont des blocs à pas de matrices plus grandes.
+     */
+    template<int _StorageA, int _StorageB, int _StorageC>
+    void checkBlockedProduct()
+    {
+        const Index m = 203, n = 150, p = 301;
+        Matrix<double, Dynamic, Dynamic, _StorageA> A(m + 3, p + 2);
+        Matrix<double, Dynamic, Dynamic, _StorageB> B(p + 1, n + 4);
+        Matrix<double, Dynamic, Dynamic, _StorageC> C(m + 2, n + 2);
+        fill(A, 0.5);
+        fill(B, -1.0);
+        fill(C, 2.0);
+        const Matrix<double, Dynamic, Dynamic, _StorageC> C0(C);
+
+        const MatrixView<const double, _StorageA> a = A.view(1, 2, m, p);
+        const MatrixView<const double, _StorageB> b = B.view(1, 3, p, n);
+        const Matrix<double> ref = referenceProduct(a, b);
+
+        gemm(2.0, a, b, -0.5, C.view(1, 1, m, n));
+        double error = 0.0;
+        for (Index i = 0; i < m; ++i)
+            for (Index j = 0; j < n; ++j)
+                error = std::max(error, std::abs(C(i + 1, j + 1) - (2.0 * ref(i, j) - 0.5 * C0(i + 1, j + 1))));
+        EXPECT_LT(error, 1e-6);
+
+        // Le pourtour du bloc n'est pas modifié.
+        for (Index j = 0; j < n + 2; ++j)
+        {
+            EXPECT_DOUBLE_EQ(C(0, j), C0(0, j));
+            EXPECT_DOUBLE_EQ(C(m + 1, j), C0(m + 1, j));
+        }
+
+        // Opérateur * sur des matrices.
+        Matrix<double, Dynamic, Dynamic, _StorageB> E(p + 2, n);
+        fill(E, 3.0);
+        const Matrix<double> D = A * E;
+        const Matrix<double> Dref = referenceProduct(A, E);
+        error = 0.0;
+        for (Index i = 0; i < D.rows(); ++i)
+            for (Index j = 0; j < D.cols(); ++j)
+                error = std::max(error, std::abs(D(i, j) - Dref(i, j)));
+        EXPECT_LT(error, 1e-6);
+    }
+
+    /**
+     * Produit par blocs à entrées entières (résultat exact quel que soit
+     * l'ordre des sommes), comparé au produit de référence, au niveau SIMD
+     * courant. Les dimensions ne sont multiples d'aucune tuile.
+     */
+    template<typename _Scalar, int _StorageA, int _StorageB, int _StorageC>
+    void checkExactBlockedProduct()
+    {
+        const Index m = 157, n = 131, p = 263;
+        Matrix<_Scalar, Dynamic, Dynamic, _StorageA> A(m + 1, p);
+        Matrix<_Scalar, Dynamic, Dynamic, _StorageB> B(p, n + 2);
+        Matrix<_Scalar, Dynamic, Dynamic, _StorageC> C(m, n);
+        for (Index i = 0; i < A.rows(); ++i)
+            for (Index k = 0; k < p; ++k)
+                A(i, k) = (_Scalar)((i + 2 * k) % 7) - 3;
+        for (Index k = 0; k < p; ++k)
+            for (Index j = 0; j < B.cols(); ++j)
+                B(k, j) = (_Scalar)((3 * k + j) % 5) - 2;
+        for (Index i = 0; i < m; ++i)
+            for (Index j = 0; j < n; ++j)
+                C(i, j) = (_Scalar)(i - j);
+
+        const MatrixView<const _Scalar, _StorageA> a = A.view(1, 0, m, p);
+        const MatrixView<const _Scalar, _StorageB> b = B.view(0, 2, p, n);
+        const Matrix<double> ref = referenceProduct(a, b);
+        gemm((_Scalar)2, a, b, (_Scalar)-1, C.view());
+        for (Index i = 0; i < m; ++i)
+            for (Index j = 0; j < n; ++j)
+                ASSERT_EQ((double)C(i, j), 2.0 * ref(i, j) - (double)(i - j))
+                    << simdLevelName(simdLevel()) << " (" << i << ", " << j << ")";
+    }
+
+} // namespace
+
+/**
+ * Indexation des blocs, colonnes, lignes et transposées.
+ */
+TEST(TestsMatrixView, Blocs)
+{
+    Matrix<double> A(6, 5);
+    fill(A, 0.0);
+
+    MatrixView<double> V = A.view(1, 2, 4, 3);
+    EXPECT_EQ(V.rows(), 4);
+    EXPECT_EQ(V.cols(), 3);
+    EXPECT_EQ(V.outerStride(), 6);
+    EXPECT_FALSE(V.isContiguous());
+    EXPECT_TRUE(A.view().isContiguous());
+    EXPECT_DOUBLE_EQ(V(0, 0), A(1, 2));
+    EXPECT_DOUBLE_EQ(V(3, 2), A(4, 4));
+
+    // Les écritures sont faites dans la matrice.
+    V(2, 1) = 100.0;
+    EXPECT_DOUBLE_EQ(A(3, 3), 100.0);
+
+    // Bloc d'un bloc, colonne, ligne.
+    EXPECT_DOUBLE_EQ(V.block(1, 1, 2, 2)(1, 0), A(3, 3));
+    EXPECT_DOUBLE_EQ(V.col(2)(3, 0), A(4, 4));
+    EXPECT_DOUBLE_EQ(V.row(3)(0, 1), A(4, 3));
+    EXPECT_EQ(V.col(2).increment(), 1);
+    EXPECT_EQ(V.row(3).increment(), 6);
+
+    // Transposée sans copie.
+    MatrixView<double, RowStorage> T = V.transpose();
+    EXPECT_EQ(T.rows(), 3);
+    EXPECT_EQ(T.cols(), 4);
+    EXPECT_EQ(T.data(), V.data());
+    EXPECT_DOUBLE_EQ(T(1, 2), 100.0);
+
+    // Affectation : copie des valeurs dans le bloc.
+    Matrix<double, Dynamic, Dynamic, RowStorage> R(4, 3);
+    fill(R, 7.0);
+    V = R;
+    for (Index i = 0; i < 4; ++i)
+        for (Index j = 0; j < 3; ++j)
+            EXPECT_DOUBLE_EQ(A(i + 1, j + 2), R(i, j));
+    EXPECT_DOUBLE_EQ(A(0, 0), 0.0);
+
+    V.setZero();
+    EXPECT_DOUBLE_EQ(A(1, 2), 0.0);
+    EXPECT_DOUBLE_EQ(A(5, 4), 0.25 * 5 - 0.5 * 4 + 0.01 * 20);
+
+    // Vue d'un vecteur.
+    Vector<double> x(8);
+    x(5) = 3.0;
+    EXPECT_EQ(x.segment(4, 3).rows(), 3);
+    EXPECT_DOUBLE_EQ(x.segment(4, 3)(1, 0), 3.0);
+}
+
+/**
+ * gemm sur des sous-blocs, pour toutes les combinaisons d'ordre de stockage.
+ */
+TEST(TestsMatrixView, ProduitBlocs)
+{
+    checkBlockProduct<ColumnStorage, ColumnStorage, ColumnStorage>();
+    checkBlockProduct<ColumnStorage, RowStorage, ColumnStorage>();
+    checkBlockProduct<RowStorage, ColumnStorage, ColumnStorage>();
+    checkBlockProduct<RowStorage, RowStorage, ColumnStorage>();
+    checkBlockProduct<ColumnStorage, ColumnStorage, RowStorage>();
+    checkBlockProduct<ColumnStorage, RowStorage, RowStorage>();
+    checkBlockProduct<RowStorage, ColumnStorage, RowStorage>();
+    checkBlockProduct<RowStorage, RowStorage, RowStorage>();
+}
+
+/**
+ * Moteur par blocs, pour toutes les combinaisons d'ordre de stockage.
+ */
+TEST(TestsMatrixView, ProduitParBlocs)
+{
+    checkBlockedProduct<ColumnStorage, ColumnStorage, ColumnStorage>();
+    checkBlockedProduct<ColumnStorage, RowStorage, ColumnStorage>();
+    checkBlockedProduct<RowStorage, ColumnStorage, ColumnStorage>();
+    checkBlockedProduct<RowStorage, RowStorage, ColumnStorage>();
+    checkBlockedProduct<ColumnStorage, ColumnStorage, RowStorage>();
+    checkBlockedProduct<ColumnStorage, RowStorage, RowStorage>();
+    checkBlockedProduct<RowStorage, ColumnStorage, RowStorage>();
+    checkBlockedProduct<RowStorage, RowStorage, RowStorage>();
+}
+
+/**
+ * Micro-noyaux de chaque niveau SIMD (tuiles portable, AVX2 et AVX-512),
+ * en double et en float, avec des tuiles de bord incomplètes.
+ */
+TEST(TestsMatrixView, ProduitParBlocsNiveauxSimd)
+{
+    const SimdLevel saved = simdLevel();
+    for (int level = SimdScalar; level <= supportedSimdLevel(); ++level)
+    {
+        setSimdLevel((SimdLevel)level);
+        checkExactBlockedProduct<double, ColumnStorage, ColumnStorage, ColumnStorage>();
+        checkExactBlockedProduct<double, RowStorage, ColumnStorage, RowStorage>();
+        checkExactBlockedProduct<double, ColumnStorage, RowStorage, RowStorage>();
+        checkExactBlockedProduct<float, ColumnStorage, ColumnStorage, ColumnStorage>();
+        checkExactBlockedProduct<float, RowStorage, RowStorage, RowStorage>();
+    }
+    setSimdLevel(saved);
+}
+
+/**
+ * gemv et add sur des blocs ; le vecteur peut être une ligne d'une matrice.
+ */
+TEST(TestsMatrixView, ProduitVecteurAddition)
+{
+    Matrix<double> A(12, 10);
+    Matrix<double, Dynamic, Dynamic, RowStorage> B(12, 10);
+    fill(A, 1.0);
+    fill(B, 2.0);
+
+    // y = A(2:9, 1:6) * (ligne 3 de A, colonnes 4:9)
+    const MatrixView<const double> a = A.view(2, 1, 7, 5);
+    const MatrixView<const double> x = A.view(3, 4, 1, 5);
+    Vector<double> y(7);
+    gemv(1.0, a, x, 0.0, y.view());
+    for (Index i = 0; i < 7; ++i)
+    {
+        double expected = 0.0;
+        for (Index j = 0; j < 5; ++j)
+            expected += a(i, j) * x(0, j);
+        EXPECT_NEAR(y(i), expected, 1e-10);
+    }
+
+    // Même produit par lignes, accumulé dans une colonne de B.
+    const MatrixView<const double, RowStorage> b = B.view(2, 1, 7, 5);
+    const Matrix<double, Dynamic, Dynamic, RowStorage> B0(B);
+    gemv(0.5, b, x, 1.0, B.view(0, 9, 7, 1));
+    for (Index i = 0; i < 7; ++i)
+    {
+        double expected = 0.0;
+        for (Index j = 0; j < 5; ++j)
+            expected += b(i, j) * x(0, j);
+        EXPECT_NEAR(B(i, 9), B0(i, 9) + 0.5 * expected, 1e-10);
+    }
+
+    // Opérateurs sur des vues.
+    const Vector<double> w = a * Vector<double>(5);
+    EXPECT_EQ(w.rows(), 7);
+    const Matrix<double> S = A.view(0, 0, 4, 4) + B0.view(1, 1, 4, 4);
+    for (Index i = 0; i < 4; ++i)
+        for (Index j = 0; j < 4; ++j)
+            EXPECT_DOUBLE_EQ(S(i, j), A(i, j) + B0(i + 1, j + 1));
+    const Matrix<double> P = A.view(0, 0, 4, 6) * B0.view(0, 0, 6, 3);
+    const Matrix<double> Pref = referenceProduct(A.view(0, 0, 4, 6), B0.view(0, 0, 6, 3));
+    for (Index i = 0; i < 4; ++i)
+        for (Index j = 0; j < 3; ++j)
+            EXPECT_NEAR(P(i, j), Pref(i, j), 1e-10);
+    const Matrix<double> D = 3.0 * A.view(2, 2, 3, 3);
+    EXPECT_DOUBLE_EQ(D(1, 2), 3.0 * A(3, 4));
+}
+
+/**
+ * Produit tuilé : chaque tuile de C accumule les produits de tuiles de A et B.
+ */
+TEST(TestsMatrixView, ProduitTuile)
+{
+    const Index n = 50, tile = 16;
+    Matrix<double> A(n, n), B(n, n), C(n, n);
+    fill(A, 0.5);
+    fill(B, -1.5);
+
+    for (Index i = 0; i < n; i += tile)
+    {
+        const Index mi = std::min(tile, n - i);
+        for (Index j = 0; j < n; j += tile)
+        {
+            const Index nj = std::min(tile, n - j);
+            for (Index k = 0; k < n; k += tile)
+            {
+                const Index pk = std::min(tile, n - k);
+                gemm(1.0, A.view(i, k, mi, pk), B.view(k, j, pk, nj), k == 0 ? 0.0 : 1.0, C.view(i, j, mi, nj));
+            }
+        }
+    }
+
+    const Matrix<double> ref = referenceProduct(A, B);
+    for (Index i = 0; i < n; ++i)
+        for (Index j = 0; j < n; ++j)
+            EXPECT_NEAR(C(i, j), ref(i, j), 1e-9);
+}
+
+/**
+ * Factorisation LU par blocs (sans pivot), entièrement en place.
+ */
+TEST(TestsMatrixView, LUBlocs)
+{
+    const Index n = 37, nb = 8;
+    Matrix<double> A(n, n);
+    fill(A, 0.0);
+    for (Index i = 0; i < n; ++i)
+        A(i, i) += 4.0 * n;
+    const Matrix<double> A0(A);
+
+    for (Index k = 0; k < n; k += nb)
+    {
+        const Index b = std::min(nb, n - k);
+
+        // Panneau : LU non bloquée des colonnes k:k+b.
+        const MatrixView<double> panel = A.view(k, k, n - k, b);
+        for (Index p = 0; p < b; ++p)
+        {
+            for (Index i = p + 1; i < panel.rows(); ++i)
+            {
+                panel(i, p) /= panel(p, p);
+                for (Index q = p + 1; q < b; ++q)
+                    panel(i, q) -= panel(i, p) * panel(p, q);
+            }
+        }
+
+        if (k + b == n)
+            break;
+
+        // U12 = L11^-1 * A12 (substitution avant, L11 unitaire).
+        const MatrixView<double> U12 = A.view(k, k + b, b, n - k - b);
+        for (Index p = 1; p < b; ++p)
+            gemm(-1.0, A.view(k + p, k, 1, p), U12.block(0, 0, p, U12.cols()), 1.0, U12.row(p));
+
+        // A22 -= L21 * U12
+        gemm(-1.0, A.view(k + b, k, n - k - b, b), MatrixView<const double>(U12), 1.0, A.view(k + b, k + b, n - k - b, n - k - b));
+    }
+
+    // L * U doit redonner A.
+    Matrix<double> L(n, n), U(n, n);
+    for (Index i = 0; i < n; ++i)
+    {
+        L(i, i) = 1.0;
+        for (Index j = 0; j < n; ++j)
+        {
+            if (j < i)
+                L(i, j) = A(i, j);
+            else
+                U(i, j) = A(i, j);
+        }
+    }
+    const Matrix<double> LU = referenceProduct(L, U);
+    for (Index i = 0; i < n; ++i)
+        for (Index j = 0; j < n; ++j)
+            EXPECT_NEAR(LU(i, j), A0(i, j), 1e-9);
+}
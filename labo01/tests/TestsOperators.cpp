@@ -11,6 +11,7 @@
 
 #include "Matrix.h"
 #include "Operators.h"
+#include "SparseMatrix.h"
 
 #include <gtest/gtest.h>
 
@@ -234,3 +235,148 @@ TEST(TestsOperators, VectorOperators)
     EXPECT_DOUBLE_EQ(v3(3), v(3) + v2(3));
     EXPECT_DOUBLE_EQ(v3(4), v(4) + v2(4));
 }
+
+/**
+ * Produits dont la dimension intérieure est nulle : le résultat est nul.
+ */
+TEST(TestsOperators, DimensionInterieureNulle)
+{
+    Matrix<double, Dynamic, Dynamic, ColumnStorage> A(3, 0);
+    Matrix<double, Dynamic, Dynamic, RowStorage> B(0, 2);
+    Vector<double> v(0);
+
+    const Matrix<double> C = A * B;
+    EXPECT_EQ(C.rows(), 3);
+    EXPECT_EQ(C.cols(), 2);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 2; ++j)
+            EXPECT_DOUBLE_EQ(C(i, j), 0.0);
+
+    const Vector<double> b = A * v;
+    EXPECT_EQ(b.rows(), 3);
+    for (int i = 0; i < 3; ++i)
+        EXPECT_DOUBLE_EQ(b(i), 0.0);
+}
+
+/**
+ * Produits dans une destination existante, y compris lorsque la destination
+ * est aussi une opérande.
+ */
+TEST(TestsOperators, ProduitsEnPlace)
+{
+    Matrix<double> A(6, 4), S(4, 4);
+    Matrix<double, Dynamic, Dynamic, RowStorage> R(4, 5);
+    Vector<double> x(4);
+    for (Index i = 0; i < 6; ++i)
+        for (Index j = 0; j < 4; ++j)
+            A(i, j) = 0.5 * i - j;
+    for (Index i = 0; i < 4; ++i)
+    {
+        x(i) = 1.0 + i;
+        for (Index j = 0; j < 4; ++j)
+            S(i, j) = (i == j) ? 2.0 : 0.1 * (i + j);
+        for (Index j = 0; j < 5; ++j)
+            R(i, j) = 0.25 * i * j - 1.0;
+    }
+
+    Vector<double> y(2);
+    multiply(A, x, y);
+    const Vector<double> Ax = A * x;
+    EXPECT_EQ(y.rows(), 6);
+    for (Index i = 0; i < 6; ++i)
+        EXPECT_DOUBLE_EQ(y(i), Ax(i));
+
+    Matrix<double> C;
+    multiply(A, S, C);
+    const Matrix<double> AS = A * S;
+    EXPECT_EQ(C.rows(), 6);
+    EXPECT_EQ(C.cols(), 4);
+    for (Index i = 0; i < 6; ++i)
+        for (Index j = 0; j < 4; ++j)
+            EXPECT_DOUBLE_EQ(C(i, j), AS(i, j));
+
+    Matrix<double, Dynamic, Dynamic, RowStorage> D(1, 1);
+    multiply(S, R, D);
+    const Matrix<double> SR = S * R;
+    for (Index i = 0; i < 4; ++i)
+        for (Index j = 0; j < 5; ++j)
+            EXPECT_DOUBLE_EQ(D(i, j), SR(i, j));
+
+    // Destination confondue avec une opérande.
+    const Vector<double> Sx = S * x;
+    multiply(S, x, x);
+    for (Index i = 0; i < 4; ++i)
+        EXPECT_DOUBLE_EQ(x(i), Sx(i));
+
+    const Matrix<double> SS = S * S;
+    multiply(S, S, S);
+    for (Index i = 0; i < 4; ++i)
+        for (Index j = 0; j < 4; ++j)
+            EXPECT_DOUBLE_EQ(S(i, j), SS(i, j));
+
+    // Matrice creuse.
+    SparseMatrix<double> B(3, 4);
+    TripletType<double> triplets[] = { { 1.0, 0, 1 }, { -2.0, 2, 3 }, { 0.5, 2, 0 } };
+    B.setFromTriplets(triplets, 3);
+    const Vector<double> Bx = B * x;
+    Vector<double> z;
+    multiply(B, x, z);
+    EXPECT_EQ(z.rows(), 3);
+    EXPECT_DOUBLE_EQ(z(0), x(1));
+    EXPECT_DOUBLE_EQ(z(1), 0.0);
+    EXPECT_DOUBLE_EQ(z(2), 0.5 * x(0) - 2.0 * x(3));
+    for (Index i = 0; i < 3; ++i)
+        EXPECT_DOUBLE_EQ(z(i), Bx(i));
+}
+
+/**
+ * axpy et axpby sur des vecteurs, des matrices et des blocs à pas, de même
+ * ordre de stockage ou non.
+ */
+TEST(TestsOperators, CombinaisonsLineaires)
+{
+    Vector<double> x(9), y(9);
+    for (Index i = 0; i < 9; ++i)
+    {
+        x(i) = 1.0 - 0.5 * i;
+        y(i) = 0.125 * i * i;
+    }
+    const Vector<double> y0(y);
+    axpy(2.0, x, y);
+    for (Index i = 0; i < 9; ++i)
+        EXPECT_DOUBLE_EQ(y(i), y0(i) + 2.0 * x(i));
+    axpby(-1.0, x, 0.5, y);
+    for (Index i = 0; i < 9; ++i)
+        EXPECT_NEAR(y(i), 0.5 * (y0(i) + 2.0 * x(i)) - x(i), 1e-14);
+
+    Matrix<double> X(6, 5), Y(6, 5);
+    Matrix<double, Dynamic, Dynamic, RowStorage> Z(6, 5);
+    for (Index i = 0; i < 6; ++i)
+        for (Index j = 0; j < 5; ++j)
+        {
+            X(i, j) = i - 0.5 * j;
+            Y(i, j) = 0.25 * i * j;
+            Z(i, j) = 1.0 + i + j;
+        }
+    const Matrix<double> Y0(Y);
+
+    // Blocs de même ordre (tranche par tranche) et d'ordres différents.
+    axpy(3.0, X.view(0, 0, 4, 3), Y.view(2, 2, 4, 3));
+    axpby(2.0, Z.view(1, 1, 2, 2), -1.0, Y.view(0, 0, 2, 2));
+    for (Index i = 0; i < 6; ++i)
+        for (Index j = 0; j < 5; ++j)
+        {
+            double expected = Y0(i, j);
+            if (i >= 2 && j >= 2)
+                expected += 3.0 * X(i - 2, j - 2);
+            if (i < 2 && j < 2)
+                expected = 2.0 * Z(i + 1, j + 1) - expected;
+            EXPECT_NEAR(Y(i, j), expected, 1e-14) << "(" << i << ", " << j << ")";
+        }
+
+    Matrix<double, Dynamic, Dynamic, RowStorage> W(Z);
+    axpy(-1.0, Z, W);
+    EXPECT_DOUBLE_EQ(W(5, 4), 0.0);
+    axpby(1.0, X, 0.0, W);
+    EXPECT_DOUBLE_EQ(W(5, 4), X(5, 4));
+}
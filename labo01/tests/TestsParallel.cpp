@@ -0,0 +1,530 @@
+/**
+ * @file TestsParallel.cpp
+ *
+ * @brief Tests unitaires de la réserve de fils, du partitionnement et des
+ *        boucles parallèles.
+ *
+ */
+
+#include "Parallel.h"
+#include "DenseStorage.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include "Operators.h"
+#include "SparseMatrix.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace gti320;
+
+namespace {
+
+    template<typename _Matrix>
+    void fill(_Matrix& A, double seed)
+    {
+        for (Index i = 0; i < A.rows(); ++i)
+            for (Index j = 0; j < A.cols(); ++j)
+                A(i, j) = std::sin(seed + 0.01 * i + 0.07 * j);
+    }
+
+    /**
+     * Fibonacci récursif : chaque appel lance une tâche et attend.
+     */
+    long fibonacci(ThreadPool& pool, int n)
+    {
+        if (n < 2)
+            return n;
+        long a = 0;
+        TaskGroup group(pool);
+        group.spawn([&pool, &a, n]() { a = fibonacci(pool, n - 1); });
+        const long b = fibonacci(pool, n - 2);
+        group.wait();
+        return a + b;
+    }
+
+    /**
+     * gemm par tranches : chaque entrée de C est calculée par le même fil,
+     * dans le même ordre, quel que soit le nombre de fils. Les résultats sont
+     * donc identiques au calcul séquentiel.
+     */
+    template<int _StorageA, int _StorageB, int _StorageC>
+    void checkParallelProduct(Index m, Index n, Index p)
+    {
+        Matrix<double, Dynamic, Dynamic, _StorageA> A(m, p);
+        Matrix<double, Dynamic, Dynamic, _StorageB> B(p, n);
+        Matrix<double, Dynamic, Dynamic, _StorageC> C0(m, n);
+        fill(A, 0.5);
+        fill(B, 1.5);
+        fill(C0, -1.0);
+
+        setParallelThreads(1);
+        Matrix<double, Dynamic, Dynamic, _StorageC> ref(C0);
+        gemm(2.0, A.view(), B.view(), 0.5, ref.view());
+
+        for (int threads = 2; threads <= 4; ++threads)
+        {
+            setParallelThreads(threads);
+            Matrix<double, Dynamic, Dynamic, _StorageC> C(C0);
+            gemm(2.0, A.view(), B.view(), 0.5, C.view());
+            for (Index i = 0; i < m; ++i)
+                for (Index j = 0; j < n; ++j)
+                    ASSERT_EQ(C(i, j), ref(i, j)) << threads << " fils, (" << i << ", " << j << ")";
+        }
+    }
+
+} // namespace
+
+/**
+ * Les tranches couvrent l'intervalle sans chevauchement.
+ */
+TEST(TestsParallel, Partition)
+{
+    const int sizes[] = { 0, 1, 7, 64, 1001 };
+    for (int s = 0; s < 5; ++s)
+    {
+        for (int parts = 1; parts <= 9; ++parts)
+        {
+            int expected = 0;
+            for (int k = 0; k < parts; ++k)
+            {
+                Index begin, end;
+                partition(sizes[s], parts, k, begin, end);
+                EXPECT_EQ(begin, expected);
+                EXPECT_LE(end - begin, sizes[s] / parts + 1);
+                expected = end;
+            }
+            EXPECT_EQ(expected, sizes[s]);
+        }
+    }
+}
+
+/**
+ * Chaque indice est visité exactement une fois, quel que soit le nombre de fils.
+ */
+TEST(TestsParallel, ParallelFor)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const int n = 10007;
+    for (int threads = 1; threads <= 4; ++threads)
+    {
+        setParallelThreads(threads);
+        EXPECT_EQ(parallelThreads(), threads);
+
+        std::vector<int> visits(n, 0);
+        std::atomic<int> slices(0);
+        parallel_for(n, [&visits, &slices](Index begin, Index end) {
+            ++slices;
+            for (Index i = begin; i < end; ++i)
+                ++visits[i];
+        });
+        EXPECT_EQ(slices.load(), threads);
+        for (int i = 0; i < n; ++i)
+            ASSERT_EQ(visits[i], 1);
+
+        // Les tranches ont au moins `grain` éléments.
+        slices = 0;
+        parallel_for(n, [&slices](Index, Index) { ++slices; }, n);
+        EXPECT_EQ(slices.load(), 1);
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * parallel_for_static() : la tranche k est toujours traitée par le même
+ * fil (le fil appelant pour k = 0, le fil k de la réserve sinon), d'un appel
+ * à l'autre, et se ramène à parallel_for() dans une région imbriquée.
+ */
+TEST(TestsParallel, PlacementStatique)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const int threads = 4;
+    const int n = 1001;
+    setParallelThreads(threads);
+
+    for (int repetition = 0; repetition < 20; ++repetition)
+    {
+        std::vector<int> owner(threads, -2);
+        std::vector<int> visits(n, 0);
+        parallel_for_static(n, [&](Index begin, Index end) {
+            int k = 0;
+            while (k < threads)
+            {
+                Index b, e;
+                partition(n, threads, k, b, e);
+                if (b == begin && e == end)
+                    break;
+                ++k;
+            }
+            ASSERT_LT(k, threads);
+            owner[(size_t)k] = internal::currentWorker().index;
+            for (Index i = begin; i < end; ++i)
+                ++visits[(size_t)i];
+        });
+        EXPECT_EQ(owner[0], -1);
+        for (int k = 1; k < threads; ++k)
+            ASSERT_EQ(owner[(size_t)k], k) << "tranche " << k;
+        for (int i = 0; i < n; ++i)
+            ASSERT_EQ(visits[(size_t)i], 1);
+    }
+
+    std::vector<std::atomic<int> > visits(n);
+    for (int i = 0; i < n; ++i)
+        visits[(size_t)i] = 0;
+    parallel_for(threads, [&](Index, Index) {
+        parallel_for_static(n, [&](Index begin, Index end) {
+            for (Index i = begin; i < end; ++i)
+                ++visits[(size_t)i];
+        });
+    });
+    for (int i = 0; i < n; ++i)
+        ASSERT_EQ(visits[(size_t)i].load(), threads);
+
+    setParallelThreads(saved);
+}
+
+/**
+ * Mise à zéro parallèle d'un grand tampon (premier contact), à
+ * l'allocation seulement.
+ */
+TEST(TestsParallel, PremierContact)
+{
+    const int saved = internal::parallelThreadsSetting();
+    setParallelThreads(4);
+
+    const int n = (int)(2 * GTI320_PARALLEL_FIRST_TOUCH / sizeof(double)) + 3;
+    DenseStorage<double, Dynamic> buf(n);
+    for (int i = 0; i < n; ++i)
+        ASSERT_EQ(buf[i], 0.0);
+
+    for (int i = 0; i < n; ++i)
+        buf[i] = 1.0;
+    buf.setZero();
+    for (int i = 0; i < n; ++i)
+        ASSERT_EQ(buf[i], 0.0);
+
+    // Agrandissement : nouveau tampon, mis à zéro en parallèle.
+    buf.resize(n / 2);
+    buf[0] = 1.0;
+    buf.resize(2 * n);
+    for (int i = 0; i < 2 * n; ++i)
+        ASSERT_EQ(buf[i], 0.0);
+
+    // Premier contact parallèle désactivé : mise à zéro par le fil appelant.
+    const size_t firstTouch = parallelFirstTouch();
+    setParallelFirstTouch(0);
+    DenseStorage<double, Dynamic> serial(n);
+    for (int i = 0; i < n; ++i)
+        ASSERT_EQ(serial[i], 0.0);
+    setParallelFirstTouch(firstTouch);
+
+    setParallelThreads(saved);
+}
+
+/**
+ * gemm parallèle, par tranches de colonnes (C large) ou de lignes (C haute).
+ */
+TEST(TestsParallel, ProduitMatriceMatrice)
+{
+    const int saved = internal::parallelThreadsSetting();
+    checkParallelProduct<ColumnStorage, ColumnStorage, ColumnStorage>(97, 190, 150);
+    checkParallelProduct<RowStorage, ColumnStorage, ColumnStorage>(190, 97, 150);
+    checkParallelProduct<ColumnStorage, RowStorage, RowStorage>(97, 190, 150);
+    checkParallelProduct<RowStorage, RowStorage, RowStorage>(190, 97, 150);
+    setParallelThreads(saved);
+}
+
+/**
+ * gemv parallèle : tranches de y (stockage par lignes) ou de colonnes de A
+ * avec réduction (stockage par colonnes), sur une vue à pas.
+ */
+TEST(TestsParallel, ProduitMatriceVecteur)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const Index m = 1203, n = 1101;
+    Matrix<double> A(m + 2, n);
+    Matrix<double, Dynamic, Dynamic, RowStorage> R(m, n + 3);
+    Vector<double> x(n), y0(m);
+    fill(A, 0.25);
+    fill(R, -0.75);
+    for (Index j = 0; j < n; ++j)
+        x(j) = 1.0 / (1.0 + j);
+    for (Index i = 0; i < m; ++i)
+        y0(i) = 0.5 * i;
+
+    setParallelThreads(1);
+    Vector<double> yc(y0), yr(y0);
+    gemv(1.5, A.view(1, 0, m, n), x.view(), -2.0, yc.view());
+    gemv(1.5, R.view(0, 2, m, n), x.view(), 0.0, yr.view());
+
+    for (int threads = 2; threads <= 4; ++threads)
+    {
+        setParallelThreads(threads);
+        Vector<double> zc(y0), zr(y0);
+        gemv(1.5, A.view(1, 0, m, n), x.view(), -2.0, zc.view());
+        gemv(1.5, R.view(0, 2, m, n), x.view(), 0.0, zr.view());
+        for (Index i = 0; i < m; ++i)
+        {
+            ASSERT_NEAR(zc(i), yc(i), 1e-13 * (1.0 + std::abs(yc(i)))) << threads << " fils";
+            ASSERT_EQ(zr(i), yr(i)) << threads << " fils";
+        }
+
+        // Résultat écrit dans une ligne d'une matrice (pas non unitaire).
+        Matrix<double> Y(3, m);
+        gemv(1.5, A.view(1, 0, m, n), x.view(), 0.0, Y.view().row(1));
+        for (Index i = 0; i < m; ++i)
+            ASSERT_NEAR(Y(1, i), yc(i) + 2.0 * y0(i), 1e-13 * (1.0 + std::abs(yc(i)) + y0(i)));
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * Tâches lancées par des tâches : le fil qui attend exécute les tâches des
+ * autres, il n'y a pas d'interblocage même avec plus de tâches que de fils.
+ */
+TEST(TestsParallel, Taches)
+{
+    for (int threads = 1; threads <= 4; ++threads)
+    {
+        ThreadPool pool(threads);
+        EXPECT_EQ(pool.size(), threads);
+        EXPECT_FALSE(pool.isWorker());
+        EXPECT_EQ(fibonacci(pool, 18), 2584);
+
+        std::atomic<int> count(0);
+        TaskGroup group(pool);
+        for (int k = 0; k < 1000; ++k)
+            group.spawn([&count]() { ++count; });
+        group.wait();
+        EXPECT_EQ(count.load(), 1000);
+    }
+
+    // Épinglage : seul l'ordonnancement change.
+    ThreadPool pinned(3, true);
+    EXPECT_TRUE(pinned.pinned());
+    EXPECT_EQ(fibonacci(pinned, 15), 610);
+}
+
+/**
+ * Une exception levée par une tâche est relancée par wait() ou parallel_for.
+ */
+TEST(TestsParallel, Exceptions)
+{
+    const int saved = internal::parallelThreadsSetting();
+    ThreadPool pool(3);
+    TaskGroup group(pool);
+    std::atomic<int> count(0);
+    for (int k = 0; k < 10; ++k)
+        group.spawn([&count, k]() {
+            ++count;
+            if (k == 4)
+                throw std::runtime_error("tache");
+        });
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    EXPECT_EQ(count.load(), 10);
+
+    setParallelThreads(3);
+    EXPECT_THROW(parallel_for(300, [](Index begin, Index) {
+        if (begin == 0)
+            throw std::runtime_error("tranche");
+    }), std::runtime_error);
+    setParallelThreads(saved);
+}
+
+/**
+ * Boucles parallèles imbriquées : chaque couple d'indices est visité une
+ * fois et les tranches internes s'exécutent sur les fils de la réserve.
+ */
+TEST(TestsParallel, BouclesImbriquees)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const int n = 37, m = 101;
+    for (int threads = 1; threads <= 4; ++threads)
+    {
+        setParallelThreads(threads);
+        std::vector<int> visits(n * m, 0);
+        std::mutex mutex;
+        std::set<std::thread::id> ids;
+        parallel_for(n, [&](Index begin, Index end) {
+            for (Index i = begin; i < end; ++i)
+            {
+                parallel_for(m, [&](Index first, Index last) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        ids.insert(std::this_thread::get_id());
+                    }
+                    for (Index j = first; j < last; ++j)
+                        ++visits[(size_t)(i * m + j)];
+                });
+            }
+        });
+        for (int k = 0; k < n * m; ++k)
+            ASSERT_EQ(visits[(size_t)k], 1);
+        EXPECT_LE((int)ids.size(), threads);
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * gemv parallèle (stockage par colonnes) appelé depuis les tâches d'un
+ * parallel_for : un fil qui attend la fin de son gemv exécute le gemv d'une
+ * autre tâche, et chacun garde ses propres résultats partiels.
+ */
+TEST(TestsParallel, ProduitsMatriceVecteurImbriques)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const Index m = 256, n = 4096;
+    const int tasks = 16;
+    Matrix<double> A(m, n);
+    fill(A, 0.5);
+    std::vector< Vector<double> > x(tasks, Vector<double>(n));
+    for (int t = 0; t < tasks; ++t)
+        for (Index j = 0; j < n; ++j)
+            x[(size_t)t](j) = (double)((t + j) % 7) - 3.0;
+
+    setParallelThreads(4);
+    std::vector< Vector<double> > expected(tasks, Vector<double>(m));
+    for (int t = 0; t < tasks; ++t)
+        gemv(1.0, A.view(), x[(size_t)t].view(), 0.0, expected[(size_t)t].view());
+
+    // Cas déterministe : le tampon partiel du fil est déjà prêté (gemv en
+    // attente plus haut dans la pile) ; le gemv imbriqué ne doit pas l'écraser.
+    {
+        const internal::GemmWorkspace<double>::Partial outer(4 * (size_t)m);
+        std::fill(outer.data(), outer.data() + 4 * m, 33.0);
+        Vector<double> y(m);
+        gemv(1.0, A.view(), x[0].view(), 0.0, y.view());
+        for (Index i = 0; i < 4 * m; ++i)
+            ASSERT_EQ(outer.data()[i], 33.0) << i;
+        for (Index i = 0; i < m; ++i)
+            ASSERT_EQ(y(i), expected[0](i)) << i;
+    }
+
+    for (int repetition = 0; repetition < 8; ++repetition)
+    {
+        std::vector< Vector<double> > y(tasks, Vector<double>(m));
+        parallel_for(tasks, [&](Index begin, Index end) {
+            for (Index t = begin; t < end; ++t)
+                gemv(1.0, A.view(), x[(size_t)t].view(), 0.0, y[(size_t)t].view());
+        }, 1);
+        for (int t = 0; t < tasks; ++t)
+            for (Index i = 0; i < m; ++i)
+                ASSERT_EQ(y[(size_t)t](i), expected[(size_t)t](i)) << "repetition " << repetition << ", tache " << t << ", ligne " << i;
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * Réduction parallèle : même résultat pour tout nombre de fils et de grain.
+ */
+TEST(TestsParallel, Reduction)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const Index n = 100003;
+    for (int threads = 1; threads <= 4; ++threads)
+    {
+        setParallelThreads(threads);
+        const long long sum = parallel_reduce(n, 0LL, [](Index begin, Index end) {
+            long long s = 0;
+            for (Index i = begin; i < end; ++i)
+                s += i;
+            return s;
+        }, [](long long a, long long b) { return a + b; });
+        EXPECT_EQ(sum, (long long)n * (n - 1) / 2);
+
+        // Combinaison dans l'ordre des tranches.
+        std::atomic<int> slices(0);
+        const Index last = parallel_reduce(n, (Index)-1, [&slices](Index, Index end) {
+            ++slices;
+            return end;
+        }, [](Index a, Index b) { return a < b ? b : a; }, n / 2);
+        EXPECT_EQ(last, n);
+        EXPECT_EQ(slices.load(), threads < 2 ? threads : 2);
+
+        EXPECT_EQ(parallel_reduce(0, 7, [](Index, Index) { return 0; }, [](int a, int b) { return a + b; }), 7);
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * Produit creux parallèle sur une matrice déséquilibrée (quelques lignes très
+ * longues) : tranches de nombre d'entrées équilibré, résultat identique au
+ * calcul séquentiel.
+ */
+TEST(TestsParallel, ProduitCreux)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const Index m = 120000, n = 50000;
+    std::vector< TripletType<double> > triplets;
+    for (Index i = 0; i < m; ++i)
+    {
+        const Index length = (i % 20000 == 17) ? 45000 : 3 + i % 5;
+        for (Index k = 0; k < length; ++k)
+            triplets.push_back(TripletType<double>{ 1.0 / (1.0 + k), i, (i * 7 + k * 13) % n });
+    }
+    SparseMatrix<double> A(m, n);
+    A.setFromTriplets(triplets.data(), (Index)triplets.size());
+
+    Vector<double> x(n);
+    for (Index j = 0; j < n; ++j)
+        x(j) = std::sin(0.001 * j);
+
+    setParallelThreads(1);
+    Vector<double> ref;
+    multiply(A, x, ref);
+
+    const double cost = (double)(A.getInnerSize() + m);
+    for (int threads = 2; threads <= 4; ++threads)
+    {
+        setParallelThreads(threads);
+        Vector<double> y(5);
+        multiply(A, x, y);
+        ASSERT_EQ(y.rows(), m);
+        for (Index i = 0; i < m; ++i)
+            ASSERT_EQ(y(i), ref(i)) << threads << " fils, ligne " << i;
+
+        // Chaque tranche coûte au plus sa part plus une ligne.
+        const std::shared_ptr<const std::vector<Index> > partition = A.rowPartition(threads);
+        const std::vector<Index>& split = *partition;
+        ASSERT_EQ(split.size(), (size_t)threads + 1);
+        EXPECT_EQ(split[0], 0);
+        EXPECT_EQ(split[threads], m);
+        for (int k = 0; k < threads; ++k)
+        {
+            ASSERT_LE(split[k], split[k + 1]);
+            const Index last = split[k + 1] > split[k] ? split[k + 1] - 1 : split[k];
+            const double rowCost = (double)(A.outer()[last + 1] - A.outer()[last] + 1);
+            const double sliceCost = (double)(A.outer()[split[k + 1]] - A.outer()[split[k]] + split[k + 1] - split[k]);
+            EXPECT_LE(sliceCost, cost / threads + rowCost + 1.0) << "tranche " << k;
+        }
+        // Le découpage en cache est partagé, sans copie.
+        EXPECT_EQ(A.rowPartition(threads).get(), partition.get());
+    }
+
+    // Découpages différents demandés en même temps sur la même matrice.
+    std::vector<std::thread> callers;
+    std::atomic<int> errors(0);
+    for (int parts = 2; parts <= 3; ++parts)
+    {
+        callers.push_back(std::thread([&A, &errors, parts, m]() {
+            for (int r = 0; r < 200; ++r)
+            {
+                const std::shared_ptr<const std::vector<Index> > partition = A.rowPartition(parts + r % 2);
+                const std::vector<Index>& split = *partition;
+                if (split.size() != (size_t)(parts + r % 2) + 1 || split[0] != 0 || split.back() != m)
+                    ++errors;
+            }
+        }));
+    }
+    for (size_t k = 0; k < callers.size(); ++k)
+        callers[k].join();
+    EXPECT_EQ(errors.load(), 0);
+    setParallelThreads(saved);
+}
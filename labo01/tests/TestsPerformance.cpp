@@ -12,12 +12,29 @@
 #include "Matrix.h"
 #include "Vector.h"
 #include "Operators.h"
+#include "Parallel.h"
+#include "SparseMatrix.h"
+#include "SellMatrix.h"
+#include "BlockSparseMatrix.h"
+#include "Simd.h"
 
 #include <gtest/gtest.h>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace gti320;
 
+// Plus grand nombre de tuples du banc d'essai TripletsCreux (10^8 tuples
+// demandent environ 6 Go de mmoire).
+#ifndef GTI320_BENCH_MAX_TRIPLETS
+#define GTI320_BENCH_MAX_TRIPLETS 10000000
+#endif
+
 namespace {
     /**
      * Multiplication  matrice * vecteur,  utilisant une implmentation naive
@@ -75,6 +92,76 @@ namespace {
         }
         return product;
     }
+#if GTI320_SIMD
+    /**
+     * Pic de calcul d'un coeur (Gflop/s, double) : 24 (AVX-512) ou 12
+     * (AVX2) chanes indpendantes de multiplications-additions, assez
+     * pour masquer la latence.
+     */
+    GTI320_TARGET_AVX512 double fmaPeakAVX512(long iterations)
+    {
+        __m512d acc[24];
+        const __m512d b = _mm512_set1_pd(1.0000001), c = _mm512_set1_pd(1e-9);
+        GTI320_UNROLL
+        for (int k = 0; k < 24; ++k)
+            acc[k] = _mm512_set1_pd((double)k);
+        for (long i = 0; i < iterations; ++i)
+        {
+            GTI320_UNROLL
+            for (int k = 0; k < 24; ++k)
+                acc[k] = _mm512_fmadd_pd(acc[k], b, c);
+        }
+        __m512d sum = acc[0];
+        for (int k = 1; k < 24; ++k)
+            sum = _mm512_add_pd(sum, acc[k]);
+        double lanes[8];
+        _mm512_storeu_pd(lanes, sum);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+    }
+
+    GTI320_TARGET_AVX2 double fmaPeakAVX2(long iterations)
+    {
+        __m256d acc[12];
+        const __m256d b = _mm256_set1_pd(1.0000001), c = _mm256_set1_pd(1e-9);
+        GTI320_UNROLL
+        for (int k = 0; k < 12; ++k)
+            acc[k] = _mm256_set1_pd((double)k);
+        for (long i = 0; i < iterations; ++i)
+        {
+            GTI320_UNROLL
+            for (int k = 0; k < 12; ++k)
+                acc[k] = _mm256_fmadd_pd(acc[k], b, c);
+        }
+        __m256d sum = acc[0];
+        for (int k = 1; k < 12; ++k)
+            sum = _mm256_add_pd(sum, acc[k]);
+        double lanes[4];
+        _mm256_storeu_pd(lanes, sum);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#endif
+
+    /**
+     * Pic mesur d'un coeur au niveau SIMD courant, 0 sans FMA (SSE2 ou
+     * scalaire).
+     */
+    double measuredPeak()
+    {
+#if GTI320_SIMD
+        using namespace std::chrono;
+        const long iterations = 20000000;
+        const SimdLevel level = simdLevel();
+        if (level < SimdAVX2)
+            return 0.0;
+        const high_resolution_clock::time_point t = high_resolution_clock::now();
+        const double check = level == SimdAVX512 ? fmaPeakAVX512(iterations) : fmaPeakAVX2(iterations);
+        const double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+        EXPECT_TRUE(check == check);
+        return (level == SimdAVX512 ? 24.0 * 16.0 : 12.0 * 8.0) * iterations / seconds * 1e-9;
+#else
+        return 0.0;
+#endif
+    }
 } // namespace
 
 /**
@@ -122,8 +209,612 @@ TEST(TestsPerformance, PerformanceLargeMatrixMatrix)
     // Test : addition avec l'implmentation spcifique pour les matrices 
     // stockage par colonnes.
     t = high_resolution_clock::now();
-    A + B;
+    const Matrix<double> C = A + B;
     const duration<double> optimal_t = duration_cast<duration<double>>(high_resolution_clock::now() - t);
 
     EXPECT_TRUE(optimal_t < 0.4 * naive_t);
 }
+
+/**
+ * Bande passante de la multiplication  matrice * vecteur selon l'allocation
+ * de la matrice : l'allocateur prcdent (tas, mise  zro par un seul fil),
+ * le tas avec premier contact parallle, puis les pages normes avec premier
+ * contact parallle. Les fils sont pingls pendant la mesure, pour que le
+ * placement des pages ait un sens (voir Parallel.h).
+ */
+TEST(TestsPerformance, BandePassanteGEMV)
+{
+    const int n = 4096;
+    const int repetitions = 10;
+    const size_t savedThreshold = HugePageAllocator::threshold();
+    const size_t savedFirstTouch = parallelFirstTouch();
+    const bool savedPinning = parallelPinning();
+    setParallelPinning(true);
+
+    const int modes = 3;
+    const char* names[modes] = { "tas, zero sequentiel", "tas, premier contact parallele", "pages enormes, premier contact parallele" };
+    Vector<double> results[modes];
+    double bandwidth[modes];
+    for (int mode = 0; mode < modes; ++mode)
+    {
+        HugePageAllocator::threshold() = (mode == 2) ? HugePageAllocator::PageSize : 0;
+        setParallelFirstTouch(mode == 0 ? 0 : savedFirstTouch);
+
+        Matrix<double> A(n, n);
+        Vector<double> v(n);
+        for (int j = 0; j < n; ++j)
+        {
+            v(j) = 1.0 / (j + 1);
+            for (int i = 0; i < n; ++i)
+                A(i, j) = (double)((i + j) % 7);
+        }
+
+        results[mode] = A * v;
+
+        using namespace std::chrono;
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        for (int r = 0; r < repetitions; ++r)
+            results[mode] = A * v;
+        const duration<double> elapsed = duration_cast<duration<double>>(high_resolution_clock::now() - t);
+
+        const double bytes = (double)repetitions * n * (double)n * sizeof(double);
+        bandwidth[mode] = bytes / elapsed.count() * 1e-9;
+        std::cout << "  GEMV " << n << "x" << n << " (" << names[mode] << "): "
+            << bandwidth[mode] << " Go/s (x" << bandwidth[mode] / bandwidth[0] << ")" << std::endl;
+    }
+    HugePageAllocator::threshold() = savedThreshold;
+    setParallelFirstTouch(savedFirstTouch);
+    setParallelPinning(savedPinning);
+
+    for (int mode = 1; mode < modes; ++mode)
+        for (int i = 0; i < n; ++i)
+            EXPECT_DOUBLE_EQ(results[0](i), results[mode](i));
+}
+
+/**
+ * Dbit (Gflop/s) du produit  matrice * matrice : algorithme naif, noyau sans
+ * blocage (internal::gemmUnblocked) et moteur par blocs (Gemm.h). Le moteur
+ * par blocs est aussi mesur sur 1 fil et compar au pic d'un coeur
+ * (multiplications-additions au niveau SIMD courant).
+ */
+TEST(TestsPerformance, PerformanceGEMM)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const double peak = measuredPeak();
+    const int sizes[2] = { 512, 1024 };
+    for (int s = 0; s < 2; ++s)
+    {
+        const int n = sizes[s];
+        Matrix<double> A(n, n), B(n, n), C(n, n, Uninitialized);
+        for (int j = 0; j < n; ++j)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                A(i, j) = (double)((i + 2 * j) % 5) - 2.0;
+                B(i, j) = (double)((3 * i + j) % 7) - 3.0;
+            }
+        }
+
+        using namespace std::chrono;
+        const double flops = 2.0 * n * (double)n * n;
+
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        const Matrix<double> naive = naiveMatrixMult(A, B);
+        const duration<double> naive_t = duration_cast<duration<double>>(high_resolution_clock::now() - t);
+
+        t = high_resolution_clock::now();
+        internal::gemmUnblocked(1.0, A.view(), B.view(), 0.0, C.view());
+        const duration<double> unblocked_t = duration_cast<duration<double>>(high_resolution_clock::now() - t);
+
+        t = high_resolution_clock::now();
+        const Matrix<double> blocked = A * B;
+        const duration<double> blocked_t = duration_cast<duration<double>>(high_resolution_clock::now() - t);
+
+        std::cout << "  GEMM " << n << "x" << n << " : naif " << flops / naive_t.count() * 1e-9
+            << " Gflop/s, sans blocage " << flops / unblocked_t.count() * 1e-9
+            << " Gflop/s, par blocs " << flops / blocked_t.count() * 1e-9 << " Gflop/s" << std::endl;
+
+        // Les entres sont des entiers : les trois rsultats sont exacts.
+        for (int j = 0; j < n; ++j)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                ASSERT_EQ(blocked(i, j), naive(i, j));
+                ASSERT_EQ(blocked(i, j), C(i, j));
+            }
+        }
+        EXPECT_TRUE(blocked_t < unblocked_t);
+        EXPECT_TRUE(blocked_t < 0.4 * naive_t);
+
+        // Meilleur de trois produits sur 1 fil.
+        setParallelThreads(1);
+        double single_t = 0.0;
+        for (int r = 0; r < 3; ++r)
+        {
+            t = high_resolution_clock::now();
+            gemm(1.0, A.view(), B.view(), 0.0, C.view());
+            const double elapsed = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+            single_t = (r == 0 || elapsed < single_t) ? elapsed : single_t;
+        }
+        setParallelThreads(saved);
+        const double single = flops / single_t * 1e-9;
+        std::cout << "  GEMM " << n << "x" << n << " " << simdLevelName(simdLevel()) << ", 1 fil : " << single << " Gflop/s";
+        if (peak > 0.0)
+            std::cout << " (" << 100.0 * single / peak << " % du pic de " << peak << " Gflop/s)";
+        std::cout << std::endl;
+        if (peak > 0.0) {
+            EXPECT_GT(single, 0.4 * peak);
+        }
+    }
+}
+
+/**
+ * Courbes de mise  l'chelle de gemm et gemv (deux ordres de stockage), de
+ * 1 fil au nombre de coeurs de la machine (puissances de deux, puis ce
+ * nombre). Les rsultats sont identiques quel que soit le nombre de fils.
+ */
+TEST(TestsPerformance, ScalabiliteParallele)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const int hardware = std::thread::hardware_concurrency() > 0 ? (int)std::thread::hardware_concurrency() : 1;
+    std::vector<int> counts;
+    for (int t = 1; t < hardware; t *= 2)
+        counts.push_back(t);
+    counts.push_back(hardware);
+
+    const int n = 1024;
+    const int nv = 8192;
+    const int repetitions = 5;
+    Matrix<double> A(n, n), B(n, n), C(n, n, Uninitialized);
+    Matrix<double> G(nv, nv);
+    Matrix<double, Dynamic, Dynamic, RowStorage> H(nv, nv);
+    Vector<double> x(nv), y(nv);
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+            A(i, j) = B(j, i) = (double)((i + j) % 7) - 3.0;
+    for (int j = 0; j < nv; ++j)
+    {
+        x(j) = 1.0 / (j + 1);
+        for (int i = 0; i < nv; ++i)
+            G(i, j) = H(i, j) = (double)((i + 3 * j) % 5);
+    }
+
+    using namespace std::chrono;
+    double base[3] = { 0.0, 0.0, 0.0 };
+    Vector<double> reference;
+    for (size_t c = 0; c < counts.size(); ++c)
+    {
+        setParallelThreads(counts[c]);
+        double seconds[3];
+
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        gemm(1.0, A.view(), B.view(), 0.0, C.view());
+        seconds[0] = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+
+        t = high_resolution_clock::now();
+        for (int r = 0; r < repetitions; ++r)
+            y = G * x;
+        seconds[1] = duration_cast<duration<double>>(high_resolution_clock::now() - t).count() / repetitions;
+
+        t = high_resolution_clock::now();
+        for (int r = 0; r < repetitions; ++r)
+            y = H * x;
+        seconds[2] = duration_cast<duration<double>>(high_resolution_clock::now() - t).count() / repetitions;
+
+        if (c == 0)
+        {
+            for (int k = 0; k < 3; ++k)
+                base[k] = seconds[k];
+            reference = y;
+        }
+
+        const double bytes = (double)nv * nv * sizeof(double);
+        std::cout << "  " << counts[c] << " fil(s) : GEMM " << n << " " << 2.0 * n * n * (double)n / seconds[0] * 1e-9
+            << " Gflop/s (x" << base[0] / seconds[0] << "), GEMV colonnes " << bytes / seconds[1] * 1e-9
+            << " Go/s (x" << base[1] / seconds[1] << "), GEMV lignes " << bytes / seconds[2] * 1e-9
+            << " Go/s (x" << base[2] / seconds[2] << ")" << std::endl;
+
+        for (int i = 0; i < nv; ++i)
+            ASSERT_EQ(y(i), reference(i));
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * Surcot de la rserve de fils : tches vides lances par un mme fil,
+ * tches rcursives et rgions parallel_for vides. Une rgion sur la rserve
+ * doit coter moins que la cration et l'attente d'autant de std::thread.
+ */
+TEST(TestsPerformance, SurcoutTaches)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const int hardware = std::thread::hardware_concurrency() > 0 ? (int)std::thread::hardware_concurrency() : 1;
+    const int threads = hardware < 4 ? 4 : hardware;
+    const int tasks = 100000;
+    const int regions = 2000;
+
+    using namespace std::chrono;
+    setParallelThreads(threads);
+    ThreadPool& pool = globalThreadPool();
+
+    std::atomic<int> count(0);
+    high_resolution_clock::time_point t = high_resolution_clock::now();
+    {
+        TaskGroup group(pool);
+        for (int k = 0; k < tasks; ++k)
+            group.spawn([&count]() { ++count; });
+        group.wait();
+    }
+    const double spawn_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+    EXPECT_EQ(count.load(), tasks);
+
+    // Arbre binaire de tches : chaque noeud lance un fils et traite l'autre.
+    count = 0;
+    std::function<void(int)> tree = [&pool, &count, &tree](int depth) {
+        ++count;
+        if (depth == 0)
+            return;
+        TaskGroup group(pool);
+        group.spawn([&tree, depth]() { tree(depth - 1); });
+        tree(depth - 1);
+        group.wait();
+    };
+    t = high_resolution_clock::now();
+    tree(16);
+    const double tree_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+    EXPECT_EQ(count.load(), (1 << 17) - 1);
+
+    t = high_resolution_clock::now();
+    for (int r = 0; r < regions; ++r)
+        parallel_for(threads, [&count](Index, Index) { ++count; });
+    const double region_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+
+    // Rfrence : un std::thread par tranche, cr  chaque rgion.
+    t = high_resolution_clock::now();
+    for (int r = 0; r < regions; ++r)
+    {
+        std::vector<std::thread> workers;
+        for (int k = 0; k < threads - 1; ++k)
+            workers.push_back(std::thread([&count]() { ++count; }));
+        ++count;
+        for (size_t k = 0; k < workers.size(); ++k)
+            workers[k].join();
+    }
+    const double thread_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+
+    std::cout << "  " << threads << " fils : tache vide " << spawn_t / tasks * 1e9
+        << " ns, tache recursive " << tree_t / ((1 << 17) - 1) * 1e9
+        << " ns, region parallel_for " << region_t / regions * 1e6
+        << " us (std::thread : " << thread_t / regions * 1e6 << " us)" << std::endl;
+
+    EXPECT_TRUE(region_t < thread_t);
+    setParallelThreads(saved);
+}
+
+/**
+ * Petites matrices de taille fixe : produits 3x3 et 4x4 et rotations de
+ * points enchans, noyau droul (FixedSize.h) contre gemm()/gemv() sur des
+ * vues. Les deux calculs donnent le mme rsultat.
+ */
+TEST(TestsPerformance, PetitesMatricesFixes)
+{
+    const int iterations = 1000000;
+    using namespace std::chrono;
+
+    // B et R sont des rotations : les produits enchans restent borns.
+    const float c = std::cos(0.1f), s = std::sin(0.1f);
+    Matrix<float, 4, 4> A, B;
+    Matrix<float, 3, 3, RowStorage> R;
+    B.setZero();
+    R.setZero();
+    for (Index i = 0; i < 4; ++i)
+        for (Index j = 0; j < 4; ++j)
+            A(i, j) = (i == j ? 0.5f : 0.0f) + 0.01f * (i - j);
+    B(0, 0) = B(1, 1) = B(2, 2) = B(3, 3) = c;
+    B(0, 1) = B(2, 3) = -s;
+    B(1, 0) = B(3, 2) = s;
+    R(0, 0) = R(1, 1) = c;
+    R(0, 1) = -s;
+    R(1, 0) = s;
+    R(2, 2) = 1.0f;
+
+    Matrix<float, 4, 4> C(A), D(A), tmp;
+    Vector<float, 3> p, q, v;
+    p(0) = q(0) = 1.0f;
+    p(1) = q(1) = -2.0f;
+    p(2) = q(2) = 0.5f;
+
+    high_resolution_clock::time_point t = high_resolution_clock::now();
+    for (int k = 0; k < iterations; ++k)
+    {
+        multiply(C, B, tmp);
+        C = tmp;
+        multiply(R, p, v);
+        p = v;
+    }
+    const double fixed_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+
+    t = high_resolution_clock::now();
+    for (int k = 0; k < iterations; ++k)
+    {
+        gemm(1.0f, D.view(), B.view(), 0.0f, tmp.view());
+        D = tmp;
+        gemv(1.0f, R.view(), q.view(), 0.0f, v.view());
+        q = v;
+    }
+    const double generic_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+
+    for (Index i = 0; i < 4; ++i)
+        for (Index j = 0; j < 4; ++j)
+            ASSERT_NEAR(C(i, j), D(i, j), 1e-5f * (1.0f + std::abs(D(i, j))));
+    for (Index i = 0; i < 3; ++i)
+        ASSERT_NEAR(p(i), q(i), 1e-5f * (1.0f + std::abs(q(i))));
+
+    std::cout << "  4x4 * 4x4 + 3x3 * 3 : deroule " << fixed_t / iterations * 1e9
+        << " ns, gemm/gemv " << generic_t / iterations * 1e9 << " ns" << std::endl;
+
+    EXPECT_TRUE(fixed_t < generic_t);
+}
+
+/**
+ * Construction d'une matrice creuse par tuples, de 10^3 
+ * GTI320_BENCH_MAX_TRIPLETS tuples (10 par ligne en moyenne, avec doublons),
+ * sur 1 fil puis sur tous les coeurs. Le cot par tuple doit rester  peu
+ * prs constant : l'ancienne construction, en O(rows * nnz), cotait 100 fois
+ * plus par tuple  chaque facteur 10.
+ */
+TEST(TestsPerformance, TripletsCreux)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const int hardware = std::thread::hardware_concurrency() > 0 ? (int)std::thread::hardware_concurrency() : 1;
+    using namespace std::chrono;
+
+    double reference = 0.0;
+    for (Index n = 1000; n <= GTI320_BENCH_MAX_TRIPLETS; n *= 10)
+    {
+        const Index rows = n / 10, cols = n / 10;
+        std::vector< TripletType<double> > triplets((size_t)n);
+        unsigned long long state = 2024;
+        for (Index t = 0; t < n; ++t)
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            triplets[(size_t)t].i = (Index)((state >> 33) % (unsigned long long)rows);
+            triplets[(size_t)t].j = (Index)((state >> 13) % (unsigned long long)cols);
+            triplets[(size_t)t].val = 1.0;
+        }
+
+        setParallelThreads(1);
+        SparseMatrix<double> A(rows, cols);
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        A.setFromTriplets(triplets.data(), n);
+        const double sequential_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+
+        setParallelThreads(hardware);
+        SparseMatrix<double> B(rows, cols);
+        t = high_resolution_clock::now();
+        B.setFromTriplets(triplets.data(), n);
+        const double parallel_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count();
+
+        ASSERT_EQ(A.getInnerSize(), B.getInnerSize());
+        ASSERT_LE(A.getInnerSize(), n);
+        double sum = 0.0;
+        for (Index k = 0; k < B.getInnerSize(); ++k)
+            sum += B.values()[k];
+        ASSERT_EQ(sum, (double)n);
+
+        std::cout << "  " << n << " tuples : " << sequential_t / n * 1e9 << " ns/tuple (1 fil), "
+            << parallel_t / n * 1e9 << " ns/tuple (" << hardware << " fils)" << std::endl;
+
+        if (n == 100000)
+            reference = sequential_t / n;
+        else if (n > 100000) {
+            EXPECT_LT(sequential_t / n, 20.0 * reference);
+        }
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * Mise  l'chelle du produit creux sur une matrice dsquilibre : 1 % des
+ * lignes portent la moiti des entres. Avec des tranches d'autant de lignes,
+ * le fil qui reoit les lignes longues retarderait tous les autres ; les
+ * tranches de nombre d'entres gal gardent une acclration proche du
+ * nombre de fils (tant que la bande passante mmoire suit).
+ */
+TEST(TestsPerformance, ProduitCreuxDesequilibre)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const int hardware = std::thread::hardware_concurrency() > 0 ? (int)std::thread::hardware_concurrency() : 1;
+    std::vector<int> counts;
+    for (int t = 1; t < hardware; t *= 2)
+        counts.push_back(t);
+    counts.push_back(hardware);
+
+    const Index m = 1000000, n = 1000000;
+    const int repetitions = 10;
+    std::vector< TripletType<double> > triplets;
+    triplets.reserve(12000000);
+    for (Index i = 0; i < m; ++i)
+    {
+        // Lignes longues regroupes au dbut de chaque bloc de 100 lignes.
+        const Index length = (i % 100 == 0) ? 500 : 5;
+        for (Index k = 0; k < length; ++k)
+            triplets.push_back(TripletType<double>{ 1.0, i, (i * 31 + k * 1009) % n });
+    }
+    SparseMatrix<double> A(m, n);
+    A.setFromTriplets(triplets.data(), (Index)triplets.size());
+    std::vector< TripletType<double> >().swap(triplets);
+
+    Vector<double> x(n), y;
+    for (Index j = 0; j < n; ++j)
+        x(j) = 1.0 / (j + 1);
+
+    using namespace std::chrono;
+    double base = 0.0;
+    Vector<double> reference;
+    for (size_t c = 0; c < counts.size(); ++c)
+    {
+        setParallelThreads(counts[c]);
+        multiply(A, x, y);
+
+        high_resolution_clock::time_point t = high_resolution_clock::now();
+        for (int r = 0; r < repetitions; ++r)
+            multiply(A, x, y);
+        const double seconds = duration_cast<duration<double>>(high_resolution_clock::now() - t).count() / repetitions;
+
+        if (c == 0)
+        {
+            base = seconds;
+            reference = y;
+        }
+
+        std::cout << "  " << counts[c] << " fil(s) : SpMV " << A.getInnerSize() << " entrees, "
+            << 2.0 * A.getInnerSize() / seconds * 1e-9 << " Gflop/s (x" << base / seconds << ")" << std::endl;
+
+        for (Index i = 0; i < m; ++i)
+            ASSERT_EQ(y(i), reference(i));
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * Produit creux CRS contre SELL-C-sigma (paquets de 8 lignes, lectures
+ * groupes), sur une matrice de lignes de longueurs voisines (comme une
+ * discrtisation par lments finis), sur 1 fil et pour chaque niveau SIMD.
+ */
+TEST(TestsPerformance, ProduitCreuxSell)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const SimdLevel savedLevel = simdLevel();
+    setParallelThreads(1);
+
+    const Index m = 500000, n = 500000;
+    const int repetitions = 20;
+    std::vector< TripletType<double> > triplets;
+    triplets.reserve(16 * m);
+    for (Index i = 0; i < m; ++i)
+    {
+        const Index length = 12 + i % 5;
+        for (Index k = 0; k < length; ++k)
+            triplets.push_back(TripletType<double>{ 1.0 + 0.01 * k, i, (i + (k - 6) * 97 + n) % n });
+    }
+    SparseMatrix<double> A(m, n);
+    A.setFromTriplets(triplets.data(), (Index)triplets.size());
+    std::vector< TripletType<double> >().swap(triplets);
+
+    const SellMatrix<double> S(A);
+    const SparseOperator<double> op(A);
+    Vector<double> x(n), y, z;
+    for (Index j = 0; j < n; ++j)
+        x(j) = 1.0 / (j + 1);
+
+    using namespace std::chrono;
+    const double flops = 2.0 * A.getInnerSize();
+    multiply(A, x, y);
+    high_resolution_clock::time_point t = high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        multiply(A, x, y);
+    const double crs_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count() / repetitions;
+
+    std::cout << "  " << A.getInnerSize() << " entrees, remplissage SELL " << (double)S.storedEntries() / S.nonZeros()
+        << ", variation " << S.rowLengthVariation() << ", format choisi : "
+        << (op.format() == SparseFormatSELL ? "SELL" : "CRS") << std::endl;
+    std::cout << "  CRS : " << flops / crs_t * 1e-9 << " Gflop/s" << std::endl;
+
+    for (int level = SimdScalar; level <= supportedSimdLevel(); ++level)
+    {
+        setSimdLevel((SimdLevel)level);
+        multiply(S, x, z);
+        t = high_resolution_clock::now();
+        for (int r = 0; r < repetitions; ++r)
+            multiply(S, x, z);
+        const double sell_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count() / repetitions;
+
+        std::cout << "  SELL-8-" << S.sigma() << " " << simdLevelName((SimdLevel)level) << " : "
+            << flops / sell_t * 1e-9 << " Gflop/s (x" << crs_t / sell_t << ")" << std::endl;
+        for (Index i = 0; i < m; ++i)
+            ASSERT_NEAR(z(i), y(i), 1e-12 * (1.0 + std::abs(y(i))));
+    }
+
+    // Le gain dpend surtout de la bande passante mmoire : seul le choix
+    // du format est vrifi.
+    if (supportedSimdLevel() >= SimdAVX2) {
+        EXPECT_EQ(op.format(), SparseFormatSELL);
+    }
+    setSimdLevel(savedLevel);
+    setParallelThreads(saved);
+}
+
+/**
+ * Produit creux par blocs 3 x 3 (BSR) contre le mme produit en CRS, sur
+ * 1 fil : un indice de colonne par bloc au lieu d'un par entre, et un
+ * noyau droul par bloc. Produit par la transpose en prime.
+ */
+TEST(TestsPerformance, ProduitCreuxBlocs)
+{
+    const int saved = internal::parallelThreadsSetting();
+    setParallelThreads(1);
+
+    const Index blockRows = 150000;
+    const int perRow = 8, repetitions = 20;
+    std::vector< BlockTripletType<double, 3, 3> > blocks;
+    std::vector< TripletType<double> > scalars;
+    blocks.reserve(perRow * blockRows);
+    scalars.reserve(9 * perRow * blockRows);
+    for (Index bi = 0; bi < blockRows; ++bi)
+    {
+        for (int k = 0; k < perRow; ++k)
+        {
+            BlockTripletType<double, 3, 3> b;
+            b.i = bi;
+            b.j = (bi + (k - perRow / 2) * 211 + blockRows) % blockRows;
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                {
+                    b.block(r, c) = 1.0 + 0.1 * r - 0.05 * c + 0.01 * k;
+                    scalars.push_back(TripletType<double>{ b.block(r, c), 3 * b.i + r, 3 * b.j + c });
+                }
+            blocks.push_back(b);
+        }
+    }
+    BlockSparseMatrix<double, 3> B(blockRows, blockRows);
+    B.setFromTriplets(blocks.data(), (Index)blocks.size());
+    SparseMatrix<double> A(B.rows(), B.cols());
+    A.setFromTriplets(scalars.data(), (Index)scalars.size());
+    std::vector< BlockTripletType<double, 3, 3> >().swap(blocks);
+    std::vector< TripletType<double> >().swap(scalars);
+
+    Vector<double> x(A.cols()), y, z, w;
+    for (Index j = 0; j < A.cols(); ++j)
+        x(j) = 1.0 / (j + 1);
+
+    using namespace std::chrono;
+    const double flops = 2.0 * A.getInnerSize();
+    multiply(A, x, y);
+    high_resolution_clock::time_point t = high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        multiply(A, x, y);
+    const double crs_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count() / repetitions;
+
+    multiply(B, x, z);
+    t = high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        multiply(B, x, z);
+    const double bsr_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count() / repetitions;
+
+    multiplyTransposed(B, x, w);
+    t = high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        multiplyTransposed(B, x, w);
+    const double transposed_t = duration_cast<duration<double>>(high_resolution_clock::now() - t).count() / repetitions;
+
+    std::cout << "  " << A.getInnerSize() << " entrees, " << B.nonZeroBlocks() << " blocs 3 x 3" << std::endl;
+    std::cout << "  CRS : " << flops / crs_t * 1e-9 << " Gflop/s" << std::endl;
+    std::cout << "  BSR : " << flops / bsr_t * 1e-9 << " Gflop/s (x" << crs_t / bsr_t << ")" << std::endl;
+    std::cout << "  BSR transposee : " << flops / transposed_t * 1e-9 << " Gflop/s" << std::endl;
+
+    for (Index i = 0; i < A.rows(); ++i)
+        ASSERT_NEAR(z(i), y(i), 1e-12 * (1.0 + std::abs(y(i))));
+    EXPECT_LT(bsr_t, crs_t);
+    setParallelThreads(saved);
+}
@@ -0,0 +1,237 @@
+/**
+ * @file TestsSimd.cpp
+ *
+ * @brief Tests unitaires des noyaux vectoriels (Simd.h) : chaque niveau
+ *        disponible sur la machine est comparé à la version scalaire.
+ *
+ */
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "Operators.h"
+#include "Simd.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace gti320;
+
+namespace {
+
+    /**
+     * Rétablit le niveau d'origine à la fin d'un test.
+     */
+    class TestsSimd : public ::testing::Test
+    {
+    protected:
+
+        void SetUp() override { m_level = simdLevel(); }
+        void TearDown() override { setSimdLevel(m_level); }
+
+    private:
+
+        SimdLevel m_level;
+    };
+
+    template<typename _Scalar>
+    std::vector<_Scalar> values(Index n, double seed)
+    {
+        std::vector<_Scalar> v((size_t)n);
+        for (Index i = 0; i < n; ++i)
+            v[(size_t)i] = (_Scalar)(std::sin(seed + 0.37 * i) * (1.0 + (i % 5)));
+        return v;
+    }
+
+    template<typename _Scalar> double tolerance();
+    template<> double tolerance<float>() { return 1e-5; }
+    template<> double tolerance<double>() { return 1e-13; }
+
+    /**
+     * Les cinq noyaux d'un niveau, pour toutes les longueurs de 0 à 70 et
+     * quelques grandes longueurs, sur des tampons décalés de 0 à 3 éléments
+     * (adresses non alignées). La sentinelle qui suit le tampon de sortie ne
+     * doit pas être modifiée.
+     */
+    template<typename _Scalar>
+    void checkKernels(SimdLevel level)
+    {
+        const internal::SimdKernels<_Scalar>& k = internal::simdKernels<_Scalar>(level);
+        const internal::SimdKernels<_Scalar>& ref = internal::simdKernels<_Scalar>(SimdScalar);
+        const double tol = tolerance<_Scalar>();
+        const _Scalar a = (_Scalar)-1.75;
+        const _Scalar sentinel = (_Scalar)12345;
+
+        std::vector<Index> lengths;
+        for (Index n = 0; n <= 70; ++n)
+            lengths.push_back(n);
+        lengths.push_back(255);
+        lengths.push_back(1000);
+        lengths.push_back(4099);
+
+        for (size_t t = 0; t < lengths.size(); ++t)
+        {
+            const Index n = lengths[t];
+            for (Index offset = 0; offset < 4; ++offset)
+            {
+                const std::vector<_Scalar> x = values<_Scalar>(n + offset + 1, 0.5);
+                const std::vector<_Scalar> y = values<_Scalar>(n + offset + 1, 2.0);
+                const _Scalar* px = x.data() + offset;
+                const _Scalar* py = y.data() + offset;
+
+                double norm = 0.0;
+                for (Index i = 0; i < n; ++i)
+                    norm += std::abs((double)px[i] * py[i]);
+                EXPECT_NEAR(k.dot(n, px, py), ref.dot(n, px, py), tol * (1.0 + norm))
+                    << simdLevelName(level) << " dot, n = " << n << ", decalage = " << offset;
+
+                std::vector<_Scalar> z(x.size() + 1, sentinel), zref(x.size() + 1, sentinel);
+                k.add(n, px, py, z.data() + offset);
+                ref.add(n, px, py, zref.data() + offset);
+                for (Index i = 0; i < n; ++i)
+                    ASSERT_EQ(z[(size_t)(offset + i)], zref[(size_t)(offset + i)]) << simdLevelName(level) << " add, n = " << n;
+                EXPECT_EQ(z[(size_t)(offset + n)], sentinel);
+
+                k.scale(n, a, px, z.data() + offset);
+                ref.scale(n, a, px, zref.data() + offset);
+                for (Index i = 0; i < n; ++i)
+                    ASSERT_EQ(z[(size_t)(offset + i)], zref[(size_t)(offset + i)]) << simdLevelName(level) << " scale, n = " << n;
+                EXPECT_EQ(z[(size_t)(offset + n)], sentinel);
+
+                // axpy : FMA arrondit une seule fois, d'où la tolérance.
+                k.axpy(n, a, py, z.data() + offset);
+                ref.axpy(n, a, py, zref.data() + offset);
+                for (Index i = 0; i < n; ++i)
+                    ASSERT_NEAR(z[(size_t)(offset + i)], zref[(size_t)(offset + i)], tol * 8.0) << simdLevelName(level) << " axpy, n = " << n;
+                EXPECT_EQ(z[(size_t)(offset + n)], sentinel);
+
+                k.axpby(n, a, px, (_Scalar)0.5, z.data() + offset);
+                ref.axpby(n, a, px, (_Scalar)0.5, zref.data() + offset);
+                for (Index i = 0; i < n; ++i)
+                    ASSERT_NEAR(z[(size_t)(offset + i)], zref[(size_t)(offset + i)], tol * 8.0) << simdLevelName(level) << " axpby, n = " << n;
+                EXPECT_EQ(z[(size_t)(offset + n)], sentinel);
+            }
+        }
+
+        // Sorties confondues avec une entrée.
+        std::vector<_Scalar> x = values<_Scalar>(37, 1.0), y = values<_Scalar>(37, 3.0);
+        const std::vector<_Scalar> x0(x);
+        k.scale(37, a, x.data(), x.data());
+        k.add(37, x.data(), y.data(), x.data());
+        for (size_t i = 0; i < 37; ++i)
+            EXPECT_EQ(x[i], a * x0[i] + y[i]);
+    }
+
+} // namespace
+
+/**
+ * Niveau détecté et restriction du niveau courant.
+ */
+TEST_F(TestsSimd, Niveaux)
+{
+#if GTI320_SIMD
+    EXPECT_GE(supportedSimdLevel(), SimdSSE2);
+#else
+    EXPECT_EQ(supportedSimdLevel(), SimdScalar);
+#endif
+    EXPECT_EQ(simdLevel(), supportedSimdLevel());
+    std::cout << "  Niveau detecte : " << simdLevelName(supportedSimdLevel()) << std::endl;
+
+    setSimdLevel(SimdScalar);
+    EXPECT_EQ(simdLevel(), SimdScalar);
+    setSimdLevel(SimdAVX512);
+    EXPECT_EQ(simdLevel(), supportedSimdLevel());
+}
+
+/**
+ * Chaque niveau disponible, en simple et en double précision.
+ */
+TEST_F(TestsSimd, Noyaux)
+{
+    for (int level = SimdScalar; level <= supportedSimdLevel(); ++level)
+    {
+        checkKernels<float>((SimdLevel)level);
+        checkKernels<double>((SimdLevel)level);
+    }
+
+    // Les autres types utilisent toujours les boucles scalaires.
+    int a[5] = { 1, 2, 3, 4, 5 };
+    EXPECT_EQ(internal::simdKernels<int>(supportedSimdLevel()).dot(5, a, a), 55);
+}
+
+/**
+ * Opérations de Vector, gemv, add et expressions : mêmes résultats quel que
+ * soit le niveau.
+ */
+TEST_F(TestsSimd, Operateurs)
+{
+    const Index m = 131, n = 77;
+    Matrix<double> A(m, n);
+    Matrix<double, Dynamic, Dynamic, RowStorage> R(m, n);
+    Matrix<double> B(m, n);
+    Vector<double> u(n), v(m);
+    Vector<float> f(m), g(m);
+    for (Index i = 0; i < m; ++i)
+    {
+        for (Index j = 0; j < n; ++j)
+        {
+            A(i, j) = std::cos(0.1 * i - 0.3 * j);
+            R(i, j) = std::sin(0.2 * i + 0.1 * j);
+            B(i, j) = 0.5 * i - j;
+        }
+        v(i) = 1.0 / (i + 1);
+        f(i) = (float)std::sin(0.5 * i);
+        g(i) = (float)(i % 7) - 3.0f;
+    }
+    for (Index j = 0; j < n; ++j)
+        u(j) = 0.25 * j - 3.0;
+
+    setSimdLevel(SimdScalar);
+    const double dotRef = v.dot(v);
+    const double normRef = v.norm();
+    const float dotfRef = f.dot(g);
+    const Vector<double> yRef = A * u;
+    const Vector<double> zRef = R * u;
+    Vector<double> wRef(v);
+    gemv(2.0, A.view(), u.view(), -0.5, wRef.view());
+    const Matrix<double> sumRef = A + B;
+    const Matrix<double> scaledRef = 3.0 * A;
+    Matrix<double> blockRef(m, n);
+    add(A.view(1, 1, 20, 30), B.view(0, 2, 20, 30), blockRef.view(3, 4, 20, 30));
+
+    for (int level = SimdSSE2; level <= supportedSimdLevel(); ++level)
+    {
+        setSimdLevel((SimdLevel)level);
+        const char* name = simdLevelName((SimdLevel)level);
+
+        EXPECT_NEAR(v.dot(v), dotRef, 1e-13 * dotRef) << name;
+        EXPECT_NEAR(v.norm(), normRef, 1e-13 * normRef) << name;
+        EXPECT_NEAR(f.dot(g), dotfRef, 1e-4f) << name;
+
+        const Vector<double> y = A * u;
+        const Vector<double> z = R * u;
+        Vector<double> w(v);
+        gemv(2.0, A.view(), u.view(), -0.5, w.view());
+        for (Index i = 0; i < m; ++i)
+        {
+            EXPECT_NEAR(y(i), yRef(i), 1e-12) << name;
+            EXPECT_NEAR(z(i), zRef(i), 1e-12) << name;
+            EXPECT_NEAR(w(i), wRef(i), 1e-12) << name;
+        }
+
+        const Matrix<double> sum = A + B;
+        const Matrix<double> scaled = 3.0 * A;
+        Matrix<double> block(m, n);
+        add(A.view(1, 1, 20, 30), B.view(0, 2, 20, 30), block.view(3, 4, 20, 30));
+        for (Index i = 0; i < m; ++i)
+        {
+            for (Index j = 0; j < n; ++j)
+            {
+                ASSERT_EQ(sum(i, j), sumRef(i, j)) << name;
+                ASSERT_EQ(scaled(i, j), scaledRef(i, j)) << name;
+                ASSERT_EQ(block(i, j), blockRef(i, j)) << name;
+            }
+        }
+    }
+}
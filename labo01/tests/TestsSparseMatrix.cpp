@@ -14,8 +14,15 @@
 #include "SparseMatrix.h"
 #include "Vector.h"
 #include "Operators.h"
+#include "Parallel.h"
+#include "SellMatrix.h"
+#include "BlockSparseMatrix.h"
+#include "Simd.h"
 
 #include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
 
 using namespace gti320;
 
@@ -71,3 +78,402 @@ TEST(TestsSparseMatrix, SparseMatrix)
     }
 
 }
+
+
+namespace {
+
+    // Vrifie que les colonnes de chaque ligne sont strictement croissantes.
+    template<typename _Scalar>
+    void expectSortedRows(const SparseMatrix<_Scalar>& A)
+    {
+        for (Index r = 0; r < A.rows(); ++r)
+        {
+            for (Index k = A.outer()[r] + 1; k < A.outer()[r + 1]; ++k)
+                ASSERT_LT(A.inner()[k - 1], A.inner()[k]) << "ligne " << r;
+        }
+    }
+
+    // Triplets pseudo-alatoires, avec des doublons (i, j).
+    std::vector< TripletType<double> > makeTriplets(Index rows, Index cols, Index n)
+    {
+        std::vector< TripletType<double> > triplets((size_t)n);
+        unsigned long long state = 12345;
+        for (Index t = 0; t < n; ++t)
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            triplets[(size_t)t].i = (Index)((state >> 33) % (unsigned long long)rows);
+            triplets[(size_t)t].j = (Index)((state >> 13) % (unsigned long long)cols);
+            triplets[(size_t)t].val = (double)(t % 17) - 8.0;
+        }
+        return triplets;
+    }
+
+} // namespace
+
+/**
+ * Construction par tuples : colonnes tries dans chaque ligne et doublons
+ * additionns.
+ */
+TEST(TestsSparseMatrix, TripletsDoublons)
+{
+    const Index rows = 50, cols = 40, n = 3000;
+    const std::vector< TripletType<double> > triplets = makeTriplets(rows, cols, n);
+
+    Matrix<double> dense(rows, cols);
+    for (Index t = 0; t < n; ++t)
+        dense(triplets[(size_t)t].i, triplets[(size_t)t].j) += triplets[(size_t)t].val;
+
+    SparseMatrix<double> A(rows, cols);
+    A.setFromTriplets(triplets.data(), n);
+    expectSortedRows(A);
+    EXPECT_LE(A.getInnerSize(), rows * cols);
+    EXPECT_EQ(A.outer()[rows], A.getInnerSize());
+
+    for (Index i = 0; i < rows; ++i)
+        for (Index j = 0; j < cols; ++j)
+            ASSERT_EQ(A(i, j), dense(i, j)) << "(" << i << ", " << j << ")";
+
+    // Reconstruction avec moins de tuples, lignes vides.
+    TripletType<double> few[] = { { 1.0, 3, 7 }, { 2.0, 3, 1 }, { 4.0, 3, 7 }, { -1.0, 49, 0 } };
+    A.setFromTriplets(few, 4);
+    EXPECT_EQ(A.getInnerSize(), 3);
+    EXPECT_DOUBLE_EQ(A(3, 1), 2.0);
+    EXPECT_DOUBLE_EQ(A(3, 7), 5.0);
+    EXPECT_DOUBLE_EQ(A(49, 0), -1.0);
+    EXPECT_DOUBLE_EQ(A(0, 0), 0.0);
+    expectSortedRows(A);
+
+    A.setFromTriplets(nullptr, 0);
+    EXPECT_EQ(A.getInnerSize(), 0);
+    EXPECT_DOUBLE_EQ(A(3, 7), 0.0);
+
+    // Le cot ne dpend pas du nombre de colonnes : quelques tuples dans
+    // une matrice de 2^40 colonnes.
+    const Index wideCols = (Index)1 << 40;
+    TripletType<double> wide[] = { { 1.0, 2, wideCols - 1 }, { 2.0, 2, 5 }, { 3.0, 0, wideCols - 1 }, { 0.5, 2, wideCols - 1 } };
+    SparseMatrix<double> W(4, wideCols);
+    W.setFromTriplets(wide, 4);
+    EXPECT_EQ(W.getInnerSize(), 3);
+    EXPECT_DOUBLE_EQ(W(2, 5), 2.0);
+    EXPECT_DOUBLE_EQ(W(2, wideCols - 1), 1.5);
+    EXPECT_DOUBLE_EQ(W(0, wideCols - 1), 3.0);
+    expectSortedRows(W);
+}
+
+/**
+ * Construction parallle (histogrammes par fil) : mme structure et mmes
+ * valeurs, au bit prs, que la construction squentielle.
+ */
+TEST(TestsSparseMatrix, TripletsParallele)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const Index rows = 20000, cols = 15000;
+    const Index n = 4 * parallelGrain(1.0) + 7;
+    const std::vector< TripletType<double> > triplets = makeTriplets(rows, cols, n);
+
+    setParallelThreads(1);
+    SparseMatrix<double> ref(rows, cols);
+    ref.setFromTriplets(triplets.data(), n);
+    expectSortedRows(ref);
+
+    for (int threads = 2; threads <= 4; ++threads)
+    {
+        setParallelThreads(threads);
+        SparseMatrix<double> A(rows, cols);
+        A.setFromTriplets(triplets.data(), n);
+        ASSERT_EQ(A.getInnerSize(), ref.getInnerSize());
+        for (Index r = 0; r <= rows; ++r)
+            ASSERT_EQ(A.outer()[r], ref.outer()[r]);
+        for (Index k = 0; k < ref.getInnerSize(); ++k)
+        {
+            ASSERT_EQ(A.inner()[k], ref.inner()[k]);
+            ASSERT_EQ(A.values()[k], ref.values()[k]);
+        }
+    }
+    setParallelThreads(saved);
+}
+
+/**
+ * Lecture par recherche galopante dans de longues lignes, et coeffRef()
+ * pour modifier une entre de la structure creuse.
+ */
+TEST(TestsSparseMatrix, RechercheEtCoeffRef)
+{
+    const Index rows = 4, cols = 1000;
+    std::vector< TripletType<double> > triplets;
+    // Ligne 0 : colonnes paires (longue) ; ligne 1 : 3 entres ;
+    // ligne 2 : vide ; ligne 3 : toutes les colonnes, en ordre dcroissant.
+    for (Index j = 0; j < cols; j += 2)
+        triplets.push_back(TripletType<double>{ 1.0 + j, 0, j });
+    triplets.push_back(TripletType<double>{ -1.0, 1, 999 });
+    triplets.push_back(TripletType<double>{ -2.0, 1, 0 });
+    triplets.push_back(TripletType<double>{ -3.0, 1, 500 });
+    for (Index j = cols - 1; j >= 0; --j)
+        triplets.push_back(TripletType<double>{ 0.5 * j, 3, j });
+
+    SparseMatrix<double> A(rows, cols);
+    A.setFromTriplets(triplets.data(), (Index)triplets.size());
+
+    for (Index j = 0; j < cols; ++j)
+    {
+        ASSERT_EQ(A(0, j), (j % 2 == 0) ? 1.0 + j : 0.0) << j;
+        ASSERT_EQ(A(2, j), 0.0) << j;
+        ASSERT_EQ(A(3, j), 0.5 * j) << j;
+        ASSERT_EQ(A.find(0, j) >= 0, j % 2 == 0) << j;
+    }
+    EXPECT_EQ(A(1, 0), -2.0);
+    EXPECT_EQ(A(1, 500), -3.0);
+    EXPECT_EQ(A(1, 999), -1.0);
+    EXPECT_EQ(A(1, 998), 0.0);
+    EXPECT_EQ(A.find(1, 1), -1);
+
+    // Modification sans changer la structure.
+    const Index nnz = A.getInnerSize();
+    A.coeffRef(0, 998) = 7.0;
+    A.coeffRef(1, 500) += 1.0;
+    A.coeffRef(3, 0) -= 4.0;
+    EXPECT_EQ(A(0, 998), 7.0);
+    EXPECT_EQ(A(1, 500), -2.0);
+    EXPECT_EQ(A(3, 0), -4.0);
+    EXPECT_EQ(A.getInnerSize(), nnz);
+}
+
+namespace {
+
+    // Matrice rows x cols dont la ligne i compte length(i) entres.
+    template<typename _Scalar, typename _Length>
+    SparseMatrix<_Scalar> makeRows(Index rows, Index cols, const _Length& length)
+    {
+        std::vector< TripletType<_Scalar> > triplets;
+        for (Index i = 0; i < rows; ++i)
+            for (Index k = 0; k < length(i); ++k)
+                triplets.push_back(TripletType<_Scalar>{ (_Scalar)(1.0 + 0.25 * ((i + k) % 9)), i, (i * 17 + k * 29) % cols });
+        SparseMatrix<_Scalar> A(rows, cols);
+        A.setFromTriplets(triplets.data(), (Index)triplets.size());
+        return A;
+    }
+
+    // Produit SELL-C-sigma compar au produit CRS,  chaque niveau SIMD.
+    template<typename _Scalar>
+    void checkSell(const SparseMatrix<_Scalar>& A, Index sigma, double tolerance)
+    {
+        Vector<_Scalar> x(A.cols());
+        for (Index j = 0; j < A.cols(); ++j)
+            x(j) = (_Scalar)std::sin(0.1 * j);
+        const Vector<_Scalar> ref = A * x;
+
+        const SellMatrix<_Scalar> S(A, sigma);
+        EXPECT_EQ(S.nonZeros(), A.getInnerSize());
+        EXPECT_GE(S.storedEntries(), S.nonZeros());
+        EXPECT_EQ(S.sigma() % SellMatrix<_Scalar>::Chunk, 0);
+
+        const SimdLevel saved = simdLevel();
+        for (int level = SimdScalar; level <= supportedSimdLevel(); ++level)
+        {
+            setSimdLevel((SimdLevel)level);
+            Vector<_Scalar> y(3);
+            multiply(S, x, y);
+            ASSERT_EQ(y.rows(), A.rows());
+            for (Index i = 0; i < A.rows(); ++i)
+            {
+                if (level == SimdScalar)
+                    ASSERT_EQ(y(i), ref(i)) << "ligne " << i;
+                else
+                    ASSERT_NEAR(y(i), ref(i), tolerance * (1.0 + std::abs(ref(i)))) << simdLevelName((SimdLevel)level) << ", ligne " << i;
+            }
+        }
+        setSimdLevel(saved);
+    }
+
+} // namespace
+
+/**
+ * Format SELL-C-sigma : mme produit que le format CRS, pour des lignes de
+ * longueurs varies (dont des lignes vides), un nombre de lignes qui n'est
+ * pas un multiple de 8 et plusieurs tailles de fentre.
+ */
+TEST(TestsSparseMatrix, FormatSell)
+{
+    const SparseMatrix<double> A = makeRows<double>(1003, 700, [](Index i) -> Index { return (i % 13 == 0) ? 0 : 1 + (i * 7) % 23; });
+    const SparseMatrix<float> B = makeRows<float>(517, 300, [](Index i) -> Index { return 2 + i % 5; });
+    for (Index sigma = 1; sigma <= 4096; sigma *= 8)
+    {
+        checkSell(A, sigma, 1e-13);
+        checkSell(B, sigma, 1e-5);
+    }
+
+    // Le tri par fentres rduit le remplissage.
+    const SellMatrix<double> narrow(A, 8), wide(A, 1024);
+    EXPECT_LT(wide.storedEntries(), narrow.storedEntries());
+    EXPECT_LT(wide.rowLengthVariation(), narrow.rowLengthVariation());
+
+    // Matrice vide.
+    const SparseMatrix<double> E(5, 4);
+    const SellMatrix<double> S(E);
+    Vector<double> x(4), y;
+    x.setZero();
+    multiply(S, x, y);
+    EXPECT_EQ(y.rows(), 5);
+    EXPECT_EQ(S.storedEntries(), 0);
+}
+
+/**
+ * Choix automatique du format : SELL-C-sigma pour des lignes de longueurs
+ * voisines, CRS lorsque les longueurs varient beaucoup dans un paquet.
+ */
+TEST(TestsSparseMatrix, ChoixDuFormat)
+{
+    const SparseMatrix<double> regular = makeRows<double>(2000, 2000, [](Index i) -> Index { return 9 + i % 2; });
+    const SparseMatrix<double> skewed = makeRows<double>(2000, 2000, [](Index i) -> Index { return (i % 8 == 0) ? 400 : 2; });
+
+    const SparseOperator<double> R(regular), K(skewed, SparseFormatAuto, 8);
+    EXPECT_EQ(R.format(), supportedSimdLevel() >= SimdAVX2 ? SparseFormatSELL : SparseFormatCRS);
+    EXPECT_EQ(K.format(), SparseFormatCRS);
+    EXPECT_EQ(SparseOperator<double>(skewed, SparseFormatSELL, 8).format(), SparseFormatSELL);
+    EXPECT_EQ(SparseOperator<double>(regular, SparseFormatCRS).format(), SparseFormatCRS);
+
+    // Colonnes au-del des indices sur 32 bits : CRS, ou chec explicite.
+    const SparseMatrix<double> wide(4, (Index)1 << 32);
+    EXPECT_FALSE(SellMatrix<double>::supports(wide));
+    EXPECT_TRUE(SellMatrix<double>::supports(regular));
+    EXPECT_EQ(SparseOperator<double>(wide).format(), SparseFormatCRS);
+    EXPECT_THROW(SellMatrix<double> S(wide), std::length_error);
+    EXPECT_THROW(SparseOperator<double>(wide, SparseFormatSELL), std::length_error);
+
+    Vector<double> x(2000);
+    for (Index j = 0; j < 2000; ++j)
+        x(j) = 1.0 / (1.0 + j);
+    const Vector<double> yr = R * x, yk = K * x;
+    const Vector<double> rr = regular * x, rk = skewed * x;
+    for (Index i = 0; i < 2000; ++i)
+    {
+        ASSERT_NEAR(yr(i), rr(i), 1e-13 * (1.0 + std::abs(rr(i))));
+        ASSERT_EQ(yk(i), rk(i));
+    }
+}
+
+namespace {
+
+    // Blocs pseudo-alatoires, avec doublons et lignes de blocs vides, et la
+    // mme matrice en triplets scalaires.
+    template<int _BlockRows, int _BlockCols>
+    void makeBlocks(Index blockRows, Index blockCols, Index count,
+        std::vector< BlockTripletType<double, _BlockRows, _BlockCols> >& blocks, std::vector< TripletType<double> >& scalars)
+    {
+        for (Index t = 0; t < count; ++t)
+        {
+            BlockTripletType<double, _BlockRows, _BlockCols> b;
+            b.i = ((t * 7919) % blockRows) / 3 * 3;
+            b.j = (t * 104729 + t / 5) % blockCols;
+            for (int r = 0; r < _BlockRows; ++r)
+                for (int c = 0; c < _BlockCols; ++c)
+                {
+                    b.block(r, c) = 0.5 + 0.125 * ((t + 3 * r + 5 * c) % 11) - 0.25 * r;
+                    scalars.push_back(TripletType<double>{ b.block(r, c), b.i * _BlockRows + r, b.j * _BlockCols + c });
+                }
+            blocks.push_back(b);
+        }
+    }
+
+    // Structure, coefficients et produits y = A * x et y = A^T * x compars
+    //  la mme matrice en CRS.
+    template<int _BlockRows, int _BlockCols>
+    void checkBlocks(Index blockRows, Index blockCols, Index count)
+    {
+        std::vector< BlockTripletType<double, _BlockRows, _BlockCols> > blocks;
+        std::vector< TripletType<double> > scalars;
+        makeBlocks<_BlockRows, _BlockCols>(blockRows, blockCols, count, blocks, scalars);
+
+        BlockSparseMatrix<double, _BlockRows, _BlockCols> A(blockRows, blockCols);
+        A.setFromTriplets(blocks.data(), (Index)blocks.size());
+        SparseMatrix<double> S(A.rows(), A.cols());
+        S.setFromTriplets(scalars.data(), (Index)scalars.size());
+
+        ASSERT_EQ(A.rows(), blockRows * _BlockRows);
+        ASSERT_EQ(A.cols(), blockCols * _BlockCols);
+        ASSERT_EQ(A.nonZeroBlocks() * _BlockRows * _BlockCols, S.getInnerSize());
+        EXPECT_EQ(A.outer()[blockRows], A.nonZeroBlocks());
+        for (Index bi = 0; bi < blockRows; ++bi)
+            for (Index k = A.outer()[bi] + 1; k < A.outer()[bi + 1]; ++k)
+                ASSERT_LT(A.inner()[k - 1], A.inner()[k]);
+        for (Index i = 0; i < A.rows(); ++i)
+            for (Index j = 0; j < A.cols(); j += 1 + i % 3)
+                ASSERT_DOUBLE_EQ(A(i, j), S(i, j)) << "(" << i << ", " << j << ")";
+
+        Vector<double> x(A.cols()), u(A.rows());
+        for (Index j = 0; j < A.cols(); ++j)
+            x(j) = std::cos(0.3 * j);
+        for (Index i = 0; i < A.rows(); ++i)
+            u(i) = 1.0 / (1.0 + i);
+
+        const Vector<double> y = A * x, ref = S * x;
+        ASSERT_EQ(y.rows(), A.rows());
+        for (Index i = 0; i < A.rows(); ++i)
+            ASSERT_NEAR(y(i), ref(i), 1e-12 * (1.0 + std::abs(ref(i)))) << "ligne " << i;
+
+        Vector<double> z(3), refT(A.cols());
+        multiplyTransposed(A, u, z);
+        refT.setZero();
+        for (Index i = 0; i < S.rows(); ++i)
+            for (Index k = S.outer()[i]; k < S.outer()[i + 1]; ++k)
+                refT(S.inner()[k]) += S.values()[k] * u(i);
+        ASSERT_EQ(z.rows(), A.cols());
+        for (Index j = 0; j < A.cols(); ++j)
+            ASSERT_NEAR(z(j), refT(j), 1e-12 * (1.0 + std::abs(refT(j)))) << "colonne " << j;
+    }
+
+} // namespace
+
+/**
+ * Matrices creuses par blocs 3 x 3, 4 x 4 et 3 x 4 : doublons additionns,
+ * lignes de blocs vides, produits par la matrice et par sa transpose.
+ */
+TEST(TestsSparseMatrix, BlocsCreux)
+{
+    checkBlocks<3, 3>(40, 30, 200);
+    checkBlocks<4, 4>(25, 25, 120);
+    checkBlocks<3, 4>(17, 9, 60);
+    checkBlocks<1, 1>(10, 12, 30);
+
+    // Matrice vide.
+    BlockSparseMatrix<double, 3> E(4, 2);
+    E.setFromTriplets(nullptr, 0);
+    Vector<double> x(6), y, z;
+    x.setZero();
+    multiply(E, x, y);
+    EXPECT_EQ(y.rows(), 12);
+    multiplyTransposed(E, y, z);
+    EXPECT_EQ(z.rows(), 6);
+    EXPECT_EQ(E.nonZeroBlocks(), 0);
+}
+
+/**
+ * Produit par blocs rparti entre les fils : mme rsultat, au bit prs,
+ * qu'avec un seul fil.
+ */
+TEST(TestsSparseMatrix, BlocsParallele)
+{
+    const int saved = internal::parallelThreadsSetting();
+    const Index blockRows = 20000;
+    std::vector< BlockTripletType<double, 3, 3> > blocks;
+    std::vector< TripletType<double> > scalars;
+    makeBlocks<3, 3>(blockRows, blockRows, 8 * blockRows, blocks, scalars);
+    std::vector< TripletType<double> >().swap(scalars);
+
+    BlockSparseMatrix<double, 3> A(blockRows, blockRows);
+    A.setFromTriplets(blocks.data(), (Index)blocks.size());
+    Vector<double> x(A.cols());
+    for (Index j = 0; j < A.cols(); ++j)
+        x(j) = std::sin(0.01 * j);
+
+    setParallelThreads(1);
+    const Vector<double> ref = A * x;
+    for (int threads = 2; threads <= 4; ++threads)
+    {
+        setParallelThreads(threads);
+        const Vector<double> y = A * x;
+        for (Index i = 0; i < A.rows(); ++i)
+            ASSERT_EQ(y(i), ref(i)) << "ligne " << i;
+    }
+    setParallelThreads(saved);
+}
@@ -36,6 +36,7 @@ int main(int argc, char** argv)
     // Executer tous les tests unitaires.
     // 
     // Les tests sont crites dans les fichiers:
+    //   tests/TestsAllocation.cpp
     //   tests/TestsMath3D.cpp
     //   tests/TestsSubMatrix.cpp
     //
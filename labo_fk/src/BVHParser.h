@@ -2,6 +2,7 @@
 
 #include "Armature.h"
 #include "Math3D.h"
+#include "Map.h"
 
 namespace gti320
 {
@@ -216,6 +217,20 @@ namespace gti320
         return bvh->jointCount - 1;
     }
 
+    // View of the motion data as a frameCount x channelCount matrix (one row per frame).
+    // No copy is made: the view is valid as long as bvh->motionData is.
+    static inline Map< Matrix<float, Dynamic, Dynamic, RowStorage> > BVHMotionMatrix(BVHData* bvh)
+    {
+        return Map< Matrix<float, Dynamic, Dynamic, RowStorage> >(bvh->motionData, bvh->frameCount, bvh->channelCount);
+    }
+
+    // View of the channel values of frame i.
+    static inline Map< Vector<float> > BVHFrame(BVHData* bvh, int i)
+    {
+        assert(0 <= i && i < bvh->frameCount);
+        return Map< Vector<float> >(bvh->motionData + i * bvh->channelCount, bvh->channelCount);
+    }
+
     //----------------------------------------------------------------------------------
     // BVH Parser
     //----------------------------------------------------------------------------------
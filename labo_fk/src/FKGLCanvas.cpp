@@ -2,6 +2,7 @@
 
 #include "FKApplication.h"
 #include "Armature.h"
+#include "Map.h"
 
 #include <fstream>
 #include <iostream>
@@ -263,7 +264,7 @@ void FKGLCanvas::draw_contents()
                 continue;
 
             Matrix4f linkM;
-            memcpy(linkM.m, l->M.data(), sizeof(Matrix4f::m));
+            gti320::Map<gti320::Matrix4f>(&linkM.m[0][0]) = l->M;
 
             Matrix4f modelMat = linkM;
             const Matrix4f mvMat = viewMat * modelMat;
@@ -289,12 +290,12 @@ void FKGLCanvas::draw_contents()
             Matrix4f linkM, parentM;
             if (l->parent)
             {
-                memcpy(parentM.m, l->parent->M.data(), sizeof(parentM.m));
+                gti320::Map<gti320::Matrix4f>(&parentM.m[0][0]) = l->parent->M;
 
                 // Compute orientation of the link 
                 // in parent reference frame
                 Vector3f trans;
-                memcpy(trans.v, l->trans.data(), sizeof(trans.v));
+                gti320::Map<gti320::Vector3f>(trans.v) = l->trans;
                 computeVectorRotation(zplus, trans, axis, theta);
 
                 // Compute length of the link
@@ -328,7 +329,7 @@ void FKGLCanvas::draw_contents()
                 m_shader->set_uniform("Kd", Vector4f(0.8f, 0.1f, 0.1f, 0.8f));
 
             Matrix4f linkM;
-            memcpy(linkM.m, l->M.data(), sizeof(Matrix4f::m));
+            gti320::Map<gti320::Matrix4f>(&linkM.m[0][0]) = l->M;
 
             Matrix4f modelMat = linkM;
             const Matrix4f mvMat = viewMat * modelMat;
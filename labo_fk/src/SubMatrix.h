@@ -21,19 +21,19 @@ namespace gti320
         SubMatrix() {}
 
         // (i,j) est le coin supérieur gauche de la sous-matrice
-        int m_i;        // Décalage en ligne 
-        int m_j;        // Décalage en colonne
+        Index m_i;        // Décalage en ligne 
+        Index m_j;        // Décalage en colonne
 
         // la sous-matrice est de dimension : m_rows x m_cols
-        int m_rows;     // Hauteur de la sous-matrice (nombre de lignes)
-        int m_cols;     // Largeur de la sous-matrice (nombre de colonnes)
+        Index m_rows;     // Hauteur de la sous-matrice (nombre de lignes)
+        Index m_cols;     // Largeur de la sous-matrice (nombre de colonnes)
 
     public:
 
         /**
          * Constructeur à partir d'une référence en lecture seule à une matrice.
          */
-        SubMatrix(const Matrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType>& _matrix, int _i, int _j, int _rows, int _cols) :
+        SubMatrix(const Matrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType>& _matrix, Index _i, Index _j, Index _rows, Index _cols) :
             m_matrix(const_cast<Matrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType>&>(_matrix)),
             m_i(_i), m_j(_j), m_rows(_rows), m_cols(_cols)
         {
@@ -42,7 +42,7 @@ namespace gti320
         /**
          * Constructeur à partir d'une référence en lecture et écriture à une matrice.
          */
-        explicit SubMatrix(Matrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType>& _matrix, int _i, int _j, int _rows, int _cols) :
+        explicit SubMatrix(Matrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType>& _matrix, Index _i, Index _j, Index _rows, Index _cols) :
             m_matrix(_matrix),
             m_i(_i), m_j(_j), m_rows(_rows), m_cols(_cols)
         {
@@ -77,8 +77,8 @@ namespace gti320
             //      la sous-matrice.
             assert (m_rows == matrix.rows() && m_cols == matrix.cols());
 
-            for (int j = 0; j < m_cols; ++j) {
-                for (int i = 0; i < m_rows; ++i) {
+            for (Index j = 0; j < m_cols; ++j) {
+                for (Index i = 0; i < m_rows; ++i) {
                     (*this)(i,j) = matrix(i,j);
                 }
             }
@@ -92,7 +92,7 @@ namespace gti320
          * Note : il faut s'assurer que les indices respectent la taille de la
          * sous-matrice
          */
-        _Scalar operator()(int i, int j) const
+        _Scalar operator()(Index i, Index j) const
         {
             // TODO implémenter
             assert(i < m_rows && j < m_cols && i >= 0 && j >= 0);
@@ -106,7 +106,7 @@ namespace gti320
          * Note : il faut s'assurer que les indices respectent la taille de la
          * sous-matrice
          */
-        _Scalar& operator()(int i, int j)
+        _Scalar& operator()(Index i, Index j)
         {
             // TODO implémenter
             assert(i < m_rows && j < m_cols && i >= 0 && j >= 0);
@@ -122,9 +122,9 @@ namespace gti320
             // TODO implémenter
             if constexpr (_OtherRows != Dynamic) { assert(_OtherRows == m_cols); } //constexpr : force de run ce de code durant compilation
             if constexpr (_OtherCols != Dynamic) { assert(_OtherCols == m_rows); }
-            Matrix<_OtherScalar, _OtherRows, _OtherCols, _OtherStorage> result(m_cols, m_rows);
-            for (int i = 0; i < m_rows; ++i) {
-                for (int j = 0; j < m_cols; ++j) {
+            Matrix<_OtherScalar, _OtherRows, _OtherCols, _OtherStorage> result(m_cols, m_rows, Uninitialized);
+            for (Index i = 0; i < m_rows; ++i) {
+                for (Index j = 0; j < m_cols; ++j) {
                     result(j,i) =  static_cast<_OtherScalar>((*this)(i,j)); //static_cast : convertir le resultat en _OtherScalar type (float,int..)
                 }
             }
@@ -133,6 +133,10 @@ namespace gti320
 
 		/**
 		 * Operateur += 
+		 *
+		 * Mise à jour en place du bloc, colonne par colonne (ou ligne par
+		 * ligne) avec le noyau axpy lorsque les ordres de stockage coïncident
+		 * (voir Expression.h).
 		 */
         template <int _OtherRows, int _OtherCols, int _OtherStorageType>
         SubMatrix<_Scalar, _RowsAtCompile, _ColsAtCompile, _StorageType>& operator+=(const Matrix<_Scalar, _OtherRows, _OtherCols, _OtherStorageType>& rhs)
@@ -140,12 +144,7 @@ namespace gti320
         	// TODO mettre à jour les valeurs dans la matrice originale en ajoutant @a rhs.
             assert(rhs.rows() == m_rows && rhs.cols() == m_cols);
 
-            for (int i = 0; i < m_rows; ++i) {
-                for (int j = 0; j < m_cols; ++j) {
-                    (*this)(i,j) += rhs(i,j);
-                }
-            }
-
+            internal::compoundAssign(internal::SumOp(), view(), LeafExpression<_Scalar, _OtherStorageType>(rhs.view()));
             return *this;
         }
 
@@ -158,9 +157,9 @@ namespace gti320
         	// TODO implémenter
             if constexpr (_OtherRows != Dynamic) { assert(_OtherRows == m_rows); }
             if constexpr (_OtherCols != Dynamic) { assert(_OtherCols == m_cols); }
-            Matrix< _Scalar, _OtherRows, _OtherCols, _OtherStorageType> result(m_rows, m_cols);
-            for (int i = 0; i < m_rows; ++i) {
-                for (int j = 0; j < m_cols; ++j) {
+            Matrix< _Scalar, _OtherRows, _OtherCols, _OtherStorageType> result(m_rows, m_cols, Uninitialized);
+            for (Index i = 0; i < m_rows; ++i) {
+                for (Index j = 0; j < m_cols; ++j) {
                     result(i,j) = (*this)(i,j);
                 }
             }
@@ -169,8 +168,17 @@ namespace gti320
 
         }
 
-        inline int rows() const { return m_rows; }
-        inline int cols() const { return m_cols; }
+        /**
+         * Vue à pas du bloc (voir MatrixView.h), utilisable directement par
+         * les noyaux de Operators.h.
+         */
+        MatrixView<_Scalar, _StorageType> view() const
+        {
+            return m_matrix.view(m_i, m_j, m_rows, m_cols);
+        }
+
+        inline Index rows() const { return m_rows; }
+        inline Index cols() const { return m_cols; }
 
     };
 
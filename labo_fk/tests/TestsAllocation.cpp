@@ -0,0 +1,193 @@
+/**
+ * @file TestsAllocation.cpp
+ *
+ * @brief Allocations sur le tas des calculs de cinématique et de la SVD.
+ *
+ * Les opérateurs globaux new[] et delete[] sont remplacés dans ce fichier afin
+ * de compter les allocations faites par les tampons dynamiques. Les petits
+ * vecteurs et matrices (au plus GTI320_INLINE_CAPACITY éléments) tiennent
+ * dans le tampon interne de DenseStorage et ne doivent rien allouer.
+ *
+ */
+
+#include "Armature.h"
+#include "SVD.h"
+#include "Instrumentation.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+using namespace gti320;
+
+namespace {
+
+    struct AllocationCounter
+    {
+        bool enabled;
+        size_t allocations;
+    };
+
+    AllocationCounter g_counter = { false, 0 };
+
+    /**
+     * Active le comptage des allocations pour la durée de vie de l'objet.
+     */
+    class CountAllocations
+    {
+    public:
+        CountAllocations()
+        {
+            g_counter.allocations = 0;
+            g_counter.enabled = true;
+        }
+
+        ~CountAllocations() { g_counter.enabled = false; }
+
+        size_t allocations() const { return g_counter.allocations; }
+    };
+
+    void report(const char* workload, size_t allocations, int iterations, double ms)
+    {
+        std::cout << "  " << std::left << std::setw(32) << workload
+            << " allocations/iteration: " << std::setw(6) << (double)allocations / iterations
+            << " temps: " << ms << " ms" << std::endl;
+    }
+
+    double elapsedMs(const std::chrono::high_resolution_clock::time_point& t)
+    {
+        using namespace std::chrono;
+        return duration_cast<duration<double, std::milli>>(high_resolution_clock::now() - t).count();
+    }
+
+} // namespace
+
+void* operator new[](std::size_t size)
+{
+    if (g_counter.enabled)
+    {
+        ++g_counter.allocations;
+    }
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Vecteurs d'angles d'une chaîne de cinq articulations (pack / unpack).
+ */
+TEST(TestsAllocation, VecteursCinematique)
+{
+    const int nlinks = 5;
+    const int iterations = 10000;
+
+    Armature armature;
+    std::chrono::high_resolution_clock::time_point t = std::chrono::high_resolution_clock::now();
+    CountAllocations counter;
+    for (int it = 0; it < iterations; ++it)
+    {
+        Vector<int, Dynamic> ind(nlinks);
+        Vector<float, Dynamic> theta(3 * nlinks);
+        for (int i = 0; i < nlinks; ++i)
+            ind(i) = i;
+
+        armature.pack(ind, theta);
+        Vector<float, Dynamic> dtheta(theta);
+        dtheta(0) = 0.01f;
+        theta = theta + dtheta;
+        armature.unpack(ind, theta);
+    }
+    report("pack / unpack (5 articulations)", counter.allocations(), iterations, elapsedMs(t));
+    EXPECT_EQ(counter.allocations(), 0u);
+}
+
+/**
+ * SVD d'une petite matrice : les vecteurs de travail (rv1, su, sv) et les
+ * facteurs U, S et V tiennent dans le tampon interne.
+ */
+TEST(TestsAllocation, SVDPetiteMatrice)
+{
+    const int iterations = 10000;
+
+    Matrix<float> A(4, 4);
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            A(i, j) = 1.0f / (float)(i + j + 1) + (i == j ? 1.0f : 0.0f);
+
+    std::chrono::high_resolution_clock::time_point t = std::chrono::high_resolution_clock::now();
+    {
+        CountAllocations counter;
+        for (int it = 0; it < iterations; ++it)
+        {
+            SVD<float> svd(A);
+            svd.decompose();
+        }
+        report("SVD 4x4", counter.allocations(), iterations, elapsedMs(t));
+        EXPECT_EQ(counter.allocations(), 0u);
+    }
+
+    // Le résultat est inchangé : A = U * S * V^T
+    SVD<float> svd(A);
+    svd.decompose();
+    const Matrix<float>& U = svd.getU();
+    const Matrix<float>& V = svd.getV();
+    const Vector<float>& S = svd.getSigma();
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            float a = 0.0f;
+            for (int k = 0; k < 4; ++k)
+                a += U(i, k) * S(k) * V(j, k);
+            EXPECT_NEAR(A(i, j), a, 1e-5f);
+        }
+    }
+}
+
+/**
+ * Cinématique directe d'une chaîne : les transformations des articulations
+ * sont de taille fixe, rien n'est alloué (ni sur le tas, ni dans l'arène de
+ * trame) et aucun tampon dynamique n'est copié.
+ */
+TEST(TestsAllocation, BudgetCinematique)
+{
+    if (!instrumentationEnabled())
+        GTEST_SKIP() << "GTI320_INSTRUMENTATION est desactive";
+
+    const int nlinks = 5;
+    const int iterations = 1000;
+
+    Armature armature;
+    Link* parent = nullptr;
+    for (int i = 0; i < nlinks; ++i)
+    {
+        Vector3f euler, trans;
+        euler(0) = 0.1f * i; euler(1) = 0.2f; euler(2) = -0.3f;
+        trans(0) = 0.0f; trans(1) = 1.0f; trans(2) = 0.0f;
+        Link* link = new Link("link" + std::to_string(i), parent, euler, trans);
+        armature.links.push_back(link);
+        parent = link;
+    }
+    armature.root = armature.links[0];
+    armature.updateKinematics();
+
+    std::chrono::high_resolution_clock::time_point t = std::chrono::high_resolution_clock::now();
+    MemoryScope scope;
+    for (int it = 0; it < iterations; ++it)
+    {
+        armature.updateKinematics();
+    }
+    report("updateKinematics (5 articulations)", scope.allocations(), iterations, elapsedMs(t));
+    EXPECT_EQ(scope.allocations(), 0u);
+    EXPECT_EQ(scope.bytesAllocated(), 0u);
+    EXPECT_EQ(scope.peakBytes(), 0u);
+}